@@ -0,0 +1,119 @@
+#ifndef __APV25_PULSE_FITTER_H__
+#define __APV25_PULSE_FITTER_H__
+
+//HPSTR
+#include "Apv25PulseShape.h"
+
+/**
+ * @brief Dedicated least-squares fitter of APV25 6-sample waveforms
+ *
+ * Fits the baseline subtracted samples of a channel with one or two pulses
+ * of fixed shape, leaving the start time and amplitude of each pulse free.
+ * The minimisation is a Levenberg-Marquardt on at most four parameters
+ * using the analytic derivatives of Apv25PulseShape, so no formula
+ * interpretation or generic minimizer is involved. The per-channel
+ * baselines, noise and pulse shape are held in a Channel, which should be
+ * built once per channel and reused for all the hits of the run.
+ */
+class Apv25PulseFitter {
+
+    public:
+
+        static const int nSamples = 6; //!< samples per waveform
+        static const int maxPulses = 2; //!< maximum number of fitted pulses
+
+        /** Calibration of a single channel */
+        struct Channel {
+            Apv25PulseShape shape; //!< pulse shape of the channel
+            double baseline[nSamples]{}; //!< baseline of each sample [ADC]
+            double sigma[nSamples]{}; //!< noise of each sample [ADC]
+            bool valid{false}; //!< calibration is available
+        };
+
+        /** Result of a waveform fit */
+        struct Result {
+            int nPulses{0}; //!< number of fitted pulses
+            double t0[maxPulses]{}; //!< pulse start times [ns]
+            double t0Err[maxPulses]{}; //!< pulse start time errors [ns]
+            double amp[maxPulses]{}; //!< pulse amplitudes [ADC]
+            double ampErr[maxPulses]{}; //!< pulse amplitude errors [ADC]
+            double chi2{-1}; //!< chi2 of the fit
+            int ndf{0}; //!< number of degrees of freedom
+            int iterations{0}; //!< number of iterations
+            bool converged{false}; //!< fit converged
+        };
+
+        /**
+         * @brief Constructor
+         *
+         * @param samplingTime time between two samples [ns]
+         */
+        Apv25PulseFitter(double samplingTime = 24.0) : samplingTime_(samplingTime) {};
+
+        ~Apv25PulseFitter() {};
+
+        /**
+         * @brief Fit a waveform starting from given pulse times and amplitudes
+         *
+         * @param adcs raw ADC samples
+         * @param channel calibration of the channel
+         * @param nPulses number of pulses, 1 or 2
+         * @param t0Guess initial pulse start times [ns]
+         * @param ampGuess initial pulse amplitudes [ADC]
+         * @return Result
+         */
+        Result fit(const int* adcs, const Channel& channel, int nPulses,
+                   const double* t0Guess, const double* ampGuess) const;
+
+        /**
+         * @brief Fit a waveform with a single pulse, guessing the start from the highest sample
+         *
+         * @param adcs raw ADC samples
+         * @param channel calibration of the channel
+         * @return Result
+         */
+        Result fit(const int* adcs, const Channel& channel) const;
+
+        /**
+         * @brief Value of the fitted pulses at a time
+         *
+         * @param result
+         * @param shape
+         * @param t [ns]
+         * @return double baseline subtracted ADC
+         */
+        static double evaluate(const Result& result, const Apv25PulseShape& shape, double t);
+
+        void setMaxIterations(int maxIterations) { maxIterations_ = maxIterations; };
+        void setTolerance(double tolerance) { tolerance_ = tolerance; };
+        double getSamplingTime() const { return samplingTime_; };
+
+    private:
+
+        /**
+         * @brief chi2 of a parameter set, optionally with the normal equations
+         *
+         * @param y baseline subtracted samples
+         * @param w sample weights 1/sigma^2
+         * @param shape
+         * @param npar number of parameters (t0, amp pairs)
+         * @param par parameters
+         * @param alpha filled with J^T W J if not null
+         * @param beta filled with J^T W (y - f) if not null
+         * @return double
+         */
+        double chi2(const double* y, const double* w, const Apv25PulseShape& shape,
+                    int npar, const double* par, double* alpha, double* beta) const;
+
+        /** Solve a (n x n) symmetric positive definite system in place, false if singular */
+        static bool solve(int n, double* a, double* b);
+
+        /** Invert a (n x n) symmetric positive definite matrix in place, false if singular */
+        static bool invert(int n, double* a);
+
+        double samplingTime_{24.0}; //!< time between two samples
+        int maxIterations_{50}; //!< maximum number of iterations
+        double tolerance_{1e-6}; //!< relative chi2 change at convergence
+};
+
+#endif // __APV25_PULSE_FITTER_H__
@@ -0,0 +1,89 @@
+#ifndef __APV25_PULSE_SHAPE_H__
+#define __APV25_PULSE_SHAPE_H__
+
+/**
+ * @brief Native APV25 pulse shape with analytic time derivative
+ *
+ * Implements the four-pole shaper response used by the SVT hit fitting
+ *
+ *   f(t) = exp(-t/tau1) - exp(-t/tau2) * (1 + r*t + (r*t)^2/2),  r = (tau1-tau2)/(tau1*tau2)
+ *
+ * and the two-pole (CR-RC) response exp(-t/tau1) - exp(-t/tau2). The shape
+ * is zero for t <= 0 and is normalised so that an amplitude A gives a pulse
+ * of height A. For the four-pole model the normalisation point is
+ * 3*(tau1*tau2^3)^(1/4), the same as SvtRawDataAnaProcessor::fourPoleFitFunction,
+ * for the two-pole model it is the exact peak. The normalisation is computed
+ * once per shape, so one instance should be kept per channel.
+ */
+class Apv25PulseShape {
+
+    public:
+
+        /** Pulse shape models */
+        enum Model {
+            FourPole = 0,
+            TwoPole  = 1
+        };
+
+        Apv25PulseShape() {};
+
+        /**
+         * @brief Constructor
+         *
+         * @param tau1 decay time [ns]
+         * @param tau2 rise time [ns]
+         * @param model
+         */
+        Apv25PulseShape(double tau1, double tau2, Model model = FourPole);
+
+        ~Apv25PulseShape() {};
+
+        /**
+         * @brief Set the shaping times and recompute the normalisation
+         *
+         * @param tau1 decay time [ns]
+         * @param tau2 rise time [ns]
+         * @param model
+         */
+        void set(double tau1, double tau2, Model model = FourPole);
+
+        /**
+         * @brief Pulse height at a time after the pulse start
+         *
+         * @param t time since t0 [ns]
+         * @return double
+         */
+        double value(double t) const;
+
+        /**
+         * @brief Pulse height and its derivative with respect to t
+         *
+         * @param t time since t0 [ns]
+         * @param deriv filled with df/dt
+         * @return double
+         */
+        double value(double t, double& deriv) const;
+
+        /** @return time of the normalisation point after t0 [ns] */
+        double getPeakTime() const { return tPeak_; };
+
+        double getTau1() const { return tau1_; };
+        double getTau2() const { return tau2_; };
+        Model getModel() const { return model_; };
+
+    private:
+
+        /** Unnormalised shape and derivative, t > 0 */
+        double raw(double t, double& deriv) const;
+
+        Model model_{FourPole}; //!< pulse shape model
+        double tau1_{0}; //!< decay time
+        double tau2_{0}; //!< rise time
+        double r_{0}; //!< four-pole (tau1-tau2)/(tau1*tau2)
+        double invTau1_{0}; //!< 1/tau1
+        double invTau2_{0}; //!< 1/tau2
+        double tPeak_{0}; //!< normalisation time
+        double norm_{0}; //!< 1/raw(tPeak_)
+};
+
+#endif // __APV25_PULSE_SHAPE_H__
@@ -20,6 +20,7 @@
 #include "ModuleMapper.h"
 #include "TFitResult.h"
 #include "TF1.h"
+#include "FitCache.h"
 #include <fstream>
 
 /**
@@ -90,6 +91,13 @@ class BlFitHistos : public HistoManager{
          */
         void setDebug(bool value){debug_ = value;};
 
+        /**
+         * @brief Use a fit result cache for the channel fits
+         * 
+         * @param fitCache owned by the caller, nullptr disables caching
+         */
+        void setFitCache(FitCache* fitCache){fitCache_ = fitCache;};
+
          /**
          * @brief description
          * 
@@ -101,7 +109,17 @@ class BlFitHistos : public HistoManager{
 
     private:
 
+        /**
+         * @brief Fit a channel histogram, through the fit cache if enabled
+         * 
+         * @param hist 
+         * @param fit 
+         * @param options 
+         */
+        void fitChannel(TH1D* hist, TF1* fit, const std::string& options);
+
         TH1F* fitHistos{nullptr}; //!< description
+        FitCache* fitCache_{nullptr}; //!< optional fit result cache
 
     protected:
         std::map<std::string, TH2F*> histos2d; //!< description
@@ -18,6 +18,8 @@
 #include <exception>
 #include <fstream>
 #include <map>
+#include <random>
+#include <string>
 #include <vector>
 
 //----------//
@@ -38,6 +40,7 @@
 
 //---//
 #include "HpsFitResult.h"
+#include "FitCache.h"
 #include "ChebyshevFitFunction.h"
 #include "LegendreFitFunction.h"
 
@@ -73,6 +76,41 @@ class BumpHunter {
          */
         HpsFitResult* performSearch(TH1* histogram, double mass_hypothesis, bool skip_bkg_fit,
                                     bool skip_ul);
+
+        /**
+         * @brief Perform the search for a list of mass hypotheses.
+         *
+         * Every mass hypothesis is searched with its own copy of this bump
+         * hunter on its own clone of the histogram, without the functions
+         * attached to the original. The result of a mass therefore does not
+         * depend on the other masses, the number of threads or the order of
+         * evaluation, and matches the serial scan bit for bit. TMinuit is not
+         * thread safe, so if it is the minimizer set, or the default one when
+         * none is set, the masses are scanned serially whatever the number of
+         * threads. Each thread fits through its own FitCache on the directory
+         * of the one of this bump hunter and writes no output stream. The
+         * default minimizer of ROOT is never changed.
+         *
+         * @param histogram Histogram containing the mass spectrum.
+         * @param masses The mass hypotheses to search.
+         * @param skip_ul Skip the upper limit calculation.
+         * @param nThreads Number of masses searched concurrently, <= 0 uses one per core.
+         * @return The results, in the order of the given masses. Owned by the caller.
+         */
+        std::vector<HpsFitResult*> scanMassHypotheses(TH1* histogram, const std::vector<double>& masses,
+                                                      bool skip_ul, int nThreads = 1);
+
+        /**
+         * @brief Prepare ROOT for searches running in several threads.
+         *
+         * Enables the ROOT thread safety. Must be called before the threads
+         * are started.
+         *
+         * @return The minimizer the concurrent searches have to use, Minuit2
+         *         if the default one is TMinuit, which is not thread safe,
+         *         empty to keep the default one.
+         */
+        static std::string enableConcurrentFits();
         
         /** 
          * @brief Given the mass of interest, setup the window parameters and 
@@ -162,6 +200,20 @@ class BumpHunter {
          */
         void getUpperLimitPower(TH1* histogram, HpsFitResult* result);
 
+        /**
+         * @brief Use a fit result cache for all the fits.
+         * 
+         * @param fit_cache The cache, owned by the caller. nullptr disables caching.
+         */
+        void setFitCache(FitCache* fit_cache) { fit_cache_ = fit_cache; };
+
+        /**
+         * @brief Set the minimizer of all the fits.
+         *
+         * @param minimizer Minimizer type, empty uses the default one of ROOT.
+         */
+        void setMinimizer(const std::string& minimizer) { minimizer_ = minimizer; };
+
         /**
          * @brief Set the resolution after instantiation.
          * 
@@ -177,16 +229,34 @@ class BumpHunter {
         void setWindowSizeUsesResScale(bool window_use_res_scale) {
             window_use_res_scale_ = window_use_res_scale;
         }
+
+        /**
+         * @brief Sets whether the number of events in each toy fluctuates.
+         * 
+         * By default every toy holds exactly the requested number of background
+         * and signal events, distributed multinomially over the bins. With
+         * Poisson toys every bin content is drawn independently, so the totals
+         * fluctuate around the requested numbers.
+         * 
+         * @param toy_poisson 
+         */
+        void setToyPoisson(bool toy_poisson) { toy_poisson_ = toy_poisson; }
         
         /**
-         * @brief description
+         * @brief Generate binned toy mass spectra within the fit window.
          * 
-         * @param histogram 
-         * @param n_toys 
+         * The expected bin contents are computed once from the "bkg_toys"
+         * function attached to the histogram and from the signal shape, then
+         * the counts of every toy are drawn per bin. Each toy uses its own
+         * random engine seeded from (seed, toy index), so a toy does not
+         * depend on the number of toys generated before it.
+         * 
+         * @param histogram Histogram holding the "bkg_toys" function.
+         * @param n_toys Number of toys to generate.
          * @param seed 
-         * @param toy_sig_samples 
-         * @param bkg_mult 
-         * @param signal_hist 
+         * @param toy_sig_samples Number of signal events per toy.
+         * @param bkg_mult Multiplier of the number of background events.
+         * @param signal_hist Signal shape, a gaussian at the mass hypothesis if null.
          * @return std::vector<TH1*> 
          */
         std::vector<TH1*> generateToys(TH1* histogram, double n_toys, int seed, int toy_sig_samples,
@@ -239,6 +309,16 @@ class BumpHunter {
          */
         void printDebug(std::string message);
          
+        /**
+         * @brief Fit the histogram within the fit window, through the fit cache if enabled.
+         * 
+         * @param histogram 
+         * @param func 
+         * @param options 
+         * @return TFitResultPtr 
+         */
+        TFitResultPtr fitWindow(TH1* histogram, TF1* func, const std::string& options);
+
         /**
          * @brief description
          * 
@@ -252,6 +332,12 @@ class BumpHunter {
         /** Background only fit result. */
         HpsFitResult* bkg_only_result_{nullptr};
         
+        /** Optional fit result cache, not owned. */
+        FitCache* fit_cache_{nullptr};
+
+        /** Minimizer of the fits, the default one if empty. */
+        std::string minimizer_;
+
         /** Output file stream */
         std::ofstream* ofs;
         
@@ -330,6 +416,30 @@ class BumpHunter {
 
         /** desription */
         bool window_use_res_scale_{true};
+
+        /** Draw the toy bin contents from independent Poisson distributions */
+        bool toy_poisson_{false};
+
+        /**
+         * @brief Expected fraction of events in every bin of a toy, including under/overflow.
+         * 
+         * @param toy Toy histogram defining the binning.
+         * @param func Shape sampled within the toy range, used if hist is null.
+         * @param hist Binned shape, uniform within each of its bins.
+         * @return std::vector<double> 
+         */
+        std::vector<double> getToyBinFractions(TH1* toy, TF1* func, TH1* hist);
+
+        /**
+         * @brief Add the counts of n_events drawn from the given bin fractions.
+         * 
+         * @param engine 
+         * @param fractions Bin fractions, summing up to one.
+         * @param n_events 
+         * @param counts 
+         */
+        void drawToyCounts(std::mt19937_64& engine, const std::vector<double>& fractions,
+                           double n_events, std::vector<double>& counts);
 };
 
 #endif // __BUMP_HUNTER_H__
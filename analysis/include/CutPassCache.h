@@ -0,0 +1,92 @@
+#ifndef CUTPASSCACHE_H
+#define CUTPASSCACHE_H
+
+#include <cstdint>
+#include <vector>
+
+#include "IterativeCutSelector.h"
+#include "MutableTTree.h"
+
+/**
+ * @brief The compiled cuts of an IterativeCutSelector bound to the variables of a tuple
+ *
+ * Each cut is bound once to the storage GetEntry fills, the cuts whose
+ * variable is not in the tuple are not applied. An entry is evaluated in
+ * one pass over the compiled cuts, without name lookups. The cache is
+ * made after the cuts are compiled and filtered, the cuts setCutValue
+ * appends later are bound when they are first used. When the cuts are
+ * compiled again, e.g. by filterCuts, all of them are bound again and the
+ * results kept for the entries are dropped.
+ *
+ * select() also keeps, for every entry, the cut which failed it and the
+ * revision of the cuts it was evaluated at. When thresholds change, an
+ * entry failing a cut which did not change is rejected without reading
+ * it, and an entry which passed only evaluates the cuts which changed.
+ * This costs 8 bytes per entry and needs the entries of the tuple to
+ * stay the same.
+ */
+class CutPassCache {
+
+    public:
+
+        /**
+         * @brief Constructor
+         *
+         * @param selector compiled cuts, not owned
+         * @param tree tuple, not owned
+         */
+        CutPassCache(IterativeCutSelector* selector, MutableTTree* tree);
+
+        /**
+         * @brief does entry pass all the cuts
+         *
+         * The entry is read if it can pass, it is the current entry of the
+         * tuple when true is returned.
+         *
+         * @param entry
+         * @return true
+         * @return false
+         */
+        bool select(int entry);
+
+        /**
+         * @brief does the current entry of the tuple pass one cut
+         *
+         * @param cut index of the compiled cut
+         * @return true
+         * @return false
+         */
+        bool passCut(unsigned int cut) {
+            if(!isBound())
+                bind();
+            return !slots_[cut] || selector_->passCompiledCut(cut, *slots_[cut]);
+        }
+
+        /**
+         * @brief get number of entries read by select
+         */
+        long getReads() const { return reads_; }
+
+    private:
+
+        /** @return true if every compiled cut is bound */
+        bool isBound() const {
+            return generation_ == selector_->getGeneration() && slots_.size() == selector_->getCompiledCuts().size();
+        }
+
+        /** Bind the cuts compiled since the last call, all of them if they were compiled again */
+        void bind();
+
+        static const int32_t kUnknown = -2; //!< entry never evaluated
+        static const int32_t kPass = -1; //!< entry passes all the cuts
+
+        IterativeCutSelector* selector_{nullptr}; //!< compiled cuts
+        MutableTTree* tree_{nullptr}; //!< tuple
+        unsigned int generation_{0}; //!< generation of the compiled cuts which are bound
+        std::vector<const double*> slots_; //!< variable of each compiled cut, nullptr if not in the tuple
+        std::vector<int32_t> failed_; //!< cut failing each entry, kPass or kUnknown
+        std::vector<unsigned int> evaluated_; //!< revision each entry was evaluated at
+        long reads_{0}; //!< entries read by select
+};
+
+#endif
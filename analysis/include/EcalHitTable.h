@@ -0,0 +1,140 @@
+#ifndef __ECAL_HIT_TABLE_H__
+#define __ECAL_HIT_TABLE_H__
+
+// HPSTR
+#include "CalHit.h"
+
+// C++
+#include <vector>
+
+/**
+ * @brief Per-event table of the ECal hits indexed by crystal
+ *
+ * The ECal is a fixed grid of crystals with ix in [-23, 23] and iy in
+ * [-5, 5], without ix = 0 and iy = 0, and with the electron gap in the
+ * rows |iy| = 1 for ix in [-10, -2]. Each crystal has a slot in a dense
+ * array, so a hit is found from its (ix, iy) without a search. A crystal
+ * can be hit more than once in an event, the hits of a crystal are told
+ * apart by a time key, the hit time in units of 0.1 ns.
+ *
+ * The slots are invalidated by a counter when the table is cleared, and
+ * the hit storage keeps its capacity, so the same table should be held by
+ * the processor and rebuilt every event.
+ */
+class EcalHitTable {
+
+    public:
+
+        static const int minIx_ = -23; //!< smallest crystal index along x
+        static const int maxIx_ = 23; //!< largest crystal index along x
+        static const int minIy_ = -5; //!< smallest crystal index along y
+        static const int maxIy_ = 5; //!< largest crystal index along y
+
+        EcalHitTable();
+
+        ~EcalHitTable() {};
+
+        /** Remove all the hits, keeping the allocated storage */
+        void clear();
+
+        /**
+         * @brief Rebuild the table from the hits of the current event
+         *
+         * @param hits ECal hits with their crystal indices set
+         */
+        void build(const std::vector<CalHit*>& hits);
+
+        /**
+         * @brief Add a hit
+         *
+         * @param hit hit with its crystal indices set
+         * @param ix crystal index along x
+         * @param iy crystal index along y
+         * @return false if (ix, iy) is not a crystal, the hit is not added
+         */
+        bool add(CalHit* hit, int ix, int iy);
+
+        /** @return key telling apart the hits of a crystal */
+        static int timeKey(double time) { return static_cast<int>(10.0*time); };
+
+        /**
+         * @brief Find a hit from its crystal and time
+         *
+         * @param ix
+         * @param iy
+         * @param key time key of the hit
+         * @return CalHit* nullptr if not found
+         */
+        CalHit* find(int ix, int iy, int key) const;
+
+        /** @return highest energy hit of a crystal, nullptr if the crystal is not hit */
+        CalHit* getHit(int ix, int iy) const;
+
+        /** @return sum of the energies of the hits of a crystal */
+        double getEnergy(int ix, int iy) const;
+
+        /**
+         * @brief Get the highest energy hit of each hit crystal around a crystal
+         *
+         * The neighbours are the up to 8 crystals sharing a side or a corner,
+         * in the same half of the ECal.
+         *
+         * @param ix
+         * @param iy
+         * @return std::vector<CalHit*>
+         */
+        std::vector<CalHit*> getNeighbours(int ix, int iy) const;
+
+        /** @return sum of the hit energies in the neighbours of a crystal, e.g. for isolation */
+        double getNeighbourEnergy(int ix, int iy) const;
+
+        /** @return true if no neighbour of the crystal of a hit has a hit with more energy */
+        bool isLocalMaximum(const CalHit* hit) const;
+
+        /** @return true if (ix, iy) is a crystal */
+        static bool isCrystal(int ix, int iy);
+
+        /**
+         * @brief Check if a crystal is at the edge of the ECal
+         *
+         * Edge crystals are on the outer border (|ix| = 23 or |iy| = 5) or
+         * next to the electron gap (|iy| = 1 and ix in [-11, -1]). Clusters
+         * seeded in an edge crystal are not fiducial.
+         *
+         * @param ix
+         * @param iy
+         * @return true if the crystal is at an edge
+         */
+        static bool isEdge(int ix, int iy);
+
+        /** @return number of hits in the table */
+        int size() const { return entries_.size(); };
+
+    private:
+
+        /** A hit and the next hit of the same crystal */
+        struct Entry {
+            CalHit* hit; //!< the hit
+            int key; //!< time key of the hit
+            int next; //!< next hit of the crystal, -1 for the last one
+        };
+
+        /** @return slot of a crystal, -1 if (ix, iy) is not a crystal */
+        static int slot(int ix, int iy);
+
+        /** @return index along x moved by one step, skipping ix = 0 */
+        static int stepX(int ix, int step) { return (ix + step == 0) ? ix + 2*step : ix + step; };
+
+        /** @return first entry of a slot, -1 if the crystal is not hit in this event */
+        int first(int s) const { return stamps_[s] == stamp_ ? first_[s] : -1; };
+
+        static const int nx_ = maxIx_ - minIx_ + 1; //!< number of slots along x
+        static const int ny_ = maxIy_ - minIy_ + 1; //!< number of slots along y
+
+        std::vector<int> first_; //!< first entry of each slot
+        std::vector<unsigned int> stamps_; //!< event counter when each slot was last filled
+        unsigned int stamp_{1}; //!< current event counter
+        std::vector<Entry> entries_; //!< hits of the event
+};
+
+#endif //__ECAL_HIT_TABLE_H__
@@ -0,0 +1,182 @@
+#ifndef __FIT_CACHE_H__
+#define __FIT_CACHE_H__
+
+//----------------//
+//   C++ StdLib   //
+//----------------//
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//----------//
+//   ROOT   //
+//----------//
+#include <TF1.h>
+#include <TFitResult.h>
+#include <TFitResultPtr.h>
+#include <TH1.h>
+
+/**
+ * @brief On-disk cache of histogram fit results
+ *
+ * Fits are keyed by a hash of the histogram binning, bin contents and
+ * errors, the fit function definition (name, formula, initial parameters
+ * and limits), the fit range and options, the minimizer settings and an
+ * optional caller tag. The tag must describe anything the key cannot
+ * see, e.g. the configuration of a functor based TF1. Each result is stored
+ * as a small text file named after the key inside the cache directory, so
+ * several jobs can share one cache. Lookups and stores may be done from
+ * several threads, as long as they do not fit the same histogram.
+ */
+class FitCache {
+
+    public:
+
+        /** Cached result of a single fit */
+        struct Entry {
+            int status{-1}; //!< minimizer status
+            bool valid{false}; //!< fit validity
+            unsigned int nfree{0}; //!< number of free parameters
+            unsigned int ndf{0}; //!< number of degrees of freedom
+            double chi2{0}; //!< chi2 of the fit
+            double minFcn{0}; //!< minimum of the objective function
+            double edm{0}; //!< estimated distance to minimum
+            std::vector<double> params; //!< fitted parameters
+            std::vector<double> errors; //!< parameter errors
+            std::vector<bool> fixed; //!< fixed parameter flags
+            std::vector<double> covariance; //!< lower triangle of the covariance matrix by rows, empty if not available
+            double xmin{0}; //!< lower edge of the range of the fitted function
+            double xmax{0}; //!< upper edge of the range of the fitted function
+            int rebin{1}; //!< factor the procedure rebinned the histogram by
+        };
+
+        /**
+         * @brief Constructor
+         *
+         * @param cacheDir directory holding the cached results, created if needed
+         */
+        FitCache(const std::string& cacheDir);
+
+        ~FitCache() {};
+
+        /**
+         * @brief Drop-in replacement for TH1::Fit
+         *
+         * If the fit is in the cache the function parameters, errors, chi2
+         * and ndf are set from the stored values, the function is attached
+         * to the histogram unless the "N" option is given and, with the "S"
+         * option, a result holding the stored values and covariance matrix
+         * is returned. Otherwise
+         * the histogram is fitted and the result stored.
+         *
+         * @param hist
+         * @param func
+         * @param options TH1::Fit options
+         * @param xmin
+         * @param xmax
+         * @param tag extra key information
+         * @param minimizer minimizer of the fit, the default one if empty
+         * @return TFitResultPtr
+         */
+        TFitResultPtr fit(TH1* hist, TF1* func, const std::string& options,
+                          double xmin = 0, double xmax = 0, const std::string& tag = "",
+                          const std::string& minimizer = "");
+
+        /**
+         * @brief TH1::Fit with the given minimizer
+         *
+         * The minimizer only applies to this fit, the default one of ROOT is
+         * left untouched, so fits running in other threads are not affected.
+         *
+         * @param hist
+         * @param func
+         * @param options TH1::Fit options
+         * @param xmin
+         * @param xmax
+         * @param minimizer minimizer type, the default one if empty
+         * @return TFitResultPtr
+         */
+        static TFitResultPtr fitWith(TH1* hist, TF1* func, const std::string& options,
+                                     double xmin, double xmax, const std::string& minimizer);
+
+        /**
+         * @brief Key of a multi-step procedure (e.g. an iterative fit) on a histogram
+         *
+         * The key must be computed before running the procedure if it
+         * modifies the histogram, e.g. by rebinning it.
+         *
+         * @param hist
+         * @param tag name and settings of the procedure
+         * @return std::string
+         */
+        std::string procedureKey(TH1* hist, const std::string& tag) const;
+
+        /**
+         * @brief Look up the result of a procedure
+         *
+         * @param key
+         * @param entry
+         * @return true if found
+         */
+        bool get(const std::string& key, Entry& entry);
+
+        /**
+         * @brief Store the result of a procedure
+         *
+         * @param key
+         * @param entry
+         */
+        void put(const std::string& key, const Entry& entry);
+
+        /** Print the number of hits and misses */
+        void printStats() const;
+
+        /** @return number of cache hits */
+        int getHits() const { return hits_; };
+
+        /** @return number of cache misses */
+        int getMisses() const { return misses_; };
+
+        /** @return the cache directory */
+        const std::string& getCacheDir() const { return cacheDir_; };
+
+        /** Add the hits and misses of another cache, e.g. the one of a worker thread */
+        void addStats(const FitCache& other) { hits_ += other.hits_; misses_ += other.misses_; };
+
+    private:
+
+        /** Result of TH1::Fit built from a cache entry */
+        class CachedFitResult : public TFitResult {
+            public:
+                CachedFitResult(const Entry& entry);
+        };
+
+        /** FNV-1a hash helpers */
+        void hash(uint64_t& h, const void* data, size_t size) const;
+        void hash(uint64_t& h, double value) const { hash(h, &value, sizeof(value)); };
+        void hash(uint64_t& h, const std::string& value) const { hash(h, value.data(), value.size()); };
+
+        /** Hash of the histogram binning, contents and errors */
+        void hashHistogram(uint64_t& h, TH1* hist) const;
+
+        /** @return key of a TH1::Fit call */
+        std::string fitKey(TH1* hist, TF1* func, const std::string& options,
+                           double xmin, double xmax, const std::string& tag,
+                           const std::string& minimizer) const;
+
+        /** @return hexadecimal representation of a hash */
+        std::string toKey(uint64_t h) const;
+
+        /** @return path of the cache file for a key */
+        std::string path(const std::string& key) const;
+
+        bool load(const std::string& key, Entry& entry) const;
+        void store(const std::string& key, const Entry& entry) const;
+
+        std::string cacheDir_; //!< cache directory
+        std::atomic<int> hits_{0}; //!< number of cache hits
+        std::atomic<int> misses_{0}; //!< number of cache misses
+};
+
+#endif // __FIT_CACHE_H__
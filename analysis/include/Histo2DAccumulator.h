@@ -0,0 +1,119 @@
+#ifndef __HISTO2D_ACCUMULATOR_H__
+#define __HISTO2D_ACCUMULATOR_H__
+
+// ROOT
+#include "TH2.h"
+
+// C++
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Integer counts of the unit weight fills of a 2D histogram
+ *
+ * A fill is an increment of a uint32_t count, at an index computed from
+ * the uniform binning of the histogram with the same arithmetic as
+ * TAxis::FindFixBin, without a bin search or a weight sum. The counts are
+ * added to the histogram by flush(), e.g. before it is written.
+ *
+ * In dense mode the counts of a row of y bins are a flat array over the x
+ * bins, under and overflows included, allocated when a bin of the row is
+ * first hit: a channel vs ADC map only allocates the ADC range its
+ * channels cover. In sparse mode only the bins which are hit are stored,
+ * for histograms with few hit bins.
+ * Fills with a weight other than 1, and every fill of a histogram with
+ * variable bins, go directly to the histogram.
+ *
+ * After a flush the statistics of the histogram (mean, RMS) are
+ * recomputed from the bin contents, the number of entries counts every
+ * fill as TH1::Fill does.
+ */
+class Histo2DAccumulator {
+
+    public:
+
+        /**
+         * @brief Constructor
+         *
+         * @param histo histogram the counts are added to, not owned
+         * @param sparse store only the bins which are hit
+         */
+        Histo2DAccumulator(TH2* histo, bool sparse = false);
+
+        ~Histo2DAccumulator() {};
+
+        /**
+         * @brief Fill the histogram
+         *
+         * @param x
+         * @param y
+         * @param weight
+         */
+        void fill(double x, double y, double weight = 1.) {
+            if (weight != 1. || !uniform_) {
+                histo_->Fill(x, y, weight);
+                return;
+            }
+            uint32_t binx = findBin(x, x_);
+            uint32_t biny = findBin(y, y_);
+            if (sparse_)
+                ++sparseCounts_[binx + nx_*biny];
+            else {
+                if (rows_.empty())
+                    rows_.resize(y_.nbins + 2);
+                std::vector<uint32_t>& row = rows_[biny];
+                if (row.empty())
+                    row.assign(nx_, 0);
+                ++row[binx];
+            }
+            // No count can wrap around
+            if (++fills_ == UINT32_MAX)
+                flush();
+        };
+
+        /** Add the counts to the histogram and reset them */
+        void flush();
+
+        /** @return histogram the counts are added to */
+        TH2* getHisto() const { return histo_; };
+
+        /** @return true if only the bins which are hit are stored */
+        bool isSparse() const { return sparse_; };
+
+        /** @return number of fills not yet added to the histogram */
+        uint32_t getPending() const { return fills_; };
+
+        /** @return memory used by the counts [bytes] */
+        size_t getMemory() const;
+
+    private:
+
+        /** Uniform binning of an axis */
+        struct Axis {
+            int nbins; //!< number of bins
+            double min; //!< lower edge
+            double max; //!< upper edge
+        };
+
+        /** @return bin of a value, 0 for the underflow and nbins+1 for the overflow, as TAxis::FindFixBin */
+        static uint32_t findBin(double value, const Axis& axis) {
+            if (value < axis.min)
+                return 0;
+            if (!(value < axis.max))
+                return axis.nbins + 1;
+            return 1 + static_cast<int>(axis.nbins*(value - axis.min)/(axis.max - axis.min));
+        };
+
+        TH2* histo_{nullptr}; //!< histogram
+        bool sparse_{false}; //!< sparse mode
+        bool uniform_{false}; //!< both axes have uniform bins
+        Axis x_; //!< x axis
+        Axis y_; //!< y axis
+        uint32_t nx_{0}; //!< bins along x, under and overflow included
+        uint32_t fills_{0}; //!< fills since the last flush
+        std::vector<std::vector<uint32_t>> rows_; //!< dense counts by y bin and x bin, empty rows not hit
+        std::unordered_map<uint32_t, uint32_t> sparseCounts_; //!< sparse counts by global bin
+};
+
+#endif //__HISTO2D_ACCUMULATOR_H__
@@ -11,6 +11,8 @@
 #include "TFile.h"
 #include "TStyle.h"
 
+#include "FitCache.h"
+
 using namespace std;
 
 
@@ -56,6 +58,27 @@ namespace HistogramHelpers {
     int IterativeGaussFit(TH1* hist, double &mu, double &mu_err, double &sigma,
                           double &sigma_err, int m_PrintLevel = 0);
 
+    /**
+     * @brief Iterative gaussian fit using a caller owned fit function
+     * 
+     * Runs the same fit sequence as above without allocating a new TF1,
+     * attaching it to the histogram or writing the projection file. The
+     * fit function must be a "gaus" in the state of a freshly constructed one.
+     * 
+     * @param hist 
+     * @param fit_func 
+     * @param mu 
+     * @param mu_err 
+     * @param sigma 
+     * @param sigma_err 
+     * @param m_PrintLevel 
+     * @param minimizer minimizer type of these fits, empty uses the default one
+     * @return int 
+     */
+    int IterativeGaussFit(TH1* hist, TF1* fit_func, double &mu, double &mu_err,
+                          double &sigma, double &sigma_err, int m_PrintLevel = 0,
+                          const std::string& minimizer = "");
+
     /**
      * @brief description
      * 
@@ -80,9 +103,11 @@ namespace HistogramHelpers {
      * @param sigma_graph 
      * @param num_bins 
      * @param m_PrintLevel 
+     * @param fit_cache optional cache of the projection fits
      */
     void profileYwithIterativeGaussFit(TH2* hist, TH1* mu_graph, TH1* sigma_graph,
-                                       int num_bins = 1, int m_PrintLevel = 0);
+                                       int num_bins = 1, int m_PrintLevel = 0,
+                                       FitCache* fit_cache = nullptr);
 
     /**
      * @brief description
@@ -93,9 +118,56 @@ namespace HistogramHelpers {
      * @param num_bins 
      * @param mu_err_graph 
      * @param sigma_err_graph 
+     * @param fit_cache optional cache of the projection fits
      */
     void profileZwithIterativeGaussFit(TH3* hist, TH2* mu_graph, TH2* sigma_graph,
-                                       int num_bins, TH2* mu_err_graph, TH2* sigma_err_graph);
+                                       int num_bins, TH2* mu_err_graph, TH2* sigma_err_graph,
+                                       FitCache* fit_cache = nullptr);
+
+    /**
+     * @brief Parallel version of profileYwithIterativeGaussFit
+     * 
+     * Bin groups are fitted concurrently, each worker owning its fit function
+     * and a projection buffer reused across bin groups. Results are stored per
+     * bin group and the graphs are filled after the loop in the serial order.
+     * The projections are fitted if they have as many entries as the ones of
+     * the serial profiler. TMinuit is not thread safe: with more than one
+     * thread and TMinuit as the default minimizer, these fits use Minuit2,
+     * whose results can differ slightly from the serial ones. The default
+     * minimizer of the job is not changed. The workers only fit: if the
+     * projection file is open or m_PrintLevel >= 1, each bin group keeps its
+     * projection and fit, which are printed and written on the calling thread
+     * once all the fits are done.
+     * 
+     * @param hist 
+     * @param mu_graph 
+     * @param sigma_graph 
+     * @param num_bins 
+     * @param nThreads number of workers, <= 0 uses one per core
+     * @param m_PrintLevel 
+     * @param fit_cache optional cache of the projection fits
+     */
+    void profileYwithIterativeGaussFitMT(TH2* hist, TH1* mu_graph, TH1* sigma_graph,
+                                         int num_bins = 1, int nThreads = 0, int m_PrintLevel = 0,
+                                         FitCache* fit_cache = nullptr);
+
+    /**
+     * @brief Parallel version of profileZwithIterativeGaussFit
+     * 
+     * See profileYwithIterativeGaussFitMT.
+     * 
+     * @param hist 
+     * @param mu_graph 
+     * @param sigma_graph 
+     * @param num_bins 
+     * @param mu_err_graph 
+     * @param sigma_err_graph 
+     * @param nThreads number of workers, <= 0 uses one per core
+     * @param fit_cache optional cache of the projection fits
+     */
+    void profileZwithIterativeGaussFitMT(TH3* hist, TH2* mu_graph, TH2* sigma_graph,
+                                         int num_bins, TH2* mu_err_graph, TH2* sigma_err_graph,
+                                         int nThreads = 0, FitCache* fit_cache = nullptr);
 
     /**
      * @brief description
@@ -117,6 +189,14 @@ namespace HistogramHelpers {
      */
     void CloseProjectionFile();
 
+    /**
+     * @brief Write a fitted projection to the projection file, if open
+     * 
+     * @param hist 
+     * @param fit_func 
+     */
+    void WriteProjection(TH1* hist, TF1* fit_func);
+
     /** description */
     TFile* outFile_for_projections;
 } 
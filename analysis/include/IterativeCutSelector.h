@@ -5,6 +5,7 @@
 #include <iostream>
 #include <map>
 #include <memory>
+#include <vector>
 #include "BaseSelector.h"
 
 #include "TH1F.h"
@@ -22,6 +23,17 @@ class IterativeCutSelector : public BaseSelector {
 
     public: 
 
+        /**
+         * @brief A cut with its variable and comparison resolved from the cut name
+         */
+        struct CompiledCut {
+            std::string name; //!< cut name
+            std::string variable; //!< variable the cut is applied to
+            bool greaterThan{false}; //!< values below the threshold fail the cut, above it otherwise
+            double threshold{0.}; //!< cut value
+            unsigned int revision{0}; //!< selector revision of the last change of the threshold
+        };
+
         IterativeCutSelector();
         
         IterativeCutSelector(const std::string& inputName);
@@ -92,10 +104,57 @@ class IterativeCutSelector : public BaseSelector {
          */
         std::map<std::string, std::pair<double,int>>* getPointerToCuts(){ return &cuts; }
 
+        /**
+         * @brief compile the cuts, in the order of the cut map
+         *
+         * The variable and comparison of each cut are resolved once here,
+         * setCutValue keeps the thresholds up to date and appends the cuts
+         * it creates. filterCuts compiles the remaining cuts again.
+         */
+        void compileCuts();
+
+        /**
+         * @brief get the compiled cuts
+         */
+        const std::vector<CompiledCut>& getCompiledCuts() const { return compiled_; }
+
+        /**
+         * @brief get the revision of the cuts, incremented by every threshold change
+         */
+        unsigned int getRevision() const { return revision_; }
+
+        /**
+         * @brief get the generation of the compiled cuts, incremented by every compileCuts
+         *
+         * The indices of the compiled cuts only hold within a generation.
+         */
+        unsigned int getGeneration() const { return generation_; }
+
+        /**
+         * @brief does value pass compiled cut, as passCutGTorLT
+         *
+         * @param cut index of the compiled cut
+         * @param val
+         * @return true
+         * @return false
+         */
+        bool passCompiledCut(unsigned int cut, double val) const {
+            if(val == skipCutVarValue_)
+                return true;
+            const CompiledCut& compiled = compiled_[cut];
+            return compiled.greaterThan ? !(val < compiled.threshold) : !(val > compiled.threshold);
+        }
+
 
     private:
         //When this variable value is encountered, do not apply cut to event
         double skipCutVarValue_ = -9876543210.0; //Must match definition in MutableTTree
+
+        bool isCompiled_{false}; //!< compileCuts was called
+        std::vector<CompiledCut> compiled_; //!< compiled cuts
+        std::map<std::string, unsigned int> compiledIndex_; //!< index of the compiled cuts by name
+        unsigned int revision_{0}; //!< revision of the cuts
+        unsigned int generation_{0}; //!< generation of the compiled cuts
 };
 
 #endif
@@ -87,6 +87,13 @@ class MutableTTree {
          */
         bool variableExists(std::string variable);
 
+        /** 
+         * @brief Get the storage of a variable, which GetEntry fills
+         * @param variable
+         * @return pointer to the value, nullptr if the variable does not exist
+         */
+        const double* getVariableSlot(const std::string& variable) const;
+
         virtual void addVariable(std::string variableName, double param)=0;
 
         void addVariableToTBranch(const std::string& variableName);
@@ -0,0 +1,94 @@
+#ifndef __SICLUSTER_INDEX_H__
+#define __SICLUSTER_INDEX_H__
+
+// HPSTR
+#include "TrackerHit.h"
+
+// C++
+#include <vector>
+
+/**
+ * @brief Per-event spatial index of SiClusters
+ *
+ * Buckets the SiClusters of an event by (volume, layer) and sorts each
+ * bucket by global Y. The strip range of every cluster is computed once
+ * at build time so that neighbour searches do not have to copy the raw
+ * hit strip vectors. Buckets keep their capacity between events, so the
+ * same index should be held by the processor and rebuilt every event.
+ */
+class SiClusterIndex {
+
+    public:
+
+        /** Cached information of a single SiCluster */
+        struct Entry {
+            double y;         //!< global Y of the cluster
+            double time;      //!< cluster time
+            int id;           //!< cluster ID
+            int minStrip;     //!< smallest raw hit strip number
+            int maxStrip;     //!< largest raw hit strip number
+            TrackerHit* hit;  //!< the indexed cluster
+        };
+
+        SiClusterIndex() {};
+
+        ~SiClusterIndex() {};
+
+        /**
+         * @brief Rebuild the index from the SiClusters of the current event
+         *
+         * Clusters without raw hit strips are not indexed.
+         *
+         * @param siClusters
+         */
+        void build(std::vector<TrackerHit*>* siClusters);
+
+        /** Remove all the entries, keeping the allocated buckets */
+        void clear();
+
+        /**
+         * @brief Get the clusters of a (volume, layer), sorted by global Y
+         *
+         * @param volume
+         * @param layer
+         * @return const std::vector<Entry>&
+         */
+        const std::vector<Entry>& getBucket(int volume, int layer) const;
+
+        /**
+         * @brief Find the closest cluster further from the beam axis than a hit
+         *
+         * Looks in the (volume, layer) bucket of the hit for the cluster
+         * closest in global Y that is further from the beam axis (above the
+         * hit in the top volume, below it in the bottom volume), that is
+         * within the time window and that is not adjacent in strip number
+         * to the hit. The search starts at the hit position and stops at the
+         * first cluster passing the requirements.
+         *
+         * @param volume
+         * @param layer
+         * @param id ID of the hit, excluded from the search
+         * @param y global Y of the hit
+         * @param minStrip smallest raw hit strip number of the hit
+         * @param maxStrip largest raw hit strip number of the hit
+         * @param maxTime maximum absolute cluster time
+         * @return const Entry* closest cluster, nullptr if none is found
+         */
+        const Entry* findClosestOutward(int volume, int layer, int id, double y,
+                int minStrip, int maxStrip, double maxTime = 30.0) const;
+
+        /** @return number of indexed clusters */
+        int size() const {return nEntries_;};
+
+    private:
+
+        /** @return bucket position of a (volume, layer), -1 if outside the index */
+        int key(int volume, int layer) const;
+
+        static const int nVolumes_ = 2; //!< top (0) and bottom (1)
+        std::vector<std::vector<Entry>> buckets_; //!< entries per (volume, layer)
+        std::vector<Entry> empty_; //!< returned for unknown (volume, layer)
+        int nEntries_{0}; //!< number of indexed clusters
+};
+
+#endif //__SICLUSTER_INDEX_H__
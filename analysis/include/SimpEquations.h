@@ -1,4 +1,8 @@
+#ifndef __SIMP_EQUATIONS_H__
+#define __SIMP_EQUATIONS_H__
+
 #include <iostream>
+#include <vector>
 #include <TEfficiency.h>
 #include <TMath.h>
 #include <TH1F.h>
@@ -13,7 +17,19 @@ using json = nlohmann::json;
 class SimpEquations {
 
     public:
-            
+
+        /**
+         * @brief Displaced vertex acceptance integrand of a signal efficiency
+         *
+         * Bins of the efficiency beyond the zcut, with the efficiency minus its
+         * low error already evaluated, so the acceptance can be integrated for
+         * many lifetimes without walking the TEfficiency again.
+         */
+        struct VertexAcceptance {
+            std::vector<double> dz; //!< target position minus the low edge of each bin
+            std::vector<double> efficiency; //!< efficiency minus its low error in each bin
+            std::vector<double> width; //!< width of each bin
+        };
 
         SimpEquations(int year);
 
@@ -75,6 +91,74 @@ class SimpEquations {
         
         double getAprimeMassFromVectorMass(double m_V){return m_V * mass_ratio_Ap_to_Vd_;};
 
+        /**
+         * @brief Evaluate the bins of a signal efficiency used by the vertex acceptance
+         *
+         * @param effCalc_h signal selection efficiency vs truth vertex z
+         * @param target_pos target position [mm]
+         * @param zcut bins with a low edge below zcut are dropped
+         * @return VertexAcceptance
+         */
+        static VertexAcceptance vertexAcceptance(TEfficiency* effCalc_h, double target_pos, double zcut);
+
+        /**
+         * @brief Displaced vertex acceptance for one boosted decay length
+         *
+         * Same integral as the vectorized overload, read directly from the
+         * efficiency, for the single point expectedSignalCalculation.
+         *
+         * @param effCalc_h signal selection efficiency vs truth vertex z
+         * @param target_pos target position [mm]
+         * @param zcut bins with a low edge below zcut are dropped
+         * @param gcTau boosted decay length [mm]
+         * @return acceptance
+         */
+        static double effVertex(TEfficiency* effCalc_h, double target_pos, double zcut, double gcTau);
+
+        /**
+         * @brief Displaced vertex acceptance for several boosted decay lengths at once
+         *
+         * The loop over the lifetimes is innermost so it is vectorized.
+         *
+         * @param acceptance integrand from vertexAcceptance
+         * @param gcTau boosted decay lengths [mm]
+         * @param effVtx acceptance for each gcTau
+         * @param n number of decay lengths
+         */
+        static void effVertex(const VertexAcceptance& acceptance, const double* gcTau, double* effVtx, int n);
+
+        /**
+         * @brief Expected signal for a list of epsilon values at one mass
+         *
+         * Same as the expectedSignalCalculation overload taking dNdm, radFrac
+         * and radAcc, evaluated for every epsilon in one pass.
+         *
+         * @param m_V dark vector mass [MeV]
+         * @param eps kinetic mixing strengths
+         * @param rho rho (true) or phi (false) dark vector
+         * @param E_V dark vector energy [GeV]
+         * @param acceptance integrand from vertexAcceptance
+         * @param dNdm background rate in the control region
+         * @param radFrac radiative fraction
+         * @param radAcc radiative acceptance
+         * @param expSignal expected signal for each epsilon
+         */
+        void expectedSignal(double m_V, const std::vector<double>& eps, bool rho, double E_V,
+                const VertexAcceptance& acceptance, double dNdm, double radFrac, double radAcc,
+                std::vector<double>& expSignal);
+
+        /**
+         * @brief Binomial significance ZBi of an on/off measurement
+         *
+         * @param n_on events in the signal region
+         * @param n_off events in the background region
+         * @param tau ratio of the background region to the signal region
+         * @return ZBi
+         */
+        static double zbi(double n_on, double n_off, double tau);
+
+        void setDebug(int debug) { debug_ = debug; };
+
     private:
 
         int year_ = 2016;//!< year (used to specify polynomial choices)
@@ -84,5 +168,8 @@ class SimpEquations {
         double ratio_mPi_to_fPi_ = 4.*M_PI;//!< defualt dark pion mass to decay constant ratio
         double m_l_ = 0.511;//!< default lepton mass (ele/pos only)
         double alpha_dark_ = 0.1;//!< default A' to dark meson coupling
+        int debug_ = 0;//!< print the inputs of each expected signal calculation
 
 };
+
+#endif
@@ -0,0 +1,116 @@
+/**
+ * @file SimpReach.h
+ * @brief Expected signal and ZBi grids of the SIMP reach.
+ */
+
+#ifndef __SIMP_REACH_H__
+#define __SIMP_REACH_H__
+
+//----------------//
+//   C++ StdLib   //
+//----------------//
+#include <memory>
+#include <string>
+#include <vector>
+
+//-----------//
+//   hpstr   //
+//-----------//
+#include "SimpEquations.h"
+
+/**
+ * @brief Expected signal and ZBi of the SIMP search on a mass x epsilon grid
+ *
+ * Replaces the mass x epsilon loops of the python reach scripts. The
+ * configuration is a JSON file:
+ *
+ *     {
+ *       "year": 2016,
+ *       "simp_params": "simp_parameters.json",
+ *       "E_V": 1.35, "target_pos": -4.3, "signal_sf": 1.0,
+ *       "logEps2": {"nbins": 200, "min": -8.0, "max": -4.0},
+ *       "masses": [
+ *         {"mass": 60.0, "effFile": "zbi_60.root", "effName": "effCalc_h",
+ *          "zcut": 25.0, "nbkg": 0.5, "dNdm": 1.0e5, "radFrac": 0.07, "radAcc": 0.1},
+ *         ...
+ *       ]
+ *     }
+ *
+ * "mass" is the dark vector mass in MeV and "effFile"/"effName" locate the
+ * signal efficiency vs truth vertex z beyond the zcut. "nbkg" is the
+ * background expected beyond the zcut. "dNdm", "radFrac" and "radAcc" are
+ * optional and default to the SimpEquations parametrizations.
+ *
+ * The efficiencies are read and turned into vertex acceptance integrands
+ * once per mass. The masses are then distributed over threads and for each
+ * mass every epsilon is evaluated in one pass with
+ * SimpEquations::expectedSignal. The grids are written as 2D histograms of
+ * mass vs log10(eps^2).
+ */
+class SimpReach {
+
+    public:
+
+        /**
+         * @brief Constructor
+         *
+         * @param cfgFile JSON configuration
+         * @param nThreads number of threads the masses are distributed over
+         */
+        SimpReach(const std::string& cfgFile, int nThreads = 1);
+
+        ~SimpReach();
+
+        /** Read the efficiencies and prepare the vertex acceptance of each mass */
+        void initialize();
+
+        /** Calculate the expected signal and ZBi of every grid point */
+        void calculate();
+
+        /**
+         * @brief Write the grids
+         *
+         * @param outFilename output ROOT file
+         */
+        void write(const std::string& outFilename);
+
+        void setDebug(int debug) { debug_ = debug; };
+
+    private:
+
+        /** Inputs and results of one mass */
+        struct MassPoint {
+            double mass{0.}; //!< dark vector mass [MeV]
+            double zcut{0.}; //!< zcut [mm]
+            double nbkg{0.}; //!< background beyond the zcut
+            double dNdm{0.}; //!< background rate in the control region
+            double radFrac{0.}; //!< radiative fraction
+            double radAcc{0.}; //!< radiative acceptance
+            SimpEquations::VertexAcceptance acceptance; //!< signal acceptance integrand
+            std::vector<double> nSigRho; //!< expected rho signal for each epsilon
+            std::vector<double> nSigPhi; //!< expected phi signal for each epsilon
+            std::vector<double> zbi; //!< ZBi for each epsilon
+        };
+
+        /** Fill the results of one mass */
+        void calculate(MassPoint& point);
+
+        std::string cfgFile_; //!< JSON configuration
+        int nThreads_{1}; //!< number of threads
+        int debug_{0}; //!< debug level
+
+        int year_{2016}; //!< year of the SimpEquations parametrizations
+        std::string simpParams_{""}; //!< SIMP model parameters
+        double E_V_{1.35}; //!< mean dark vector energy [GeV]
+        double targetPos_{-4.3}; //!< target position [mm]
+        double signalSf_{1.0}; //!< signal scale factor
+        int nLogEps2_{200}; //!< number of log10(eps^2) bins
+        double minLogEps2_{-8.0}; //!< lower edge of the log10(eps^2) axis
+        double maxLogEps2_{-4.0}; //!< upper edge of the log10(eps^2) axis
+
+        std::unique_ptr<SimpEquations> simpEqs_; //!< SIMP equations
+        std::vector<double> eps_; //!< epsilon at the center of each log10(eps^2) bin
+        std::vector<MassPoint> points_; //!< masses, sorted
+};
+
+#endif // __SIMP_REACH_H__
@@ -11,13 +11,18 @@
 #include "RawSvtHit.h"
 
 #include "ModuleMapper.h"
+#include "Histo2DAccumulator.h"
 
 #include <string>
+#include <vector>
 
 /**
- * @brief description
+ * @brief Baseline histograms of the SVT hybrids
  *
- * details
+ * The histograms of each hybrid are bound once, when they are defined, to
+ * the (module, layer) of the hybrid. The channel vs ADC histograms of the
+ * samples are filled through Histo2DAccumulator counts which are added to
+ * them by saveHistos.
  */
 class Svt2DBlHistos : public HistoManager{
 
@@ -45,6 +50,23 @@ class Svt2DBlHistos : public HistoManager{
          */
         void FillHistograms(std::vector<RawSvtHit*> *rawSvtHits_,float weight = 1.);
 
+        /**
+         * @brief Add the pending counts to the channel vs ADC histograms and save them
+         *
+         * @param outF
+         * @param folder
+         */
+        virtual void saveHistos(TFile* outF = nullptr, std::string folder = "");
+
+        /**
+         * @brief Store only the hit (channel, ADC) bins, for low occupancy runs
+         *
+         * Must be set before DefineHistos.
+         *
+         * @param sparse
+         */
+        void setSparse(bool sparse) { sparse_ = sparse; };
+
 
     private:
 
@@ -54,5 +76,26 @@ class Svt2DBlHistos : public HistoManager{
         TH1F* svtCondHisto{nullptr}; //!< description 
         //ModuleMapper
         ModuleMapper* mmapper_; //!< description
+
+        static const int nModules_ = 4; //!< modules of a layer
+        static const int nLayers_ = 15; //!< layers, numbered from 1
+
+        /** @struct Hybrid */
+        struct Hybrid {
+            TH1F* hitN{nullptr}; //!< number of hits per event
+            std::vector<int> samples; //!< samples with a channel vs ADC histogram
+            std::vector<Histo2DAccumulator> adcs; //!< channel vs ADC counts of each sample
+        };
+
+        /** @return index of the hybrid of a module and layer, -1 if none */
+        int hybridIndex(int mod, int lay) const {
+            return (mod >= 0 && mod < nModules_ && lay >= 0 && lay < nLayers_) ? hybridIndex_[mod][lay] : -1;
+        };
+
+        bool sparse_{false}; //!< sparse channel vs ADC counts
+        int hybridIndex_[nModules_][nLayers_]; //!< hybrid of each module and layer
+        std::vector<Hybrid> hybrids_; //!< hybrids and their histograms
+        std::vector<int> hybridHits_; //!< hits of each hybrid in the event
+        TH1F* hitMulti_{nullptr}; //!< number of hits per event
 };
 #endif
@@ -0,0 +1,86 @@
+#ifndef __SVT_CALIBRATION_CACHE_H__
+#define __SVT_CALIBRATION_CACHE_H__
+
+//----------------//
+//   C++ StdLib   //
+//----------------//
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Binary cache of SVT calibration tables
+ *
+ * Stores float tables indexed by (feb, hybrid, channel), e.g. the offline
+ * baselines and the pulse shape time profiles, so that the text calibration
+ * files only have to be parsed once per node. The cache file is named after
+ * a signature of the source files (path, size and modification time), so a
+ * changed calibration file gets a new cache entry. The file starts with a
+ * versioned header and a table directory, followed by the table contents
+ * and protected by a checksum. It is memory mapped when loading, so jobs on
+ * the same node share the page cache. Files are written to a temporary name
+ * and renamed, so concurrent jobs never see a partial cache.
+ */
+class SvtCalibrationCache {
+
+    public:
+
+        /**
+         * @brief Constructor
+         *
+         * @param cacheDir directory holding the cache files, created if needed
+         * @param sources calibration files the tables are built from
+         */
+        SvtCalibrationCache(const std::string& cacheDir, const std::vector<std::string>& sources);
+
+        ~SvtCalibrationCache() {};
+
+        /**
+         * @brief Register a table to load or store
+         *
+         * @param name table name, at most 31 characters
+         * @param data table contents
+         * @param size number of floats in the table
+         */
+        void addTable(const std::string& name, float* data, size_t size);
+
+        /**
+         * @brief Fill the registered tables from the cache
+         *
+         * Fails if the cache file is missing, has another version, does not
+         * have the registered tables with the same sizes or has a wrong
+         * checksum. The tables are left untouched on failure.
+         *
+         * @return true if the tables were loaded
+         */
+        bool load();
+
+        /**
+         * @brief Write the registered tables to the cache
+         *
+         * @return true if the cache file was written
+         */
+        bool store() const;
+
+        /** @return path of the cache file */
+        std::string getPath() const { return path_; };
+
+    private:
+
+        /** Registered table */
+        struct Table {
+            std::string name; //!< table name
+            float* data; //!< table contents
+            size_t size; //!< number of floats
+        };
+
+        /** FNV-1a hash */
+        static void hash(uint64_t& h, const void* data, size_t size);
+
+        std::string cacheDir_; //!< cache directory
+        std::string path_; //!< cache file
+        uint64_t signature_{0}; //!< hash of the source files
+        std::vector<Table> tables_; //!< registered tables
+};
+
+#endif // __SVT_CALIBRATION_CACHE_H__
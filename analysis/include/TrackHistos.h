@@ -6,13 +6,19 @@
 #include "TrackerHit.h"
 #include "Vertex.h"
 #include "Particle.h"
+#include <map>
+#include <memory>
 #include <string>
 #include <vector>
 
 /**
  * @brief description
  * 
- * details
+ * The track and vertex histograms are filled through fill plans: the first
+ * fill of a track name prefix, or of the vertices, binds every configured
+ * histogram to the quantity it shows, then every fill computes the
+ * quantities once and fills the bound histograms directly, without building
+ * names or looking them up.
  */
 class TrackHistos : public HistoManager {
 
@@ -146,6 +152,95 @@ class TrackHistos : public HistoManager {
         void doTrackComparisonPlots(bool doplots) { doTrkCompPlots = doplots; };
 
     private:
+
+        /** Quantities of a track filled by Fill1DTrack and Fill2DTrack */
+        enum TrackQuantity {
+            kTrkD0, kTrkPhi, kTrkOmega, kTrkSignedPt, kTrkP, kTrkSignedInvPt, kTrkTanLambda, kTrkZ0,
+            kTrkZ0oTanLambda, kTrkTime, kTrkChi2, kTrkChi2Ndf, kTrkNShared, kTrkNHits2d,
+            kTrkPosX, kTrkPosY, kTrkPosZ, kTrkEcalX, kTrkEcalY, kTrkEcalZ,
+            kTrkD0Err, kTrkPhiErr, kTrkOmegaErr, kTrkTanLambdaErr, kTrkZ0Err, kTrkType,
+            kNTrackQuantities
+        };
+
+        /** Quantities of a vertex and of its particles filled by the vertex fills */
+        enum VertexQuantity {
+            kVtxChi2, kVtxX, kVtxY, kVtxZ, kVtxSvtX, kVtxSvtY, kVtxSvtZ,
+            kVtxSigmaX, kVtxSigmaY, kVtxSigmaZ, kVtxCovXX, kVtxCovYY, kVtxCovZZ,
+            kVtxInvM, kVtxInvMErr, kVtxPx, kVtxPy, kVtxPz, kVtxP,
+            kEleClusE, kPosClusE, kEleEoP, kPosEoP, kEleClusX, kPosClusX,
+            kEleTrkClusX, kEleTrkClusY, kPosTrkClusX, kPosTrkClusY,
+            kEleTrkP, kPosTrkP, kEleTrkPhi, kPosTrkPhi, kEleTrkZ0, kPosTrkZ0,
+            kEleTrkD0, kPosTrkD0, kEleTrkTanLambda, kPosTrkTanLambda,
+            kEleP, kPosP, kPmiss, kEsum, kEsumClus, kPsum, kPtAsym,
+            kThetaxV0, kThetaxPos, kThetayPos, kThetayMiss, kThetayDiff,
+            kNVertexQuantities
+        };
+
+        /** 1D histogram bound to a quantity */
+        struct Fill1D {
+            TH1F* histo; //!< bound histogram
+            int x; //!< quantity
+            bool weighted; //!< filled with the event weight, or with 1
+        };
+
+        /** 2D histogram bound to two quantities */
+        struct Fill2D {
+            TH2F* histo; //!< bound histogram
+            int x; //!< quantity on the x axis
+            int y; //!< quantity on the y axis
+        };
+
+        /** Histograms filled from the same quantities */
+        struct FillList {
+            std::vector<Fill1D> fills1d; //!< 1D histograms
+            std::vector<Fill2D> fills2d; //!< 2D histograms
+        };
+
+        /** Fill1DTrack histograms of a track name prefix */
+        struct TrackFillPlan : public FillList {
+            TH1F* topZ0{nullptr}; //!< z0 of the top tracks
+            TH1F* botZ0{nullptr}; //!< z0 of the bottom tracks
+            TH1F* hitLayers{nullptr}; //!< layers of the hits
+            TH1F* sharingHits{nullptr}; //!< hit sharing categories
+            TH1F* strategy{nullptr}; //!< tracking strategies
+        };
+
+        /** Histograms of a vertex and its particles */
+        struct PairFillPlan : public FillList {
+            TH2F* eleTrkClusXHitLayers{nullptr}; //!< electron track-cluster x vs hit layers
+            TH2F* posTrkClusXHitLayers{nullptr}; //!< positron track-cluster x vs hit layers
+        };
+
+        /** @return the Fill1DTrack plan of a track name prefix, bound at the first call */
+        const TrackFillPlan& trackPlan(const std::string& trkname);
+
+        /** @return the Fill2DTrack plan of a track name prefix, bound at the first call */
+        const FillList& track2DPlan(const std::string& trkname);
+
+        /** @return the Fill1DVertex(vtx) plan, bound at the first call */
+        const FillList& vertexPlan();
+
+        /** @return the Fill1DVertex(vtx, ele, pos, ...) plan, bound at the first call */
+        const PairFillPlan& pairPlan();
+
+        /** @return the Fill2DHistograms plan, bound at the first call */
+        const FillList& vertex2DPlan();
+
+        /** @return configured 1D histogram, nullptr with a warning if not defined */
+        TH1F* bind1D(const std::string& histoName);
+
+        /** @return configured 2D histogram, nullptr with a warning if not defined */
+        TH2F* bind2D(const std::string& histoName);
+
+        /** Compute the vertex quantities shared by all vertex fills */
+        void vertexQuantities(Vertex* vtx, float* q);
+
+        std::map<std::string, TrackFillPlan> trackPlans_; //!< Fill1DTrack plans by track name prefix
+        std::map<std::string, FillList> track2DPlans_; //!< Fill2DTrack plans by track name prefix
+        std::unique_ptr<FillList> vertexPlan_; //!< Fill1DVertex(vtx) plan
+        std::unique_ptr<PairFillPlan> pairPlan_; //!< Fill1DVertex(vtx, ele, pos, ...) plan
+        std::unique_ptr<FillList> vertex2DPlan_; //!< Fill2DHistograms plan
+
         /** Vertices */
         std::vector<std::string> vPs{"vtx_chi2", "vtx_X", "vtx_Y", "vtx_Z", "vtx_sigma_X","vtx_sigma_Y","vtx_sigma_Z","vtx_InvM","vtx_InvMErr"};
 
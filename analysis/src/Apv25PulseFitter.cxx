@@ -0,0 +1,188 @@
+#include "Apv25PulseFitter.h"
+
+#include <cmath>
+
+namespace {
+    const int MAX_PAR = 2*Apv25PulseFitter::maxPulses;
+}
+
+double Apv25PulseFitter::chi2(const double* y, const double* w, const Apv25PulseShape& shape,
+        int npar, const double* par, double* alpha, double* beta) const {
+
+    if (alpha) {
+        for (int i = 0; i < npar*npar; ++i) alpha[i] = 0.;
+        for (int i = 0; i < npar; ++i) beta[i] = 0.;
+    }
+
+    double sum = 0.;
+    for (int isample = 0; isample < nSamples; ++isample) {
+        double t = isample*samplingTime_;
+        double model = 0.;
+        //Derivatives of the model with respect to (t0, amp) of each pulse
+        double grad[MAX_PAR];
+        for (int ipar = 0; ipar < npar; ipar += 2) {
+            double deriv;
+            double f = shape.value(t - par[ipar], deriv);
+            model += par[ipar+1]*f;
+            grad[ipar] = -par[ipar+1]*deriv;
+            grad[ipar+1] = f;
+        }
+        double res = y[isample] - model;
+        sum += w[isample]*res*res;
+
+        if (alpha) {
+            for (int i = 0; i < npar; ++i) {
+                beta[i] += w[isample]*grad[i]*res;
+                for (int j = 0; j <= i; ++j)
+                    alpha[i*npar+j] += w[isample]*grad[i]*grad[j];
+            }
+        }
+    }
+
+    if (alpha) {
+        for (int i = 0; i < npar; ++i)
+            for (int j = i+1; j < npar; ++j)
+                alpha[i*npar+j] = alpha[j*npar+i];
+    }
+    return sum;
+}
+
+bool Apv25PulseFitter::solve(int n, double* a, double* b) {
+    //Cholesky decomposition a = L L^T, L stored in the lower triangle
+    for (int j = 0; j < n; ++j) {
+        double d = a[j*n+j];
+        for (int k = 0; k < j; ++k) d -= a[j*n+k]*a[j*n+k];
+        if (!(d > 0.)) return false;
+        d = std::sqrt(d);
+        a[j*n+j] = d;
+        for (int i = j+1; i < n; ++i) {
+            double s = a[i*n+j];
+            for (int k = 0; k < j; ++k) s -= a[i*n+k]*a[j*n+k];
+            a[i*n+j] = s/d;
+        }
+    }
+    //Forward and back substitution
+    for (int i = 0; i < n; ++i) {
+        for (int k = 0; k < i; ++k) b[i] -= a[i*n+k]*b[k];
+        b[i] /= a[i*n+i];
+    }
+    for (int i = n-1; i >= 0; --i) {
+        for (int k = i+1; k < n; ++k) b[i] -= a[k*n+i]*b[k];
+        b[i] /= a[i*n+i];
+    }
+    return true;
+}
+
+bool Apv25PulseFitter::invert(int n, double* a) {
+    double inv[MAX_PAR*MAX_PAR];
+    for (int col = 0; col < n; ++col) {
+        double work[MAX_PAR*MAX_PAR];
+        double b[MAX_PAR];
+        for (int i = 0; i < n*n; ++i) work[i] = a[i];
+        for (int i = 0; i < n; ++i) b[i] = (i == col) ? 1. : 0.;
+        if (!solve(n, work, b)) return false;
+        for (int i = 0; i < n; ++i) inv[i*n+col] = b[i];
+    }
+    for (int i = 0; i < n*n; ++i) a[i] = inv[i];
+    return true;
+}
+
+Apv25PulseFitter::Result Apv25PulseFitter::fit(const int* adcs, const Channel& channel, int nPulses,
+        const double* t0Guess, const double* ampGuess) const {
+
+    Result result;
+    if (nPulses < 1) nPulses = 1;
+    if (nPulses > maxPulses) nPulses = maxPulses;
+    result.nPulses = nPulses;
+    int npar = 2*nPulses;
+
+    double y[nSamples], w[nSamples];
+    for (int isample = 0; isample < nSamples; ++isample) {
+        y[isample] = adcs[isample] - channel.baseline[isample];
+        double sigma = channel.sigma[isample];
+        w[isample] = sigma > 0. ? 1./(sigma*sigma) : 1.;
+    }
+
+    double par[MAX_PAR];
+    for (int ipulse = 0; ipulse < nPulses; ++ipulse) {
+        par[2*ipulse] = t0Guess[ipulse];
+        par[2*ipulse+1] = ampGuess[ipulse];
+    }
+
+    double alpha[MAX_PAR*MAX_PAR], beta[MAX_PAR];
+    double current = chi2(y, w, channel.shape, npar, par, alpha, beta);
+    double lambda = 1e-3;
+
+    for (int iter = 0; iter < maxIterations_; ++iter) {
+        result.iterations = iter+1;
+
+        double a[MAX_PAR*MAX_PAR], step[MAX_PAR], trial[MAX_PAR];
+        for (int i = 0; i < npar*npar; ++i) a[i] = alpha[i];
+        for (int i = 0; i < npar; ++i) {
+            a[i*npar+i] *= 1. + lambda;
+            step[i] = beta[i];
+        }
+        if (!solve(npar, a, step)) {
+            lambda *= 10.;
+            if (lambda > 1e10) break;
+            continue;
+        }
+        for (int i = 0; i < npar; ++i) trial[i] = par[i] + step[i];
+
+        double trialChi2 = chi2(y, w, channel.shape, npar, trial, nullptr, nullptr);
+        if (std::isfinite(trialChi2) && trialChi2 <= current) {
+            double change = current - trialChi2;
+            for (int i = 0; i < npar; ++i) par[i] = trial[i];
+            current = chi2(y, w, channel.shape, npar, par, alpha, beta);
+            lambda = lambda > 1e-7 ? lambda*0.1 : lambda;
+            if (change <= tolerance_*(current + tolerance_)) {
+                result.converged = true;
+                break;
+            }
+        } else {
+            lambda *= 10.;
+            if (lambda > 1e10) {
+                //No downhill step left, we are at the minimum within precision
+                result.converged = true;
+                break;
+            }
+        }
+    }
+
+    result.chi2 = current;
+    result.ndf = nSamples - npar;
+    for (int ipulse = 0; ipulse < nPulses; ++ipulse) {
+        result.t0[ipulse] = par[2*ipulse];
+        result.amp[ipulse] = par[2*ipulse+1];
+    }
+    if (invert(npar, alpha)) {
+        for (int ipulse = 0; ipulse < nPulses; ++ipulse) {
+            result.t0Err[ipulse] = std::sqrt(alpha[(2*ipulse)*npar + 2*ipulse]);
+            result.ampErr[ipulse] = std::sqrt(alpha[(2*ipulse+1)*npar + 2*ipulse+1]);
+        }
+    } else {
+        result.converged = false;
+    }
+    return result;
+}
+
+Apv25PulseFitter::Result Apv25PulseFitter::fit(const int* adcs, const Channel& channel) const {
+    int imax = 0;
+    double ymax = adcs[0] - channel.baseline[0];
+    for (int isample = 1; isample < nSamples; ++isample) {
+        double y = adcs[isample] - channel.baseline[isample];
+        if (y > ymax) {
+            ymax = y;
+            imax = isample;
+        }
+    }
+    double t0 = imax*samplingTime_ - channel.shape.getPeakTime();
+    return fit(adcs, channel, 1, &t0, &ymax);
+}
+
+double Apv25PulseFitter::evaluate(const Result& result, const Apv25PulseShape& shape, double t) {
+    double sum = 0.;
+    for (int ipulse = 0; ipulse < result.nPulses; ++ipulse)
+        sum += result.amp[ipulse]*shape.value(t - result.t0[ipulse]);
+    return sum;
+}
@@ -0,0 +1,53 @@
+#include "Apv25PulseShape.h"
+
+#include <cmath>
+
+Apv25PulseShape::Apv25PulseShape(double tau1, double tau2, Model model) {
+    set(tau1, tau2, model);
+}
+
+void Apv25PulseShape::set(double tau1, double tau2, Model model) {
+    model_ = model;
+    tau1_ = tau1;
+    tau2_ = tau2;
+    invTau1_ = 1./tau1;
+    invTau2_ = 1./tau2;
+    r_ = (tau1 - tau2)/(tau1*tau2);
+
+    if (model_ == FourPole)
+        tPeak_ = 3.*std::pow(tau1*tau2*tau2*tau2, 0.25);
+    else
+        tPeak_ = std::log(tau1/tau2)*tau1*tau2/(tau1 - tau2);
+
+    double deriv;
+    double peak = raw(tPeak_, deriv);
+    norm_ = (peak != 0 && std::isfinite(peak)) ? 1./peak : 0.;
+}
+
+double Apv25PulseShape::raw(double t, double& deriv) const {
+    double e1 = std::exp(-t*invTau1_);
+    double e2 = std::exp(-t*invTau2_);
+    if (model_ == TwoPole) {
+        deriv = -e1*invTau1_ + e2*invTau2_;
+        return e1 - e2;
+    }
+    double rt = r_*t;
+    double poly = 1. + rt + 0.5*rt*rt;
+    deriv = -e1*invTau1_ + e2*(poly*invTau2_ - r_ - r_*rt);
+    return e1 - e2*poly;
+}
+
+double Apv25PulseShape::value(double t) const {
+    double deriv;
+    return value(t, deriv);
+}
+
+double Apv25PulseShape::value(double t, double& deriv) const {
+    if (t <= 0) {
+        deriv = 0.;
+        return 0.;
+    }
+    double f = raw(t, deriv);
+    deriv *= norm_;
+    return f*norm_;
+}
@@ -52,11 +52,18 @@ void BlFitHistos::getHistosFromFile(TFile* inFile, std::string layer){
     }
 }
 
+void BlFitHistos::fitChannel(TH1D* hist, TF1* fit, const std::string& options) {
+    if (fitCache_)
+        fitCache_->fit(hist, fit, options);
+    else
+        hist->Fit(fit, options.c_str(), "");
+}
+
 void BlFitHistos::backwardsIterChi2Fit(TH1D* hist, double xmin, double xmax){
 
 
     TF1 *fit = new TF1("fit", "gaus", xmin, xmax);
-    hist->Fit("fit","ORQN","");
+    fitChannel(hist, fit, "ORQN");
     double fitMean = fit->GetParameter(1);
     double fitSig = fit->GetParameter(2);
     double fitnorm = fit->GetParameter(0);
@@ -86,7 +93,7 @@ void BlFitHistos::backwardsIterChi2Fit(TH1D* hist, double xmin, double xmax){
         }
 
         fit->SetRange(xmin,iterxmax);
-        hist->Fit("fit","ORQN","");
+        fitChannel(hist, fit, "ORQN");
         fitMean = fit->GetParameter(1);
         fitSig = fit->GetParameter(2);
         fitnorm = fit->GetParameter(0);
@@ -128,7 +135,7 @@ void BlFitHistos::iterativeGausFit(TH1D* hist, double min, double max, double si
         std::cout << "initial min: " << min << " | initial max: " << max << std::endl;
 
     TF1 *fitA = new TF1("fitA", "gaus", min, max);
-    hist->Fit("fitA","ORQN","");
+    fitChannel(hist, fitA, "ORQN");
     double fitAMean = fitA->GetParameter(1);
     double fitASig = fitA->GetParameter(2);
 
@@ -146,7 +153,7 @@ void BlFitHistos::iterativeGausFit(TH1D* hist, double min, double max, double si
 
     //Fit second time using updated min and max
     TF1 *fitB = new TF1("fitB", "gaus", min, max);
-    hist->Fit("fitB","ORQN","");
+    fitChannel(hist, fitB, "ORQN");
     double fitMean = fitB->GetParameter(1);
     double fitSig = fitB->GetParameter(2);
     if (debug_)
@@ -161,7 +168,7 @@ void BlFitHistos::iterativeGausFit(TH1D* hist, double min, double max, double si
         std::cout << "minB: " << min << " | maxB: " << max << std::endl;
 
     TF1 *fit = new TF1("fit", "gaus", min, max);
-    hist->Fit("fit","ORQN","");
+    fitChannel(hist, fit, "ORQN");
 
     double newFitSig = 99999;
     double newFitMean = 99999;
@@ -180,7 +187,7 @@ void BlFitHistos::iterativeGausFit(TH1D* hist, double min, double max, double si
         if(fitMean - fitSig*sigmaRange > minthresh)
             min = fitMean - fitSig*sigmaRange;
         fit->SetRange(min,max);
-        hist->Fit("fit","ORQN","");
+        fitChannel(hist, fit, "ORQN");
 
         newFitMean = fit->GetParameter(1);
         newFitSig = fit->GetParameter(2);
@@ -317,7 +324,7 @@ void BlFitHistos::fit2DHistoChannelBaselines(std::map<std::string,TH2F*> histos2
             backwardsIterChi2Fit(projy_h, fitmin, fitmax);
 
             TF1 *fit = new TF1("fit", "gaus", fitmin, fitmax);
-            projy_h->Fit("fit","ORQ","");
+            fitChannel(projy_h, fit, "ORQ");
             double fitmean = fit->GetParameter(1);
             double fitsigma = fit->GetParameter(2);
             double fitnorm = fit->GetParameter(0);
@@ -11,6 +11,14 @@
 
 #include "BumpHunter.h"
 
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+
+#include <TROOT.h>
+
 BumpHunter::BumpHunter(FitFunction::BkgModel model, int poly_order, int toy_poly_order, int res_factor, double res_scale, bool asymptotic_limit)
     : ofs(nullptr),
       res_factor_(res_factor), 
@@ -25,8 +33,8 @@ BumpHunter::~BumpHunter() { }
 void BumpHunter::initialize(TH1* histogram, double &mass_hypothesis) {
     mass_hypothesis_ = mass_hypothesis; 
 
-    //Set Minuit Minimizer options
-    ROOT::Math::MinimizerOptions::SetDefaultStrategy(2);
+    //Set Minuit Minimizer options. Only written if needed, mass scans call this concurrently.
+    if(ROOT::Math::MinimizerOptions::DefaultStrategy() != 2) { ROOT::Math::MinimizerOptions::SetDefaultStrategy(2); }
     
     // Shift the mass hypothesis so it sits in the middle of a bin.  
     std::cout << "[ BumpHunter ]: Shifting mass hypothesis to nearest bin center "
@@ -198,7 +206,7 @@ HpsFitResult* BumpHunter::performSearch(TH1* histogram, double mass_hypothesis,
         }
         
         // Perform the background-only fit and store the result.
-        TFitResultPtr result = histogram->Fit("bkg", "QLES+", "", window_start_, window_end_);
+        TFitResultPtr result = fitWindow(histogram, bkg, "QLES+");
         fit_result->setBkgFitResult(result);
 
         std::cout << "*************************************************" << std::endl;
@@ -208,7 +216,7 @@ HpsFitResult* BumpHunter::performSearch(TH1* histogram, double mass_hypothesis,
         std::cout << "*************************************************" << std::endl;
 
         // Perform the toy model fit and store the result.
-        TFitResultPtr result_toys = histogram->Fit("bkg_toys", "QLES+", "", window_start_, window_end_);
+        TFitResultPtr result_toys = fitWindow(histogram, bkg_toys, "QLES+");
         fit_result->setBkgToysFitResult(result_toys);
     }
     
@@ -244,7 +252,7 @@ HpsFitResult* BumpHunter::performSearch(TH1* histogram, double mass_hypothesis,
     for(int parI = 0; parI < poly_order_ + 1; parI++) {
         full->SetParameter(parI, bkg->GetParameter(parI));
     }
-    TFitResultPtr full_result = histogram->Fit("full", "QLES+", "", window_start_, window_end_);
+    TFitResultPtr full_result = fitWindow(histogram, full, "QLES+");
     fit_result->setCompFitResult(full_result);
     
     calculatePValue(fit_result);
@@ -268,6 +276,85 @@ HpsFitResult* BumpHunter::performSearch(TH1* histogram, double mass_hypothesis,
     return fit_result;
 }
 
+std::vector<HpsFitResult*> BumpHunter::scanMassHypotheses(TH1* histogram, const std::vector<double>& masses,
+                                                          bool skip_ul, int nThreads) {
+    int nMasses = masses.size();
+    if(nThreads <= 0) { nThreads = std::max(1u, std::thread::hardware_concurrency()); }
+    int nWorkers = std::max(1, std::min(nThreads, nMasses));
+    
+    // Global settings are fixed before any worker starts
+    if(ROOT::Math::MinimizerOptions::DefaultStrategy() != 2) { ROOT::Math::MinimizerOptions::SetDefaultStrategy(2); }
+    // TMinuit is not thread safe, scans with it run serially so that the results do not depend on the threads
+    std::string minimizer = minimizer_.empty() ? ROOT::Math::MinimizerOptions::DefaultMinimizerType() : minimizer_;
+    if(nWorkers > 1 && (minimizer == "Minuit" || minimizer == "TMinuit")) {
+        std::cout << "[ BumpHunter ]: Minimizer " << minimizer << " is not thread safe, the masses are scanned serially."
+                  << " Set Minuit2 as minimizer to scan them concurrently." << std::endl;
+        nWorkers = 1;
+    }
+    if(nWorkers > 1) { enableConcurrentFits(); }
+    
+    // Thread-private histogram clones, made up front so the workers never touch the original
+    std::vector<TH1*> clones;
+    for(int imass = 0; imass < nMasses; ++imass) {
+        TH1* clone = (TH1*) histogram->Clone(Form("%s_scan_%i", histogram->GetName(), imass));
+        clone->SetDirectory(0);
+        clone->GetListOfFunctions()->Delete();
+        clones.push_back(clone);
+    }
+    
+    std::vector<HpsFitResult*> results(nMasses, nullptr);
+    std::vector<std::exception_ptr> errors(nMasses);
+    std::atomic<int> next_mass(0);
+    auto work = [&]() {
+        // Nothing this bump hunter points to is shared with the other threads
+        std::unique_ptr<FitCache> cache;
+        if(fit_cache_ != nullptr) { cache.reset(new FitCache(fit_cache_->getCacheDir())); }
+        for(int imass = next_mass++; imass < nMasses; imass = next_mass++) {
+            // Every mass starts from the configuration of this bump hunter
+            BumpHunter worker(*this);
+            worker.ofs = nullptr;
+            worker.bkg_only_result_ = nullptr;
+            worker.fit_cache_ = cache.get();
+            try {
+                results[imass] = worker.performSearch(clones[imass], masses[imass], false, skip_ul);
+            } catch(...) {
+                errors[imass] = std::current_exception();
+            }
+        }
+        if(cache) { fit_cache_->addStats(*cache); }
+    };
+    if(nWorkers == 1) {
+        work();
+    } else {
+        std::vector<std::thread> workers;
+        for(int iworker = 0; iworker < nWorkers; ++iworker) { workers.emplace_back(work); }
+        for(auto& t : workers) { t.join(); }
+    }
+    
+    for(auto clone : clones) { delete clone; }
+    
+    // Report the failure of the lowest mass, as the serial scan would
+    for(int imass = 0; imass < nMasses; ++imass) {
+        if(errors[imass]) {
+            for(auto result : results) { delete result; }
+            std::rethrow_exception(errors[imass]);
+        }
+    }
+    return results;
+}
+
+std::string BumpHunter::enableConcurrentFits() {
+    ROOT::EnableThreadSafety();
+    if(ROOT::Math::MinimizerOptions::DefaultStrategy() != 2) { ROOT::Math::MinimizerOptions::SetDefaultStrategy(2); }
+    std::string minimizer = ROOT::Math::MinimizerOptions::DefaultMinimizerType();
+    if(minimizer == "Minuit" || minimizer == "TMinuit") {
+        std::cout << "[ BumpHunter ]: Default minimizer " << minimizer
+                  << " is not thread safe, the concurrent fits use Minuit2" << std::endl;
+        return "Minuit2";
+    }
+    return "";
+}
+
 void BumpHunter::calculatePValue(HpsFitResult* result) {
     std::cout << "[ BumpHunter ]: Calculating p-value: " << std::endl;
     
@@ -418,7 +505,7 @@ void BumpHunter::getUpperLimitAsymCLs(TH1* histogram, HpsFitResult* result) {
         tryN++;
         comp->FixParameter(poly_order_ + 1, mu95up);
         
-        TFitResultPtr full_result = histogram->Fit("comp_ul", "NQLES", "", window_start_, window_end_);
+        TFitResultPtr full_result = fitWindow(histogram, comp, "NQLES");
         double mu_nll = full_result->MinFcnValue();
 
         double nllamb_mu = mu_nll - mle_nll;
@@ -549,7 +636,7 @@ void BumpHunter::getUpperLimitPower(TH1* histogram, HpsFitResult* result) {
         //std::cout << "[ BumpHunter ]: Current p-value: " << p_value << std::endl;
         comp->FixParameter(poly_order_ + 1, signal_yield);
         
-        TFitResultPtr full_result = histogram->Fit("comp_ul", "QLES+", "", window_start_, window_end_);
+        TFitResultPtr full_result = fitWindow(histogram, comp, "QLES+");
         double cond_nll = full_result->MinFcnValue();
         
         // 1) Calculate the likelihood ratio which is chi2 distributed.
@@ -587,35 +674,135 @@ void BumpHunter::getUpperLimitPower(TH1* histogram, HpsFitResult* result) {
 }
 
 std::vector<TH1*> BumpHunter::generateToys(TH1* histogram, double n_toys, int seed, int toy_sig_samples, int bkg_mult, TH1* signal_hist) {
-    gRandom->SetSeed(seed);
-    
     TF1* bkg_toys = histogram->GetFunction("bkg_toys");
     TF1* sig_toys = new TF1("sig_toys", "gaus", window_start_, window_end_);
     sig_toys->SetParameters(1.0, mass_hypothesis_, mass_resolution_);
     
+    // Template holding the toy binning, the toys are clones of it
+    TH1F* toy_template = new TH1F("invariant_mass_template", "invariant_mass_template", bins_, window_start_, window_end_);
+    toy_template->SetDirectory(0);
+    
+    // Expected fractions per bin, computed once for all the toys
+    std::vector<double> bkg_fractions = getToyBinFractions(toy_template, bkg_toys, nullptr);
+    std::vector<double> sig_fractions;
+    if(toy_sig_samples > 0) { sig_fractions = getToyBinFractions(toy_template, sig_toys, signal_hist); }
+    
     std::vector<TH1*> hists;
     int bkg_events = bkg_mult * int(integral_);
+    std::vector<double> counts(bins_ + 2);
     for(int itoy = 0; itoy < n_toys; ++itoy) {
         std::string name = "invariant_mass_" + std::to_string(itoy);
         if(itoy%100 == 0) {
             std::cout << "Generating Toy " << itoy << std::endl;
         }
-        TH1F* hist = new TH1F(name.c_str(), name.c_str(), bins_, window_start_, window_end_);
-        for(int i = 0; i < bkg_events; ++i) {
-            hist->Fill(bkg_toys->GetRandom(window_start_, window_end_));
-        }
-        for(int i = 0; i < toy_sig_samples; i++) {
-            double sig_sample = 0;
-            if(signal_hist != NULL) { sig_sample = signal_hist->GetRandom(); }
-            else { sig_sample = sig_toys->GetRandom(window_start_, window_end_); }
-            hist->Fill(sig_sample);
+        
+        std::seed_seq seq{seed, itoy};
+        std::mt19937_64 engine(seq);
+        std::fill(counts.begin(), counts.end(), 0.);
+        drawToyCounts(engine, bkg_fractions, bkg_events, counts);
+        if(toy_sig_samples > 0) { drawToyCounts(engine, sig_fractions, toy_sig_samples, counts); }
+        
+        TH1F* hist = (TH1F*) toy_template->Clone(name.c_str());
+        hist->SetTitle(name.c_str());
+        hist->SetDirectory(gDirectory);
+        double entries = 0;
+        for(int ibin = 0; ibin < bins_ + 2; ++ibin) {
+            hist->SetBinContent(ibin, counts[ibin]);
+            entries += counts[ibin];
         }
+        hist->ResetStats();
+        hist->SetEntries(entries);
         hists.push_back(hist); 
     }
     
+    delete toy_template;
+    delete sig_toys;
     return hists;
 }
 
+std::vector<double> BumpHunter::getToyBinFractions(TH1* toy, TF1* func, TH1* hist) {
+    TAxis* axis = toy->GetXaxis();
+    std::vector<double> fractions(bins_ + 2, 0.);
+    
+    if(hist != nullptr) {
+        // Events are spread uniformly within each bin of the shape, as TH1::GetRandom does
+        TAxis* shape_axis = hist->GetXaxis();
+        for(int jbin = 1; jbin <= shape_axis->GetNbins(); ++jbin) {
+            double content = hist->GetBinContent(jbin);
+            if(content <= 0) { continue; }
+            double low = shape_axis->GetBinLowEdge(jbin);
+            double high = shape_axis->GetBinUpEdge(jbin);
+            double width = high - low;
+            
+            int first = axis->FindFixBin(low);
+            int last = axis->FindFixBin(high);
+            for(int ibin = first; ibin <= last; ++ibin) {
+                double overlap_low = (ibin == 0) ? low : std::max(low, axis->GetBinLowEdge(ibin));
+                double overlap_high = (ibin == bins_ + 1) ? high : std::min(high, axis->GetBinUpEdge(ibin));
+                if(overlap_high > overlap_low) { fractions[ibin] += content * (overlap_high - overlap_low)/width; }
+            }
+        }
+    } else {
+        // Sampled within the window only, as TF1::GetRandom(window_start_, window_end_) does
+        for(int ibin = 1; ibin <= bins_; ++ibin) {
+            fractions[ibin] = std::max(0., func->Integral(axis->GetBinLowEdge(ibin), axis->GetBinUpEdge(ibin)));
+        }
+    }
+    
+    double total = 0;
+    for(double fraction : fractions) { total += fraction; }
+    if(total <= 0) {
+        throw std::runtime_error("[ BumpHunter ]: Toy shape has no positive content within the window");
+    }
+    for(double& fraction : fractions) { fraction /= total; }
+    return fractions;
+}
+
+void BumpHunter::drawToyCounts(std::mt19937_64& engine, const std::vector<double>& fractions,
+                               double n_events, std::vector<double>& counts) {
+    if(toy_poisson_) {
+        for(unsigned int ibin = 0; ibin < fractions.size(); ++ibin) {
+            double mean = n_events * fractions[ibin];
+            if(mean <= 0) { continue; }
+            std::poisson_distribution<long long> poisson(mean);
+            counts[ibin] += poisson(engine);
+        }
+        return;
+    }
+    
+    // Multinomial through successive conditional binomials
+    long long remaining = (long long) n_events;
+    double remaining_fraction = 1.0;
+    for(unsigned int ibin = 0; ibin < fractions.size() && remaining > 0; ++ibin) {
+        if(fractions[ibin] <= 0) { continue; }
+        double p = std::min(1.0, fractions[ibin]/remaining_fraction);
+        std::binomial_distribution<long long> binomial(remaining, p);
+        long long n = (ibin + 1 == fractions.size()) ? remaining : binomial(engine);
+        counts[ibin] += n;
+        remaining -= n;
+        remaining_fraction -= fractions[ibin];
+        if(remaining_fraction <= 0) { remaining_fraction = 0; }
+    }
+    // Rounding may leave events behind, they go to the last populated bin
+    if(remaining > 0) {
+        for(int ibin = fractions.size() - 1; ibin >= 0; --ibin) {
+            if(fractions[ibin] > 0) { counts[ibin] += remaining; break; }
+        }
+    }
+}
+
+TFitResultPtr BumpHunter::fitWindow(TH1* histogram, TF1* func, const std::string& options) {
+    if(fit_cache_ == nullptr) {
+        return FitCache::fitWith(histogram, func, options, window_start_, window_end_, minimizer_);
+    }
+    
+    // The fit functions are functors, so their configuration is not visible
+    // to the cache and has to be part of the key.
+    std::string tag = Form("BumpHunter_%i_%i_%.17g_%.17g_%.17g_%.17g", int(bkg_model_), poly_order_,
+                           mass_hypothesis_, mass_resolution_, window_end_ - window_start_, bin_width_);
+    return fit_cache_->fit(histogram, func, options, window_start_, window_end_, tag, minimizer_);
+}
+
 void BumpHunter::getChi2Prob(double cond_nll, double mle_nll, double &q0, double &p_value) {
     //printDebug("Cond NLL: " + std::to_string(cond_nll));
     //printDebug("Uncod NLL: " + std::to_string(mle_nll));
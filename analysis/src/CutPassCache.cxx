@@ -0,0 +1,54 @@
+#include "CutPassCache.h"
+
+const int32_t CutPassCache::kUnknown;
+const int32_t CutPassCache::kPass;
+
+CutPassCache::CutPassCache(IterativeCutSelector* selector, MutableTTree* tree) : selector_(selector), tree_(tree) {
+    bind();
+}
+
+void CutPassCache::bind(){
+    //Cuts compiled again have new indices, nothing known about the entries holds
+    if(generation_ != selector_->getGeneration()){
+        generation_ = selector_->getGeneration();
+        slots_.clear();
+        failed_.clear();
+        evaluated_.clear();
+    }
+    const std::vector<IterativeCutSelector::CompiledCut>& cuts = selector_->getCompiledCuts();
+    for(unsigned int cut = slots_.size(); cut < cuts.size(); cut++)
+        slots_.push_back(tree_->getVariableSlot(cuts[cut].variable));
+}
+
+bool CutPassCache::select(int entry){
+    const std::vector<IterativeCutSelector::CompiledCut>& cuts = selector_->getCompiledCuts();
+    if(!isBound())
+        bind();
+    if(failed_.empty()){
+        failed_.assign(tree_->GetEntries(), kUnknown);
+        evaluated_.assign(tree_->GetEntries(), 0);
+    }
+
+    int32_t& failed = failed_[entry];
+    unsigned int& evaluated = evaluated_[entry];
+    //An entry failing a cut which did not change still fails it
+    if(failed >= 0 && cuts[failed].revision <= evaluated)
+        return false;
+
+    tree_->GetEntry(entry);
+    ++reads_;
+    //An entry which passed only needs the cuts which changed
+    bool all = failed != kPass;
+    int32_t first = kPass;
+    for(unsigned int cut = 0; cut < cuts.size(); cut++){
+        if(!all && cuts[cut].revision <= evaluated)
+            continue;
+        if(slots_[cut] && !selector_->passCompiledCut(cut, *slots_[cut])){
+            first = cut;
+            break;
+        }
+    }
+    failed = first;
+    evaluated = selector_->getRevision();
+    return first == kPass;
+}
@@ -0,0 +1,130 @@
+#include "EcalHitTable.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+EcalHitTable::EcalHitTable() : first_(nx_*ny_, -1), stamps_(nx_*ny_, 0) {
+}
+
+void EcalHitTable::clear() {
+    entries_.clear();
+    // Invalidates every slot, they are reset when the counter wraps around
+    if (++stamp_ == 0) {
+        std::fill(stamps_.begin(), stamps_.end(), 0);
+        stamp_ = 1;
+    }
+}
+
+int EcalHitTable::slot(int ix, int iy) {
+    if (!isCrystal(ix, iy))
+        return -1;
+    return (iy - minIy_)*nx_ + (ix - minIx_);
+}
+
+bool EcalHitTable::isCrystal(int ix, int iy) {
+    if (ix < minIx_ || ix > maxIx_ || ix == 0)
+        return false;
+    if (iy < minIy_ || iy > maxIy_ || iy == 0)
+        return false;
+    //Electron gap
+    if (std::abs(iy) == 1 && ix >= -10 && ix <= -2)
+        return false;
+    return true;
+}
+
+bool EcalHitTable::isEdge(int ix, int iy) {
+    if (std::abs(ix) == maxIx_ || std::abs(iy) == maxIy_)
+        return true;
+    if (std::abs(iy) == 1 && ix >= -11 && ix <= -1)
+        return true;
+    return false;
+}
+
+void EcalHitTable::build(const std::vector<CalHit*>& hits) {
+    clear();
+    for (auto hit : hits)
+        add(hit, hit->getCrystalIndexX(), hit->getCrystalIndexY());
+}
+
+bool EcalHitTable::add(CalHit* hit, int ix, int iy) {
+    int s = slot(ix, iy);
+    if (s < 0)
+        return false;
+    entries_.push_back({hit, timeKey(hit->getTime()), first(s)});
+    first_[s] = entries_.size() - 1;
+    stamps_[s] = stamp_;
+    return true;
+}
+
+CalHit* EcalHitTable::find(int ix, int iy, int key) const {
+    int s = slot(ix, iy);
+    if (s < 0)
+        return nullptr;
+    for (int e = first(s); e >= 0; e = entries_[e].next) {
+        if (entries_[e].key == key)
+            return entries_[e].hit;
+    }
+    return nullptr;
+}
+
+CalHit* EcalHitTable::getHit(int ix, int iy) const {
+    int s = slot(ix, iy);
+    if (s < 0)
+        return nullptr;
+    CalHit* best{nullptr};
+    for (int e = first(s); e >= 0; e = entries_[e].next) {
+        if (!best || entries_[e].hit->getEnergy() > best->getEnergy())
+            best = entries_[e].hit;
+    }
+    return best;
+}
+
+double EcalHitTable::getEnergy(int ix, int iy) const {
+    int s = slot(ix, iy);
+    if (s < 0)
+        return 0.;
+    double energy = 0.;
+    for (int e = first(s); e >= 0; e = entries_[e].next)
+        energy += entries_[e].hit->getEnergy();
+    return energy;
+}
+
+std::vector<CalHit*> EcalHitTable::getNeighbours(int ix, int iy) const {
+    std::vector<CalHit*> neighbours;
+    for (int dy = -1; dy <= 1; ++dy) {
+        int ny = iy + dy;
+        //The two halves of the ECal are not neighbours
+        if (ny == 0)
+            continue;
+        for (int dx = -1; dx <= 1; ++dx) {
+            if (dx == 0 && dy == 0)
+                continue;
+            if (CalHit* hit = getHit(dx ? stepX(ix, dx) : ix, ny))
+                neighbours.push_back(hit);
+        }
+    }
+    return neighbours;
+}
+
+double EcalHitTable::getNeighbourEnergy(int ix, int iy) const {
+    double energy = 0.;
+    for (int dy = -1; dy <= 1; ++dy) {
+        int ny = iy + dy;
+        if (ny == 0)
+            continue;
+        for (int dx = -1; dx <= 1; ++dx) {
+            if (dx == 0 && dy == 0)
+                continue;
+            energy += getEnergy(dx ? stepX(ix, dx) : ix, ny);
+        }
+    }
+    return energy;
+}
+
+bool EcalHitTable::isLocalMaximum(const CalHit* hit) const {
+    for (auto neighbour : getNeighbours(hit->getCrystalIndexX(), hit->getCrystalIndexY())) {
+        if (neighbour->getEnergy() > hit->getEnergy())
+            return false;
+    }
+    return true;
+}
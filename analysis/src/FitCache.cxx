@@ -0,0 +1,273 @@
+#include "FitCache.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+#include <Foption.h>
+#include <HFitInterface.h>
+#include <TSystem.h>
+#include <Fit/DataRange.h>
+#include <Math/MinimizerOptions.h>
+
+namespace {
+    /** Version of the on-disk format, bump when the layout changes */
+    const int CACHE_VERSION = 2;
+}
+
+FitCache::CachedFitResult::CachedFitResult(const Entry& entry) : TFitResult(entry.status) {
+    fValid = entry.valid;
+    fNFree = entry.nfree;
+    fNdf = entry.ndf;
+    fStatus = entry.status;
+    fVal = entry.minFcn;
+    fEdm = entry.edm;
+    fChi2 = entry.chi2;
+    fParams = entry.params;
+    fErrors = entry.errors;
+    fCovMatrix = entry.covariance;
+    for (unsigned int ipar = 0; ipar < entry.fixed.size(); ++ipar) {
+        if (entry.fixed[ipar]) fFixedParams[ipar] = true;
+    }
+}
+
+FitCache::FitCache(const std::string& cacheDir) : cacheDir_(cacheDir) {
+    if (gSystem->AccessPathName(cacheDir_.c_str()))
+        gSystem->mkdir(cacheDir_.c_str(), kTRUE);
+    std::cout << "[ FitCache ]: Using fit cache in " << cacheDir_ << std::endl;
+}
+
+void FitCache::hash(uint64_t& h, const void* data, size_t size) const {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; ++i) {
+        h ^= bytes[i];
+        h *= 1099511628211ULL;
+    }
+}
+
+void FitCache::hashHistogram(uint64_t& h, TH1* hist) const {
+    TAxis* axis = hist->GetXaxis();
+    int nbins = axis->GetNbins();
+    hash(h, (double)nbins);
+    for (int ibin = 1; ibin <= nbins; ++ibin)
+        hash(h, axis->GetBinLowEdge(ibin));
+    hash(h, axis->GetBinUpEdge(nbins));
+    for (int ibin = 0; ibin <= nbins+1; ++ibin) {
+        hash(h, hist->GetBinContent(ibin));
+        hash(h, hist->GetBinError(ibin));
+    }
+    hash(h, hist->GetEntries());
+}
+
+std::string FitCache::fitKey(TH1* hist, TF1* func, const std::string& options,
+        double xmin, double xmax, const std::string& tag, const std::string& minimizer) const {
+    uint64_t h = 14695981039346656037ULL;
+    hashHistogram(h, hist);
+    hash(h, tag);
+    hash(h, std::string(func->GetName()));
+    hash(h, std::string(func->GetExpFormula().Data()));
+    hash(h, (double)func->GetNpar());
+    for (int ipar = 0; ipar < func->GetNpar(); ++ipar) {
+        double low, high;
+        func->GetParLimits(ipar, low, high);
+        hash(h, func->GetParameter(ipar));
+        hash(h, low);
+        hash(h, high);
+    }
+    hash(h, func->GetXmin());
+    hash(h, func->GetXmax());
+    hash(h, xmin);
+    hash(h, xmax);
+    hash(h, options);
+    hash(h, minimizer.empty() ? ROOT::Math::MinimizerOptions::DefaultMinimizerType() : minimizer);
+    hash(h, ROOT::Math::MinimizerOptions::DefaultMinimizerAlgo());
+    hash(h, (double)ROOT::Math::MinimizerOptions::DefaultStrategy());
+    hash(h, ROOT::Math::MinimizerOptions::DefaultTolerance());
+    return toKey(h);
+}
+
+std::string FitCache::procedureKey(TH1* hist, const std::string& tag) const {
+    uint64_t h = 14695981039346656037ULL;
+    hashHistogram(h, hist);
+    hash(h, tag);
+    return toKey(h);
+}
+
+std::string FitCache::toKey(uint64_t h) const {
+    std::stringstream key;
+    key << std::hex << std::setw(16) << std::setfill('0') << h;
+    return key.str();
+}
+
+std::string FitCache::path(const std::string& key) const {
+    return cacheDir_ + "/" + key + ".fit";
+}
+
+bool FitCache::load(const std::string& key, Entry& entry) const {
+    std::ifstream in(path(key));
+    if (!in.is_open())
+        return false;
+
+    int version = -1;
+    unsigned int npar = 0;
+    in >> version;
+    if (version != CACHE_VERSION)
+        return false;
+    in >> entry.status >> entry.valid >> entry.nfree >> entry.ndf
+       >> entry.chi2 >> entry.minFcn >> entry.edm
+       >> entry.xmin >> entry.xmax >> entry.rebin >> npar;
+    entry.params.resize(npar);
+    entry.errors.resize(npar);
+    entry.fixed.resize(npar);
+    for (unsigned int ipar = 0; ipar < npar; ++ipar) {
+        bool fixed = false;
+        in >> entry.params[ipar] >> entry.errors[ipar] >> fixed;
+        entry.fixed[ipar] = fixed;
+    }
+    unsigned int ncov = 0;
+    in >> ncov;
+    if (ncov != 0 && ncov != npar*(npar + 1)/2)
+        return false;
+    entry.covariance.resize(ncov);
+    for (unsigned int icov = 0; icov < ncov; ++icov)
+        in >> entry.covariance[icov];
+    return !in.fail();
+}
+
+void FitCache::store(const std::string& key, const Entry& entry) const {
+    // Write to a temporary file first so concurrent jobs never read a partial entry
+    std::string tmp = path(key) + "." + std::to_string(gSystem->GetPid()) + "."
+        + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+    {
+        std::ofstream out(tmp);
+        if (!out.is_open()) {
+            std::cout << "[ FitCache ]: WARNING: cannot write " << tmp << std::endl;
+            return;
+        }
+        out << std::setprecision(17);
+        out << CACHE_VERSION << "\n"
+            << entry.status << " " << entry.valid << " " << entry.nfree << " " << entry.ndf << "\n"
+            << entry.chi2 << " " << entry.minFcn << " " << entry.edm << "\n"
+            << entry.xmin << " " << entry.xmax << " " << entry.rebin << "\n"
+            << entry.params.size() << "\n";
+        for (unsigned int ipar = 0; ipar < entry.params.size(); ++ipar)
+            out << entry.params[ipar] << " " << entry.errors[ipar] << " " << entry.fixed[ipar] << "\n";
+        out << entry.covariance.size() << "\n";
+        for (unsigned int icov = 0; icov < entry.covariance.size(); ++icov)
+            out << entry.covariance[icov] << (icov + 1 < entry.covariance.size() ? " " : "\n");
+    }
+    std::rename(tmp.c_str(), path(key).c_str());
+}
+
+TFitResultPtr FitCache::fit(TH1* hist, TF1* func, const std::string& options,
+        double xmin, double xmax, const std::string& tag, const std::string& minimizer) {
+
+    std::string key = fitKey(hist, func, options, xmin, xmax, tag, minimizer);
+    bool storeFunc = options.find('N') == std::string::npos;
+    bool returnResult = options.find('S') != std::string::npos;
+
+    Entry entry;
+    if (load(key, entry) && (int)entry.params.size() == func->GetNpar()) {
+        hits_++;
+        func->SetParameters(entry.params.data());
+        func->SetParErrors(entry.errors.data());
+        func->SetChisquare(entry.chi2);
+        func->SetNDF(entry.ndf);
+        func->SetNumberFitPoints(entry.ndf + entry.nfree);
+
+        if (storeFunc) {
+            TList* funcs = hist->GetListOfFunctions();
+            // Without "+" TH1::Fit replaces all the previously fitted functions
+            if (options.find('+') == std::string::npos) {
+                TIter next(funcs);
+                while (TObject* obj = next()) {
+                    if (obj->InheritsFrom(TF1::Class())) {
+                        funcs->Remove(obj);
+                        delete obj;
+                    }
+                }
+            } else if (TObject* old = funcs->FindObject(func->GetName())) {
+                funcs->Remove(old);
+                delete old;
+            }
+            TF1* copy = (TF1*)func->IsA()->New();
+            func->Copy(*copy);
+            copy->SetParent(hist);
+            funcs->Add(copy);
+        }
+
+        if (returnResult)
+            return TFitResultPtr(new CachedFitResult(entry));
+        return TFitResultPtr(entry.status);
+    }
+
+    misses_++;
+    std::string fitOptions = returnResult ? options : options + "S";
+    TFitResultPtr result = fitWith(hist, func, fitOptions, xmin, xmax, minimizer);
+    if (result.Get() == nullptr)
+        return result;
+
+    entry.status = result->Status();
+    entry.valid = result->IsValid();
+    entry.nfree = result->NFreeParameters();
+    entry.ndf = result->Ndf();
+    entry.chi2 = result->Chi2();
+    entry.minFcn = result->MinFcnValue();
+    entry.edm = result->Edm();
+    entry.params.clear();
+    entry.errors.clear();
+    entry.fixed.clear();
+    entry.covariance.clear();
+    for (unsigned int ipar = 0; ipar < result->NPar(); ++ipar) {
+        entry.params.push_back(result->Parameter(ipar));
+        entry.errors.push_back(result->ParError(ipar));
+        entry.fixed.push_back(result->IsParameterFixed(ipar));
+        // Same layout as the matrix of FitResult, zero for the fixed parameters
+        for (unsigned int jpar = 0; jpar <= ipar && result->CovMatrixStatus() > 0; ++jpar)
+            entry.covariance.push_back(result->CovMatrix(ipar, jpar));
+    }
+    func->GetRange(entry.xmin, entry.xmax);
+    store(key, entry);
+
+    if (returnResult)
+        return result;
+    return TFitResultPtr(entry.status);
+}
+
+TFitResultPtr FitCache::fitWith(TH1* hist, TF1* func, const std::string& options,
+        double xmin, double xmax, const std::string& minimizer) {
+    if (minimizer.empty())
+        return hist->Fit(func, options.c_str(), "", xmin, xmax);
+    // Same steps as TH1::Fit, with the minimizer options of this fit only
+    Foption_t fitOption;
+    ROOT::Fit::FitOptionsMake(ROOT::Fit::EFitObjectType::kHistogram, options.c_str(), fitOption);
+    ROOT::Fit::DataRange range(xmin, xmax);
+    ROOT::Math::MinimizerOptions minOption;
+    minOption.SetMinimizerType(minimizer.c_str());
+    return ROOT::Fit::FitObject(hist, func, fitOption, minOption, "", range);
+}
+
+bool FitCache::get(const std::string& key, Entry& entry) {
+    if (load(key, entry)) {
+        hits_++;
+        return true;
+    }
+    misses_++;
+    return false;
+}
+
+void FitCache::put(const std::string& key, const Entry& entry) {
+    store(key, entry);
+}
+
+void FitCache::printStats() const {
+    int hits = hits_;
+    int misses = misses_;
+    std::cout << "[ FitCache ]: " << hits << " hits, " << misses << " misses";
+    if (hits + misses > 0)
+        std::cout << " (" << std::setprecision(3) << 100.*hits/(hits + misses) << "% hit rate)";
+    std::cout << std::endl;
+}
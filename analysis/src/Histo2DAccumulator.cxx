@@ -0,0 +1,67 @@
+#include "Histo2DAccumulator.h"
+
+// C++
+#include <algorithm>
+
+namespace {
+    /** @return uniform binning of an axis */
+    template <class Axis>
+    Axis makeAxis(const TAxis* axis) {
+        Axis uniform;
+        uniform.nbins = axis->GetNbins();
+        uniform.min = axis->GetXmin();
+        uniform.max = axis->GetXmax();
+        return uniform;
+    }
+}
+
+Histo2DAccumulator::Histo2DAccumulator(TH2* histo, bool sparse) : histo_(histo), sparse_(sparse) {
+    const TAxis* xaxis = histo_->GetXaxis();
+    const TAxis* yaxis = histo_->GetYaxis();
+    // Variable bins have edges in fXbins, their fills go to the histogram
+    uniform_ = xaxis->GetXbins()->GetSize() == 0 && yaxis->GetXbins()->GetSize() == 0;
+    x_ = makeAxis<Axis>(xaxis);
+    y_ = makeAxis<Axis>(yaxis);
+    nx_ = x_.nbins + 2;
+}
+
+void Histo2DAccumulator::flush() {
+    if (fills_ == 0)
+        return;
+    double entries = histo_->GetEntries();
+    bool sumw2 = histo_->GetSumw2N() > 0;
+    auto add = [this, sumw2](uint32_t bin, uint32_t count) {
+        histo_->AddBinContent(bin, count);
+        // Unit weights, the sum of the squared weights is the count
+        if (sumw2)
+            histo_->GetSumw2()->fArray[bin] += count;
+    };
+    if (sparse_) {
+        for (auto& count : sparseCounts_)
+            add(count.first, count.second);
+        sparseCounts_.clear();
+    } else {
+        for (uint32_t biny = 0; biny < rows_.size(); ++biny) {
+            std::vector<uint32_t>& row = rows_[biny];
+            for (uint32_t binx = 0; binx < row.size(); ++binx) {
+                if (row[binx])
+                    add(binx + nx_*biny, row[binx]);
+            }
+            // Rows keep their storage, the same ones are hit again
+            std::fill(row.begin(), row.end(), 0);
+        }
+    }
+    histo_->ResetStats();
+    histo_->SetEntries(entries + fills_);
+    fills_ = 0;
+}
+
+size_t Histo2DAccumulator::getMemory() const {
+    if (sparse_)
+        return sparseCounts_.size()*(2*sizeof(uint32_t) + 2*sizeof(void*))
+            + sparseCounts_.bucket_count()*sizeof(void*);
+    size_t memory = rows_.capacity()*sizeof(std::vector<uint32_t>);
+    for (auto& row : rows_)
+        memory += row.capacity()*sizeof(uint32_t);
+    return memory;
+}
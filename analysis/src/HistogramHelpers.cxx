@@ -2,6 +2,240 @@
 
 #include "HistogramHelpers.h"
 #include "TMath.h" 
+#include "TROOT.h"
+#include "Math/MinimizerOptions.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <thread>
+
+namespace {
+
+  /** 
+   * Restore the binning of a reusable projection buffer. IterativeGaussFit
+   * may rebin the histogram it fits, so the buffer is reset before every bin group.
+   */
+  void ResetProjectionBuffer(TH1D* buffer, const TAxis* axis) {
+    if (axis->GetXbins()->GetSize() > 0)
+      buffer->SetBins(axis->GetNbins(), axis->GetXbins()->GetArray());
+    else
+      buffer->SetBins(axis->GetNbins(), axis->GetXmin(), axis->GetXmax());
+    buffer->Reset();
+    buffer->GetListOfFunctions()->Clear("nodelete");
+  }
+
+  /** Bring a reused fit function back to the state of a freshly constructed "gaus" */
+  void ResetFitFunction(TF1* fit_func) {
+    for (int ipar = 0; ipar < fit_func->GetNpar(); ++ipar) {
+      fit_func->SetParameter(ipar, 0.);
+      fit_func->SetParError(ipar, 0.);
+    }
+    fit_func->SetRange(0., 1.);
+  }
+
+  /** Number of workers for the parallel profilers, <= 0 means one per core */
+  int NumberOfWorkers(int nThreads, int nTasks) {
+    if (nThreads <= 0)
+      nThreads = std::max(1u, std::thread::hardware_concurrency());
+    return std::max(1, std::min(nThreads, nTasks));
+  }
+
+  /**
+   * TMinuit keeps its state in a global and cannot be used from several threads.
+   * Return the minimizer of the concurrent fits: Minuit2 if the default one is
+   * TMinuit, empty to keep the default. The default itself is never changed.
+   */
+  std::string PrepareConcurrentFits() {
+    ROOT::EnableThreadSafety();
+    std::string minimizer = ROOT::Math::MinimizerOptions::DefaultMinimizerType();
+    if (minimizer == "Minuit" || minimizer == "TMinuit") {
+      std::cout << "HistogramHelpers: default minimizer " << minimizer
+                << " is not thread safe, the concurrent fits use Minuit2" << std::endl;
+      return "Minuit2";
+    }
+    return "";
+  }
+
+  /** @return true if a projection over [first, last] of an axis keeps the statistics of the histogram */
+  bool WholeAxis(const TAxis* axis, int first, int last) {
+    if (TH1::GetStatOverflows())
+      return first == 0 && last == axis->GetNbins() + 1;
+    return first == 1 && last == axis->GetNbins();
+  }
+
+  /**
+   * Set the entries of a projection buffer as TH2::ProjectionY and TH3::ProjectionZ
+   * do: a projection over the whole range of the other axes keeps the entries of
+   * the histogram, any other one gets its effective entries.
+   */
+  void SetProjectionEntries(TH1D* proj, const TH1* hist, bool wholeRange) {
+    proj->ResetStats();
+    proj->SetEntries(wholeRange ? hist->GetEntries() : proj->GetEffectiveEntries());
+  }
+
+  /** TH1::Fit with the given minimizer, the default one if empty */
+  int FitHistogram(TH1* hist, TF1* fit_func, const char* option, const std::string& minimizer) {
+    return FitCache::fitWith(hist, fit_func, option, 0., 0., minimizer);
+  }
+
+  /** Run task(worker, group) for every group, pulling groups from a shared counter */
+  template <typename Task>
+  void RunConcurrently(int nWorkers, int nGroups, Task task) {
+    std::atomic<int> next_group(0);
+    auto work = [&](int worker) {
+      for (int group = next_group++; group < nGroups; group = next_group++)
+        task(worker, group);
+    };
+    if (nWorkers == 1) {
+      work(0);
+      return;
+    }
+    std::vector<std::thread> workers;
+    for (int worker = 0; worker < nWorkers; ++worker)
+      workers.emplace_back(work, worker);
+    for (auto& t : workers)
+      t.join();
+  }
+
+  /** Set a gaus to the state a cached iterative fit left it in */
+  void SetCachedFunction(TF1* fit_func, const FitCache::Entry& entry) {
+    fit_func->SetParameters(entry.params.data());
+    fit_func->SetParErrors(entry.errors.data());
+    fit_func->SetRange(entry.xmin, entry.xmax);
+    fit_func->SetChisquare(entry.chi2);
+    fit_func->SetNDF(entry.ndf);
+  }
+
+  /** 
+   * IterativeGaussFit with an optional fit cache. A null fit function uses the
+   * self-contained overload. Only converged fits are stored. On a hit the
+   * histogram is rebinned and the fit function rebuilt as the fit left them,
+   * the self-contained overload also attaches the function and writes the
+   * projection, so the outputs do not depend on the cache.
+   */
+  int CachedIterativeGaussFit(TH1* hist, TF1* fit_func, FitCache* fit_cache,
+                              double &mu, double &mu_err, double &sigma, double &sigma_err, int m_PrintLevel,
+                              const std::string& minimizer = "") {
+    auto fit = [&]() {
+      if (fit_func)
+        return HistogramHelpers::IterativeGaussFit(hist, fit_func, mu, mu_err, sigma, sigma_err, m_PrintLevel, minimizer);
+      return HistogramHelpers::IterativeGaussFit(hist, mu, mu_err, sigma, sigma_err, m_PrintLevel);
+    };
+    if (!fit_cache || !hist)
+      return fit();
+
+    // The key is taken before fitting since IterativeGaussFit may rebin the histogram
+    std::string key = fit_cache->procedureKey(hist, std::string("IterativeGaussFit_")
+                                              + (minimizer.empty() ? ROOT::Math::MinimizerOptions::DefaultMinimizerType() : minimizer));
+    FitCache::Entry entry;
+    if (fit_cache->get(key, entry) && entry.params.size() == 3 && entry.errors.size() == 3) {
+      mu = entry.params[1];
+      sigma = entry.params[2];
+      mu_err = entry.errors[1];
+      sigma_err = entry.errors[2];
+      if (entry.rebin > 1)
+        hist->Rebin(entry.rebin);
+      if (fit_func) {
+        SetCachedFunction(fit_func, entry);
+      } else {
+        TF1* cached_func = new TF1("fit_func","gaus");
+        SetCachedFunction(cached_func, entry);
+        hist->GetListOfFunctions()->Add(cached_func);
+        HistogramHelpers::WriteProjection(hist, cached_func);
+      }
+      return entry.status;
+    }
+
+    int nbins = hist->GetNbinsX();
+    int status = fit();
+    TF1* fitted = fit_func ? fit_func : hist->GetFunction("fit_func");
+    if (status == 0 && fitted) {
+      entry.status = status;
+      entry.valid = true;
+      entry.nfree = 3;
+      entry.ndf = fitted->GetNDF();
+      entry.chi2 = fitted->GetChisquare();
+      entry.params.clear();
+      entry.errors.clear();
+      for (int ipar = 0; ipar < 3; ++ipar) {
+        entry.params.push_back(fitted->GetParameter(ipar));
+        entry.errors.push_back(fitted->GetParError(ipar));
+      }
+      entry.fixed = {false, false, false};
+      fitted->GetRange(entry.xmin, entry.xmax);
+      entry.rebin = nbins/hist->GetNbinsX();
+      fit_cache->put(key, entry);
+    }
+    return status;
+  }
+
+  /** Fit of a projection, kept to print and write it once the concurrent fits are done */
+  struct ProjectionFit {
+    bool fitted{false};
+    double params[3]{0., 0., 0.};
+    double errors[3]{0., 0., 0.};
+    double xmin{0.};
+    double xmax{0.};
+  };
+
+  /** 
+   * Fit one projection with a reused fit function, with the serial defaults for low
+   * statistics. Runs on the workers, so it neither prints nor writes: if a result is
+   * given, the state of the fit function is kept in it for ReportProjections.
+   */
+  void FitProjection(TH1D* proj, TF1* fit_func, FitCache* fit_cache, int minEntries, double failed_err,
+                     double &mu, double &mu_err, double &sigma, double &sigma_err, int m_PrintLevel,
+                     const std::string& minimizer, ProjectionFit* result) {
+    if (proj->GetEntries() < minEntries) {
+      mu = 0;
+      mu_err = failed_err;
+      sigma = 0;
+      sigma_err = failed_err;
+      return;
+    }
+    ResetFitFunction(fit_func);
+    CachedIterativeGaussFit(proj, fit_func, fit_cache, mu, mu_err, sigma, sigma_err, m_PrintLevel, minimizer);
+    
+    if (result) {
+      result->fitted = true;
+      for (int ipar = 0; ipar < 3; ++ipar) {
+        result->params[ipar] = fit_func->GetParameter(ipar);
+        result->errors[ipar] = fit_func->GetParError(ipar);
+      }
+      fit_func->GetRange(result->xmin, result->xmax);
+    }
+  }
+
+  /** @return true if the fitted projections have to be printed or written */
+  bool KeepProjections(int m_PrintLevel) {
+    return m_PrintLevel >= 1 || (HistogramHelpers::outFile_for_projections && HistogramHelpers::outFile_for_projections->IsOpen());
+  }
+
+  /** 
+   * Print and write the kept projections in the serial order. ROOT graphics and
+   * the projection file are not thread safe, so this runs on the calling thread
+   * once the concurrent fits are done.
+   */
+  void ReportProjections(const std::vector<TH1D*>& projs, const std::vector<ProjectionFit>& fits,
+                         const std::vector<double>& mus, const std::vector<double>& mu_errs,
+                         const std::vector<double>& sigmas, const std::vector<double>& sigma_errs,
+                         int m_PrintLevel) {
+    TF1 fit_func("fit_func", "gaus");
+    for (unsigned int group = 0; group < projs.size(); ++group) {
+      if (!fits[group].fitted)
+        continue;
+      if (m_PrintLevel >= 1)
+        std::cout << " ** IterativeGaussFit ** fit result: histo name " << projs[group]->GetName() << "    title: " << projs[group]->GetTitle() << std::endl
+                  << "    mu = " << mus[group] << " +- " << mu_errs[group] << std::endl
+                  << " sigma = " << sigmas[group] << " +- " << sigma_errs[group] << std::endl;
+      fit_func.SetParameters(fits[group].params);
+      fit_func.SetParErrors(fits[group].errors);
+      fit_func.SetRange(fits[group].xmin, fits[group].xmax);
+      HistogramHelpers::WriteProjection(projs[group], &fit_func);
+    }
+  }
+}
 
 double HistogramHelpers::GaussExpTails_f(double* x, double *par) {
   //core Gaussian with exponential tails starting K
@@ -75,7 +309,7 @@ double HistogramHelpers::twoGauss_f(double *x, double *par){
 
   
 //-------------------------------------------------------------
-void HistogramHelpers::profileZwithIterativeGaussFit(TH3* hist, TH2* mu_graph, TH2* sigma_graph, int num_bins, TH2* mu_err_graph, TH2* sigma_err_graph)
+void HistogramHelpers::profileZwithIterativeGaussFit(TH3* hist, TH2* mu_graph, TH2* sigma_graph, int num_bins, TH2* mu_err_graph, TH2* sigma_err_graph, FitCache* fit_cache)
 {
   if (!hist) {
     cout<< "ProfileZwithIterativeGaussFit(): No histogram supplied!"<<endl;
@@ -134,7 +368,7 @@ void HistogramHelpers::profileZwithIterativeGaussFit(TH3* hist, TH2* mu_graph, T
 	//			    << "  entries: "<< current_proj->GetEntries()
 	//			    << endl;
 	
-	IterativeGaussFit(current_proj, current_mu, current_err_mu, current_sigma, current_err_sigma);
+	CachedIterativeGaussFit(current_proj, nullptr, fit_cache, current_mu, current_err_mu, current_sigma, current_err_sigma, 0);
 	
 	if (current_sigma > max_sigma || max_sigma == 0) max_sigma = current_sigma;
 	if (current_sigma < min_sigma || min_sigma == 0) min_sigma = current_sigma;
@@ -222,7 +456,7 @@ void HistogramHelpers::profileZwithIterativeGaussFit(TH3* hist, TH2* mu_graph, T
 
 
 //-----------------------------------------------------------------------------
-void HistogramHelpers::profileYwithIterativeGaussFit(TH2* hist, TH1* mu_graph, TH1* sigma_graph, int num_bins,int m_PrintLevel)
+void HistogramHelpers::profileYwithIterativeGaussFit(TH2* hist, TH1* mu_graph, TH1* sigma_graph, int num_bins,int m_PrintLevel, FitCache* fit_cache)
 {
   
   if (!hist) {
@@ -279,7 +513,7 @@ void HistogramHelpers::profileYwithIterativeGaussFit(TH2* hist, TH1* mu_graph, T
       if ( fDebug ) std::cout<<"WARNING: Not enough entries in bin "<<index<<std::endl;
     } else {
 
-      IterativeGaussFit(current_proj, mu, mu_err, sigma, sigma_err,m_PrintLevel);
+      CachedIterativeGaussFit(current_proj, nullptr, fit_cache, mu, mu_err, sigma, sigma_err,m_PrintLevel);
 
       if (sigma > max_sigma || max_sigma == 0) max_sigma = sigma;
       if (sigma < min_sigma || min_sigma == 0) min_sigma = sigma;
@@ -337,6 +571,277 @@ void HistogramHelpers::profileYwithIterativeGaussFit(TH2* hist, TH1* mu_graph, T
 }
 
 
+
+//-----------------------------------------------------------------------------
+void HistogramHelpers::profileYwithIterativeGaussFitMT(TH2* hist, TH1* mu_graph, TH1* sigma_graph, int num_bins, int nThreads, int m_PrintLevel, FitCache* fit_cache)
+{
+  
+  if (!hist) {
+    std::cout << "Error in ProfileYwithIterativeGaussFitMT(): Histogram not found" <<std::endl;
+    return;
+  }
+  
+  if (num_bins < 1 ) {
+    std::cout << "Error in ProfileYwithIterativeGaussFitMT(): Invalid number of bins to integrate over." <<std::endl;
+    return;
+  }
+
+  const int minEntries = 50;
+
+  int num_bins_x = hist->GetXaxis()->GetNbins();
+  int num_bins_y = hist->GetYaxis()->GetNbins();
+  bool useSumw2 = hist->GetSumw2N() > 0;
+
+  if (mu_graph) mu_graph->Rebin(num_bins);
+  if (sigma_graph) sigma_graph->Rebin(num_bins);
+
+  // Same bin groups as profileYwithIterativeGaussFit
+  std::vector<int> first_bins;
+  for (int i = 1; i < (num_bins_x + (num_bins == 1)); i+=num_bins) 
+    first_bins.push_back(i);
+  int nGroups = first_bins.size();
+  
+  std::vector<double> mus(nGroups), mu_errs(nGroups), sigmas(nGroups), sigma_errs(nGroups);
+  
+  int nWorkers = NumberOfWorkers(nThreads, nGroups);
+  std::string minimizer = nWorkers > 1 ? PrepareConcurrentFits() : "";
+  
+  // Thread-local fit functions and projection buffers
+  std::vector<TF1*> fit_funcs;
+  std::vector<TH1D*> buffers;
+  for (int worker = 0; worker < nWorkers; ++worker) {
+    fit_funcs.push_back(new TF1(Form("%s_fit_func_%i",hist->GetName(),worker),"gaus"));
+    TH1D* buffer = new TH1D(Form("%s_projection_buffer_%i",hist->GetName(),worker),"",1,0.,1.);
+    buffer->SetDirectory(0);
+    if (useSumw2) buffer->Sumw2();
+    buffers.push_back(buffer);
+  }
+
+  // Projections to print or write, one per bin group, created here since the workers do not allocate histograms
+  bool keep = KeepProjections(m_PrintLevel);
+  std::vector<TH1D*> projs;
+  std::vector<ProjectionFit> fits(keep ? nGroups : 0);
+  for (int group = 0; keep && group < nGroups; ++group) {
+    TH1D* proj = new TH1D(Form("%s_kept_projection_%i",hist->GetName(),group),"",1,0.,1.);
+    proj->SetDirectory(0);
+    if (useSumw2) proj->Sumw2();
+    projs.push_back(proj);
+  }
+
+  RunConcurrently(nWorkers, nGroups, [&](int worker, int group) {
+    int i = first_bins[group];
+    int index = i/num_bins;
+    if (num_bins == 1) index--;
+    int last = std::min(i+num_bins-1, num_bins_x+1);
+
+    TH1D* proj = keep ? projs[group] : buffers[worker];
+    ResetProjectionBuffer(proj, hist->GetYaxis());
+    proj->SetName(Form("%s_projection_%i",hist->GetName(),index));
+    for (int iy = 0; iy <= num_bins_y+1; ++iy) {
+      double cont = 0;
+      double err2 = 0;
+      for (int ix = i; ix <= last; ++ix) {
+        cont += hist->GetBinContent(ix, iy);
+        if (useSumw2) err2 += hist->GetBinError(ix, iy)*hist->GetBinError(ix, iy);
+      }
+      proj->SetBinContent(iy, cont);
+      if (useSumw2) proj->SetBinError(iy, std::sqrt(err2));
+    }
+    SetProjectionEntries(proj, hist, WholeAxis(hist->GetXaxis(), i, last));
+
+    FitProjection(proj, fit_funcs[worker], fit_cache, minEntries, 0.,
+                  mus[group], mu_errs[group], sigmas[group], sigma_errs[group], m_PrintLevel, minimizer, keep ? &fits[group] : nullptr);
+  });
+
+  for (int worker = 0; worker < nWorkers; ++worker) {
+    delete fit_funcs[worker];
+    delete buffers[worker];
+  }
+
+  ReportProjections(projs, fits, mus, mu_errs, sigmas, sigma_errs, m_PrintLevel);
+  for (auto proj : projs)
+    delete proj;
+  
+  // Fill the graphs in the same order as the serial profiler
+  std::vector<double> errs_mu(num_bins_x/num_bins + 2, 0.); // +2 for overflow!!
+  std::vector<double> errs_sigma(num_bins_x/num_bins + 2, 0.);
+  for (int group = 0; group < nGroups; ++group) {
+    int i = first_bins[group];
+    int index = i/num_bins;
+    if (num_bins == 1) index--;
+
+    double value_x = (hist->GetXaxis()->GetBinLowEdge(i) + hist->GetXaxis()->GetBinUpEdge(i+num_bins-1))/2;
+    
+    if (sigma_graph) sigma_graph->Fill(value_x, sigmas[group]);
+    if (mu_graph) mu_graph->Fill(value_x, mus[group]);
+        
+    errs_mu[index + 1] = mu_errs[group];
+    errs_sigma[index + 1] = sigma_errs[group];
+  }
+
+  if (sigma_graph) {
+    sigma_graph->SetError(errs_sigma.data());
+    sigma_graph->GetYaxis()->SetTitleOffset(1.5);
+    sigma_graph->SetTitle("");
+  }
+
+  if (mu_graph) {
+    mu_graph->SetError(errs_mu.data());
+    mu_graph->GetYaxis()->SetTitleOffset(1.5);
+    mu_graph->SetTitle("");
+  }
+
+  return;
+}
+
+
+//-------------------------------------------------------------
+void HistogramHelpers::profileZwithIterativeGaussFitMT(TH3* hist, TH2* mu_graph, TH2* sigma_graph, int num_bins, TH2* mu_err_graph, TH2* sigma_err_graph, int nThreads, FitCache* fit_cache)
+{
+  if (!hist) {
+    cout<< "ProfileZwithIterativeGaussFitMT(): No histogram supplied!"<<endl;
+    return;
+  }
+
+  int num_bins_x = hist->GetXaxis()->GetNbins();
+  int num_bins_y = hist->GetYaxis()->GetNbins();
+  int num_bins_z = hist->GetZaxis()->GetNbins();
+  bool useSumw2 = hist->GetSumw2N() > 0;
+
+  int minEntries = 50;
+
+  // Same bin groups as profileZwithIterativeGaussFit
+  std::vector<std::pair<int,int>> first_bins;
+  for (int i = 1; i < num_bins_x+(num_bins==1); i+=num_bins) 
+    for (int j = 1; j < num_bins_y+(num_bins==1); j+=num_bins) 
+      first_bins.push_back(std::make_pair(i,j));
+  int nGroups = first_bins.size();
+
+  std::vector<double> mus(nGroups), mu_errs(nGroups), sigmas(nGroups), sigma_errs(nGroups);
+
+  int nWorkers = NumberOfWorkers(nThreads, nGroups);
+  std::string minimizer = nWorkers > 1 ? PrepareConcurrentFits() : "";
+
+  // Thread-local fit functions and projection buffers
+  std::vector<TF1*> fit_funcs;
+  std::vector<TH1D*> buffers;
+  for (int worker = 0; worker < nWorkers; ++worker) {
+    fit_funcs.push_back(new TF1(Form("%s_fit_func_%i",hist->GetName(),worker),"gaus"));
+    TH1D* buffer = new TH1D(Form("%s_projection_buffer_%i",hist->GetName(),worker),"",1,0.,1.);
+    buffer->SetDirectory(0);
+    if (useSumw2) buffer->Sumw2();
+    buffers.push_back(buffer);
+  }
+
+  // Projections to print or write, one per bin group, created here since the workers do not allocate histograms
+  bool keep = KeepProjections(0);
+  std::vector<TH1D*> projs;
+  std::vector<ProjectionFit> fits(keep ? nGroups : 0);
+  for (int group = 0; keep && group < nGroups; ++group) {
+    TH1D* proj = new TH1D(Form("%s_kept_projection_%i",hist->GetName(),group),"",1,0.,1.);
+    proj->SetDirectory(0);
+    if (useSumw2) proj->Sumw2();
+    projs.push_back(proj);
+  }
+
+  RunConcurrently(nWorkers, nGroups, [&](int worker, int group) {
+    int i = first_bins[group].first;
+    int j = first_bins[group].second;
+    int index = i/num_bins;
+    int index_y = j/num_bins;
+    int last_x = std::min(i+num_bins-1, num_bins_x+1);
+    int last_y = std::min(j+num_bins-1, num_bins_y+1);
+
+    TH1D* proj = keep ? projs[group] : buffers[worker];
+    ResetProjectionBuffer(proj, hist->GetZaxis());
+    proj->SetName(Form("%s_GaussProjection_%i_%i",hist->GetName(),index, index_y));
+    proj->SetTitle(Form("%s - Bin %i x %i",hist->GetName(), index,index_y));
+    for (int iz = 0; iz <= num_bins_z+1; ++iz) {
+      double cont = 0;
+      double err2 = 0;
+      for (int ix = i; ix <= last_x; ++ix) {
+        for (int iy = j; iy <= last_y; ++iy) {
+          cont += hist->GetBinContent(ix, iy, iz);
+          if (useSumw2) err2 += hist->GetBinError(ix, iy, iz)*hist->GetBinError(ix, iy, iz);
+        }
+      }
+      proj->SetBinContent(iz, cont);
+      if (useSumw2) proj->SetBinError(iz, std::sqrt(err2));
+    }
+    SetProjectionEntries(proj, hist, WholeAxis(hist->GetXaxis(), i, last_x) && WholeAxis(hist->GetYaxis(), j, last_y));
+
+    FitProjection(proj, fit_funcs[worker], fit_cache, minEntries, 1.,
+                  mus[group], mu_errs[group], sigmas[group], sigma_errs[group], 0, minimizer, keep ? &fits[group] : nullptr);
+  });
+
+  for (int worker = 0; worker < nWorkers; ++worker) {
+    delete fit_funcs[worker];
+    delete buffers[worker];
+  }
+
+  ReportProjections(projs, fits, mus, mu_errs, sigmas, sigma_errs, 0);
+  for (auto proj : projs)
+    delete proj;
+
+  // Fill the graphs in the same order as the serial profiler
+  for (int group = 0; group < nGroups; ++group) {
+    int i = first_bins[group].first;
+    int j = first_bins[group].second;
+
+    float x_coord = (hist->GetXaxis()->GetBinLowEdge(i) + hist->GetXaxis()->GetBinUpEdge(i+num_bins-1))/2;
+    float y_coord = (hist->GetYaxis()->GetBinLowEdge(j) + hist->GetYaxis()->GetBinUpEdge(j+num_bins-1))/2;
+    
+    if (mu_graph) {
+      int binx = mu_graph->GetXaxis()->FindBin(x_coord);
+      int biny = mu_graph->GetYaxis()->FindBin(y_coord);
+      mu_graph->Fill(x_coord,y_coord,mus[group]);
+      mu_graph->SetBinError(binx,biny, mu_errs[group]);
+      if (sigma_graph)         sigma_graph->SetBinContent(binx, biny, sigmas[group]);
+      if (sigma_err_graph) sigma_err_graph->SetBinContent(binx, biny, sigma_errs[group]);
+      if (mu_err_graph)       mu_err_graph->SetBinContent(binx, biny, mu_errs[group]);
+    }
+  }
+  
+  if (mu_graph) {
+    mu_graph->GetXaxis()->SetTitle(hist->GetXaxis()->GetTitle());
+    mu_graph->GetYaxis()->SetTitle(hist->GetYaxis()->GetTitle());
+    mu_graph->GetYaxis()->SetTitleOffset(1);
+    mu_graph->GetZaxis()->SetTitle(hist->GetZaxis()->GetTitle());
+    mu_graph->GetZaxis()->SetTitleOffset(1.2);
+    mu_graph->SetTitle(hist->GetTitle() );
+  }
+  
+  if (sigma_graph) {
+    sigma_graph->GetXaxis()->SetTitle(hist->GetXaxis()->GetTitle());
+    sigma_graph->GetYaxis()->SetTitle(hist->GetYaxis()->GetTitle());
+    sigma_graph->GetYaxis()->SetTitleOffset(1);
+    sigma_graph->GetZaxis()->SetTitle(hist->GetZaxis()->GetTitle());
+    sigma_graph->GetZaxis()->SetTitleOffset(1.2);
+    sigma_graph->SetTitle( hist->GetTitle() );
+  }
+  
+  if (mu_err_graph) {
+    mu_err_graph->GetXaxis()->SetTitle(hist->GetXaxis()->GetTitle());
+    mu_err_graph->GetYaxis()->SetTitle(hist->GetYaxis()->GetTitle());
+    mu_err_graph->GetYaxis()->SetTitleOffset(1);
+    mu_err_graph->GetZaxis()->SetTitle(Form("Error of fit #mu: %s",hist->GetZaxis()->GetTitle()));
+    mu_err_graph->GetZaxis()->SetTitleOffset(1.2);
+    mu_err_graph->SetTitle(hist->GetTitle());
+  }
+  
+  if (sigma_err_graph) {
+    sigma_err_graph->GetXaxis()->SetTitle(hist->GetXaxis()->GetTitle());
+    sigma_err_graph->GetYaxis()->SetTitle(hist->GetYaxis()->GetTitle());
+    sigma_err_graph->GetYaxis()->SetTitleOffset(1);
+    sigma_err_graph->GetZaxis()->SetTitle(Form("Error of fit #sigma: %s",hist->GetZaxis()->GetTitle()));
+    sigma_err_graph->GetZaxis()->SetTitleOffset(1.2);
+    sigma_err_graph->SetTitle(hist->GetTitle());
+  }
+  
+  return;
+}
+
+
 //@par1 histogram to fit
 //@par2 pointer to function (which needs to be defined as double fcn(double*,double*)
 //@par3 initialParams
@@ -386,6 +891,41 @@ TF1* HistogramHelpers::IterativeGeneralFit(TH1* hist, double(*fcn)(double *, dou
 int HistogramHelpers::IterativeGaussFit(TH1* hist, double &mu, double &mu_err, double &sigma, double &sigma_err, int m_PrintLevel)
 {
   
+  if (!hist || hist->GetEntries() < 25) 
+    return IterativeGaussFit(hist, nullptr, mu, mu_err, sigma, sigma_err, m_PrintLevel);
+  
+  TF1* fit_func = new TF1("fit_func","gaus");
+  
+  int status = IterativeGaussFit(hist, fit_func, mu, mu_err, sigma, sigma_err, m_PrintLevel);
+  
+  hist->GetListOfFunctions()->Add(fit_func);
+  
+  if (m_PrintLevel >= 1 ) {
+    cout << " ** IterativeGaussFit ** fit result: histo name " << hist->GetName() << "    title: " << hist->GetTitle()  << endl
+	 << "    mu = " << mu << " +- " << mu_err << endl
+	 << " sigma = " << sigma << " +- " << sigma_err
+	 << endl;
+    //if (TempCanvasIterGaussFit == NULL) {
+    //TempCanvasIterGaussFit = new TCanvas ("TempCanvasIterGaussFit","Iter Gauss fit", 400, 400);
+    //}
+    //hist->DrawCopy();
+    //TempCanvasIterGaussFit->Update();
+    //hist->Print();
+    string input = "";
+    cout << " ** IterativeGaussFit ** Please type RETURN to continue:\n>";
+    getline(cin, input);
+  }
+  
+  WriteProjection(hist, fit_func);
+      
+  return status;
+}
+
+
+int HistogramHelpers::IterativeGaussFit(TH1* hist, TF1* fit_func, double &mu, double &mu_err, double &sigma, double &sigma_err, int m_PrintLevel,
+                                        const std::string& minimizer)
+{
+  
   //constants for fitting algorithm
   const int iteration_limit = 20;
   const float percent_limit = 0.01;
@@ -412,9 +952,7 @@ int HistogramHelpers::IterativeGaussFit(TH1* hist, double &mu, double &mu_err, d
   
   HistogramConditioning(hist);
   
-  TF1* fit_func = new TF1("fit_func","gaus");
-  
-  int bad_fit = hist->Fit(fit_func,"QN");
+  int bad_fit = FitHistogram(hist, fit_func, "QN", minimizer);
 
   if (fDebug && bad_fit) std::cout <<"BAD INITIAL FIT: "<< hist->GetTitle() << std::endl;
   
@@ -451,7 +989,7 @@ int HistogramHelpers::IterativeGaussFit(TH1* hist, double &mu, double &mu_err, d
     if (m_PrintLevel >= 3) cout << " ** IterativeGaussFit ** fit iter # " << iteration
 				<< "   new fit range: " << FitRangeLower << " --> " << FitRangeUpper << endl;
     
-    bad_fit = hist->Fit(fit_func, "RQN");
+    bad_fit = FitHistogram(hist, fit_func, "RQN", minimizer);
     // check that fit result is sound
     // 1) the mean must be within the histogram range
     if (fit_func->GetParameter(1) < hist->GetXaxis()->GetXmin() || fit_func->GetParameter(1) > hist->GetXaxis()->GetXmax()) bad_fit = 1;
@@ -469,7 +1007,7 @@ int HistogramHelpers::IterativeGaussFit(TH1* hist, double &mu, double &mu_err, d
 	}
       //std::cout<<"Rebinning by factor:"<<rebinFactor<<std::endl;
       hist->Rebin(rebinFactor);
-      hist->Fit(fit_func, "RQN");
+      FitHistogram(hist, fit_func, "RQN", minimizer);
     }
     
     // extract the correction for this iteration
@@ -519,26 +1057,12 @@ int HistogramHelpers::IterativeGaussFit(TH1* hist, double &mu, double &mu_err, d
   sigma = current_sigma;
   sigma_err = fit_func->GetParError(2);
   
-  hist->GetListOfFunctions()->Add(fit_func);
-  
-  if (m_PrintLevel >= 1 ) {
-    cout << " ** IterativeGaussFit ** fit result: histo name " << hist->GetName() << "    title: " << hist->GetTitle()  << endl
-	 << "    mu = " << mu << " +- " << mu_err << endl
-	 << " sigma = " << sigma << " +- " << sigma_err
-	 << endl;
-    //if (TempCanvasIterGaussFit == NULL) {
-    //TempCanvasIterGaussFit = new TCanvas ("TempCanvasIterGaussFit","Iter Gauss fit", 400, 400);
-    //}
-    //hist->DrawCopy();
-    //TempCanvasIterGaussFit->Update();
-    //hist->Print();
-    string input = "";
-    cout << " ** IterativeGaussFit ** Please type RETURN to continue:\n>";
-    getline(cin, input);
-  }
-  
+  return 0;
+}
+
+void HistogramHelpers::WriteProjection(TH1* hist, TF1* fit_func) {
   
-  if (outFile_for_projections->IsOpen()) {
+  if (outFile_for_projections && outFile_for_projections->IsOpen()) {
       TCanvas q; 
       q.cd();
       hist->Draw();
@@ -548,8 +1072,6 @@ int HistogramHelpers::IterativeGaussFit(TH1* hist, double &mu, double &mu_err, d
       outFile_for_projections->cd();
       q.Write((str+"_"+hist->GetName()).c_str()); 
   }
-      
-  return 0;
 }
 
 void HistogramHelpers::OpenProjectionFile() {
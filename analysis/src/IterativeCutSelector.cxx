@@ -48,6 +48,24 @@ void IterativeCutSelector::setCutValue(std::string cutname, double value){
     pair.first = value;
     pair.second = id;
     cuts[cutname] = pair;
+    if(isCompiled_){
+        std::map<std::string, unsigned int>::iterator index = compiledIndex_.find(cutname);
+        if(index == compiledIndex_.end()){
+            //New cuts are appended, the indices of the others do not change
+            CompiledCut compiled;
+            compiled.name = cutname;
+            compiled.variable = getCutVar(cutname);
+            compiled.greaterThan = isCutGreaterThan(cutname);
+            compiled.threshold = value;
+            compiled.revision = ++revision_;
+            compiledIndex_[cutname] = compiled_.size();
+            compiled_.push_back(compiled);
+        }
+        else if(compiled_[index->second].threshold != value){
+            compiled_[index->second].threshold = value;
+            compiled_[index->second].revision = ++revision_;
+        }
+    }
     if(debug_)
         std::cout << "[IterativeCutSelector] Updating cut " << cutname << " value from " << ogval << " to: " << cuts[cutname].first << std::endl; 
 }
@@ -108,5 +126,26 @@ void IterativeCutSelector::filterCuts(std::vector<std::string> cut_variable_list
         else
             ++it;
     }
+
+    if(isCompiled_)
+        compileCuts();
+}
+
+void IterativeCutSelector::compileCuts(){
+    compiled_.clear();
+    compiledIndex_.clear();
+    ++revision_;
+    ++generation_;
+    for(cut_it it=cuts.begin(); it != cuts.end(); it++){
+        CompiledCut compiled;
+        compiled.name = it->first;
+        compiled.variable = getCutVar(it->first);
+        compiled.greaterThan = isCutGreaterThan(it->first);
+        compiled.threshold = it->second.first;
+        compiled.revision = revision_;
+        compiledIndex_[it->first] = compiled_.size();
+        compiled_.push_back(compiled);
+    }
+    isCompiled_ = true;
 }
 
@@ -40,6 +40,13 @@ bool MutableTTree::variableExists(std::string variable){
         return false;
 }
 
+const double* MutableTTree::getVariableSlot(const std::string& variable) const{
+    std::map<std::string,double*>::const_iterator it = tuple_.find(variable);
+    if(it == tuple_.end())
+        return nullptr;
+    return it->second;
+}
+
 std::vector<std::string> MutableTTree::getAllVariables(){
     std::vector<std::string> variables;
     for(std::map<std::string,double*>::iterator it = tuple_.begin(); it != tuple_.end(); it++){
@@ -0,0 +1,91 @@
+#include "SiClusterIndex.h"
+
+#include <algorithm>
+#include <cmath>
+
+void SiClusterIndex::clear() {
+    for (auto& bucket : buckets_)
+        bucket.clear();
+    nEntries_ = 0;
+}
+
+int SiClusterIndex::key(int volume, int layer) const {
+    if (volume < 0 || volume >= nVolumes_ || layer < 0)
+        return -1;
+    return layer*nVolumes_ + volume;
+}
+
+void SiClusterIndex::build(std::vector<TrackerHit*>* siClusters) {
+    clear();
+    if (siClusters == nullptr)
+        return;
+
+    for (auto hit : *siClusters) {
+        int k = key(hit->getVolume(), hit->getLayer());
+        if (k < 0)
+            continue;
+
+        const std::vector<int>& strips = hit->getRawHitStripNumbers();
+        if (strips.empty())
+            continue;
+        auto minmax = std::minmax_element(strips.begin(), strips.end());
+
+        if (k >= (int)buckets_.size())
+            buckets_.resize(k+1);
+        buckets_[k].push_back({hit->getGlobalY(), hit->getTime(), hit->getID(),
+                *minmax.first, *minmax.second, hit});
+        nEntries_++;
+    }
+
+    for (auto& bucket : buckets_) {
+        std::stable_sort(bucket.begin(), bucket.end(),
+                [](const Entry& a, const Entry& b) {return a.y < b.y;});
+    }
+}
+
+const std::vector<SiClusterIndex::Entry>& SiClusterIndex::getBucket(int volume, int layer) const {
+    int k = key(volume, layer);
+    if (k < 0 || k >= (int)buckets_.size())
+        return empty_;
+    return buckets_[k];
+}
+
+const SiClusterIndex::Entry* SiClusterIndex::findClosestOutward(int volume, int layer, int id, double y,
+        int minStrip, int maxStrip, double maxTime) const {
+
+    const std::vector<Entry>& bucket = getBucket(volume, layer);
+
+    auto passes = [&](const Entry& e) {
+        //Skip same hit
+        if (e.id == id)
+            return false;
+        //Require alternative hits to be within the time window
+        if (std::abs(e.time) > maxTime)
+            return false;
+        //Skip adjacent rawhits
+        if (minStrip - e.maxStrip <= 1 && e.minStrip - maxStrip <= 1)
+            return false;
+        return true;
+    };
+
+    auto cmp = [](const Entry& e, double v) {return e.y < v;};
+
+    //Top volume: walk up in global Y starting from the hit
+    if (volume == 0) {
+        for (auto it = std::lower_bound(bucket.begin(), bucket.end(), y, cmp); it != bucket.end(); ++it) {
+            if (passes(*it))
+                return &(*it);
+        }
+    }
+    //Bottom volume: walk down in global Y starting from the hit
+    else {
+        auto it = std::upper_bound(bucket.begin(), bucket.end(), y,
+                [](double v, const Entry& e) {return v < e.y;});
+        while (it != bucket.begin()) {
+            --it;
+            if (passes(*it))
+                return &(*it);
+        }
+    }
+    return nullptr;
+}
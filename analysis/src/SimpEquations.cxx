@@ -202,20 +202,15 @@ double SimpEquations::expectedSignalCalculation(double m_V, double eps, bool rho
     //Mass in MeV
     double ctau = getCtau(m_Ap,m_pi, m_V,eps,alpha_dark_,f_pi,m_l_,rho);
     double gcTau = ctau * gamma(m_V/1000.0, E_V); //E_V in GeV
-    std::cout << "gcTau: " << gcTau << std::endl;
-    std::cout << "radFrac: " << radFrac << std::endl;
-    std::cout << "radAcc: " << radAcc << std::endl;
-    std::cout << "dNdm:" << dNdm << std::endl;
+    if(debug_){
+        std::cout << "gcTau: " << gcTau << std::endl;
+        std::cout << "radFrac: " << radFrac << std::endl;
+        std::cout << "radAcc: " << radAcc << std::endl;
+        std::cout << "dNdm:" << dNdm << std::endl;
+    }
 
     //Calculate the Efficiency Vertex (Displaced VD Acceptance)
-    double effVtx = 0.0;
-    for(int zbin = 0; zbin < (effCalc_h->GetTotalHistogram()->GetNbinsX())+1; zbin++){
-        double zz = effCalc_h->GetTotalHistogram()->GetBinLowEdge(zbin);
-        if(zz < zcut) continue;
-        effVtx += (TMath::Exp((target_pos-zz)/gcTau)/gcTau)*
-            (effCalc_h->GetEfficiency(zbin) - effCalc_h->GetEfficiencyErrorLow(zbin))*
-            effCalc_h->GetTotalHistogram()->GetBinWidth(zbin);
-    }
+    double effVtx = effVertex(effCalc_h, target_pos, zcut, gcTau);
 
     //Total A' Production Rate
     double apProduction = (3.*137/2.)*3.14159*(m_Ap*eps*eps*radFrac*dNdm)/radAcc;
@@ -227,7 +222,7 @@ double SimpEquations::expectedSignalCalculation(double m_V, double eps, bool rho
     else
         br_VPi = br_Vphi_pi(m_Ap, m_pi, m_V, alpha_dark_, f_pi);
 
-    std::cout << "Branching ratio is " << br_VPi << std::endl;
+    if(debug_) std::cout << "Branching ratio is " << br_VPi << std::endl;
     //Vector to e+e- BR = 1
     double br_V_ee = 1.0;
 
@@ -237,6 +232,87 @@ double SimpEquations::expectedSignalCalculation(double m_V, double eps, bool rho
     return expSignal;
 }
 
+SimpEquations::VertexAcceptance SimpEquations::vertexAcceptance(TEfficiency* effCalc_h, double target_pos, double zcut){
+
+    //The underflow bin is included, as in the original integration
+    const TH1* total_h = effCalc_h->GetTotalHistogram();
+    VertexAcceptance acceptance;
+    for(int zbin = 0; zbin < total_h->GetNbinsX()+1; zbin++){
+        double zz = total_h->GetBinLowEdge(zbin);
+        if(zz < zcut) continue;
+        acceptance.dz.push_back(target_pos-zz);
+        acceptance.efficiency.push_back(effCalc_h->GetEfficiency(zbin) - effCalc_h->GetEfficiencyErrorLow(zbin));
+        acceptance.width.push_back(total_h->GetBinWidth(zbin));
+    }
+    return acceptance;
+}
+
+double SimpEquations::effVertex(TEfficiency* effCalc_h, double target_pos, double zcut, double gcTau){
+
+    //Walks the bins directly, a single point does not pay for building a VertexAcceptance
+    const TH1* total_h = effCalc_h->GetTotalHistogram();
+    double effVtx = 0.0;
+    for(int zbin = 0; zbin < total_h->GetNbinsX()+1; zbin++){
+        double zz = total_h->GetBinLowEdge(zbin);
+        if(zz < zcut) continue;
+        double efficiency = effCalc_h->GetEfficiency(zbin) - effCalc_h->GetEfficiencyErrorLow(zbin);
+        effVtx += (std::exp((target_pos-zz)/gcTau)/gcTau)*efficiency*total_h->GetBinWidth(zbin);
+    }
+    return effVtx;
+}
+
+void SimpEquations::effVertex(const VertexAcceptance& acceptance, const double* gcTau, double* effVtx, int n){
+
+    for(int i = 0; i < n; i++)
+        effVtx[i] = 0.0;
+    //Same terms and order of operations as the single point integration
+    for(size_t zbin = 0; zbin < acceptance.dz.size(); zbin++){
+        double dz = acceptance.dz[zbin];
+        double efficiency = acceptance.efficiency[zbin];
+        double width = acceptance.width[zbin];
+        for(int i = 0; i < n; i++)
+            effVtx[i] += (std::exp(dz/gcTau[i])/gcTau[i])*efficiency*width;
+    }
+}
+
+void SimpEquations::expectedSignal(double m_V, const std::vector<double>& eps, bool rho, double E_V,
+        const VertexAcceptance& acceptance, double dNdm, double radFrac, double radAcc,
+        std::vector<double>& expSignal){
+
+    //Signal mass dependent SIMP parameters
+    double m_Ap = m_V*(mass_ratio_Ap_to_Vd_);
+    double m_pi = m_Ap/mass_ratio_Ap_to_Pid_;
+    double f_pi = m_pi/ratio_mPi_to_fPi_;
+
+    //Boosted decay length of each epsilon
+    std::vector<double> gcTau(eps.size());
+    for(size_t i = 0; i < eps.size(); i++)
+        gcTau[i] = getCtau(m_Ap,m_pi, m_V,eps[i],alpha_dark_,f_pi,m_l_,rho) * gamma(m_V/1000.0, E_V);
+
+    std::vector<double> effVtx(eps.size());
+    effVertex(acceptance, gcTau.data(), effVtx.data(), eps.size());
+
+    //A' -> V+Pi Branching Ratio does not depend on epsilon
+    double br_VPi = 0.0;
+    if(rho)
+        br_VPi = br_Vrho_pi(m_Ap, m_pi, m_V, alpha_dark_, f_pi);
+    else
+        br_VPi = br_Vphi_pi(m_Ap, m_pi, m_V, alpha_dark_, f_pi);
+    double br_V_ee = 1.0;
+
+    expSignal.resize(eps.size());
+    for(size_t i = 0; i < eps.size(); i++){
+        double apProduction = (3.*137/2.)*3.14159*(m_Ap*eps[i]*eps[i]*radFrac*dNdm)/radAcc;
+        expSignal[i] = apProduction * effVtx[i] * br_VPi * br_V_ee;
+    }
+}
+
+double SimpEquations::zbi(double n_on, double n_off, double tau){
+    if(n_on <= 0.0) return 0.0;
+    double P_Bi = TMath::BetaIncomplete(1./(1.+tau),n_on,n_off+1);
+    return std::pow(2,0.5)*TMath::ErfInverse(1-2*P_Bi);
+}
+
 double SimpEquations::expectedSignalCalculation(double m_V, double eps, bool rho, 
         double E_V, TEfficiency* effCalc_h, double target_pos, double zcut){
 
@@ -250,14 +326,7 @@ double SimpEquations::expectedSignalCalculation(double m_V, double eps, bool rho
     double gcTau = ctau * gamma(m_V/1000.0, E_V); //E_V in GeV
 
     //Calculate the Efficiency Vertex (Displaced VD Acceptance)
-    double effVtx = 0.0;
-    for(int zbin = 0; zbin < (effCalc_h->GetTotalHistogram()->GetNbinsX())+1; zbin++){
-        double zz = effCalc_h->GetTotalHistogram()->GetBinLowEdge(zbin);
-        if(zz < zcut) continue;
-        effVtx += (TMath::Exp((target_pos-zz)/gcTau)/gcTau)*
-            (effCalc_h->GetEfficiency(zbin) - effCalc_h->GetEfficiencyErrorLow(zbin))*
-            effCalc_h->GetTotalHistogram()->GetBinWidth(zbin);
-    }
+    double effVtx = effVertex(effCalc_h, target_pos, zcut, gcTau);
 
 
     //Total A' Production Rate
@@ -288,14 +357,7 @@ double SimpEquations::expectedSignalCalculation(double m_Ap, double m_pi, double
     double gcTau = ctau * gamma(m_V/1000.0, E_V); //E_V in GeV
 
     //Calculate the Efficiency Vertex (Displaced VD Acceptance)
-    double effVtx = 0.0;
-    for(int zbin = 0; zbin < (effCalc_h->GetTotalHistogram()->GetNbinsX())+1; zbin++){
-        double zz = effCalc_h->GetTotalHistogram()->GetBinLowEdge(zbin);
-        if(zz < zcut) continue;
-        effVtx += (TMath::Exp((target_pos-zz)/gcTau)/gcTau)*
-            (effCalc_h->GetEfficiency(zbin) - effCalc_h->GetEfficiencyErrorLow(zbin))*
-            effCalc_h->GetTotalHistogram()->GetBinWidth(zbin);
-    }
+    double effVtx = effVertex(effCalc_h, target_pos, zcut, gcTau);
 
 
     //Total A' Production Rate
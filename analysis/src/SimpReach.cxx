@@ -0,0 +1,176 @@
+/**
+ * @file SimpReach.cxx
+ * @brief Expected signal and ZBi grids of the SIMP reach.
+ */
+
+#include "SimpReach.h"
+
+//----------------//
+//   C++ StdLib   //
+//----------------//
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+
+//----------//
+//   ROOT   //
+//----------//
+#include "TEfficiency.h"
+#include "TFile.h"
+#include "TH2D.h"
+
+SimpReach::SimpReach(const std::string& cfgFile, int nThreads) :
+    cfgFile_(cfgFile), nThreads_(std::max(nThreads, 1)) {
+}
+
+SimpReach::~SimpReach() {
+}
+
+void SimpReach::initialize() {
+
+    std::ifstream i_file(cfgFile_);
+    if (!i_file.is_open())
+        throw std::runtime_error("[SimpReach]::ERROR::Cannot open configuration " + cfgFile_);
+    json config;
+    i_file >> config;
+    i_file.close();
+
+    year_ = config.value("year", year_);
+    simpParams_ = config.value("simp_params", simpParams_);
+    E_V_ = config.value("E_V", E_V_);
+    targetPos_ = config.value("target_pos", targetPos_);
+    signalSf_ = config.value("signal_sf", signalSf_);
+    if (config.contains("logEps2")) {
+        nLogEps2_ = config["logEps2"].value("nbins", nLogEps2_);
+        minLogEps2_ = config["logEps2"].value("min", minLogEps2_);
+        maxLogEps2_ = config["logEps2"].value("max", maxLogEps2_);
+    }
+
+    if (simpParams_.empty())
+        simpEqs_.reset(new SimpEquations(year_));
+    else
+        simpEqs_.reset(new SimpEquations(year_, simpParams_));
+    simpEqs_->setDebug(debug_);
+
+    eps_.resize(nLogEps2_);
+    double step = (maxLogEps2_ - minLogEps2_)/nLogEps2_;
+    for (int ibin = 0; ibin < nLogEps2_; ibin++)
+        eps_[ibin] = std::sqrt(std::pow(10, minLogEps2_ + (ibin + 0.5)*step));
+
+    // The TEfficiency bins are walked once per mass, here, before any thread is started
+    for (auto& mass : config.at("masses")) {
+        MassPoint point;
+        point.mass = mass.at("mass");
+        point.zcut = mass.at("zcut");
+        point.nbkg = mass.at("nbkg");
+        double m_Ap = simpEqs_->getAprimeMassFromVectorMass(point.mass);
+        point.dNdm = mass.contains("dNdm") ? mass["dNdm"].get<double>() : simpEqs_->controlRegionBackgroundRate(m_Ap);
+        point.radFrac = mass.contains("radFrac") ? mass["radFrac"].get<double>() : simpEqs_->radiativeFraction(m_Ap);
+        point.radAcc = mass.contains("radAcc") ? mass["radAcc"].get<double>() : simpEqs_->radiativeAcceptance(m_Ap);
+
+        std::string effFile = mass.at("effFile");
+        std::string effName = mass.at("effName");
+        TFile* file = TFile::Open(effFile.c_str());
+        TEfficiency* effCalc_h = file ? (TEfficiency*) file->Get(effName.c_str()) : nullptr;
+        if (!effCalc_h) {
+            delete file;
+            throw std::runtime_error("[SimpReach]::ERROR::Cannot read " + effName + " from " + effFile);
+        }
+        point.acceptance = SimpEquations::vertexAcceptance(effCalc_h, targetPos_, point.zcut);
+        delete effCalc_h;
+        file->Close();
+        delete file;
+
+        if (debug_)
+            std::cout << "[SimpReach]::Mass " << point.mass << " MeV: zcut " << point.zcut
+                << " nbkg " << point.nbkg << " dNdm " << point.dNdm << " radFrac " << point.radFrac
+                << " radAcc " << point.radAcc << std::endl;
+        points_.push_back(std::move(point));
+    }
+    if (points_.empty())
+        throw std::runtime_error("[SimpReach]::ERROR::No mass in " + cfgFile_);
+
+    std::sort(points_.begin(), points_.end(),
+            [](const MassPoint& a, const MassPoint& b) { return a.mass < b.mass; });
+}
+
+void SimpReach::calculate(MassPoint& point) {
+
+    simpEqs_->expectedSignal(point.mass, eps_, true, E_V_, point.acceptance,
+            point.dNdm, point.radFrac, point.radAcc, point.nSigRho);
+    simpEqs_->expectedSignal(point.mass, eps_, false, E_V_, point.acceptance,
+            point.dNdm, point.radFrac, point.radAcc, point.nSigPhi);
+
+    point.zbi.resize(eps_.size());
+    for (size_t ieps = 0; ieps < eps_.size(); ieps++) {
+        point.nSigRho[ieps] *= signalSf_;
+        point.nSigPhi[ieps] *= signalSf_;
+        double nsig = point.nSigRho[ieps] + point.nSigPhi[ieps];
+        point.zbi[ieps] = SimpEquations::zbi(nsig + point.nbkg, point.nbkg, 1.0);
+    }
+}
+
+void SimpReach::calculate() {
+
+    std::cout << "[SimpReach]::Calculating " << points_.size() << " masses x " << eps_.size()
+        << " epsilon values using " << nThreads_ << " threads" << std::endl;
+
+    // The masses are independent, each thread takes the next one until none is left
+    std::atomic<size_t> next{0};
+    auto work = [&]() {
+        for (size_t ipoint = next++; ipoint < points_.size(); ipoint = next++)
+            calculate(points_[ipoint]);
+    };
+    std::vector<std::thread> workers;
+    for (int ithread = 1; ithread < nThreads_; ++ithread)
+        workers.emplace_back(work);
+    work();
+    for (auto& worker : workers)
+        worker.join();
+}
+
+void SimpReach::write(const std::string& outFilename) {
+
+    // Mass bin edges halfway between the masses
+    std::vector<double> massEdges;
+    if (points_.size() == 1) {
+        massEdges = {points_[0].mass - 0.5, points_[0].mass + 0.5};
+    }
+    else {
+        massEdges.push_back(points_[0].mass - (points_[1].mass - points_[0].mass)/2.);
+        for (size_t ipoint = 1; ipoint < points_.size(); ipoint++)
+            massEdges.push_back((points_[ipoint-1].mass + points_[ipoint].mass)/2.);
+        size_t last = points_.size() - 1;
+        massEdges.push_back(points_[last].mass + (points_[last].mass - points_[last-1].mass)/2.);
+    }
+
+    TFile* outFile = new TFile(outFilename.c_str(), "RECREATE");
+    std::string axes = ";m_{V_{D}} [MeV];log_{10}(#epsilon^{2})";
+    auto book = [&](const std::string& name) {
+        return new TH2D(name.c_str(), axes.c_str(), massEdges.size() - 1, massEdges.data(),
+                nLogEps2_, minLogEps2_, maxLogEps2_);
+    };
+    TH2D* nSig_hh = book("Nsig_hh");
+    TH2D* nSigRho_hh = book("NsigRho_hh");
+    TH2D* nSigPhi_hh = book("NsigPhi_hh");
+    TH2D* zbi_hh = book("ZBi_hh");
+
+    for (size_t ipoint = 0; ipoint < points_.size(); ipoint++) {
+        const MassPoint& point = points_[ipoint];
+        for (size_t ieps = 0; ieps < eps_.size(); ieps++) {
+            nSig_hh->SetBinContent(ipoint + 1, ieps + 1, point.nSigRho[ieps] + point.nSigPhi[ieps]);
+            nSigRho_hh->SetBinContent(ipoint + 1, ieps + 1, point.nSigRho[ieps]);
+            nSigPhi_hh->SetBinContent(ipoint + 1, ieps + 1, point.nSigPhi[ieps]);
+            zbi_hh->SetBinContent(ipoint + 1, ieps + 1, point.zbi[ieps]);
+        }
+    }
+
+    outFile->Write();
+    outFile->Close();
+    delete outFile;
+    std::cout << "[SimpReach]::Grids written to " << outFilename << std::endl;
+}
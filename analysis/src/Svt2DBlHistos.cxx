@@ -1,10 +1,12 @@
 #include "Svt2DBlHistos.h"
 #include <math.h>
+#include <algorithm>
 #include "TCanvas.h"
 
 Svt2DBlHistos::Svt2DBlHistos(const std::string& inputName, ModuleMapper* mmapper) {
     m_name = inputName;
     mmapper_ = mmapper;
+    std::fill(&hybridIndex_[0][0], &hybridIndex_[0][0] + nModules_*nLayers_, -1);
 }
 
 Svt2DBlHistos::~Svt2DBlHistos() {
@@ -24,66 +26,83 @@ void Svt2DBlHistos::DefineHistos(){
     std::string makeMultiplesTag = "SvtHybrids";
     HistoManager::DefineHistos(hybridNames, makeMultiplesTag );
 
+    //Bind the histograms of each hybrid to its module and layer
+    std::fill(&hybridIndex_[0][0], &hybridIndex_[0][0] + nModules_*nLayers_, -1);
+    hybrids_.clear();
+    for (int mod = 0; mod < nModules_; mod++)
+    {
+        for (int lay = 1; lay < nLayers_; lay++)
+        {
+            if (lay < 9 && mod > 1)
+                continue;
+            std::string swTag = mmapper_->getStringFromSw("ly"+std::to_string(lay)+"_m"+std::to_string(mod));
+            Hybrid hybrid;
+            auto hitN = histos1d.find(m_name+"_"+swTag+"_SvtHybridsHitN_h");
+            if (hitN != histos1d.end())
+                hybrid.hitN = hitN->second;
+            //The samples are the ones with a histogram in the JSON file
+            for (int ss = 0; ss < 6; ss++)
+            {
+                auto adcs = histos2d.find(m_name+"_"+swTag+"_SvtHybrids_s"+std::to_string(ss)+"_hh");
+                if (adcs == histos2d.end() || !adcs->second)
+                    continue;
+                hybrid.samples.push_back(ss);
+                hybrid.adcs.emplace_back(adcs->second, sparse_);
+            }
+            hybridIndex_[mod][lay] = hybrids_.size();
+            hybrids_.push_back(hybrid);
+        }
+    }
+    hybridHits_.assign(hybrids_.size(), 0);
+    auto hitMulti = histos1d.find(m_name+"_SvtHitMulti_h");
+    hitMulti_ = hitMulti != histos1d.end() ? hitMulti->second : nullptr;
 }
 
 void Svt2DBlHistos::FillHistograms(std::vector<RawSvtHit*> *rawSvtHits_,float weight) {
 
     int nhits = rawSvtHits_->size();
-    std::vector<std::string> hybridStrings={};
-    std::string histokey;
     if(Event_number%10000 == 0) std::cout << "Event: " << Event_number 
         << " Number of RawSvtHits: " << nhits << std::endl;
 
     //Following Block counts the total number of hits each hybrid records per event
-    int svtHybMulti[4][15] = {0};
+    std::fill(hybridHits_.begin(), hybridHits_.end(), 0);
     for (int i = 0; i < nhits; i++)
     {
         RawSvtHit* rawSvtHit = rawSvtHits_->at(i);
-        int mod = rawSvtHit->getModule();
-        int lay = rawSvtHit->getLayer();
-        svtHybMulti[mod][lay]++;
-
+        int hybrid = hybridIndex(rawSvtHit->getModule(), rawSvtHit->getLayer());
+        if (hybrid >= 0)
+            hybridHits_[hybrid]++;
     }
-    for (int i =0; i < 4; i++)
+    for (unsigned int i = 0; i < hybrids_.size(); i++)
     {
-        for (int j = 1; j < 15; j++)
-        {
-            if (!(j<9 && i>1))
-            {   
-                std::string swTag = mmapper_->getStringFromSw("ly"+std::to_string(j)+"_m"+std::to_string(i));
-                hybridStrings.push_back(swTag);
-                Fill1DHisto(swTag+ "_SvtHybridsHitN_h", svtHybMulti[i][j],weight);
-            }
-        }
+        if (hybrids_[i].hitN)
+            hybrids_[i].hitN->Fill(hybridHits_[i], weight);
     }
 
-    Fill1DHisto("SvtHitMulti_h", nhits,weight);
+    if (hitMulti_)
+        hitMulti_->Fill(nhits, weight);
     //End of counting block
 
     //Populates histograms for each hybrid
     for (int i = 0; i < nhits; i++)
     {
         RawSvtHit* rawSvtHit = rawSvtHits_->at(i);
-        auto mod = std::to_string(rawSvtHit->getModule());
-        auto lay = std::to_string(rawSvtHit->getLayer());
-        std::string swTag= mmapper_->getStringFromSw("ly"+lay+"_m"+mod);
-        
-        //Manually select which baselines (0 - 6) are included. THIS MUST MATCH THE JSON FILE!
-        int ss = 0;
-        histokey = swTag + "_SvtHybrids_s"+std::to_string(ss)+"_hh";
-                    Fill2DHisto(histokey, 
-                (float)rawSvtHit->getStrip(),
-                (float)rawSvtHit->getADCs()[ss], 
-                weight);
-
-        ss = 3;
-        histokey = swTag + "_SvtHybrids_s"+std::to_string(ss)+"_hh";
-                    Fill2DHisto(histokey, 
-                (float)rawSvtHit->getStrip(),
-                (float)rawSvtHit->getADCs()[ss], 
-                weight);
-        
+        int hybrid = hybridIndex(rawSvtHit->getModule(), rawSvtHit->getLayer());
+        if (hybrid < 0)
+            continue;
+        Hybrid& histos = hybrids_[hybrid];
+        float strip = rawSvtHit->getStrip();
+        int* adcs = rawSvtHit->getADCs();
+        for (unsigned int is = 0; is < histos.samples.size(); is++)
+            histos.adcs[is].fill(strip, (float)adcs[histos.samples[is]], weight);
     }
 
-            Event_number++;
-}      
+    Event_number++;
+}
+
+void Svt2DBlHistos::saveHistos(TFile* outF, std::string folder) {
+    for (auto& hybrid : hybrids_)
+        for (auto& adcs : hybrid.adcs)
+            adcs.flush();
+    HistoManager::saveHistos(outF, folder);
+}
@@ -0,0 +1,170 @@
+#include "SvtCalibrationCache.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <TSystem.h>
+
+namespace {
+    /** Version of the on-disk format, bump when the layout or the parsed contents change */
+    const uint32_t CACHE_VERSION = 2;
+    const char CACHE_MAGIC[8] = {'H','P','S','V','T','C','A','L'};
+
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t nTables;
+        uint64_t signature; //!< hash of the source files
+        uint64_t checksum; //!< hash of the directory and the table contents
+    };
+
+    struct DirEntry {
+        char name[32];
+        uint64_t offset; //!< position of the table in the file
+        uint64_t size; //!< number of floats
+    };
+}
+
+SvtCalibrationCache::SvtCalibrationCache(const std::string& cacheDir,
+        const std::vector<std::string>& sources) : cacheDir_(cacheDir) {
+
+    if (gSystem->AccessPathName(cacheDir_.c_str()))
+        gSystem->mkdir(cacheDir_.c_str(), kTRUE);
+
+    uint64_t h = 14695981039346656037ULL;
+    hash(h, &CACHE_VERSION, sizeof(CACHE_VERSION));
+    for (auto& source : sources) {
+        hash(h, source.data(), source.size());
+        struct stat st;
+        if (stat(source.c_str(), &st) == 0) {
+            int64_t size = st.st_size;
+            int64_t mtime = st.st_mtime;
+            hash(h, &size, sizeof(size));
+            hash(h, &mtime, sizeof(mtime));
+        }
+    }
+    signature_ = h;
+    std::stringstream name;
+    name << cacheDir_ << "/svtcalib_" << std::hex << std::setw(16) << std::setfill('0') << h << ".bin";
+    path_ = name.str();
+}
+
+void SvtCalibrationCache::hash(uint64_t& h, const void* data, size_t size) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; ++i) {
+        h ^= bytes[i];
+        h *= 1099511628211ULL;
+    }
+}
+
+void SvtCalibrationCache::addTable(const std::string& name, float* data, size_t size) {
+    tables_.push_back({name.substr(0, sizeof(DirEntry::name)-1), data, size});
+}
+
+bool SvtCalibrationCache::load() {
+    int fd = open(path_.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(Header)) {
+        close(fd);
+        return false;
+    }
+    size_t fileSize = st.st_size;
+    void* map = mmap(nullptr, fileSize, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+        return false;
+
+    const char* bytes = static_cast<const char*>(map);
+    bool ok = true;
+    Header header;
+    std::memcpy(&header, bytes, sizeof(Header));
+    size_t dirEnd = sizeof(Header) + header.nTables*sizeof(DirEntry);
+    if (std::memcmp(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0
+            || header.version != CACHE_VERSION
+            || header.signature != signature_
+            || header.nTables != tables_.size()
+            || dirEnd > fileSize) {
+        ok = false;
+    }
+
+    //Check the directory against the registered tables
+    std::vector<DirEntry> dir(ok ? header.nTables : 0);
+    for (unsigned int itable = 0; ok && itable < dir.size(); ++itable) {
+        std::memcpy(&dir[itable], bytes + sizeof(Header) + itable*sizeof(DirEntry), sizeof(DirEntry));
+        const Table& table = tables_[itable];
+        if (table.name != std::string(dir[itable].name, strnlen(dir[itable].name, sizeof(DirEntry::name)))
+                || dir[itable].size != table.size
+                || dir[itable].offset + table.size*sizeof(float) > fileSize)
+            ok = false;
+    }
+
+    if (ok) {
+        uint64_t h = 14695981039346656037ULL;
+        hash(h, bytes + sizeof(Header), fileSize - sizeof(Header));
+        ok = (h == header.checksum);
+    }
+
+    if (ok) {
+        for (unsigned int itable = 0; itable < dir.size(); ++itable)
+            std::memcpy(tables_[itable].data, bytes + dir[itable].offset, tables_[itable].size*sizeof(float));
+    } else {
+        std::cout << "[ SvtCalibrationCache ]: WARNING: ignoring invalid cache " << path_ << std::endl;
+    }
+
+    munmap(map, fileSize);
+    return ok;
+}
+
+bool SvtCalibrationCache::store() const {
+    Header header;
+    std::memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    header.version = CACHE_VERSION;
+    header.nTables = tables_.size();
+    header.signature = signature_;
+
+    std::vector<DirEntry> dir(tables_.size());
+    uint64_t offset = sizeof(Header) + dir.size()*sizeof(DirEntry);
+    for (unsigned int itable = 0; itable < tables_.size(); ++itable) {
+        std::memset(dir[itable].name, 0, sizeof(DirEntry::name));
+        std::memcpy(dir[itable].name, tables_[itable].name.data(), tables_[itable].name.size());
+        dir[itable].offset = offset;
+        dir[itable].size = tables_[itable].size;
+        offset += tables_[itable].size*sizeof(float);
+    }
+
+    uint64_t h = 14695981039346656037ULL;
+    hash(h, dir.data(), dir.size()*sizeof(DirEntry));
+    for (auto& table : tables_)
+        hash(h, table.data, table.size*sizeof(float));
+    header.checksum = h;
+
+    // Write to a temporary file first so concurrent jobs never read a partial cache
+    std::string tmp = path_ + "." + std::to_string(gSystem->GetPid()) + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::binary);
+        if (!out.is_open()) {
+            std::cout << "[ SvtCalibrationCache ]: WARNING: cannot write " << tmp << std::endl;
+            return false;
+        }
+        out.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+        out.write(reinterpret_cast<const char*>(dir.data()), dir.size()*sizeof(DirEntry));
+        for (auto& table : tables_)
+            out.write(reinterpret_cast<const char*>(table.data), table.size*sizeof(float));
+        if (!out.good()) {
+            std::remove(tmp.c_str());
+            return false;
+        }
+    }
+    return std::rename(tmp.c_str(), path_.c_str()) == 0;
+}
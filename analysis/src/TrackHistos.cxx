@@ -5,6 +5,29 @@
 
 void TrackHistos::BuildAxes(){}
 
+namespace {
+
+    /** Histogram of a fill plan and its quantity */
+    struct Binding1D {
+        const char* name; //!< histogram name without the prefixes
+        int x; //!< quantity
+    };
+
+    /** 2D histogram of a fill plan and its quantities */
+    struct Binding2D {
+        const char* name; //!< histogram name without the prefixes
+        int x; //!< quantity on the x axis
+        int y; //!< quantity on the y axis
+    };
+
+    /** Histogram configuration read once from the JSON */
+    struct TrkHitHistoConfig {
+        std::string key;
+        std::string extension;
+        json config;
+    };
+}
+
 void TrackHistos::DefineTrkHitHistos(){
 
     std::vector<std::string> trkTypes;
@@ -12,51 +35,58 @@ void TrackHistos::DefineTrkHitHistos(){
     trkTypes.push_back("botEle");
     trkTypes.push_back("topPos");
     trkTypes.push_back("botPos");
+
+    //Get the extension of the name to decide the histogram to create
+    //i.e. _h = TH1D, _hh = TH2D, _ge = TGraphErrors, _p = TProfile ...
+    std::vector<TrkHitHistoConfig> configs;
+    for (auto hist : _h_configs.items()) {
+        std::size_t found = (hist.key()).find_last_of("_");
+        configs.push_back({hist.key(), hist.key().substr(found+1), hist.value()});
+    }
+
     std::string h_name = "";
     for (auto trkType : trkTypes)
     {
-        for (auto hist : _h_configs.items()) {
-
-            h_name = m_name+"_"+trkType+"_"+hist.key();
+        for (auto& hist : configs) {
 
-            //Get the extension of the name to decide the histogram to create
-            //i.e. _h = TH1D, _hh = TH2D, _ge = TGraphErrors, _p = TProfile ...
+            h_name = m_name+"_"+trkType+"_"+hist.key;
 
-            std::size_t found = (hist.key()).find_last_of("_");
-            std::string extension = hist.key().substr(found+1);
+            if (hist.extension == "h") {
+                histos1d[h_name] = plot1D(h_name, trkType+" "+std::string(hist.config.at("xtitle")),
+                        hist.config.at("bins"),
+                        hist.config.at("minX"),
+                        hist.config.at("maxX"));
 
-            if (extension == "h") {
-                histos1d[h_name] = plot1D(h_name, trkType+" "+std::string(hist.value().at("xtitle")),
-                        hist.value().at("bins"),
-                        hist.value().at("minX"),
-                        hist.value().at("maxX"));
-
-                std::string ytitle = hist.value().at("ytitle");
+                std::string ytitle = hist.config.at("ytitle");
 
                 histos1d[h_name]->GetYaxis()->SetTitle(ytitle.c_str());
 
-                if (hist.value().contains("labels")) {
-                    std::vector<std::string> labels = hist.value().at("labels").get<std::vector<std::string> >();
+                if (hist.config.contains("labels")) {
+                    std::vector<std::string> labels = hist.config.at("labels").get<std::vector<std::string> >();
 
-                    if (labels.size() < hist.value().at("bins")) {
+                    if (labels.size() < hist.config.at("bins")) {
                         std::cout<<"Cannot apply labels to histogram:"<<h_name<<std::endl;
                     }
                     else {
-                        for (int i = 1; i<=hist.value().at("bins");++i)
+                        for (int i = 1; i<=hist.config.at("bins");++i)
                             histos1d[h_name]->GetXaxis()->SetBinLabel(i,labels[i-1].c_str());
                     }//bins
                 }//labels
             }//1D histo
 
-            else if (extension == "hh") {
+            else if (hist.extension == "hh") {
                 histos2d[h_name] = plot2D(h_name,
-                        trkType+" "+std::string(hist.value().at("xtitle")),hist.value().at("binsX"),hist.value().at("minX"),hist.value().at("maxX"),
-                        hist.value().at("ytitle"),hist.value().at("binsY"),hist.value().at("minY"),hist.value().at("maxY"));
+                        trkType+" "+std::string(hist.config.at("xtitle")),hist.config.at("binsX"),hist.config.at("minX"),hist.config.at("maxX"),
+                        hist.config.at("ytitle"),hist.config.at("binsY"),hist.config.at("minY"),hist.config.at("maxY"));
             }
             else
                 std::cout<<"Error in histo definition "<<h_name<<std::endl;
         }//loop on config
     }//loop on trkTypes
+
+    //Fill plans bound before are missing these histograms
+    trackPlans_.clear();
+    track2DPlans_.clear();
 }
 
 void TrackHistos::Define2DHistos() {
@@ -89,6 +119,230 @@ void TrackHistos::Define2DHistos() {
 }//define 2dhistos
 
 
+TH1F* TrackHistos::bind1D(const std::string& histoName) {
+    auto histo = histos1d.find(m_name+"_"+histoName);
+    if (histo != histos1d.end() && histo->second)
+        return histo->second;
+    printWarnings_++;
+    if (doPrintWarnings_) {
+        if (printWarnings_ < maxWarnings_)
+            std::cout<<"ERROR::Fill1DHisto Histogram not found! "<<m_name+"_"+histoName<<std::endl;
+        else {
+            std::cout<<"Fill1DHisto::Printed max number of warnings " << maxWarnings_ << ". Stop"<<std::endl;
+            doPrintWarnings_ = false;
+        }
+    }
+    return nullptr;
+}
+
+TH2F* TrackHistos::bind2D(const std::string& histoName) {
+    auto histo = histos2d.find(m_name+"_"+histoName);
+    if (histo != histos2d.end() && histo->second)
+        return histo->second;
+    printWarnings_++;
+    if (doPrintWarnings_) {
+        if (printWarnings_ < maxWarnings_)
+            std::cout<<"ERROR::Fill2DHisto Histogram not found! "<<m_name+"_"+histoName<<std::endl;
+        else {
+            std::cout<<"Fill2DHisto::Printed max number of warnings " << maxWarnings_ << ". Stop"<<std::endl;
+            doPrintWarnings_ = false;
+        }
+    }
+    return nullptr;
+}
+
+const TrackHistos::TrackFillPlan& TrackHistos::trackPlan(const std::string& trkname) {
+
+    auto found = trackPlans_.find(trkname);
+    if (found != trackPlans_.end())
+        return found->second;
+
+    TrackFillPlan& plan = trackPlans_[trkname];
+    const Binding1D bindings1D[] = {
+        {"d0_h", kTrkD0}, {"Phi_h", kTrkPhi}, {"Omega_h", kTrkOmega}, {"pT_h", kTrkSignedPt},
+        {"p_h", kTrkP}, {"invpT_h", kTrkSignedInvPt}, {"TanLambda_h", kTrkTanLambda}, {"Z0_h", kTrkZ0},
+        {"Z0oTanLambda_h", kTrkZ0oTanLambda}, {"time_h", kTrkTime}, {"chi2_h", kTrkChi2},
+        {"chi2ndf_h", kTrkChi2Ndf}, {"nShared_h", kTrkNShared}, {"nHits_2d_h", kTrkNHits2d},
+        {"track_xpos_h", kTrkPosX}, {"track_ypos_h", kTrkPosY}, {"track_zpos_h", kTrkPosZ},
+        {"xpos_at_ecal_h", kTrkEcalX}, {"ypos_at_ecal_h", kTrkEcalY}, {"zpos_at_ecal_h", kTrkEcalZ},
+        {"d0_err_h", kTrkD0Err}, {"Phi_err_h", kTrkPhiErr}, {"Omega_err_h", kTrkOmegaErr},
+        {"TanLambda_err_h", kTrkTanLambdaErr}, {"Z0_err_h", kTrkZ0Err}, {"type_h", kTrkType}
+    };
+    for (auto& binding : bindings1D) {
+        if (TH1F* histo = bind1D(trkname+binding.name))
+            plan.fills1d.push_back({histo, binding.x, true});
+    }
+    plan.topZ0       = bind1D(trkname+"top_track_z0_h");
+    plan.botZ0       = bind1D(trkname+"bot_track_z0_h");
+    plan.hitLayers   = bind1D(trkname+"hit_lay_h");
+    plan.sharingHits = bind1D(trkname+"sharingHits_h");
+    plan.strategy    = bind1D(trkname+"strategy_h");
+    return plan;
+}
+
+const TrackHistos::FillList& TrackHistos::track2DPlan(const std::string& trkname) {
+
+    auto found = track2DPlans_.find(trkname);
+    if (found != track2DPlans_.end())
+        return found->second;
+
+    FillList& plan = track2DPlans_[trkname];
+    const Binding2D bindings2D[] = {
+        {"d0_vs_p_hh", kTrkP, kTrkD0},
+        {"d0_vs_phi0_hh", kTrkPhi, kTrkD0},
+        {"d0_vs_tanlambda_hh", kTrkTanLambda, kTrkD0},
+        {"z0_vs_p_hh", kTrkP, kTrkZ0},
+        {"phi0_vs_p_hh", kTrkP, kTrkPhi},
+        {"z0_vs_phi0_hh", kTrkPhi, kTrkZ0},
+        {"z0_vs_tanlambda_hh", kTrkTanLambda, kTrkZ0},
+        {"TanLambda_vs_Phi_hh", kTrkPhi, kTrkTanLambda},
+        {"p_vs_Phi_hh", kTrkPhi, kTrkP},
+        {"p_vs_TanLambda_hh", kTrkTanLambda, kTrkP}
+    };
+    for (auto& binding : bindings2D) {
+        if (TH2F* histo = bind2D(trkname+binding.name))
+            plan.fills2d.push_back({histo, binding.x, binding.y});
+    }
+    return plan;
+}
+
+const TrackHistos::FillList& TrackHistos::vertexPlan() {
+
+    if (vertexPlan_)
+        return *vertexPlan_;
+    vertexPlan_.reset(new FillList());
+    FillList& plan = *vertexPlan_;
+
+    const Binding1D bindings1D[] = {
+        {"vtx_chi2_h", kVtxChi2}, {"vtx_X_h", kVtxX}, {"vtx_Y_h", kVtxY}, {"vtx_Z_h", kVtxZ},
+        {"vtx_X_svt_h", kVtxSvtX}, {"vtx_Y_svt_h", kVtxSvtY}, {"vtx_Z_svt_h", kVtxSvtZ},
+        {"vtx_sigma_X_h", kVtxSigmaX}, {"vtx_sigma_Y_h", kVtxSigmaY}, {"vtx_sigma_Z_h", kVtxSigmaZ},
+        {"vtx_InvM_h", kVtxInvM}, {"vtx_InvMErr_Z_h", kVtxInvMErr}
+    };
+    for (auto& binding : bindings1D) {
+        if (TH1F* histo = bind1D(binding.name))
+            plan.fills1d.push_back({histo, binding.x, true});
+    }
+    //The momentum histograms are not weighted
+    const Binding1D momentumBindings1D[] = {
+        {"vtx_px_h", kVtxPx}, {"vtx_py_h", kVtxPy}, {"vtx_pz_h", kVtxPz}, {"vtx_p_h", kVtxP}
+    };
+    for (auto& binding : momentumBindings1D) {
+        if (TH1F* histo = bind1D(binding.name))
+            plan.fills1d.push_back({histo, binding.x, false});
+    }
+    const Binding2D bindings2D[] = {
+        {"vtx_XY_hh", kVtxX, kVtxY}, {"vtx_XY_svt_hh", kVtxSvtX, kVtxSvtY}
+    };
+    for (auto& binding : bindings2D) {
+        if (TH2F* histo = bind2D(binding.name))
+            plan.fills2d.push_back({histo, binding.x, binding.y});
+    }
+    return plan;
+}
+
+const TrackHistos::PairFillPlan& TrackHistos::pairPlan() {
+
+    if (pairPlan_)
+        return *pairPlan_;
+    pairPlan_.reset(new PairFillPlan());
+    PairFillPlan& plan = *pairPlan_;
+
+    const Binding1D bindings1D[] = {
+        {"ele_clusE_h", kEleClusE}, {"pos_clusE_h", kPosClusE},
+        {"ele_EoP_h", kEleEoP}, {"pos_EoP_h", kPosEoP},
+        {"ele_trkClusX_h", kEleTrkClusX}, {"ele_trkClusY_h", kEleTrkClusY},
+        {"pos_trkClusX_h", kPosTrkClusX}, {"pos_trkClusY_h", kPosTrkClusY},
+        {"Pmiss_h", kPmiss}, {"Esum_h", kEsum}, {"EsumClus_h", kEsumClus}, {"Psum_h", kPsum},
+        {"PtAsym_h", kPtAsym}, {"thetax_v0_h", kThetaxV0}, {"thetax_pos_h", kThetaxPos},
+        {"thetay_pos_h", kThetayPos}, {"thetay_miss_h", kThetayMiss}, {"thetay_diff_h", kThetayDiff}
+    };
+    for (auto& binding : bindings1D) {
+        if (TH1F* histo = bind1D(binding.name))
+            plan.fills1d.push_back({histo, binding.x, true});
+    }
+    const Binding2D bindings2D[] = {
+        {"EoP_hh", kEleEoP, kPosEoP},
+        {"ele_trkClusX_p_hh", kEleTrkP, kEleTrkClusX}, {"pos_trkClusX_p_hh", kPosTrkP, kPosTrkClusX},
+        {"ele_trkClusX_phi_hh", kEleTrkPhi, kEleTrkClusX}, {"pos_trkClusX_phi_hh", kPosTrkPhi, kPosTrkClusX},
+        {"ele_trkClusX_z0_hh", kEleTrkZ0, kEleTrkClusX}, {"pos_trkClusX_z0_hh", kPosTrkZ0, kPosTrkClusX},
+        {"ele_trkClusX_d0_hh", kEleTrkD0, kEleTrkClusX}, {"pos_trkClusX_d0_hh", kPosTrkD0, kPosTrkClusX},
+        {"ele_trkClusX_tanL_hh", kEleTrkTanLambda, kEleTrkClusX},
+        {"pos_trkClusX_tanL_hh", kPosTrkTanLambda, kPosTrkClusX},
+        {"ele_trkClusX_clusX_hh", kEleClusX, kEleTrkClusX}, {"pos_trkClusX_clusX_hh", kPosClusX, kPosTrkClusX},
+        {"EClus_hh", kEleClusE, kPosClusE},
+        {"InvM_eleP_hh", kEleP, kVtxInvM}, {"InvM_posP_hh", kPosP, kVtxInvM}
+    };
+    for (auto& binding : bindings2D) {
+        if (TH2F* histo = bind2D(binding.name))
+            plan.fills2d.push_back({histo, binding.x, binding.y});
+    }
+    plan.eleTrkClusXHitLayers = bind2D("ele_trkClusX_hitLay_hh");
+    plan.posTrkClusXHitLayers = bind2D("pos_trkClusX_hitLay_hh");
+    return plan;
+}
+
+const TrackHistos::FillList& TrackHistos::vertex2DPlan() {
+
+    if (vertex2DPlan_)
+        return *vertex2DPlan_;
+    vertex2DPlan_.reset(new FillList());
+    FillList& plan = *vertex2DPlan_;
+
+    const Binding2D bindings2D[] = {
+        {"vtx_InvM_vtx_z_hh", kVtxInvM, kVtxZ},
+        {"vtx_InvM_vtx_svt_z_hh", kVtxInvM, kVtxSvtZ},
+        {"vtx_p_svt_z_hh", kVtxP, kVtxSvtZ},
+        {"vtx_p_svt_x_hh", kVtxP, kVtxSvtX},
+        {"vtx_p_svt_y_hh", kVtxP, kVtxSvtY},
+        {"vtx_svt_y_svt_z_hh", kVtxSvtY, kVtxSvtZ},
+        {"vtx_p_sigmaZ_hh", kVtxP, kVtxCovZZ},
+        {"vtx_p_sigmaX_hh", kVtxP, kVtxCovYY},
+        {"vtx_p_sigmaY_hh", kVtxP, kVtxCovXX}
+    };
+    for (auto& binding : bindings2D) {
+        if (TH2F* histo = bind2D(binding.name))
+            plan.fills2d.push_back({histo, binding.x, binding.y});
+    }
+    return plan;
+}
+
+void TrackHistos::vertexQuantities(Vertex* vtx, float* q) {
+
+    q[kVtxChi2] = vtx->getChi2();
+    q[kVtxX]    = vtx->getX();
+    q[kVtxY]    = vtx->getY();
+    q[kVtxZ]    = vtx->getZ();
+
+    TVector3 vtxPosSvt;
+    vtxPosSvt.SetX(vtx->getX());
+    vtxPosSvt.SetY(vtx->getY());
+    vtxPosSvt.SetZ(vtx->getZ());
+
+    vtxPosSvt.RotateY(-0.0305);
+
+    q[kVtxSvtX] = vtxPosSvt.X();
+    q[kVtxSvtY] = vtxPosSvt.Y();
+    q[kVtxSvtZ] = vtxPosSvt.Z();
+
+    // 0 xx 1 xy 2 xz 3 yy 4 yz 5 zz
+    const std::vector<float>& cov = vtx->getCovariance();
+    q[kVtxCovXX]   = cov[0];
+    q[kVtxCovYY]   = cov[3];
+    q[kVtxCovZZ]   = cov[5];
+    q[kVtxSigmaX]  = sqrt(cov[0]);
+    q[kVtxSigmaY]  = sqrt(cov[3]);
+    q[kVtxSigmaZ]  = sqrt(cov[5]);
+    q[kVtxInvM]    = vtx->getInvMass();
+    q[kVtxInvMErr] = vtx->getInvMassErr();
+
+    TVector3 p = vtx->getP();
+    q[kVtxPx] = p.X();
+    q[kVtxPy] = p.Y();
+    q[kVtxPz] = p.Z();
+    q[kVtxP]  = p.Mag();
+}
+
 void TrackHistos::Fill1DVertex(Vertex* vtx, 
         Particle* ele, 
         Particle* pos, 
@@ -98,8 +352,8 @@ void TrackHistos::Fill1DVertex(Vertex* vtx,
 
     Fill1DVertex(vtx,weight);
 
-    CalCluster eleClus = ele->getCluster();
-    CalCluster posClus = pos->getCluster();
+    const CalCluster& eleClus = ele->getCluster();
+    const CalCluster& posClus = pos->getCluster();
 
     //TODO remove hardcode!
     if (ele_trk)
@@ -107,48 +361,50 @@ void TrackHistos::Fill1DVertex(Vertex* vtx,
     if (pos_trk)
         Fill1DTrack(pos_trk,weight,"pos_");
 
+    const PairFillPlan& plan = pairPlan();
+    float q[kNVertexQuantities];
+    q[kVtxInvM] = vtx->getInvMass();
 
     TLorentzVector p_ele;
     //p_ele.SetPxPyPzE(ele->getMomentum()[0], ele->getMomentum()[1],ele->getMomentum()[2],ele->getEnergy());
-    p_ele.SetPxPyPzE(ele_trk->getMomentum()[0],ele_trk->getMomentum()[1],ele_trk->getMomentum()[2],ele->getEnergy());
+    std::vector<double> ele_mom = ele_trk->getMomentum();
+    p_ele.SetPxPyPzE(ele_mom[0],ele_mom[1],ele_mom[2],ele->getEnergy());
 
     TLorentzVector p_pos;
     //p_pos.SetPxPyPzE(pos->getMomentum()[0], pos->getMomentum()[1],pos->getMomentum()[2],pos->getEnergy());
-    p_pos.SetPxPyPzE(pos_trk->getMomentum()[0],pos_trk->getMomentum()[1],pos_trk->getMomentum()[2],pos->getEnergy());
+    std::vector<double> pos_mom = pos_trk->getMomentum();
+    p_pos.SetPxPyPzE(pos_mom[0],pos_mom[1],pos_mom[2],pos->getEnergy());
 
     //Fill ele and pos information
-    //Fill1DHisto("ele_p_h",p_ele.P(),weight);
-    //Fill1DHisto("pos_p_h",p_pos.P(),weight);
-    Fill1DHisto("ele_clusE_h",eleClus.getEnergy(),weight);
-    Fill1DHisto("pos_clusE_h",posClus.getEnergy(),weight);
-    Fill1DHisto("ele_EoP_h",eleClus.getEnergy()/p_ele.P(),weight);
-    Fill1DHisto("ele_trkClusX_h",ele_trk->getPositionAtEcal()[0] - eleClus.getPosition()[0],weight);
-    Fill1DHisto("ele_trkClusY_h",ele_trk->getPositionAtEcal()[1] - eleClus.getPosition()[1],weight);
-    Fill1DHisto("pos_trkClusX_h",pos_trk->getPositionAtEcal()[0] - posClus.getPosition()[0],weight);
-    Fill1DHisto("pos_trkClusY_h",pos_trk->getPositionAtEcal()[1] - posClus.getPosition()[1],weight);
-    Fill1DHisto("pos_EoP_h",posClus.getEnergy()/p_pos.P(),weight);
-    Fill2DHisto("EoP_hh", eleClus.getEnergy()/p_ele.P(), posClus.getEnergy()/p_pos.P(),weight);
-    Fill2DHisto("ele_trkClusX_p_hh", ele_trk->getP(),ele_trk->getPositionAtEcal()[0] - eleClus.getPosition()[0], weight);
-    Fill2DHisto("pos_trkClusX_p_hh", pos_trk->getP(),pos_trk->getPositionAtEcal()[0] - posClus.getPosition()[0], weight);
-    Fill2DHisto("ele_trkClusX_phi_hh", ele_trk->getPhi(),ele_trk->getPositionAtEcal()[0] - eleClus.getPosition()[0], weight);
-    Fill2DHisto("pos_trkClusX_phi_hh", pos_trk->getPhi(),pos_trk->getPositionAtEcal()[0] - posClus.getPosition()[0], weight);
-    Fill2DHisto("ele_trkClusX_z0_hh", ele_trk->getZ0(),ele_trk->getPositionAtEcal()[0] - eleClus.getPosition()[0], weight);
-    Fill2DHisto("pos_trkClusX_z0_hh", pos_trk->getZ0(),pos_trk->getPositionAtEcal()[0] - posClus.getPosition()[0], weight);
-    Fill2DHisto("ele_trkClusX_d0_hh", ele_trk->getD0(),ele_trk->getPositionAtEcal()[0] - eleClus.getPosition()[0], weight);
-    Fill2DHisto("pos_trkClusX_d0_hh", pos_trk->getD0(),pos_trk->getPositionAtEcal()[0] - posClus.getPosition()[0], weight);
-    Fill2DHisto("ele_trkClusX_tanL_hh", ele_trk->getTanLambda(),ele_trk->getPositionAtEcal()[0] - eleClus.getPosition()[0], weight);
-    Fill2DHisto("pos_trkClusX_tanL_hh", pos_trk->getTanLambda(), pos_trk->getPositionAtEcal()[0] - posClus.getPosition()[0], weight);
-    Fill2DHisto("ele_trkClusX_clusX_hh", eleClus.getPosition()[0],ele_trk->getPositionAtEcal()[0] - eleClus.getPosition()[0], weight);
-    Fill2DHisto("pos_trkClusX_clusX_hh", posClus.getPosition()[0], pos_trk->getPositionAtEcal()[0] - posClus.getPosition()[0], weight);
-    for(int i = 0; i < ele_trk->getHitLayers().size(); i++)
-    {
-        Fill2DHisto("ele_trkClusX_hitLay_hh", (float) ele_trk->getHitLayers().at(i), ele_trk->getPositionAtEcal()[0] - eleClus.getPosition()[0], weight);
-    }
-    for(int i = 0; i < pos_trk->getHitLayers().size(); i++)
-    {
-        Fill2DHisto("pos_trkClusX_hitLay_hh", (float) pos_trk->getHitLayers().at(i), pos_trk->getPositionAtEcal()[0] - posClus.getPosition()[0], weight);
-    }
-
+    double eleClusE = eleClus.getEnergy();
+    double posClusE = posClus.getEnergy();
+    double eleClusX = eleClus.getPosition()[0];
+    double posClusX = posClus.getPosition()[0];
+    std::vector<double> eleAtEcal = ele_trk->getPositionAtEcal();
+    std::vector<double> posAtEcal = pos_trk->getPositionAtEcal();
+    double eleTrkClusX = eleAtEcal[0] - eleClusX;
+    double posTrkClusX = posAtEcal[0] - posClusX;
+
+    q[kEleClusE]        = eleClusE;
+    q[kPosClusE]        = posClusE;
+    q[kEleEoP]          = eleClusE/p_ele.P();
+    q[kPosEoP]          = posClusE/p_pos.P();
+    q[kEleClusX]        = eleClusX;
+    q[kPosClusX]        = posClusX;
+    q[kEleTrkClusX]     = eleTrkClusX;
+    q[kEleTrkClusY]     = eleAtEcal[1] - eleClus.getPosition()[1];
+    q[kPosTrkClusX]     = posTrkClusX;
+    q[kPosTrkClusY]     = posAtEcal[1] - posClus.getPosition()[1];
+    q[kEleTrkP]         = ele_trk->getP();
+    q[kPosTrkP]         = pos_trk->getP();
+    q[kEleTrkPhi]       = ele_trk->getPhi();
+    q[kPosTrkPhi]       = pos_trk->getPhi();
+    q[kEleTrkZ0]        = ele_trk->getZ0();
+    q[kPosTrkZ0]        = pos_trk->getZ0();
+    q[kEleTrkD0]        = ele_trk->getD0();
+    q[kPosTrkD0]        = pos_trk->getD0();
+    q[kEleTrkTanLambda] = ele_trk->getTanLambda();
+    q[kPosTrkTanLambda] = pos_trk->getTanLambda();
 
     //Compute some extra variables 
 
@@ -181,22 +437,35 @@ void TrackHistos::Fill1DVertex(Vertex* vtx,
         thetay_diff_val = thetay_pos_val - thetay_miss_val;
     }
 
-    //Fill event information
-
-    //Esum
-    Fill1DHisto("Pmiss_h", p_miss.P(),weight);
-    Fill1DHisto("Esum_h",ele->getEnergy() + pos->getEnergy(),weight);
-    Fill1DHisto("EsumClus_h",eleClus.getEnergy() + posClus.getEnergy(),weight);
-    Fill2DHisto("EClus_hh", eleClus.getEnergy() , posClus.getEnergy(),weight);
-    Fill2DHisto("InvM_eleP_hh", p_ele.P(), vtx->getInvMass(),weight);
-    Fill2DHisto("InvM_posP_hh", p_pos.P(), vtx->getInvMass(), weight);
-    Fill1DHisto("Psum_h",p_ele.P() + p_pos.P(),weight);
-    Fill1DHisto("PtAsym_h",pt_asym_val,weight);
-    Fill1DHisto("thetax_v0_h",thetax_v0_val,weight);
-    Fill1DHisto("thetax_pos_h",thetax_pos_val,weight);
-    Fill1DHisto("thetay_pos_h",thetay_pos_val,weight);
-    Fill1DHisto("thetay_miss_h",thetay_miss_val,weight);
-    Fill1DHisto("thetay_diff_h",thetay_diff_val,weight);
+    //Event information
+    double p_ele_val = p_ele.P();
+    double p_pos_val = p_pos.P();
+    q[kEleP]        = p_ele_val;
+    q[kPosP]        = p_pos_val;
+    q[kPmiss]       = p_miss.P();
+    q[kEsum]        = ele->getEnergy() + pos->getEnergy();
+    q[kEsumClus]    = eleClusE + posClusE;
+    q[kPsum]        = p_ele_val + p_pos_val;
+    q[kPtAsym]      = pt_asym_val;
+    q[kThetaxV0]    = thetax_v0_val;
+    q[kThetaxPos]   = thetax_pos_val;
+    q[kThetayPos]   = thetay_pos_val;
+    q[kThetayMiss]  = thetay_miss_val;
+    q[kThetayDiff]  = thetay_diff_val;
+
+    for (auto& fill : plan.fills1d)
+        fill.histo->Fill(q[fill.x], weight);
+    for (auto& fill : plan.fills2d)
+        fill.histo->Fill(q[fill.x], q[fill.y], weight);
+
+    if (plan.eleTrkClusXHitLayers) {
+        for (int layer : ele_trk->getHitLayers())
+            plan.eleTrkClusXHitLayers->Fill((float) layer, q[kEleTrkClusX], weight);
+    }
+    if (plan.posTrkClusXHitLayers) {
+        for (int layer : pos_trk->getHitLayers())
+            plan.posTrkClusXHitLayers->Fill((float) layer, q[kPosTrkClusX], weight);
+    }
 }
 
 
@@ -205,28 +474,23 @@ void TrackHistos::Fill2DTrack(Track* track, float weight, const std::string& trk
 
     if (track) {
 
-        double d0 = track->getD0();
-        double z0 = track->getZ0();
-        //Fill2DHisto(trkname+"tanlambda_vs_phi0_hh",track->getPhi(),track->getTanLambda(), weight);
-        Fill2DHisto(trkname+"d0_vs_p_hh",track->getP(),d0,weight);
-        Fill2DHisto(trkname+"d0_vs_phi0_hh",track->getPhi(),d0,weight);
-        Fill2DHisto(trkname+"d0_vs_tanlambda_hh",track->getTanLambda(),d0,weight);
-
-        Fill2DHisto(trkname+"z0_vs_p_hh",track->getP(),z0,weight);
-        Fill2DHisto(trkname+"phi0_vs_p_hh",track->getP(),track->getPhi(),weight);
-        Fill2DHisto(trkname+"z0_vs_phi0_hh",track->getPhi(),z0,weight);
-        Fill2DHisto(trkname+"z0_vs_tanlambda_hh",track->getTanLambda(),z0,weight);
-                
-        Fill2DHisto(trkname+"TanLambda_vs_Phi_hh"      ,track->getPhi()  , track->getTanLambda()       ,weight);
-        Fill2DHisto(trkname+"p_vs_Phi_hh"      ,track->getPhi()  , track->getP()       ,weight);
-        Fill2DHisto(trkname+"p_vs_TanLambda_hh"      ,track->getTanLambda()  , track->getP()       ,weight);
-
+        const FillList& plan = track2DPlan(trkname);
+        float q[kNTrackQuantities];
+        q[kTrkD0]        = track->getD0();
+        q[kTrkZ0]        = track->getZ0();
+        q[kTrkP]         = track->getP();
+        q[kTrkPhi]       = track->getPhi();
+        q[kTrkTanLambda] = track->getTanLambda();
 
+        for (auto& fill : plan.fills2d)
+            fill.histo->Fill(q[fill.x], q[fill.y], weight);
     }
 }
 
 void TrackHistos::Fill1DTrack(Track* track, float weight, const std::string& trkname) {
 
+    const TrackFillPlan& plan = trackPlan(trkname);
+
     double charge = (double) track->getCharge();
 
     //2D hits
@@ -234,110 +498,101 @@ void TrackHistos::Fill1DTrack(Track* track, float weight, const std::string& trk
     if (!track->isKalmanTrack())
         n_hits_2d*=2;
 
-    Fill1DHisto(trkname+"d0_h"       ,track->getD0()          ,weight);
-    Fill1DHisto(trkname+"Phi_h"      ,track->getPhi()         ,weight);
-    Fill1DHisto(trkname+"Omega_h"    ,track->getOmega()       ,weight);
-    Fill1DHisto(trkname+"pT_h"       ,-1*charge*track->getPt(),weight);
-    Fill1DHisto(trkname+"p_h"        ,track->getP()           ,weight);
-    Fill1DHisto(trkname+"invpT_h"    ,-1*charge/track->getPt(),weight);
-    Fill1DHisto(trkname+"TanLambda_h",track->getTanLambda()   ,weight);
-    Fill1DHisto(trkname+"Z0_h"       ,track->getZ0()          ,weight);
-    Fill1DHisto(trkname+"Z0oTanLambda_h",track->getZ0()/track->getTanLambda()   ,weight);
-    Fill1DHisto(trkname+"time_h"     ,track->getTrackTime()   ,weight);
-    Fill1DHisto(trkname+"chi2_h"     ,track->getChi2()        ,weight);
-    Fill1DHisto(trkname+"chi2ndf_h"  ,track->getChi2Ndf()     ,weight);
-    Fill1DHisto(trkname+"nShared_h"  ,track->getNShared()     ,weight);
-    Fill1DHisto(trkname+"nHits_2d_h" ,n_hits_2d               ,weight);
-    Fill1DHisto(trkname+"track_xpos_h",track->getPosition().at(0) ,weight);
-    Fill1DHisto(trkname+"track_ypos_h",track->getPosition().at(1) ,weight);
-    Fill1DHisto(trkname+"track_zpos_h",track->getPosition().at(2) ,weight);
-    Fill1DHisto(trkname+"xpos_at_ecal_h",track->getPositionAtEcal().at(0) ,weight);
-    Fill1DHisto(trkname+"ypos_at_ecal_h",track->getPositionAtEcal().at(1) ,weight);
-    Fill1DHisto(trkname+"zpos_at_ecal_h",track->getPositionAtEcal().at(2) ,weight);
+    double pt = track->getPt();
+    double tanLambda = track->getTanLambda();
+    double z0 = track->getZ0();
+    std::vector<double> position = track->getPosition();
+    std::vector<double> atEcal = track->getPositionAtEcal();
+
+    float q[kNTrackQuantities];
+    q[kTrkD0]           = track->getD0();
+    q[kTrkPhi]          = track->getPhi();
+    q[kTrkOmega]        = track->getOmega();
+    q[kTrkSignedPt]     = -1*charge*pt;
+    q[kTrkP]            = track->getP();
+    q[kTrkSignedInvPt]  = -1*charge/pt;
+    q[kTrkTanLambda]    = tanLambda;
+    q[kTrkZ0]           = z0;
+    q[kTrkZ0oTanLambda] = z0/tanLambda;
+    q[kTrkTime]         = track->getTrackTime();
+    q[kTrkChi2]         = track->getChi2();
+    q[kTrkChi2Ndf]      = track->getChi2Ndf();
+    q[kTrkNShared]      = track->getNShared();
+    q[kTrkNHits2d]      = n_hits_2d;
+    q[kTrkPosX]         = position.at(0);
+    q[kTrkPosY]         = position.at(1);
+    q[kTrkPosZ]         = position.at(2);
+    q[kTrkEcalX]        = atEcal.at(0);
+    q[kTrkEcalY]        = atEcal.at(1);
+    q[kTrkEcalZ]        = atEcal.at(2);
+    //Track param errors
+    q[kTrkD0Err]        = track->getD0Err();
+    q[kTrkPhiErr]       = track->getPhiErr();
+    q[kTrkOmegaErr]     = track->getOmegaErr();
+    q[kTrkTanLambdaErr] = track->getTanLambdaErr();
+    q[kTrkZ0Err]        = track->getZ0Err();
+    q[kTrkType]         = track->getType();
+
+    for (auto& fill : plan.fills1d)
+        fill.histo->Fill(q[fill.x], weight);
 
     //Top vs Bot
-    if(track->getTanLambda() > 0.0)
-        Fill1DHisto(trkname+"top_track_z0_h", track->getZ0(), weight);
-    else
-        Fill1DHisto(trkname+"bot_track_z0_h", track->getZ0(), weight);
-
-    //Track param errors
-    Fill1DHisto(trkname+"d0_err_h"       ,track->getD0Err()          ,weight);
-    Fill1DHisto(trkname+"Phi_err_h"      ,track->getPhiErr()         ,weight);
-    Fill1DHisto(trkname+"Omega_err_h"    ,track->getOmegaErr()       ,weight);
-    Fill1DHisto(trkname+"TanLambda_err_h",track->getTanLambdaErr()   ,weight);
-    Fill1DHisto(trkname+"Z0_err_h"       ,track->getZ0Err()          ,weight);
+    if (tanLambda > 0.0) {
+        if (plan.topZ0)
+            plan.topZ0->Fill(q[kTrkZ0], weight);
+    }
+    else if (plan.botZ0)
+        plan.botZ0->Fill(q[kTrkZ0], weight);
 
-    for (int ihit=0; ihit<track->getHitLayers().size();++ihit) 
-    {
-        int hit2d = track->getHitLayers().at(ihit);
-        Fill1DHisto(trkname+"hit_lay_h",(float) hit2d  ,weight);
+    if (plan.hitLayers) {
+        for (int hit2d : track->getHitLayers())
+            plan.hitLayers->Fill((float) hit2d, weight);
     }
     
     //All Tracks
-    Fill1DHisto(trkname+"sharingHits_h",0,weight);
-    if (track->getNShared() == 0)
-        Fill1DHisto(trkname+"sharingHits_h",1.,weight);
-    else {
-        //track has shared hits
-        if (track->getSharedLy0())
-            Fill1DHisto(trkname+"sharingHits_h",2.,weight);
-        if (track->getSharedLy1())
-            Fill1DHisto(trkname+"sharingHits_h",3.,weight);
-        if (track->getSharedLy0() && track->getSharedLy1())
-            Fill1DHisto(trkname+"sharingHits_h",4.,weight);
-        if (!track->getSharedLy0() && !track->getSharedLy1())
-            Fill1DHisto(trkname+"sharingHits_h",5.,weight);
+    if (TH1F* sharingHits = plan.sharingHits) {
+        sharingHits->Fill(0.f, weight);
+        if (track->getNShared() == 0)
+            sharingHits->Fill(1.f, weight);
+        else {
+            //track has shared hits
+            if (track->getSharedLy0())
+                sharingHits->Fill(2.f, weight);
+            if (track->getSharedLy1())
+                sharingHits->Fill(3.f, weight);
+            if (track->getSharedLy0() && track->getSharedLy1())
+                sharingHits->Fill(4.f, weight);
+            if (!track->getSharedLy0() && !track->getSharedLy1())
+                sharingHits->Fill(5.f, weight);
+        }
     }
 
-    if (track -> is345Seed())
-        Fill1DHisto(trkname+"strategy_h",0,weight);
-    if (track-> is456Seed())
-        Fill1DHisto(trkname+"strategy_h",1,weight);
-    if (track-> is123SeedC4())
-        Fill1DHisto(trkname+"strategy_h",2,weight);
-    if (track->is123SeedC5())
-        Fill1DHisto(trkname+"strategy_h",3,weight);
-    if (track->isMatchedTrack())
-        Fill1DHisto(trkname+"strategy_h",4,weight);
-    if (track->isGBLTrack())
-        Fill1DHisto(trkname+"strategy_h",5,weight);
-
-
-    Fill1DHisto(trkname+"type_h",track->getType(),weight);
+    if (TH1F* strategy = plan.strategy) {
+        if (track -> is345Seed())
+            strategy->Fill(0.f, weight);
+        if (track-> is456Seed())
+            strategy->Fill(1.f, weight);
+        if (track-> is123SeedC4())
+            strategy->Fill(2.f, weight);
+        if (track->is123SeedC5())
+            strategy->Fill(3.f, weight);
+        if (track->isMatchedTrack())
+            strategy->Fill(4.f, weight);
+        if (track->isGBLTrack())
+            strategy->Fill(5.f, weight);
+    }
 }
 
 void TrackHistos::Fill1DVertex(Vertex* vtx, float weight) {
 
-    Fill1DHisto("vtx_chi2_h"   ,vtx->getChi2(),weight);
-    Fill2DHisto("vtx_XY_hh",vtx->getX(),vtx->getY(),weight);
-    Fill1DHisto("vtx_X_h"      ,vtx->getX(),weight);
-    Fill1DHisto("vtx_Y_h"      ,vtx->getY(),weight);
-    Fill1DHisto("vtx_Z_h"      ,vtx->getZ(),weight);
-
-    TVector3 vtxPosSvt;
-    vtxPosSvt.SetX(vtx->getX());
-    vtxPosSvt.SetY(vtx->getY());
-    vtxPosSvt.SetZ(vtx->getZ());
-
-    vtxPosSvt.RotateY(-0.0305);
-
-    Fill2DHisto("vtx_XY_svt_hh",vtxPosSvt.X(),vtxPosSvt.Y(),weight);
-    Fill1DHisto("vtx_X_svt_h",vtxPosSvt.X(),weight);
-    Fill1DHisto("vtx_Y_svt_h",vtxPosSvt.Y(),weight);
-    Fill1DHisto("vtx_Z_svt_h",vtxPosSvt.Z(),weight);
+    const FillList& plan = vertexPlan();
+    float q[kNVertexQuantities];
+    vertexQuantities(vtx, q);
 
-
-    // 0 xx 1 xy 2 xz 3 yy 4 yz 5 zz
-    Fill1DHisto("vtx_sigma_X_h",sqrt(vtx->getCovariance()[0]),weight);
-    Fill1DHisto("vtx_sigma_Y_h",sqrt(vtx->getCovariance()[3]),weight);
-    Fill1DHisto("vtx_sigma_Z_h",sqrt(vtx->getCovariance()[5]),weight);
-    Fill1DHisto("vtx_InvM_h"   ,vtx->getInvMass(),weight);
-    Fill1DHisto("vtx_InvMErr_Z_h",vtx->getInvMassErr(),weight);
-    Fill1DHisto("vtx_px_h",vtx->getP().X());
-    Fill1DHisto("vtx_py_h",vtx->getP().Y());
-    Fill1DHisto("vtx_pz_h",vtx->getP().Z());
-    Fill1DHisto("vtx_p_h" ,vtx->getP().Mag());
+    for (auto& fill : plan.fills1d)
+        fill.histo->Fill(q[fill.x], fill.weighted ? weight : 1.f);
+    for (auto& fill : plan.fills2d)
+        fill.histo->Fill(q[fill.x], q[fill.y], weight);
 }
 
 void TrackHistos::Fill1DHistograms(Track *track, Vertex* vtx, float weight ) {
@@ -414,28 +669,12 @@ void TrackHistos::Fill2DHistograms(Vertex* vtx, float weight) {
 
     if (vtx) {
 
-        //TODO Improve this.
-        TVector3 vtxPosSvt;
-        vtxPosSvt.SetX(vtx->getX());
-        vtxPosSvt.SetY(vtx->getY());
-        vtxPosSvt.SetZ(vtx->getZ());
-
-        vtxPosSvt.RotateY(-0.0305);
-
-
-        double vtxP = vtx->getP().Mag();
-
-        Fill2DHisto("vtx_InvM_vtx_z_hh",vtx->getInvMass(),vtx->getZ(),weight);
-        Fill2DHisto("vtx_InvM_vtx_svt_z_hh",vtx->getInvMass(),vtxPosSvt.Z(),weight);
-        Fill2DHisto("vtx_p_svt_z_hh",vtxP,vtxPosSvt.Z(),weight);
-        Fill2DHisto("vtx_p_svt_x_hh",vtxP,vtxPosSvt.X(),weight);
-        Fill2DHisto("vtx_p_svt_y_hh",vtxP,vtxPosSvt.Y(),weight);
-
-        Fill2DHisto("vtx_svt_y_svt_z_hh",vtxPosSvt.Y(),vtxPosSvt.Z(),weight);
+        const FillList& plan = vertex2DPlan();
+        float q[kNVertexQuantities];
+        vertexQuantities(vtx, q);
 
-        Fill2DHisto("vtx_p_sigmaZ_hh",vtxP,vtx->getCovariance()[5],weight);
-        Fill2DHisto("vtx_p_sigmaX_hh",vtxP,vtx->getCovariance()[3],weight);
-        Fill2DHisto("vtx_p_sigmaY_hh",vtxP,vtx->getCovariance()[0],weight);
+        for (auto& fill : plan.fills2d)
+            fill.histo->Fill(q[fill.x], q[fill.y], weight);
     }
 }
 
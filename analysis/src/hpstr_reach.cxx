@@ -0,0 +1,62 @@
+/**
+ *  @file   hpstr_reach.cxx
+ *  @brief  App used to compute the SIMP reach grids.
+ */
+
+//----------------//
+//   C++ StdLib   //
+//----------------//
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <string>
+#include <vector>
+
+//-----------//
+//   hpstr   //
+//-----------//
+#include "SimpReach.h"
+
+static void displayUsage() {
+    printf("Usage: hpstr-reach [-j threads] [-d] {reach_config.json} {output.root}\n");
+    printf("  -j threads  Number of threads the masses are distributed over\n");
+    printf("  -d          Print the inputs of each mass\n");
+}
+
+int main(int argc, char** argv) {
+
+    int nthreads = 1;
+    int debug = 0;
+    std::vector<std::string> files;
+    for (int iarg = 1; iarg < argc; iarg++) {
+        if (!strcmp(argv[iarg], "-j") && iarg + 1 < argc)
+            nthreads = atoi(argv[++iarg]);
+        else if (!strcmp(argv[iarg], "-d"))
+            debug = 1;
+        else
+            files.push_back(argv[iarg]);
+    }
+    if (files.size() != 2) {
+        displayUsage();
+        return EXIT_FAILURE;
+    }
+
+    try {
+        auto start = std::chrono::steady_clock::now();
+        SimpReach reach(files[0], nthreads);
+        reach.setDebug(debug);
+        reach.initialize();
+        reach.calculate();
+        reach.write(files[1]);
+        std::cout << "---- [ hpstr-reach ]: Reach took "
+            << std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count()
+            << " s --------" << std::endl;
+    } catch (std::exception& e) {
+        std::cerr << "Error! [" << e.what() << "] \n";
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
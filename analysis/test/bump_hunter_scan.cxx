@@ -0,0 +1,77 @@
+/**
+ * @file bump_hunter_scan.cxx
+ * @brief Check that BumpHunter::scanMassHypotheses gives the same results
+ *        for any number of threads, with the default minimizer and with
+ *        Minuit2, and leaves the default minimizer alone.
+ */
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <TH1D.h>
+#include <TRandom3.h>
+#include <Math/MinimizerOptions.h>
+
+#include "BumpHunter.h"
+
+/**
+ * Scan the masses with one and with three threads.
+ *
+ * @return The number of masses whose results differ.
+ */
+int compareScans(BumpHunter& hunter, TH1D& spectrum, const std::vector<double>& masses,
+                 const std::string& configuration) {
+    std::vector<HpsFitResult*> serial = hunter.scanMassHypotheses(&spectrum, masses, true, 1);
+    std::vector<HpsFitResult*> concurrent = hunter.scanMassHypotheses(&spectrum, masses, true, 3);
+
+    int failures = 0;
+    for(unsigned int imass = 0; imass < masses.size(); ++imass) {
+        if(serial[imass]->getSignalYield() != concurrent[imass]->getSignalYield()
+                || serial[imass]->getPValue() != concurrent[imass]->getPValue()) {
+            std::cerr << "[ bump-hunter-scan ]: " << configuration << ", mass " << masses[imass]
+                      << " differs: signal yield " << serial[imass]->getSignalYield() << " vs "
+                      << concurrent[imass]->getSignalYield() << ", p-value " << serial[imass]->getPValue()
+                      << " vs " << concurrent[imass]->getPValue() << std::endl;
+            ++failures;
+        }
+        delete serial[imass];
+        delete concurrent[imass];
+    }
+    return failures;
+}
+
+int main(int argc, char** argv) {
+
+    // Falling exponential spectrum with 0.1 MeV bins
+    TRandom3 random(1234);
+    TH1D spectrum("scan_spectrum", "", 3000, 0., 0.3);
+    spectrum.SetDirectory(0);
+    for(int i = 0; i < 200000; ++i) { spectrum.Fill(random.Exp(0.03)); }
+
+    std::vector<double> masses{0.06, 0.08, 0.10, 0.12};
+    std::string default_minimizer = ROOT::Math::MinimizerOptions::DefaultMinimizerType();
+
+    // Default configuration: with TMinuit as default, the concurrent scan runs serially
+    BumpHunter hunter(FitFunction::BkgModel::EXP_CHEBYSHEV, 3, 3, 11, 1.56, true);
+    hunter.setBounds(0.02, 0.25);
+    int failures = compareScans(hunter, spectrum, masses, "default minimizer " + default_minimizer);
+
+    // Minuit2 is scanned concurrently
+    hunter.setMinimizer("Minuit2");
+    failures += compareScans(hunter, spectrum, masses, "Minuit2");
+
+    if(ROOT::Math::MinimizerOptions::DefaultMinimizerType() != default_minimizer) {
+        std::cerr << "[ bump-hunter-scan ]: the scan changed the default minimizer from "
+                  << default_minimizer << " to " << ROOT::Math::MinimizerOptions::DefaultMinimizerType()
+                  << std::endl;
+        ++failures;
+    }
+    if(spectrum.GetListOfFunctions()->GetSize() != 0) {
+        std::cerr << "[ bump-hunter-scan ]: the scan attached functions to the histogram" << std::endl;
+        ++failures;
+    }
+
+    std::cout << "[ bump-hunter-scan ]: " << (failures ? "FAILED" : "passed") << std::endl;
+    return failures ? 1 : 0;
+}
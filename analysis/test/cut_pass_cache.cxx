@@ -0,0 +1,107 @@
+/**
+ * @file cut_pass_cache.cxx
+ * @brief Check that CutPassCache selects the same entries as the cut name
+ *        lookups of IterativeCutSelector while the thresholds change and
+ *        after the cuts are filtered.
+ */
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "TFile.h"
+#include "TTree.h"
+
+#include "CutPassCache.h"
+#include "IterativeCutSelector.h"
+#include "SimpAnaTTree.h"
+
+int main(int argc, char** argv) {
+
+    const int nCuts = 8;
+    const int nEntries = 5000;
+
+    // Cuts cut<i>_gt on the variables cut<i>, some entries do not define a variable
+    std::string config = "cut_pass_cache.json";
+    {
+        std::ofstream out(config);
+        out << "{";
+        for (int icut = 0; icut < nCuts; ++icut) {
+            out << (icut ? ", " : "") << "\"cut" << icut << "_gt\": {\"cut\": 0.25, \"id\": " << icut
+                << ", \"info\": \"cut " << icut << "\"}";
+        }
+        out << "}" << std::endl;
+    }
+    std::string path = "cut_pass_cache.root";
+    {
+        std::mt19937_64 rng(12345);
+        std::uniform_real_distribution<double> dist(0., 1.);
+        TFile file(path.c_str(), "RECREATE");
+        TTree tree("cut_tuple", "");
+        std::vector<double> vars(nCuts);
+        for (int icut = 0; icut < nCuts; ++icut)
+            tree.Branch(("cut" + std::to_string(icut)).c_str(), &vars[icut], ("cut" + std::to_string(icut) + "/D").c_str());
+        for (int e = 0; e < nEntries; ++e) {
+            for (auto& var : vars)
+                var = dist(rng) < 0.05 ? -9876543210.0 : dist(rng);
+            tree.Fill();
+        }
+        tree.Write();
+        file.Close();
+    }
+
+    TFile file(path.c_str(), "READ");
+    IterativeCutSelector selector("cut_pass_cache", config);
+    // MutableTTree has no destructor definition, the tuple lives until the end of the job
+    SimpAnaTTree* tuple = new SimpAnaTTree(&file, "cut_tuple");
+    tuple->Fill();
+    selector.LoadSelection();
+    selector.compileCuts();
+    CutPassCache cache(&selector, tuple);
+    std::vector<std::string> names;
+    for (int icut = 0; icut < nCuts; ++icut)
+        names.push_back("cut" + std::to_string(icut) + "_gt");
+
+    auto passNames = [&]() {
+        for (auto& name : names) {
+            std::string var = selector.getCutVar(name);
+            if (tuple->variableExists(var) && !selector.passCutGTorLT(name, tuple->getValue(var)))
+                return false;
+        }
+        return true;
+    };
+
+    // Thresholds move both ways, as the cut which is tightened changes. The
+    // cuts on the first variables are then filtered out, which compiles the
+    // others again with new indices.
+    int nproblems = 0;
+    for (int iteration = 0; iteration < 80 && !nproblems; ++iteration) {
+        if (iteration == 50) {
+            std::vector<std::string> variables;
+            for (int icut = 2; icut < nCuts; ++icut)
+                variables.push_back("cut" + std::to_string(icut));
+            selector.filterCuts(variables);
+            names.erase(names.begin(), names.begin() + 2);
+        }
+        selector.setCutValue(names[iteration % names.size()], 0.02*((iteration*7) % 13));
+        for (int e = 0; e < nEntries; ++e) {
+            bool pass = cache.select(e);
+            tuple->GetEntry(e);
+            if (pass != passNames()) {
+                std::cerr << "[ cut-pass-cache ]: iteration " << iteration << ", entry " << e
+                          << " differs from passCutGTorLT" << std::endl;
+                ++nproblems;
+                break;
+            }
+        }
+    }
+
+    file.Close();
+    std::remove(path.c_str());
+    std::remove(config.c_str());
+    std::cout << "[ cut-pass-cache ]: " << (nproblems ? "FAILED" : "passed") << std::endl;
+    return nproblems ? 1 : 0;
+}
@@ -0,0 +1,67 @@
+/**
+ * @file histo2d_accumulator.cxx
+ * @brief Check that the dense and sparse Histo2DAccumulator fill a channel
+ *        vs ADC map exactly as TH2::Fill.
+ */
+
+#include <iostream>
+#include <random>
+#include <string>
+
+#include "TH1.h"
+#include "TH2F.h"
+
+#include "Histo2DAccumulator.h"
+
+namespace {
+
+    /** @return number of bins or statistics which differ from TH2::Fill */
+    int check(bool sparse) {
+        std::string mode = sparse ? "sparse" : "dense";
+        TH2F histo(("accumulated_" + mode).c_str(), "", 640, -0.5, 639.5, 5000, 0., 20000.);
+        TH2F reference(("reference_" + mode).c_str(), "", 640, -0.5, 639.5, 5000, 0., 20000.);
+        Histo2DAccumulator accumulator(&histo, sparse);
+
+        // Channel and ADC of raw SVT hits around a baseline depending on the
+        // channel, with some entries out of the ADC range and weighted ones
+        std::mt19937_64 rng(12345);
+        std::normal_distribution<float> noise(0., 60.);
+        for (int i = 0; i < 500000; ++i) {
+            int channel = rng() % 640;
+            float adc = (int)(3000. + 5.*(channel % 200) + noise(rng));
+            if (i % 1000 == 0)
+                adc = (i % 2000) ? -10. : 25000.;
+            double weight = (i % 7 == 0) ? 2. : 1.;
+            accumulator.fill(channel, adc, weight);
+            reference.Fill(channel, adc, weight);
+            // Flushing in the middle of the fills must not change the result
+            if (i == 250000)
+                accumulator.flush();
+        }
+        accumulator.flush();
+
+        int nproblems = 0;
+        for (int bin = 0; bin < reference.GetNcells(); ++bin) {
+            if (histo.GetBinContent(bin) != reference.GetBinContent(bin)
+                    || histo.GetBinError(bin) != reference.GetBinError(bin)) {
+                if (nproblems < 10)
+                    std::cerr << "[ histo2d-accumulator ]: " << mode << " bin " << bin << " differs from TH2::Fill"
+                              << std::endl;
+                ++nproblems;
+            }
+        }
+        if (histo.GetEntries() != reference.GetEntries()) {
+            std::cerr << "[ histo2d-accumulator ]: " << mode << " entries differ from TH2::Fill" << std::endl;
+            ++nproblems;
+        }
+        return nproblems;
+    }
+}
+
+int main(int argc, char** argv) {
+
+    TH1::AddDirectory(kFALSE);
+    int nproblems = check(false) + check(true);
+    std::cout << "[ histo2d-accumulator ]: " << (nproblems ? "FAILED" : "passed") << std::endl;
+    return nproblems ? 1 : 0;
+}
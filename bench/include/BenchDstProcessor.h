@@ -0,0 +1,107 @@
+/**
+ * @file BenchDstProcessor.h
+ * @brief Analysis processor used by the end-to-end benchmark.
+ */
+
+#ifndef __BENCH_DST_PROCESSOR_H__
+#define __BENCH_DST_PROCESSOR_H__
+
+//----------------//
+//   C++ StdLib   //
+//----------------//
+#include <memory>
+#include <string>
+#include <vector>
+
+//----------//
+//   ROOT   //
+//----------//
+#include "TBranch.h"
+#include "TTree.h"
+
+//-----------//
+//   hpstr   //
+//-----------//
+#include "BaseSelector.h"
+#include "CalCluster.h"
+#include "FlatTupleMaker.h"
+#include "HistoManager.h"
+#include "Processor.h"
+#include "Track.h"
+#include "TrackerHit.h"
+#include "Vertex.h"
+
+/**
+ * @brief Reads the collections written by bench::EventGenerator::writeDst
+ *
+ * Does the work of a typical analysis processor on every event: reads the
+ * track, vertex, hit and cluster branches, applies track cuts with a
+ * BaseSelector, fills histograms through a HistoManager and fills a flat
+ * vertex tuple, so Process::runOnRoot is measured with realistic I/O and
+ * per-object costs.
+ */
+class BenchDstProcessor : public Processor {
+
+    public:
+
+        /**
+         * @brief Constructor
+         *
+         * @param name
+         * @param process
+         */
+        BenchDstProcessor(const std::string& name, Process& process);
+
+        ~BenchDstProcessor();
+
+        /**
+         * @brief Configure using given parameters.
+         *
+         * @param parameters The parameters used for configuration.
+         */
+        virtual void configure(const ParameterSet& parameters);
+
+        /**
+         * @brief Set the branches and book the histograms
+         *
+         * @param tree
+         */
+        virtual void initialize(TTree* tree);
+
+        /**
+         * @brief Fill the histograms and the tuple
+         *
+         * @param ievent
+         * @return true
+         */
+        virtual bool process(IEvent* ievent);
+
+        /** Write the histograms and the tuple */
+        virtual void finalize();
+
+    private:
+
+        std::string histCfg_{""}; //!< histogram configuration
+        std::string selectionCfg_{""}; //!< track selection
+        std::string trkColl_{"GBLTracks"}; //!< track collection
+        std::string vtxColl_{"UnconstrainedV0Vertices"}; //!< vertex collection
+        std::string hitColl_{"RotatedHelicalTrackHits"}; //!< 3D hit collection
+        std::string ecalColl_{"EcalClustersCorr"}; //!< ECal cluster collection
+        int debug_{0}; //!< debug level
+
+        TTree* tree_{nullptr}; //!< input tree
+        std::vector<Track*>* tracks_{nullptr}; //!< tracks
+        std::vector<Vertex*>* vtxs_{nullptr}; //!< vertices
+        std::vector<TrackerHit*>* hits_{nullptr}; //!< 3D hits
+        std::vector<CalCluster*>* clusters_{nullptr}; //!< ECal clusters
+        TBranch* btracks_{nullptr}; //!< track branch
+        TBranch* bvtxs_{nullptr}; //!< vertex branch
+        TBranch* bhits_{nullptr}; //!< 3D hit branch
+        TBranch* bclusters_{nullptr}; //!< ECal cluster branch
+
+        std::unique_ptr<HistoManager> histos_; //!< histograms
+        std::unique_ptr<BaseSelector> trkSelector_; //!< track selection
+        std::unique_ptr<FlatTupleMaker> tuple_; //!< vertex tuple
+};
+
+#endif // __BENCH_DST_PROCESSOR_H__
@@ -0,0 +1,202 @@
+/**
+ * @file BenchGenerators.h
+ * @brief Synthetic event and histogram generators used by the benchmarks.
+ */
+
+#ifndef __BENCH_GENERATORS_H__
+#define __BENCH_GENERATORS_H__
+
+//----------------//
+//   C++ StdLib   //
+//----------------//
+#include <functional>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+//----------//
+//   LCIO   //
+//----------//
+#include <IMPL/LCCollectionVec.h>
+
+//----------//
+//   ROOT   //
+//----------//
+#include "TH1D.h"
+
+//-----------//
+//   hpstr   //
+//-----------//
+#include "CalCluster.h"
+#include "OutputSettings.h"
+#include "Particle.h"
+#include "Track.h"
+#include "TrackerHit.h"
+#include "Vertex.h"
+#include "VTPData.h"
+
+namespace bench {
+
+    /** Mean multiplicities of the generated events */
+    struct Multiplicity {
+        double tracks{4}; //!< tracks per event
+        double vertices{2}; //!< vertices per event
+        double hits{40}; //!< 3D tracker hits per event
+        double clusters{3}; //!< ECal clusters per event
+    };
+
+    /** LCIO tracks with their GBL kink and track data, as read from a recon file */
+    struct LcioTracks {
+        std::unique_ptr<IMPL::LCCollectionVec> tracks; //!< tracks with track states
+        std::unique_ptr<IMPL::LCCollectionVec> kinkData; //!< GBLKinkData generic objects
+        std::unique_ptr<IMPL::LCCollectionVec> kinkRelations; //!< kink data to track relations
+        std::unique_ptr<IMPL::LCCollectionVec> trackData; //!< TrackData generic objects
+        std::unique_ptr<IMPL::LCCollectionVec> trackDataRelations; //!< track data to track relations
+    };
+
+    /**
+     * @brief Seeded generator of HPS-like event collections
+     *
+     * The objects are filled with values in the ranges seen in 2019 data
+     * (track momenta, angles and impact parameters, vertex positions, hit
+     * times, cluster energies) so the benchmarks exercise the same branches
+     * and histogram bins as real data. The same seed gives the same events,
+     * which keeps the benchmarks comparable between commits.
+     */
+    class EventGenerator {
+
+        public:
+
+            /**
+             * @brief Constructor
+             *
+             * @param seed seed of the random engine
+             */
+            EventGenerator(unsigned long seed = 20190705);
+
+            /** Restart the sequence from a seed */
+            void reseed(unsigned long seed) { rng_.seed(seed); };
+
+            /** @return n tracks, owned by the caller */
+            std::vector<Track*> generateTracks(int n);
+
+            /** @return n vertices, owned by the caller */
+            std::vector<Vertex*> generateVertices(int n);
+
+            /** @return n tracker hits, owned by the caller */
+            std::vector<TrackerHit*> generateTrackerHits(int n);
+
+            /** @return n ECal clusters, owned by the caller */
+            std::vector<CalCluster*> generateCalClusters(int n);
+
+            /**
+             * @brief Generate a particle of each track
+             *
+             * @param tracks tracks of the particles
+             * @param clusters the particle of track i gets cluster i, if any
+             * @return particles, owned by the caller
+             */
+            std::vector<Particle*> generateParticles(const std::vector<Track*>& tracks,
+                    const std::vector<CalCluster*>& clusters);
+
+            /**
+             * @brief Generate LCIO tracks as input of utils::buildTrack
+             *
+             * @param n number of tracks
+             * @return collections, the kink and track data are related to every track
+             */
+            LcioTracks generateLcioTracks(int n);
+
+            /**
+             * @brief Generate the decoded content of a VTP bank
+             *
+             * The block and event headers, the trigger time and the tail
+             * are always set, the records are filled with random values
+             * within the width of their fields.
+             *
+             * @param nClusters number of HPS clusters
+             * @param nTriggers number of records of each trigger subtype
+             * @param vtp generated data, cleared first
+             */
+            void generateVTP(int nClusters, int nTriggers, VTPData& vtp);
+
+            /**
+             * @brief Write a DST with the HPS_Event tree layout read by hpstr
+             *
+             * @param filename output ROOT file
+             * @param nEvents number of events
+             * @param multiplicity mean number of objects per event, Poisson distributed
+             * @param settings compression, basket and flush settings of the file, ROOT defaults if null
+             */
+            void writeDst(const std::string& filename, int nEvents, const Multiplicity& multiplicity = Multiplicity(),
+                    const OutputSettings* settings = nullptr);
+
+            /** @return random number following a Poisson distribution */
+            int poisson(double mean);
+
+            /** @return random engine, e.g. to fill histograms */
+            std::mt19937_64& engine() { return rng_; };
+
+        private:
+
+            double uniform(double low, double high);
+            double gauss(double mean, double sigma);
+
+            std::mt19937_64 rng_; //!< random engine
+    };
+
+    /**
+     * @brief Histogram of an analytic shape
+     *
+     * Each bin is set to the integral of the shape over the bin (Simpson rule),
+     * normalized to nEntries, and fluctuated following a Poisson distribution
+     * if an engine is given, e.g. to get a pseudo-data mass spectrum.
+     *
+     * @param name
+     * @param nBins
+     * @param min
+     * @param max
+     * @param shape density, not necessarily normalized
+     * @param nEntries expected number of entries
+     * @param rng engine used for the fluctuations, Asimov histogram if nullptr
+     * @return TH1D*, owned by the caller and not attached to a directory
+     */
+    TH1D* makeShapeHisto(const std::string& name, int nBins, double min, double max,
+            const std::function<double(double)>& shape, double nEntries, std::mt19937_64* rng = nullptr);
+
+    /**
+     * @brief Falling exponential with a gaussian bump, a simple model of the e+e- mass spectrum
+     *
+     * @param mass [GeV]
+     * @param slope exponential slope [1/GeV]
+     * @param bumpMass mass of the bump [GeV]
+     * @param bumpWidth width of the bump [GeV]
+     * @param bumpFraction fraction of the entries in the bump
+     * @return density
+     */
+    double massShape(double mass, double slope, double bumpMass, double bumpWidth, double bumpFraction);
+
+    /**
+     * @brief Encode VTP data in the words of a VTP bank, the inverse of TriggerDecoder::decodeVTP
+     *
+     * The words are, in order, the block header, the event header, the
+     * trigger time, the clusters, the single, pair, calibration, multiplicity
+     * and FEE triggers, and the block tail.
+     *
+     * @param vtp data to encode
+     * @param words encoded words, cleared first
+     */
+    void encodeVTP(const VTPData& vtp, std::vector<int>& words);
+
+    /** Delete the objects of a collection and clear it */
+    template <class T>
+    void clearCollection(std::vector<T*>& collection) {
+        for (auto object : collection)
+            delete object;
+        collection.clear();
+    }
+
+} // bench
+
+#endif // __BENCH_GENERATORS_H__
@@ -0,0 +1,156 @@
+/**
+ * @file BenchHarness.h
+ * @brief Minimal micro-benchmark harness used by hpstr-bench.
+ */
+
+#ifndef __BENCH_HARNESS_H__
+#define __BENCH_HARNESS_H__
+
+//----------------//
+//   C++ StdLib   //
+//----------------//
+#include <string>
+#include <vector>
+
+namespace bench {
+
+    /**
+     * @brief Timing state handed to a benchmark function
+     *
+     * A benchmark does its setup, then loops with
+     *
+     *     while (state.keepRunning()) { ... }
+     *
+     * The clocks start at the first call of keepRunning() and stop when it
+     * returns false, so the setup and teardown are not measured. Work inside
+     * the loop which should not be measured is bracketed by pauseTiming() and
+     * resumeTiming().
+     */
+    class State {
+
+        public:
+
+            /**
+             * @brief Constructor
+             *
+             * @param iterations number of iterations to run
+             * @param args arguments of the benchmark instance
+             */
+            State(long iterations, const std::vector<long>& args);
+
+            /** @return true while iterations are left */
+            bool keepRunning() {
+                if (__builtin_expect(!started_, false))
+                    startTimers();
+                if (__builtin_expect(remaining_ > 0, true)) {
+                    --remaining_;
+                    return true;
+                }
+                stopTimers();
+                return false;
+            }
+
+            /** Stop the clocks */
+            void pauseTiming();
+
+            /** Restart the clocks */
+            void resumeTiming();
+
+            /** @return argument i of the benchmark instance */
+            long range(unsigned int i = 0) const { return i < args_.size() ? args_[i] : 0; }
+
+            /** @return number of iterations of this run */
+            long iterations() const { return iterations_; }
+
+            /** Set the number of items processed by the run, reported as a rate */
+            void setItemsProcessed(long items) { items_ = items; }
+
+            /** Set a label printed and stored with the result */
+            void setLabel(const std::string& label) { label_ = label; }
+
+            /** Mark the run as failed, e.g. when the setup cannot be done */
+            void skipWithError(const std::string& error);
+
+            double getWallTime() const { return wall_; }
+            double getCpuTime() const { return cpu_; }
+            long getItemsProcessed() const { return items_; }
+            const std::string& getLabel() const { return label_; }
+            const std::string& getError() const { return error_; }
+
+        private:
+
+            void startTimers();
+            void stopTimers();
+
+            long iterations_{0}; //!< iterations of the run
+            long remaining_{0}; //!< iterations left
+            std::vector<long> args_; //!< arguments of the instance
+            bool started_{false}; //!< clocks started once
+            bool running_{false}; //!< clocks currently running
+            double wallStart_{0}; //!< wall clock at the last (re)start [s]
+            double cpuStart_{0}; //!< CPU clock at the last (re)start [s]
+            double wall_{0}; //!< measured wall time [s]
+            double cpu_{0}; //!< measured CPU time [s]
+            long items_{0}; //!< items processed
+            std::string label_; //!< free label
+            std::string error_; //!< error message, empty if the run succeeded
+    };
+
+    /** Benchmark function */
+    typedef void (*Function)(State&);
+
+    /**
+     * @brief Register a benchmark instance, used by the HPSTR_BENCHMARK macros
+     *
+     * @param name function name
+     * @param function
+     * @param args arguments of the instance, appended to the name as /a/b
+     * @return number of registered instances
+     */
+    int registerBenchmark(const std::string& name, Function function, const std::vector<long>& args = {});
+
+    /**
+     * @brief Run the registered benchmarks
+     *
+     * Options:
+     *   --filter REGEX       run the benchmarks whose name matches
+     *   --min-time SECONDS   minimal measured time per benchmark (default 0.5)
+     *   --repetitions N      repeat each benchmark and add mean/median/stddev
+     *   --json FILE          write the results in the Google Benchmark JSON format
+     *   --compare FILE       compare the CPU times with a previous JSON output
+     *   --label TEXT         label stored in the JSON context, e.g. a commit id
+     *   --list               list the benchmarks and exit
+     *
+     * @return exit code
+     */
+    int runBenchmarks(int argc, char** argv);
+
+    /** @return a path in the per-job scratch directory of the benchmarks */
+    std::string scratchPath(const std::string& name);
+
+    /** Prevent the compiler from optimizing away a computed value */
+    template <class T>
+    inline void doNotOptimize(const T& value) {
+        asm volatile("" : : "r,m"(value) : "memory");
+    }
+
+} // bench
+
+#define BENCH_CONCAT_(a, b) a##b
+#define BENCH_CONCAT(a, b) BENCH_CONCAT_(a, b)
+
+/**
+ * @def HPSTR_BENCHMARK(FUNC)
+ * @brief Register a benchmark function without arguments
+ */
+#define HPSTR_BENCHMARK(FUNC) \
+    static int BENCH_CONCAT(bench_registered_, __LINE__) __attribute__((unused)) = bench::registerBenchmark(#FUNC, FUNC)
+
+/**
+ * @def HPSTR_BENCHMARK_ARGS(FUNC, ...)
+ * @brief Register an instance of a benchmark function with the given arguments
+ */
+#define HPSTR_BENCHMARK_ARGS(FUNC, ...) \
+    static int BENCH_CONCAT(bench_registered_, __LINE__) __attribute__((unused)) = bench::registerBenchmark(#FUNC, FUNC, {__VA_ARGS__})
+
+#endif // __BENCH_HARNESS_H__
@@ -0,0 +1,60 @@
+/**
+ * @file BenchUtils.h
+ * @brief Helpers shared by the benchmarks of the hpstr modules.
+ */
+
+#ifndef __BENCH_UTILS_H__
+#define __BENCH_UTILS_H__
+
+//----------------//
+//   C++ StdLib   //
+//----------------//
+#include <iostream>
+#include <string>
+#include <vector>
+
+//----------//
+//   ROOT   //
+//----------//
+#include "TH1.h"
+
+namespace bench {
+
+    /** Silence std::cout in a scope, the formatting is still measured but not the terminal */
+    class QuietStdout {
+        public:
+            QuietStdout();
+            ~QuietStdout() { std::cout.rdbuf(old_); }
+        private:
+            std::streambuf* old_; //!< buffer restored at the end of the scope
+    };
+
+    /** Keep the histograms created in a scope out of the current directory */
+    class DetachedHistos {
+        public:
+            DetachedHistos() : status_(TH1::AddDirectoryStatus()) { TH1::AddDirectory(kFALSE); }
+            ~DetachedHistos() { TH1::AddDirectory(status_); }
+        private:
+            bool status_; //!< add directory status restored at the end of the scope
+    };
+
+    /** Number of precomputed input values, a power of 2 */
+    const int N_VALUES = 1024;
+
+    /** @return N_VALUES values uniformly distributed in [min, max), the same on every call */
+    std::vector<float> uniformValues(double min, double max);
+
+    /** @return size of a file [MB] */
+    double fileSizeMB(const std::string& path);
+
+    /** Delete the objects of a collection and empty it */
+    template <class T>
+    void deleteAll(std::vector<T*>& objects) {
+        for (auto obj : objects)
+            delete obj;
+        objects.clear();
+    }
+
+} // bench
+
+#endif // __BENCH_UTILS_H__
@@ -0,0 +1,416 @@
+/**
+ * @file AnalysisBenchmarks.cxx
+ * @brief Benchmarks of the per-event hot paths of the analysis module.
+ */
+
+//----------------//
+//   C++ StdLib   //
+//----------------//
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+//----------//
+//   ROOT   //
+//----------//
+#include "TFile.h"
+#include "TH1.h"
+#include "TH2F.h"
+#include "TTree.h"
+
+//-----------//
+//   hpstr   //
+//-----------//
+#include "BaseSelector.h"
+#include "BenchGenerators.h"
+#include "BenchHarness.h"
+#include "BenchUtils.h"
+#include "BumpHunter.h"
+#include "CutPassCache.h"
+#include "FlatTupleMaker.h"
+#include "Histo2DAccumulator.h"
+#include "HistoManager.h"
+#include "IterativeCutSelector.h"
+#include "ModuleMapper.h"
+#include "RawSvtHit.h"
+#include "SimpAnaTTree.h"
+#include "Svt2DBlHistos.h"
+
+namespace {
+
+    /** Write a HistoManager configuration with nHistos 1D histograms named var<i>_h */
+    std::string writeHistoConfig(int nHistos) {
+        json config;
+        for (int ihist = 0; ihist < nHistos; ++ihist) {
+            config["var" + std::to_string(ihist) + "_h"] = {
+                {"bins", 100}, {"minX", 0.}, {"maxX", 1.}, {"xtitle", "x"}, {"ytitle", "Events"}};
+        }
+        std::string path = bench::scratchPath("histos_" + std::to_string(nHistos) + ".json");
+        std::ofstream out(path);
+        out << config;
+        return path;
+    }
+
+    /**
+     * Write a Svt2DBlHistos configuration with the histograms of
+     * analysis/plotconfigs/svt/Svt2DBl.json, the ADC axis has 500 bins
+     * instead of 5000 to keep the 72 channel vs ADC maps in memory.
+     */
+    std::string writeSvtBlConfig() {
+        json config;
+        config["SvtHybridsHitN_h"] = {{"bins", 2000}, {"minX", -0.5}, {"maxX", 1999.5},
+            {"xtitle", "# of Strips"}, {"ytitle", "Events"}};
+        config["SvtHitMulti_h"] = {{"bins", 4000}, {"minX", 0}, {"maxX", 4000},
+            {"xtitle", "# of Strips"}, {"ytitle", "Events"}};
+        for (auto sample : {"s0", "s3"}) {
+            config[std::string("SvtHybrids_") + sample + "_hh"] = {{"binsX", 640}, {"minX", -0.5}, {"maxX", 639.5},
+                {"binsY", 500}, {"minY", 0}, {"maxY", 20000}, {"xtitle", "Strip Number"}, {"ytitle", "ADC Value"}};
+        }
+        std::string path = bench::scratchPath("svt_bl2d.json");
+        std::ofstream out(path);
+        out << config;
+        return path;
+    }
+
+    /** Channel and ADC of raw SVT hits, around a baseline which depends on the channel */
+    std::vector<std::pair<float, float>> baselineValues(int n) {
+        std::mt19937_64 rng(12345);
+        std::normal_distribution<float> noise(0., 60.);
+        std::vector<std::pair<float, float>> values(n);
+        for (auto& value : values) {
+            int channel = rng() % 640;
+            value = {(float)channel, (float)(int)(3000. + 5.*(channel % 200) + noise(rng))};
+        }
+        return values;
+    }
+
+    /** Write a selection with nCuts cuts named cut<i>_gt */
+    std::string writeSelectionConfig(int nCuts) {
+        json config;
+        for (int icut = 0; icut < nCuts; ++icut) {
+            config["cut" + std::to_string(icut) + "_gt"] = {
+                {"cut", 0.25}, {"id", icut}, {"info", "cut " + std::to_string(icut)}};
+        }
+        std::string path = bench::scratchPath("selection_" + std::to_string(nCuts) + ".json");
+        std::ofstream out(path);
+        out << config;
+        return path;
+    }
+}
+
+/**
+ * HistoManager::Fill1DHisto on round robin histograms, the argument is the
+ * number of histograms of the manager, which sets the cost of the lookup.
+ */
+static void HistoManager_Fill1DHisto(bench::State& state) {
+    int nHistos = state.range(0);
+    bench::DetachedHistos detached;
+    HistoManager histos("bench");
+    histos.loadHistoConfig(writeHistoConfig(nHistos));
+    histos.DefineHistos();
+    std::vector<std::string> names;
+    for (int ihist = 0; ihist < nHistos; ++ihist)
+        names.push_back("var" + std::to_string(ihist) + "_h");
+    std::vector<float> values = bench::uniformValues(0., 1.);
+
+    long i = 0;
+    while (state.keepRunning()) {
+        histos.Fill1DHisto(names[i % nHistos], values[i & (bench::N_VALUES-1)]);
+        ++i;
+    }
+    state.setItemsProcessed(state.iterations());
+    histos.Clear();
+}
+HPSTR_BENCHMARK_ARGS(HistoManager_Fill1DHisto, 8);
+HPSTR_BENCHMARK_ARGS(HistoManager_Fill1DHisto, 64);
+HPSTR_BENCHMARK_ARGS(HistoManager_Fill1DHisto, 512);
+
+/** BaseSelector::passCutGt on round robin cuts, the argument is the number of cuts */
+static void BaseSelector_passCutGt(bench::State& state) {
+    int nCuts = state.range(0);
+    bench::DetachedHistos detached;
+    BaseSelector selector("bench_selection", writeSelectionConfig(nCuts));
+    selector.LoadSelection();
+    std::vector<std::string> names;
+    for (int icut = 0; icut < nCuts; ++icut)
+        names.push_back("cut" + std::to_string(icut) + "_gt");
+    std::vector<float> values = bench::uniformValues(0., 1.);
+
+    long i = 0;
+    while (state.keepRunning()) {
+        bench::doNotOptimize(selector.passCutGt(names[i % nCuts], values[i & (bench::N_VALUES-1)], 1.));
+        ++i;
+    }
+    state.setItemsProcessed(state.iterations());
+}
+HPSTR_BENCHMARK_ARGS(BaseSelector_passCutGt, 4);
+HPSTR_BENCHMARK_ARGS(BaseSelector_passCutGt, 32);
+
+/**
+ * FlatTupleMaker::fill of a tuple written to a file, the argument is the
+ * number of scalar variables, two vectors of 5 values are filled as well.
+ */
+static void FlatTupleMaker_fill(bench::State& state) {
+    int nVariables = state.range(0);
+    std::string filename = bench::scratchPath("tuple.root");
+    TFile* file = TFile::Open(filename.c_str(), "RECREATE");
+    if (file == nullptr || file->IsZombie()) {
+        state.skipWithError("cannot create " + filename);
+        delete file;
+        return;
+    }
+    std::unique_ptr<FlatTupleMaker> tuple(new FlatTupleMaker("bench_tuple"));
+    std::vector<std::string> names;
+    for (int ivar = 0; ivar < nVariables; ++ivar) {
+        names.push_back("var" + std::to_string(ivar));
+        tuple->addVariable(names.back());
+    }
+    tuple->addVector("vec0");
+    tuple->addVector("vec1");
+    std::vector<float> values = bench::uniformValues(-1., 1.);
+
+    long i = 0;
+    while (state.keepRunning()) {
+        for (int ivar = 0; ivar < nVariables; ++ivar)
+            tuple->setVariableValue(names[ivar], values[(i + ivar) & (bench::N_VALUES-1)]);
+        for (int ival = 0; ival < 5; ++ival) {
+            tuple->addToVector("vec0", values[(i + ival) & (bench::N_VALUES-1)]);
+            tuple->addToVector("vec1", values[(i + 2*ival) & (bench::N_VALUES-1)]);
+        }
+        tuple->fill();
+        ++i;
+    }
+    state.setItemsProcessed(state.iterations());
+
+    file->cd();
+    tuple->writeTree();
+    tuple.reset();
+    file->Close();
+    delete file;
+    std::remove(filename.c_str());
+}
+HPSTR_BENCHMARK_ARGS(FlatTupleMaker_fill, 10);
+HPSTR_BENCHMARK_ARGS(FlatTupleMaker_fill, 50);
+
+/**
+ * BumpHunter::performSearch at 145 MeV on a pseudo-data spectrum, falling
+ * exponential with 0.1 MeV bins, with the settings of bhToys_cfg.py. The
+ * argument skips the upper limit when set.
+ */
+static void BumpHunter_performSearch(bench::State& state) {
+    bool skipUl = state.range(0);
+    bench::DetachedHistos detached;
+    bench::EventGenerator generator;
+    std::unique_ptr<TH1D> spectrum(bench::makeShapeHisto("bench_mass", 3000, 0., 0.3,
+                [](double mass) { return bench::massShape(mass, 20., 0.145, 0.002, 0.); },
+                2e6, &generator.engine()));
+
+    std::unique_ptr<BumpHunter> hunter;
+    {
+        bench::QuietStdout quiet;
+        hunter.reset(new BumpHunter(FitFunction::BkgModel::EXP_CHEBYSHEV, 3, 3, 11, 1.56, true));
+        hunter->setBounds(0.02, 0.25);
+    }
+
+    while (state.keepRunning()) {
+        // The fits are attached to the histogram, start from a clean copy
+        state.pauseTiming();
+        std::unique_ptr<TH1> hist(static_cast<TH1*>(spectrum->Clone("bench_mass_fit")));
+        state.resumeTiming();
+        bench::QuietStdout quiet;
+        HpsFitResult* result = hunter->performSearch(hist.get(), 0.145, false, skipUl);
+        bench::doNotOptimize(result);
+        delete result;
+    }
+    state.setItemsProcessed(state.iterations());
+}
+HPSTR_BENCHMARK_ARGS(BumpHunter_performSearch, 1);
+HPSTR_BENCHMARK_ARGS(BumpHunter_performSearch, 0);
+
+/**
+ * Channel vs ADC fills of a 640 x 5000 bins map: TH2::Fill (0), dense
+ * Histo2DAccumulator (1) or sparse Histo2DAccumulator (2). The label holds
+ * the memory of the counts.
+ */
+static void Histo2DAccumulator_fill(bench::State& state) {
+    int mode = state.range(0);
+    bench::DetachedHistos detached;
+    TH2F histo("bench_map", "", 640, -0.5, 639.5, 5000, 0., 20000.);
+    Histo2DAccumulator accumulator(&histo, mode == 2);
+    const int nValues = 1 << 16;
+    std::vector<std::pair<float, float>> values = baselineValues(nValues);
+
+    long i = 0;
+    while (state.keepRunning()) {
+        const std::pair<float, float>& value = values[i & (nValues-1)];
+        if (mode == 0)
+            histo.Fill(value.first, value.second);
+        else
+            accumulator.fill(value.first, value.second);
+        ++i;
+    }
+    size_t memory = accumulator.getMemory();
+    accumulator.flush();
+    state.setItemsProcessed(state.iterations());
+
+    char label[64];
+    snprintf(label, sizeof(label), "%s, %.1f MB of counts", mode == 0 ? "TH2::Fill" : mode == 1 ? "dense" : "sparse",
+            memory/1.e6);
+    state.setLabel(label);
+}
+HPSTR_BENCHMARK_ARGS(Histo2DAccumulator_fill, 0);
+HPSTR_BENCHMARK_ARGS(Histo2DAccumulator_fill, 1);
+HPSTR_BENCHMARK_ARGS(Histo2DAccumulator_fill, 2);
+
+/**
+ * Svt2DBlHistos::FillHistograms on events of raw SVT hits spread over the
+ * hybrids, the argument is the number of hits per event. The pending
+ * counts are added to the histograms by saveHistos, which is timed once.
+ */
+static void Svt2DBlHistos_FillHistograms(bench::State& state) {
+    int nHits = state.range(0);
+    bench::DetachedHistos detached;
+    ModuleMapper mapper(2019);
+    std::unique_ptr<Svt2DBlHistos> histos;
+    {
+        bench::QuietStdout quiet;
+        histos.reset(new Svt2DBlHistos("bench_bl", &mapper));
+        histos->loadHistoConfig(writeSvtBlConfig());
+        histos->DefineHistos();
+    }
+
+    // Hybrids of the 2019 SVT: modules 0-1 of layers 1-8, 0-3 of layers 9-14
+    std::vector<std::pair<int, int>> hybrids;
+    for (int mod = 0; mod < 4; ++mod)
+        for (int lay = 1; lay < 15; ++lay)
+            if (!(lay < 9 && mod > 1))
+                hybrids.push_back({mod, lay});
+    const int nEvents = 64;
+    std::vector<std::pair<float, float>> values = baselineValues(nEvents*nHits);
+    std::vector<std::vector<RawSvtHit*>> events(nEvents);
+    for (int ievent = 0; ievent < nEvents; ++ievent) {
+        for (int ihit = 0; ihit < nHits; ++ihit) {
+            const std::pair<float, float>& value = values[ievent*nHits + ihit];
+            const std::pair<int, int>& hybrid = hybrids[(ievent*nHits + ihit) % hybrids.size()];
+            RawSvtHit* hit = new RawSvtHit();
+            int adcs[6];
+            for (int ss = 0; ss < 6; ++ss)
+                adcs[ss] = (int)value.second + 10*ss;
+            hit->setADCs(adcs);
+            hit->setModule(hybrid.first);
+            hit->setLayer(hybrid.second);
+            hit->setStrip((int)value.first);
+            events[ievent].push_back(hit);
+        }
+    }
+
+    long i = 0;
+    {
+        bench::QuietStdout quiet;
+        while (state.keepRunning()) {
+            histos->FillHistograms(&events[i % nEvents]);
+            ++i;
+        }
+        std::string out = bench::scratchPath("svt_bl2d.root");
+        TFile file(out.c_str(), "RECREATE");
+        histos->saveHistos(&file, "");
+        file.Close();
+        std::remove(out.c_str());
+    }
+    state.setItemsProcessed(state.iterations()*nHits);
+    for (auto& event : events)
+        bench::deleteAll(event);
+}
+HPSTR_BENCHMARK_ARGS(Svt2DBlHistos_FillHistograms, 100);
+HPSTR_BENCHMARK_ARGS(Svt2DBlHistos_FillHistograms, 1000);
+
+/**
+ * Iterations of SimpZBiOptimizationProcessor over a flat tuple: every
+ * iteration changes the threshold of one cut and selects the entries
+ * passing all the cuts. The argument selects the cut name lookups of
+ * IterativeCutSelector::passCutGTorLT (0) or CutPassCache (1). With the
+ * cache the label holds the fraction of the entries it read.
+ */
+static void IterativeCutSelector_select(bench::State& state) {
+    bool compiled = state.range(0);
+    const int nCuts = 8;
+    const int nEntries = 20000;
+    bench::DetachedHistos detached;
+
+    // Cut variables cut0..cut7 of writeSelectionConfig, some not defined for an entry
+    std::string path = bench::scratchPath("cut_tuple.root");
+    {
+        std::mt19937_64 rng(12345);
+        std::uniform_real_distribution<double> dist(0., 1.);
+        TFile file(path.c_str(), "RECREATE");
+        TTree tree("bench_tuple", "");
+        std::vector<double> vars(nCuts);
+        for (int icut = 0; icut < nCuts; ++icut)
+            tree.Branch(("cut" + std::to_string(icut)).c_str(), &vars[icut], ("cut" + std::to_string(icut) + "/D").c_str());
+        for (int e = 0; e < nEntries; ++e) {
+            for (auto& var : vars)
+                var = dist(rng) < 0.05 ? -9876543210.0 : dist(rng);
+            tree.Fill();
+        }
+        tree.Write();
+        file.Close();
+    }
+
+    TFile file(path.c_str(), "READ");
+    IterativeCutSelector selector("bench_cuts", writeSelectionConfig(nCuts));
+    // MutableTTree has no destructor definition, the tuple lives until the end of the job
+    SimpAnaTTree* tuple{nullptr};
+    {
+        bench::QuietStdout quiet;
+        tuple = new SimpAnaTTree(&file, "bench_tuple");
+        tuple->Fill();
+        selector.LoadSelection();
+    }
+    selector.compileCuts();
+    CutPassCache cache(&selector, tuple);
+    std::vector<std::string> names;
+    for (int icut = 0; icut < nCuts; ++icut)
+        names.push_back("cut" + std::to_string(icut) + "_gt");
+
+    auto passNames = [&]() {
+        for (auto& name : names) {
+            std::string var = selector.getCutVar(name);
+            if (tuple->variableExists(var) && !selector.passCutGTorLT(name, tuple->getValue(var)))
+                return false;
+        }
+        return true;
+    };
+
+    long i = 0;
+    long selected = 0;
+    while (state.keepRunning()) {
+        // Thresholds move both ways, as the cut which is tightened changes
+        selector.setCutValue(names[i % nCuts], 0.02*((i*7) % 13));
+        for (int e = 0; e < nEntries; ++e) {
+            if (compiled) {
+                selected += cache.select(e);
+            } else {
+                tuple->GetEntry(e);
+                selected += passNames();
+            }
+        }
+        ++i;
+    }
+    bench::doNotOptimize(selected);
+    state.setItemsProcessed(state.iterations()*nEntries);
+
+    if (compiled) {
+        char label[64];
+        snprintf(label, sizeof(label), "%.0f%% of the entries read",
+                100.*cache.getReads()/(state.iterations()*nEntries));
+        state.setLabel(label);
+    }
+    file.Close();
+    std::remove(path.c_str());
+}
+HPSTR_BENCHMARK_ARGS(IterativeCutSelector_select, 0);
+HPSTR_BENCHMARK_ARGS(IterativeCutSelector_select, 1);
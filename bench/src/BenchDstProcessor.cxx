@@ -0,0 +1,124 @@
+/**
+ * @file BenchDstProcessor.cxx
+ * @brief Analysis processor used by the end-to-end benchmark.
+ */
+
+#include "BenchDstProcessor.h"
+
+#include <iostream>
+#include <stdexcept>
+
+BenchDstProcessor::BenchDstProcessor(const std::string& name, Process& process) : Processor(name, process) {
+}
+
+BenchDstProcessor::~BenchDstProcessor() {
+}
+
+void BenchDstProcessor::configure(const ParameterSet& parameters) {
+
+    std::cout << "Configuring BenchDstProcessor" << std::endl;
+    try
+    {
+        debug_        = parameters.getInteger("debug", debug_);
+        histCfg_      = parameters.getString("histCfg", histCfg_);
+        selectionCfg_ = parameters.getString("selectionCfg", selectionCfg_);
+        trkColl_      = parameters.getString("trkColl", trkColl_);
+        vtxColl_      = parameters.getString("vtxColl", vtxColl_);
+        hitColl_      = parameters.getString("hitColl", hitColl_);
+        ecalColl_     = parameters.getString("ecalColl", ecalColl_);
+    }
+    catch (std::runtime_error& error)
+    {
+        std::cout << error.what() << std::endl;
+    }
+}
+
+void BenchDstProcessor::initialize(TTree* tree) {
+    tree_ = tree;
+
+    histos_.reset(new HistoManager(name_));
+    histos_->loadHistoConfig(histCfg_);
+    histos_->DefineHistos();
+
+    if (!selectionCfg_.empty()) {
+        trkSelector_.reset(new BaseSelector(name_ + "_trkSelection", selectionCfg_));
+        trkSelector_->setDebug(debug_);
+        trkSelector_->LoadSelection();
+    }
+
+    // Created in the output file, which is the current directory
+    tuple_.reset(new FlatTupleMaker(name_ + "_tree"));
+    tuple_->addVariable("vtx_z");
+    tuple_->addVariable("vtx_chi2");
+    tuple_->addVariable("n_tracks");
+    tuple_->addVariable("n_hits");
+    tuple_->addVector("trk_p");
+
+    tree_->SetBranchAddress(trkColl_.c_str(), &tracks_, &btracks_);
+    tree_->SetBranchAddress(vtxColl_.c_str(), &vtxs_, &bvtxs_);
+    tree_->SetBranchAddress(hitColl_.c_str(), &hits_, &bhits_);
+    tree_->SetBranchAddress(ecalColl_.c_str(), &clusters_, &bclusters_);
+}
+
+bool BenchDstProcessor::process(IEvent* ievent) {
+
+    histos_->Fill1DHisto("n_tracks_h", tracks_->size());
+    histos_->Fill1DHisto("n_hits_h", hits_->size());
+
+    for (auto track : *tracks_) {
+        if (trkSelector_) {
+            trkSelector_->clearSelector();
+            if (!trkSelector_->passCutLt("chi2ndf_lt", track->getChi2Ndf(), 1.))
+                continue;
+            if (!trkSelector_->passCutGt("p_gt", track->getP(), 1.))
+                continue;
+        }
+        histos_->Fill1DHisto("trk_p_h", track->getP());
+        histos_->Fill1DHisto("trk_d0_h", track->getD0());
+        histos_->Fill1DHisto("trk_z0_h", track->getZ0());
+        histos_->Fill1DHisto("trk_tanLambda_h", track->getTanLambda());
+        histos_->Fill1DHisto("trk_chi2ndf_h", track->getChi2Ndf());
+        histos_->Fill1DHisto("trk_time_h", track->getTrackTime());
+        tuple_->addToVector("trk_p", track->getP());
+    }
+
+    for (auto hit : *hits_)
+        histos_->Fill1DHisto("hit_time_h", hit->getTime());
+
+    for (auto cluster : *clusters_) {
+        histos_->Fill1DHisto("clu_energy_h", cluster->getEnergy());
+        histos_->Fill1DHisto("clu_time_h", cluster->getTime());
+    }
+
+    for (auto vtx : *vtxs_) {
+        histos_->Fill1DHisto("vtx_z_h", vtx->getZ());
+        histos_->Fill1DHisto("vtx_chi2_h", vtx->getChi2());
+    }
+
+    if (!vtxs_->empty()) {
+        tuple_->setVariableValue("vtx_z", vtxs_->at(0)->getZ());
+        tuple_->setVariableValue("vtx_chi2", vtxs_->at(0)->getChi2());
+    }
+    tuple_->setVariableValue("n_tracks", tracks_->size());
+    tuple_->setVariableValue("n_hits", hits_->size());
+    tuple_->fill();
+
+    return true;
+}
+
+void BenchDstProcessor::finalize() {
+
+    histos_->saveHistos(outF_, histos_->getName());
+    outF_->cd();
+    // Delete the tuple before the output file is closed, which deletes its tree otherwise
+    tuple_->writeTree();
+    tuple_.reset();
+    if (trkSelector_) {
+        outF_->cd();
+        trkSelector_->getCutFlowHisto()->Write();
+        trkSelector_.reset();
+    }
+    histos_.reset();
+}
+
+DECLARE_PROCESSOR(BenchDstProcessor);
@@ -0,0 +1,460 @@
+/**
+ * @file BenchGenerators.cxx
+ * @brief Synthetic event and histogram generators used by the benchmarks.
+ */
+
+#include "BenchGenerators.h"
+
+//----------------//
+//   C++ StdLib   //
+//----------------//
+#include <cmath>
+#include <iostream>
+
+//----------//
+//   LCIO   //
+//----------//
+#include <EVENT/LCIO.h>
+#include <IMPL/LCGenericObjectImpl.h>
+#include <IMPL/LCRelationImpl.h>
+#include <IMPL/TrackImpl.h>
+#include <IMPL/TrackStateImpl.h>
+
+//----------//
+//   ROOT   //
+//----------//
+#include "TFile.h"
+#include "TTree.h"
+
+//-----------//
+//   hpstr   //
+//-----------//
+#include "Collections.h"
+#include "EventHeader.h"
+
+namespace {
+    /** Number of SVT layers of the 2019 detector */
+    const int N_LAYERS = 14;
+
+    /** Header bit and type of a VTP word */
+    int vtpType(int type) { return static_cast<int>(0x80000000u | (static_cast<unsigned int>(type) << 27)); }
+
+    /** Header bit, type and subtype of a VTP expansion word */
+    int vtpExpansion(int subtype) { return vtpType(12) | (subtype << 23); }
+}
+
+namespace bench {
+
+    EventGenerator::EventGenerator(unsigned long seed) : rng_(seed) {
+    }
+
+    double EventGenerator::uniform(double low, double high) {
+        return std::uniform_real_distribution<double>(low, high)(rng_);
+    }
+
+    double EventGenerator::gauss(double mean, double sigma) {
+        return std::normal_distribution<double>(mean, sigma)(rng_);
+    }
+
+    int EventGenerator::poisson(double mean) {
+        return mean > 0 ? std::poisson_distribution<int>(mean)(rng_) : 0;
+    }
+
+    std::vector<Track*> EventGenerator::generateTracks(int n) {
+        std::vector<Track*> tracks;
+        tracks.reserve(n);
+        for (int itrk = 0; itrk < n; ++itrk) {
+            Track* track = new Track();
+            int charge = uniform(0, 1) < 0.5 ? -1 : 1;
+            double p = uniform(0.3, 3.5);
+            double tanLambda = (uniform(0, 1) < 0.5 ? -1 : 1)*uniform(0.015, 0.08);
+            double phi = gauss(0., 0.05);
+            double pt = p/std::sqrt(1 + tanLambda*tanLambda);
+            // omega = charge*c*B/pt with B = 0.52 T, in 1/mm
+            double omega = -charge*2.99792458e-4*0.52/pt;
+            track->setTrackParameters(gauss(0., 0.3), phi, omega, tanLambda, gauss(0., 0.3));
+            std::vector<float> cov(15, 0.);
+            for (int i = 0, diag = 0; i < 5; diag += i + 2, ++i)
+                cov[diag] = 1e-4*(1 + uniform(0, 1));
+            track->setCov(cov);
+            track->setChi2(std::fabs(gauss(0., 1.))*10 + 2);
+            int nHits = 10 + (int)uniform(0, 5);
+            track->setNdf(2*nHits - 5);
+            track->setTrackerHitCount(nHits);
+            for (int layer = N_LAYERS - nHits; layer < N_LAYERS; ++layer)
+                track->addHitLayer(layer);
+            track->setTrackTime(gauss(0., 2.));
+            track->setCharge(charge);
+            track->setType(1);
+            track->setID(itrk);
+            track->setTrackVolume(tanLambda > 0 ? 0 : 1);
+            track->setMomentum(pt*std::sin(phi), p*tanLambda/std::sqrt(1 + tanLambda*tanLambda), pt*std::cos(phi));
+            double atEcal[3] = {gauss(0., 150.), tanLambda*1400., 1394.};
+            track->setPositionAtEcal(atEcal);
+            for (int layer = 0; layer < N_LAYERS; ++layer) {
+                track->setLambdaKink(layer, gauss(0., 1e-3));
+                track->setPhiKink(layer, gauss(0., 1e-3));
+            }
+            tracks.push_back(track);
+        }
+        return tracks;
+    }
+
+    std::vector<Vertex*> EventGenerator::generateVertices(int n) {
+        std::vector<Vertex*> vertices;
+        vertices.reserve(n);
+        for (int ivtx = 0; ivtx < n; ++ivtx) {
+            Vertex* vertex = new Vertex();
+            // Prompt vertices at the target with an exponential tail of displaced ones
+            double z = -4.3 + (uniform(0, 1) < 0.9 ? gauss(0., 1.5) : -std::log(uniform(1e-9, 1))*10.);
+            vertex->setPos(TVector3(gauss(0., 0.2), gauss(0., 0.1), z));
+            vertex->setChi2(std::fabs(gauss(0., 1.))*5);
+            vertex->setNdf(1);
+            vertex->setProbability(uniform(0, 1));
+            vertex->setCovariance({0.01f, 0.f, 0.0025f, 0.f, 0.f, 2.25f});
+            vertex->setType("Unconstrained");
+            vertex->setID(ivtx);
+            vertices.push_back(vertex);
+        }
+        return vertices;
+    }
+
+    std::vector<TrackerHit*> EventGenerator::generateTrackerHits(int n) {
+        std::vector<TrackerHit*> hits;
+        hits.reserve(n);
+        for (int ihit = 0; ihit < n; ++ihit) {
+            TrackerHit* hit = new TrackerHit();
+            int layer = (int)uniform(0, N_LAYERS);
+            int volume = uniform(0, 1) < 0.5 ? 0 : 1;
+            // LCIO order (z, x, y), rotated to the SVT frame by setPosition
+            double position[3] = {50. + 50.*layer + gauss(0., 2.), gauss(0., 20.), (volume ? -1 : 1)*uniform(0.5, 40.)};
+            hit->setPosition(position);
+            hit->setCovarianceMatrix({1e-4f, 0.f, 0.f, 1e-2f, 0.f, 1e-6f});
+            hit->setTime(gauss(0., 4.));
+            hit->setCharge(std::fabs(gauss(1500., 500.)));
+            hit->setVolume(volume);
+            hit->setLayer(layer + 1);
+            hit->setID(ihit);
+            int strip = (int)uniform(0, 638);
+            hit->setRawHitStripNumbers({strip, strip + 1});
+            hits.push_back(hit);
+        }
+        return hits;
+    }
+
+    std::vector<CalCluster*> EventGenerator::generateCalClusters(int n) {
+        std::vector<CalCluster*> clusters;
+        clusters.reserve(n);
+        for (int iclu = 0; iclu < n; ++iclu) {
+            CalCluster* cluster = new CalCluster();
+            float position[3] = {(float)uniform(-270., 350.), (float)((uniform(0, 1) < 0.5 ? -1 : 1)*uniform(25., 85.)), 1443.f};
+            cluster->setPosition(position);
+            cluster->setEnergy(std::fabs(gauss(1.2, 0.8)));
+            cluster->setTime(gauss(40., 2.));
+            clusters.push_back(cluster);
+        }
+        return clusters;
+    }
+
+    std::vector<Particle*> EventGenerator::generateParticles(const std::vector<Track*>& tracks,
+            const std::vector<CalCluster*>& clusters) {
+        std::vector<Particle*> particles;
+        particles.reserve(tracks.size());
+        for (unsigned int ipart = 0; ipart < tracks.size(); ++ipart) {
+            Particle* particle = new Particle();
+            Track* track = tracks[ipart];
+            particle->setTrack(track);
+            if (ipart < clusters.size()) {
+                particle->setCluster(clusters[ipart]);
+                particle->setEnergy(clusters[ipart]->getEnergy());
+            }
+            std::vector<double> p = track->getMomentum();
+            double momentum[3] = {p[0], p[1], p[2]};
+            particle->setMomentum(momentum);
+            particle->setCorrMomentum(momentum);
+            particle->setCharge(track->getCharge());
+            particle->setPDG(track->getCharge() < 0 ? 11 : -11);
+            particle->setType(1);
+            particle->setGoodnessOfPID(uniform(0, 10));
+            particle->setMass(0.000511);
+            particles.push_back(particle);
+        }
+        return particles;
+    }
+
+    LcioTracks EventGenerator::generateLcioTracks(int n) {
+        LcioTracks lcio;
+        lcio.tracks.reset(new IMPL::LCCollectionVec(EVENT::LCIO::TRACK));
+        lcio.kinkData.reset(new IMPL::LCCollectionVec(EVENT::LCIO::LCGENERICOBJECT));
+        lcio.kinkRelations.reset(new IMPL::LCCollectionVec(EVENT::LCIO::LCRELATION));
+        lcio.trackData.reset(new IMPL::LCCollectionVec(EVENT::LCIO::LCGENERICOBJECT));
+        lcio.trackDataRelations.reset(new IMPL::LCCollectionVec(EVENT::LCIO::LCRELATION));
+        for (auto relations : {lcio.kinkRelations.get(), lcio.trackDataRelations.get()}) {
+            relations->parameters().setValue("FromType", EVENT::LCIO::LCGENERICOBJECT);
+            relations->parameters().setValue("ToType", EVENT::LCIO::TRACK);
+        }
+
+        std::vector<Track*> tracks = generateTracks(n);
+        for (auto track : tracks) {
+            IMPL::TrackImpl* lcTrack = new IMPL::TrackImpl();
+            lcTrack->setTypeBit(track->getType());
+            lcTrack->setChi2(track->getChi2());
+            lcTrack->setNdf(track->getNdf());
+
+            std::vector<float> cov = track->getCov();
+            std::vector<double> atEcal = track->getPositionAtEcal();
+            float refAtIP[3] = {0., 0., 0.};
+            float refAtTarget[3] = {-4.3f, (float)track->getD0(), (float)track->getZ0()};
+            float refAtEcal[3] = {(float)atEcal[2], (float)atEcal[0], (float)atEcal[1]};
+            // The first track state is the one returned by the TrackImpl getters
+            lcTrack->addTrackState(new IMPL::TrackStateImpl(EVENT::TrackState::AtIP,
+                        track->getD0(), track->getPhi(), track->getOmega(), track->getZ0(), track->getTanLambda(),
+                        cov, refAtIP));
+            lcTrack->addTrackState(new IMPL::TrackStateImpl(EVENT::TrackState::LastLocation,
+                        track->getD0(), track->getPhi(), track->getOmega(), track->getZ0(), track->getTanLambda(),
+                        cov, refAtTarget));
+            lcTrack->addTrackState(new IMPL::TrackStateImpl(EVENT::TrackState::AtCalorimeter,
+                        0., track->getPhi(), track->getOmega(), 0., track->getTanLambda(),
+                        cov, refAtEcal));
+            lcio.tracks->addElement(lcTrack);
+
+            IMPL::LCGenericObjectImpl* kinks = new IMPL::LCGenericObjectImpl(0, N_LAYERS, N_LAYERS);
+            for (int layer = 0; layer < N_LAYERS; ++layer) {
+                kinks->setFloatVal(layer, track->getLambdaKink(layer));
+                kinks->setDoubleVal(layer, track->getPhiKink(layer));
+            }
+            lcio.kinkData->addElement(kinks);
+            lcio.kinkRelations->addElement(new IMPL::LCRelationImpl(kinks, lcTrack));
+
+            // Isolations, time, momentum and the field at the IP, target and ECal
+            IMPL::LCGenericObjectImpl* data = new IMPL::LCGenericObjectImpl(1, 7, N_LAYERS);
+            data->setIntVal(0, track->isTopTrack() ? 0 : 1);
+            data->setFloatVal(0, track->getTrackTime());
+            std::vector<double> momentum = track->getMomentum();
+            for (int i = 0; i < 3; ++i)
+                data->setFloatVal(i + 1, momentum[i]);
+            data->setFloatVal(4, -0.52);
+            data->setFloatVal(5, -0.52);
+            data->setFloatVal(6, -0.3);
+            for (int layer = 0; layer < N_LAYERS; ++layer)
+                data->setDoubleVal(layer, std::fabs(gauss(0., 1.)));
+            lcio.trackData->addElement(data);
+            lcio.trackDataRelations->addElement(new IMPL::LCRelationImpl(data, lcTrack));
+        }
+        clearCollection(tracks);
+        return lcio;
+    }
+
+    void EventGenerator::generateVTP(int nClusters, int nTriggers, VTPData& vtp) {
+        vtp.Clear();
+        auto bits = [this](int n) { return static_cast<unsigned int>(rng_() & ((1ul << n) - 1)); };
+
+        vtp.blockHeader = {bits(8), bits(10), bits(4), bits(5), 0, true};
+        // The decoder reads 8 bits for the 4 unused bits, the low bits of the slot id included
+        vtp.blockHeader.nothing |= (vtp.blockHeader.slotid & 0xF) << 4;
+        vtp.eventHeader = {bits(27), 2, true};
+        vtp.trigTime = (static_cast<unsigned long>(bits(24)) << 24) + bits(24);
+        vtp.blockTail = {bits(22), bits(5), 1, true};
+
+        for (int iclu = 0; iclu < nClusters; ++iclu) {
+            VTPData::hpsCluster clus;
+            // Crystal indices, signed on 6 and 4 bits
+            clus.X = static_cast<int>(bits(6)) - 32;
+            clus.Y = static_cast<int>(bits(4)) - 8;
+            clus.E = bits(13);
+            clus.subtype = 2;
+            clus.type = 12;
+            clus.istype = true;
+            clus.T = bits(10);
+            clus.N = bits(4);
+            clus.nothing = bits(18);
+            vtp.clusters.push_back(clus);
+        }
+
+        for (int itrig = 0; itrig < nTriggers; ++itrig) {
+            VTPData::hpsSingleTrig strig;
+            strig.T = bits(10);
+            strig.emin = bits(1);
+            strig.emax = bits(1);
+            strig.nmin = bits(1);
+            strig.xmin = bits(1);
+            strig.pose = bits(1);
+            strig.hodo1c = bits(1);
+            strig.hodo2c = bits(1);
+            strig.hodogeo = bits(1);
+            strig.hodoecal = bits(1);
+            strig.topnbot = bits(1);
+            strig.inst = bits(3);
+            strig.subtype = 3;
+            strig.type = 12;
+            strig.istype = true;
+            vtp.singletrigs.push_back(strig);
+
+            VTPData::hpsPairTrig ptrig;
+            ptrig.T = bits(10);
+            ptrig.clusesum = bits(1);
+            ptrig.clusedif = bits(1);
+            ptrig.eslope = bits(1);
+            ptrig.coplane = bits(1);
+            ptrig.dummy = bits(5);
+            ptrig.topnbot = bits(1);
+            ptrig.inst = bits(3);
+            ptrig.subtype = 4;
+            ptrig.type = 12;
+            ptrig.istype = true;
+            vtp.pairtrigs.push_back(ptrig);
+
+            VTPData::hpsCalibTrig ctrig;
+            ctrig.T = bits(10);
+            ctrig.reserved = bits(9);
+            ctrig.cosmicTrig = bits(1);
+            ctrig.LEDTrig = bits(1);
+            ctrig.hodoTrig = bits(1);
+            ctrig.pulserTrig = bits(1);
+            ctrig.subtype = 5;
+            ctrig.type = 12;
+            ctrig.istype = true;
+            vtp.calibtrigs.push_back(ctrig);
+
+            VTPData::hpsClusterMult clmul;
+            clmul.T = bits(10);
+            clmul.multtop = bits(4);
+            clmul.multbot = bits(4);
+            clmul.multtot = bits(4);
+            clmul.bitinst = bits(1);
+            clmul.subtype = 6;
+            clmul.type = 12;
+            clmul.istype = true;
+            vtp.clustermult.push_back(clmul);
+
+            VTPData::hpsFEETrig fee;
+            fee.T = bits(10);
+            fee.region = bits(7);
+            fee.reserved = bits(6);
+            fee.subtype = 7;
+            fee.type = 12;
+            fee.istype = true;
+            vtp.feetrigger.push_back(fee);
+        }
+    }
+
+    void EventGenerator::writeDst(const std::string& filename, int nEvents, const Multiplicity& multiplicity,
+            const OutputSettings* settings) {
+        TFile* file = TFile::Open(filename.c_str(), "RECREATE");
+        if (file == nullptr || file->IsZombie()) {
+            std::cerr << "[ EventGenerator ]: ERROR: cannot create " << filename << std::endl;
+            delete file;
+            return;
+        }
+        if (settings)
+            settings->applyToFile(file);
+        TTree* tree = new TTree("HPS_Event", "HPS event tree");
+        EventHeader* header = new EventHeader();
+        std::vector<Track*> tracks;
+        std::vector<Vertex*> vertices;
+        std::vector<TrackerHit*> hits;
+        std::vector<CalCluster*> clusters;
+        tree->Branch(Collections::EVENT_HEADERS, &header);
+        tree->Branch(Collections::GBL_TRACKS, &tracks);
+        tree->Branch(Collections::UC_V0VERTICES, &vertices);
+        tree->Branch(Collections::TRACKER_HITS, &hits);
+        tree->Branch(Collections::ECAL_CLUSTERS, &clusters);
+        if (settings)
+            settings->applyToTree(tree, filename);
+
+        for (int ievent = 0; ievent < nEvents; ++ievent) {
+            header->setRunNumber(10031);
+            header->setEventNumber(ievent);
+            header->setEventTime(1562300000000000000L + 2000L*ievent);
+            tracks = generateTracks(poisson(multiplicity.tracks));
+            vertices = generateVertices(poisson(multiplicity.vertices));
+            hits = generateTrackerHits(poisson(multiplicity.hits));
+            clusters = generateCalClusters(poisson(multiplicity.clusters));
+            tree->Fill();
+            clearCollection(tracks);
+            clearCollection(vertices);
+            clearCollection(hits);
+            clearCollection(clusters);
+        }
+        file->cd();
+        tree->Write();
+        file->Close();
+        delete file;
+        delete header;
+    }
+
+    TH1D* makeShapeHisto(const std::string& name, int nBins, double min, double max,
+            const std::function<double(double)>& shape, double nEntries, std::mt19937_64* rng) {
+        bool addDirectory = TH1::AddDirectoryStatus();
+        TH1::AddDirectory(kFALSE);
+        TH1D* hist = new TH1D(name.c_str(), name.c_str(), nBins, min, max);
+        TH1::AddDirectory(addDirectory);
+
+        std::vector<double> integrals(nBins);
+        double total = 0;
+        double width = (max - min)/nBins;
+        for (int ibin = 0; ibin < nBins; ++ibin) {
+            double low = min + ibin*width;
+            integrals[ibin] = width/6.*(shape(low) + 4*shape(low + 0.5*width) + shape(low + width));
+            total += integrals[ibin];
+        }
+        if (total <= 0)
+            return hist;
+        for (int ibin = 0; ibin < nBins; ++ibin) {
+            double expected = nEntries*integrals[ibin]/total;
+            double content = expected;
+            if (rng && expected > 0)
+                content = std::poisson_distribution<long>(expected)(*rng);
+            hist->SetBinContent(ibin + 1, content);
+            hist->SetBinError(ibin + 1, std::sqrt(content));
+        }
+        hist->SetEntries(hist->Integral());
+        return hist;
+    }
+
+    double massShape(double mass, double slope, double bumpMass, double bumpWidth, double bumpFraction) {
+        double background = slope*std::exp(-slope*mass);
+        double bump = std::exp(-0.5*std::pow((mass - bumpMass)/bumpWidth, 2))/(std::sqrt(2*M_PI)*bumpWidth);
+        return (1 - bumpFraction)*background + bumpFraction*bump;
+    }
+
+    void encodeVTP(const VTPData& vtp, std::vector<int>& words) {
+        words.clear();
+
+        const VTPData::bHeader& header = vtp.blockHeader;
+        words.push_back(vtpType(0) | header.blocklevel | (header.blocknum << 8)
+                | ((header.nothing & 0xF) << 18) | (header.slotid << 22));
+        words.push_back(vtpType(2) | vtp.eventHeader.eventnum);
+        words.push_back(vtpType(3) | (vtp.trigTime & 0xFFFFFF));
+        words.push_back((vtp.trigTime >> 24) & 0xFFFFFF);
+
+        for (auto& clus : vtp.clusters) {
+            words.push_back(vtpExpansion(2) | (clus.X & 0x3F) | ((clus.Y & 0xF) << 6) | (clus.E << 10));
+            words.push_back(clus.T | (clus.N << 10) | (clus.nothing << 14));
+        }
+        for (auto& strig : vtp.singletrigs) {
+            words.push_back(vtpExpansion(3) | strig.T | (strig.emin << 10) | (strig.emax << 11)
+                    | (strig.nmin << 12) | (strig.xmin << 13) | (strig.pose << 14) | (strig.hodo1c << 15)
+                    | (strig.hodo2c << 16) | (strig.hodogeo << 17) | (strig.hodoecal << 18)
+                    | (strig.topnbot << 19) | (strig.inst << 20));
+        }
+        for (auto& ptrig : vtp.pairtrigs) {
+            words.push_back(vtpExpansion(4) | ptrig.T | (ptrig.clusesum << 10) | (ptrig.clusedif << 11)
+                    | (ptrig.eslope << 12) | (ptrig.coplane << 13) | (ptrig.dummy << 14)
+                    | (ptrig.topnbot << 19) | (ptrig.inst << 20));
+        }
+        for (auto& ctrig : vtp.calibtrigs) {
+            words.push_back(vtpExpansion(5) | ctrig.T | (ctrig.reserved << 10) | (ctrig.cosmicTrig << 19)
+                    | (ctrig.LEDTrig << 20) | (ctrig.hodoTrig << 21) | (ctrig.pulserTrig << 22));
+        }
+        for (auto& clmul : vtp.clustermult) {
+            words.push_back(vtpExpansion(6) | clmul.T | (clmul.multtop << 10) | (clmul.multbot << 14)
+                    | (clmul.multtot << 18) | (clmul.bitinst << 22));
+        }
+        for (auto& fee : vtp.feetrigger)
+            words.push_back(vtpExpansion(7) | fee.T | (fee.region << 10) | (fee.reserved << 17));
+
+        words.push_back(vtpType(1) | vtp.blockTail.nwords | (vtp.blockTail.slotid << 22));
+    }
+
+} // bench
@@ -0,0 +1,506 @@
+/**
+ * @file BenchHarness.cxx
+ * @brief Minimal micro-benchmark harness used by hpstr-bench.
+ */
+
+#include "BenchHarness.h"
+
+//----------------//
+//   C++ StdLib   //
+//----------------//
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <regex>
+#include <sstream>
+#include <thread>
+
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+//-----------//
+//   hpstr   //
+//-----------//
+#include "json.hpp"
+
+using json = nlohmann::json;
+
+namespace {
+
+    /** Registered benchmark instance */
+    struct Entry {
+        std::string name; //!< full name, function/arg0/arg1
+        bench::Function function; //!< benchmark function
+        std::vector<long> args; //!< arguments
+    };
+
+    /** Result of a run, or aggregate of the repetitions */
+    struct Result {
+        std::string name; //!< name of the entry, with the aggregate suffix if any
+        std::string runName; //!< name of the entry
+        std::string aggregate; //!< empty for a single run, else mean, median or stddev
+        int repetitions{1}; //!< number of repetitions
+        int repetitionIndex{0}; //!< index of the run
+        long iterations{0}; //!< iterations of the run
+        double realTime{0}; //!< wall time per iteration [ns]
+        double cpuTime{0}; //!< CPU time per iteration [ns]
+        double itemsPerSecond{0}; //!< processed items per CPU second, 0 if not set
+        std::string label; //!< label of the run
+        std::string error; //!< error message
+    };
+
+    /** Iterations are capped, whatever the minimal time */
+    const long MAX_ITERATIONS = 1000000000L;
+
+    std::vector<Entry>& registry() {
+        static std::vector<Entry> entries;
+        return entries;
+    }
+
+    std::string& scratchDir() {
+        static std::string dir;
+        return dir;
+    }
+
+    double wallNow() {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    double cpuNow() {
+        timespec ts;
+        clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+        return ts.tv_sec + 1e-9*ts.tv_nsec;
+    }
+
+    /** Run a benchmark instance for a given number of iterations */
+    bench::State runOnce(const Entry& entry, long iterations) {
+        bench::State state(iterations, entry.args);
+        entry.function(state);
+        return state;
+    }
+
+    Result makeResult(const Entry& entry, const bench::State& state) {
+        Result result;
+        result.name = entry.name;
+        result.runName = entry.name;
+        result.iterations = state.iterations();
+        result.label = state.getLabel();
+        result.error = state.getError();
+        if (state.iterations() > 0) {
+            result.realTime = 1e9*state.getWallTime()/state.iterations();
+            result.cpuTime = 1e9*state.getCpuTime()/state.iterations();
+        }
+        if (state.getItemsProcessed() > 0 && state.getCpuTime() > 0)
+            result.itemsPerSecond = state.getItemsProcessed()/state.getCpuTime();
+        return result;
+    }
+
+    /**
+     * Find the number of iterations needed to reach the minimal time. The
+     * iterations are increased by 10 while the runs are too short to be
+     * trusted, then extrapolated from the last run with a 40% margin.
+     */
+    bench::State calibrate(const Entry& entry, double minTime) {
+        long iterations = 1;
+        while (true) {
+            bench::State state = runOnce(entry, iterations);
+            double seconds = std::max(state.getCpuTime(), state.getWallTime());
+            if (!state.getError().empty() || seconds >= minTime || iterations >= MAX_ITERATIONS)
+                return state;
+            double multiplier = seconds/minTime > 0.1 ? 1.4*minTime/std::max(seconds, 1e-9) : 10.;
+            long next = std::max((long)(multiplier*iterations), iterations + 1);
+            iterations = std::min(next, MAX_ITERATIONS);
+        }
+    }
+
+    /** Mean, median and standard deviation of the repetitions */
+    std::vector<Result> aggregate(const std::vector<Result>& runs) {
+        std::vector<Result> aggregates;
+        if (runs.size() < 2)
+            return aggregates;
+        auto stat = [&](const std::string& name, double (*field)(const Result&)) {
+            std::vector<double> values;
+            for (auto& run : runs)
+                values.push_back(field(run));
+            double mean = 0;
+            for (double value : values)
+                mean += value;
+            mean /= values.size();
+            if (name == "mean")
+                return mean;
+            if (name == "median") {
+                std::sort(values.begin(), values.end());
+                size_t mid = values.size()/2;
+                return values.size() % 2 ? values[mid] : 0.5*(values[mid-1] + values[mid]);
+            }
+            double var = 0;
+            for (double value : values)
+                var += (value - mean)*(value - mean);
+            return std::sqrt(var/(values.size() - 1));
+        };
+        for (std::string name : {"mean", "median", "stddev"}) {
+            Result result = runs[0];
+            result.name = runs[0].runName + "_" + name;
+            result.aggregate = name;
+            result.repetitions = runs.size();
+            result.realTime = stat(name, [](const Result& r) { return r.realTime; });
+            result.cpuTime = stat(name, [](const Result& r) { return r.cpuTime; });
+            result.itemsPerSecond = stat(name, [](const Result& r) { return r.itemsPerSecond; });
+            aggregates.push_back(result);
+        }
+        return aggregates;
+    }
+
+    /** @return time per iteration with a readable unit */
+    std::string formatTime(double ns) {
+        std::stringstream ss;
+        ss << std::fixed << std::setprecision(ns < 10 ? 2 : 0);
+        if (ns < 1e4)
+            ss << ns << " ns";
+        else if (ns < 1e7)
+            ss << std::setprecision(1) << ns/1e3 << " us";
+        else
+            ss << std::setprecision(1) << ns/1e6 << " ms";
+        return ss.str();
+    }
+
+    std::string formatRate(double rate) {
+        if (rate <= 0)
+            return "";
+        const char* prefixes[] = {"", "k", "M", "G"};
+        int iprefix = 0;
+        while (rate >= 1000 && iprefix < 3) {
+            rate /= 1000;
+            ++iprefix;
+        }
+        std::stringstream ss;
+        ss << std::fixed << std::setprecision(2) << rate << prefixes[iprefix] << " items/s";
+        return ss.str();
+    }
+
+    void printHeader() {
+        std::cout << std::left << std::setw(48) << "Benchmark" << std::right
+            << std::setw(14) << "Time"
+            << std::setw(14) << "CPU"
+            << std::setw(13) << "Iterations"
+            << "  Rate" << std::endl;
+        std::cout << std::string(100, '-') << std::endl;
+    }
+
+    void printResult(const Result& result) {
+        std::cout << std::left << std::setw(48) << result.name << std::right;
+        if (!result.error.empty()) {
+            std::cout << "  ERROR: " << result.error << std::endl;
+            return;
+        }
+        std::cout << std::setw(14) << formatTime(result.realTime)
+            << std::setw(14) << formatTime(result.cpuTime)
+            << std::setw(13) << (result.aggregate.empty() ? std::to_string(result.iterations) : "")
+            << "  " << formatRate(result.itemsPerSecond);
+        if (!result.label.empty())
+            std::cout << " " << result.label;
+        std::cout << std::endl;
+    }
+
+    std::string isoDate() {
+        char buffer[64];
+        time_t now = time(nullptr);
+        strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%S%z", localtime(&now));
+        return buffer;
+    }
+
+    std::string hostName() {
+        char buffer[256] = {0};
+        gethostname(buffer, sizeof(buffer)-1);
+        return buffer;
+    }
+
+    /** Results in the format written by Google Benchmark --benchmark_out_format=json */
+    bool writeJson(const std::string& filename, const std::vector<Result>& results,
+            const std::string& executable, const std::string& label) {
+        json out;
+        out["context"] = {
+            {"date", isoDate()},
+            {"host_name", hostName()},
+            {"executable", executable},
+            {"num_cpus", std::thread::hardware_concurrency()},
+#ifdef NDEBUG
+            {"library_build_type", "release"},
+#else
+            {"library_build_type", "debug"},
+#endif
+            {"label", label}
+        };
+        out["benchmarks"] = json::array();
+        for (auto& result : results) {
+            json entry = {
+                {"name", result.name},
+                {"run_name", result.runName},
+                {"run_type", result.aggregate.empty() ? "iteration" : "aggregate"},
+                {"repetitions", result.repetitions},
+                {"repetition_index", result.repetitionIndex},
+                {"iterations", result.iterations},
+                {"real_time", result.realTime},
+                {"cpu_time", result.cpuTime},
+                {"time_unit", "ns"}
+            };
+            if (!result.aggregate.empty())
+                entry["aggregate_name"] = result.aggregate;
+            if (result.itemsPerSecond > 0)
+                entry["items_per_second"] = result.itemsPerSecond;
+            if (!result.label.empty())
+                entry["label"] = result.label;
+            if (!result.error.empty()) {
+                entry["error_occurred"] = true;
+                entry["error_message"] = result.error;
+            }
+            out["benchmarks"].push_back(entry);
+        }
+        std::ofstream file(filename);
+        if (!file.is_open())
+            return false;
+        file << std::setw(2) << out << std::endl;
+        return file.good();
+    }
+
+    /** @return mean CPU time per iteration [ns] of every run name of a JSON output */
+    std::map<std::string, double> meanCpuTimes(const json& doc) {
+        std::map<std::string, double> sums;
+        std::map<std::string, int> counts;
+        if (!doc.contains("benchmarks"))
+            return sums;
+        for (auto& entry : doc.at("benchmarks")) {
+            if (entry.value("run_type", "iteration") != "iteration" || entry.value("error_occurred", false))
+                continue;
+            std::string unit = entry.value("time_unit", "ns");
+            double scale = unit == "s" ? 1e9 : unit == "ms" ? 1e6 : unit == "us" ? 1e3 : 1.;
+            std::string name = entry.value("run_name", entry.value("name", ""));
+            sums[name] += scale*entry.value("cpu_time", 0.);
+            counts[name]++;
+        }
+        for (auto& sum : sums)
+            sum.second /= counts[sum.first];
+        return sums;
+    }
+
+    /** Print the change of the CPU times with respect to a previous output */
+    bool compare(const std::string& filename, const std::vector<Result>& results) {
+        std::ifstream file(filename);
+        if (!file.is_open()) {
+            std::cerr << "[ hpstr-bench ]: ERROR: cannot open " << filename << std::endl;
+            return false;
+        }
+        json baseline;
+        try {
+            file >> baseline;
+        } catch (std::exception& e) {
+            std::cerr << "[ hpstr-bench ]: ERROR: cannot parse " << filename << ": " << e.what() << std::endl;
+            return false;
+        }
+        std::map<std::string, double> before = meanCpuTimes(baseline);
+
+        json current;
+        current["benchmarks"] = json::array();
+        for (auto& result : results) {
+            if (result.aggregate.empty() && result.error.empty())
+                current["benchmarks"].push_back({{"run_name", result.runName}, {"cpu_time", result.cpuTime}});
+        }
+        std::map<std::string, double> after = meanCpuTimes(current);
+
+        std::cout << std::endl << "Comparison with " << filename << " (CPU time per iteration)" << std::endl;
+        std::cout << std::left << std::setw(48) << "Benchmark" << std::right
+            << std::setw(14) << "Before" << std::setw(14) << "After" << std::setw(10) << "Change" << std::endl;
+        std::cout << std::string(86, '-') << std::endl;
+        for (auto& entry : after) {
+            auto it = before.find(entry.first);
+            std::cout << std::left << std::setw(48) << entry.first << std::right;
+            if (it == before.end() || it->second <= 0) {
+                std::cout << std::setw(14) << "-" << std::setw(14) << formatTime(entry.second) << std::setw(10) << "new" << std::endl;
+                continue;
+            }
+            double change = 100.*(entry.second - it->second)/it->second;
+            std::stringstream ss;
+            ss << std::showpos << std::fixed << std::setprecision(1) << change << "%";
+            std::cout << std::setw(14) << formatTime(it->second) << std::setw(14) << formatTime(entry.second)
+                << std::setw(10) << ss.str() << std::endl;
+        }
+        return true;
+    }
+
+    void removeScratch() {
+        std::string& dir = scratchDir();
+        if (dir.empty())
+            return;
+        if (DIR* d = opendir(dir.c_str())) {
+            while (dirent* file = readdir(d)) {
+                std::string name = file->d_name;
+                if (name != "." && name != "..")
+                    std::remove((dir + "/" + name).c_str());
+            }
+            closedir(d);
+        }
+        rmdir(dir.c_str());
+        dir.clear();
+    }
+
+    void printUsage() {
+        std::cout << "Usage: hpstr-bench [--filter REGEX] [--min-time SECONDS] [--repetitions N]\n"
+            << "                   [--json FILE] [--compare FILE] [--label TEXT] [--list]" << std::endl;
+    }
+}
+
+namespace bench {
+
+    State::State(long iterations, const std::vector<long>& args)
+        : iterations_(iterations), remaining_(iterations), args_(args) {
+    }
+
+    void State::startTimers() {
+        started_ = true;
+        resumeTiming();
+    }
+
+    void State::stopTimers() {
+        pauseTiming();
+    }
+
+    void State::pauseTiming() {
+        if (!running_)
+            return;
+        wall_ += wallNow() - wallStart_;
+        cpu_ += cpuNow() - cpuStart_;
+        running_ = false;
+    }
+
+    void State::resumeTiming() {
+        if (running_)
+            return;
+        running_ = true;
+        cpuStart_ = cpuNow();
+        wallStart_ = wallNow();
+    }
+
+    void State::skipWithError(const std::string& error) {
+        error_ = error;
+        remaining_ = 0;
+    }
+
+    int registerBenchmark(const std::string& name, Function function, const std::vector<long>& args) {
+        std::string fullName = name;
+        for (long arg : args)
+            fullName += "/" + std::to_string(arg);
+        registry().push_back({fullName, function, args});
+        return registry().size();
+    }
+
+    std::string scratchPath(const std::string& name) {
+        std::string& dir = scratchDir();
+        if (dir.empty()) {
+            const char* tmp = getenv("TMPDIR");
+            dir = std::string(tmp ? tmp : "/tmp") + "/hpstr-bench-" + std::to_string(getpid());
+            mkdir(dir.c_str(), 0755);
+        }
+        return dir + "/" + name;
+    }
+
+    int runBenchmarks(int argc, char** argv) {
+        std::string filter = ".*";
+        std::string jsonFile, compareFile, label;
+        double minTime = 0.5;
+        int repetitions = 1;
+        bool list = false;
+        for (int iarg = 1; iarg < argc; ++iarg) {
+            std::string arg = argv[iarg];
+            bool hasValue = iarg + 1 < argc;
+            if (arg == "--filter" && hasValue) filter = argv[++iarg];
+            else if (arg == "--min-time" && hasValue) minTime = atof(argv[++iarg]);
+            else if (arg == "--repetitions" && hasValue) repetitions = std::max(1, atoi(argv[++iarg]));
+            else if (arg == "--json" && hasValue) jsonFile = argv[++iarg];
+            else if (arg == "--compare" && hasValue) compareFile = argv[++iarg];
+            else if (arg == "--label" && hasValue) label = argv[++iarg];
+            else if (arg == "--list") list = true;
+            else {
+                printUsage();
+                return arg == "--help" || arg == "-h" ? 0 : 1;
+            }
+        }
+
+        std::regex pattern;
+        try {
+            pattern = std::regex(filter);
+        } catch (std::regex_error& e) {
+            std::cerr << "[ hpstr-bench ]: ERROR: invalid filter " << filter << std::endl;
+            return 1;
+        }
+
+        std::vector<const Entry*> selected;
+        for (auto& entry : registry()) {
+            if (std::regex_search(entry.name, pattern))
+                selected.push_back(&entry);
+        }
+        if (list) {
+            for (auto entry : selected)
+                std::cout << entry->name << std::endl;
+            return 0;
+        }
+        if (selected.empty()) {
+            std::cerr << "[ hpstr-bench ]: ERROR: no benchmark matches " << filter << std::endl;
+            return 1;
+        }
+
+        std::cout << "[ hpstr-bench ]: " << isoDate() << " on " << hostName() << ", "
+            << std::thread::hardware_concurrency() << " CPUs" << std::endl;
+        printHeader();
+
+        std::vector<Result> results;
+        int errors = 0;
+        for (auto entry : selected) {
+            // The last calibration run is the first repetition, the others use the same iterations
+            std::vector<Result> runs;
+            State state = calibrate(*entry, minTime);
+            for (int irep = 0; irep < repetitions; ++irep) {
+                if (irep > 0)
+                    state = runOnce(*entry, state.iterations());
+                Result result = makeResult(*entry, state);
+                result.repetitions = repetitions;
+                result.repetitionIndex = irep;
+                printResult(result);
+                runs.push_back(result);
+                if (!result.error.empty()) {
+                    errors++;
+                    break;
+                }
+            }
+            results.insert(results.end(), runs.begin(), runs.end());
+            if (runs.back().error.empty()) {
+                for (auto& result : aggregate(runs)) {
+                    printResult(result);
+                    results.push_back(result);
+                }
+            }
+        }
+        removeScratch();
+
+        if (!jsonFile.empty()) {
+            if (writeJson(jsonFile, results, argv[0], label))
+                std::cout << "[ hpstr-bench ]: Results written to " << jsonFile << std::endl;
+            else {
+                std::cerr << "[ hpstr-bench ]: ERROR: cannot write " << jsonFile << std::endl;
+                errors++;
+            }
+        }
+        if (!compareFile.empty() && !compare(compareFile, results))
+            errors++;
+
+        return errors ? 1 : 0;
+    }
+
+} // bench
@@ -0,0 +1,49 @@
+/**
+ * @file BenchUtils.cxx
+ * @brief Helpers shared by the benchmarks of the hpstr modules.
+ */
+
+#include "BenchUtils.h"
+
+//----------------//
+//   C++ StdLib   //
+//----------------//
+#include <random>
+#include <streambuf>
+
+#include <sys/stat.h>
+
+namespace {
+
+    /** Stream buffer dropping everything, used to silence the code under test */
+    class NullBuffer : public std::streambuf {
+        protected:
+            int overflow(int c) override { return c; }
+            std::streamsize xsputn(const char*, std::streamsize n) override { return n; }
+    };
+
+    NullBuffer& sink() {
+        static NullBuffer buffer;
+        return buffer;
+    }
+}
+
+namespace bench {
+
+    QuietStdout::QuietStdout() : old_(std::cout.rdbuf(&sink())) {}
+
+    std::vector<float> uniformValues(double min, double max) {
+        std::mt19937_64 rng(12345);
+        std::uniform_real_distribution<float> dist(min, max);
+        std::vector<float> values(N_VALUES);
+        for (auto& value : values)
+            value = dist(rng);
+        return values;
+    }
+
+    double fileSizeMB(const std::string& path) {
+        struct stat st;
+        return stat(path.c_str(), &st) ? 0. : st.st_size/1.e6;
+    }
+
+} // bench
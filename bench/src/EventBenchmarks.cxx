@@ -0,0 +1,235 @@
+/**
+ * @file EventBenchmarks.cxx
+ * @brief Benchmarks of the decoders and the compact representation of the event module.
+ */
+
+//----------------//
+//   C++ StdLib   //
+//----------------//
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+//----------//
+//   ROOT   //
+//----------//
+#include "TFile.h"
+#include "TTree.h"
+
+//-----------//
+//   hpstr   //
+//-----------//
+#include "BenchGenerators.h"
+#include "BenchHarness.h"
+#include "BenchUtils.h"
+#include "Collections.h"
+#include "CompactEvent.h"
+#include "HpsEvent.h"
+#include "HpsEventFile.h"
+#include "TriggerDecoder.h"
+
+namespace {
+
+    /** Collections of an event, the particles and the vertices point to the other ones */
+    struct ParticleEvent {
+        std::vector<Track*> tracks;
+        std::vector<CalCluster*> clusters;
+        std::vector<Particle*> particles;
+        std::vector<Vertex*> vertices;
+
+        ~ParticleEvent() { clear(); }
+
+        /** Generate an event, vertex i is made of the particles 2i and 2i+1 */
+        void generate(bench::EventGenerator& generator) {
+            clear();
+            tracks = generator.generateTracks(generator.poisson(4));
+            clusters = generator.generateCalClusters(generator.poisson(3));
+            particles = generator.generateParticles(tracks, clusters);
+            vertices = generator.generateVertices(particles.size()/2);
+            for (unsigned int ivtx = 0; ivtx < vertices.size(); ++ivtx) {
+                vertices[ivtx]->addParticle(particles[2*ivtx]);
+                vertices[ivtx]->addParticle(particles[2*ivtx + 1]);
+            }
+        }
+
+        void clear() {
+            bench::deleteAll(vertices);
+            bench::deleteAll(particles);
+            bench::deleteAll(clusters);
+            bench::deleteAll(tracks);
+        }
+
+        long size() const { return tracks.size() + particles.size() + vertices.size(); }
+    };
+
+    /**
+     * @brief Write a DST with tracks, clusters, particles and vertices
+     *
+     * @param filename output ROOT file
+     * @param nEvents number of events
+     * @param compact store the tracks, particles and vertices in the compact representation
+     * @return number of tracks, particles and vertices written
+     */
+    long writeParticleDst(const std::string& filename, int nEvents, bool compact) {
+        TFile file(filename.c_str(), "RECREATE");
+        TTree* tree = new TTree("HPS_Event", "HPS event tree");
+        const std::string suffix = CompactEvent::kSuffix;
+        ParticleEvent event;
+        std::vector<CompactTrack> compactTracks;
+        std::vector<CompactParticle> compactParticles;
+        std::vector<CompactVertex> compactVertices;
+        tree->Branch(Collections::ECAL_CLUSTERS, &event.clusters);
+        if (compact) {
+            tree->Branch((Collections::GBL_TRACKS + suffix).c_str(), &compactTracks)
+                ->SetTitle(CompactEvent::branchTitle("CompactTrack").c_str());
+            tree->Branch((Collections::FINAL_STATE_PARTICLES + suffix).c_str(), &compactParticles)
+                ->SetTitle(CompactEvent::branchTitle("CompactParticle", {{"tracks", Collections::GBL_TRACKS},
+                            {"clusters", Collections::ECAL_CLUSTERS}}).c_str());
+            tree->Branch((Collections::UC_V0VERTICES + suffix).c_str(), &compactVertices)
+                ->SetTitle(CompactEvent::branchTitle("CompactVertex",
+                            {{"particles", Collections::FINAL_STATE_PARTICLES}}).c_str());
+        } else {
+            tree->Branch(Collections::GBL_TRACKS, &event.tracks);
+            tree->Branch(Collections::FINAL_STATE_PARTICLES, &event.particles);
+            tree->Branch(Collections::UC_V0VERTICES, &event.vertices);
+        }
+
+        bench::EventGenerator generator;
+        long nObjects = 0;
+        for (int ievent = 0; ievent < nEvents; ++ievent) {
+            event.generate(generator);
+            if (compact) {
+                CompactEvent::packTracks(event.tracks, compactTracks);
+                CompactEvent::packParticles(event.particles, &event.tracks, &event.clusters, compactParticles);
+                CompactEvent::packVertices(event.vertices, &event.particles, compactVertices);
+            }
+            tree->Fill();
+            nObjects += event.size();
+        }
+        file.cd();
+        tree->Write();
+        file.Close();
+        return nObjects;
+    }
+}
+
+/**
+ * TriggerDecoder::decodeVTP of a synthetic VTP bank, the arguments are the
+ * number of clusters and the number of records of each trigger subtype.
+ * The bank is decoded as EventProcessor does: the encoded records fill its
+ * first half, the second half is padding. The decoding is checked by the
+ * trigger-decoder test of the event module.
+ */
+static void TriggerDecoder_decodeVTP(bench::State& state) {
+    bench::EventGenerator generator;
+    VTPData reference;
+    generator.generateVTP(state.range(0), state.range(1), reference);
+    std::vector<int> words;
+    bench::encodeVTP(reference, words);
+    int nRecordWords = words.size();
+    words.resize(2*nRecordWords, 0);
+    VTPData vtp;
+
+    while (state.keepRunning()) {
+        TriggerDecoder::Status status = TriggerDecoder::decodeVTP(words.data(), words.size()/2, words.size(), vtp);
+        bench::doNotOptimize(status);
+    }
+    state.setItemsProcessed(state.iterations()*nRecordWords);
+}
+HPSTR_BENCHMARK_ARGS(TriggerDecoder_decodeVTP, 4, 1);
+HPSTR_BENCHMARK_ARGS(TriggerDecoder_decodeVTP, 32, 4);
+
+/** TriggerDecoder::decodeTS of a TS bank with random words */
+static void TriggerDecoder_decodeTS(bench::State& state) {
+    std::mt19937_64 rng(12345);
+    std::vector<int> words(TriggerDecoder::nTSWords*bench::N_VALUES);
+    for (auto& word : words)
+        word = static_cast<int>(rng());
+    TSData ts;
+
+    long i = 0;
+    while (state.keepRunning()) {
+        TriggerDecoder::decodeTS(words.data() + (i & (bench::N_VALUES-1))*TriggerDecoder::nTSWords,
+                TriggerDecoder::nTSWords, ts);
+        bench::doNotOptimize(ts.T);
+        ++i;
+    }
+    state.setItemsProcessed(state.iterations());
+}
+HPSTR_BENCHMARK(TriggerDecoder_decodeTS);
+
+/**
+ * Pack the tracks, particles and vertices of generated events to the
+ * compact representation and unpack them, as the compact DST writer and
+ * HpsEventFile do. The unpacked collections are checked by the
+ * compact-event-round-trip test of the event module.
+ */
+static void CompactEvent_roundTrip(bench::State& state) {
+    bench::EventGenerator generator;
+    ParticleEvent event, unpacked;
+    std::vector<CompactTrack> tracks;
+    std::vector<CompactParticle> particles;
+    std::vector<CompactVertex> vertices;
+
+    long nObjects = 0;
+    while (state.keepRunning()) {
+        state.pauseTiming();
+        event.generate(generator);
+        unpacked.clear();
+        state.resumeTiming();
+        CompactEvent::packTracks(event.tracks, tracks);
+        CompactEvent::packParticles(event.particles, &event.tracks, &event.clusters, particles);
+        CompactEvent::packVertices(event.vertices, &event.particles, vertices);
+        CompactEvent::unpackTracks(tracks, unpacked.tracks);
+        CompactEvent::unpackParticles(particles, &unpacked.tracks, &event.clusters, unpacked.particles);
+        CompactEvent::unpackVertices(vertices, &unpacked.particles, unpacked.vertices);
+        nObjects += event.size();
+    }
+    state.setItemsProcessed(nObjects);
+}
+HPSTR_BENCHMARK(CompactEvent_roundTrip);
+
+/**
+ * Read the tracks, particles and vertices of a DST through HpsEventFile,
+ * the argument selects the standard (0) or the compact (1) representation.
+ * The label holds the file size. The collections read back are checked by
+ * the compact-dst-read test of the processing module.
+ */
+static void CompactEvent_readDst(bench::State& state) {
+    bool compact = state.range(0);
+    int nEvents = 5000;
+    std::string dst = bench::scratchPath(compact ? "dst_compact.root" : "dst_standard.root");
+    std::string out = bench::scratchPath("dst_compact_read.root");
+    writeParticleDst(dst, nEvents, compact);
+
+    while (state.keepRunning()) {
+        bench::QuietStdout quiet;
+        HpsEvent event;
+        HpsEventFile file(dst, out);
+        file.setupEvent(&event);
+        TTree* tree = event.getTree();
+        std::vector<Track*>* tracks{nullptr};
+        std::vector<Particle*>* particles{nullptr};
+        std::vector<Vertex*>* vertices{nullptr};
+        if (!tree || tree->SetBranchAddress(Collections::GBL_TRACKS, &tracks) < 0
+                || tree->SetBranchAddress(Collections::FINAL_STATE_PARTICLES, &particles) < 0
+                || tree->SetBranchAddress(Collections::UC_V0VERTICES, &vertices) < 0) {
+            state.skipWithError("cannot read the collections of " + dst);
+            break;
+        }
+        long nRead = 0;
+        while (file.nextEvent())
+            nRead += tracks->size() + particles->size() + vertices->size();
+        bench::doNotOptimize(nRead);
+        file.close();
+    }
+    state.setItemsProcessed(state.iterations()*nEvents);
+    char label[64];
+    snprintf(label, sizeof(label), "%s, %.2f MB", compact ? "compact" : "standard", bench::fileSizeMB(dst));
+    state.setLabel(label);
+    std::remove(dst.c_str());
+    std::remove(out.c_str());
+}
+HPSTR_BENCHMARK_ARGS(CompactEvent_readDst, 0);
+HPSTR_BENCHMARK_ARGS(CompactEvent_readDst, 1);
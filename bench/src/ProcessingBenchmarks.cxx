@@ -0,0 +1,208 @@
+/**
+ * @file ProcessingBenchmarks.cxx
+ * @brief Benchmarks of the event loop and the output files of the processing module.
+ */
+
+//----------------//
+//   C++ StdLib   //
+//----------------//
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+#include <unistd.h>
+
+//----------//
+//   ROOT   //
+//----------//
+#include "TFile.h"
+#include "TTree.h"
+
+//-----------//
+//   hpstr   //
+//-----------//
+#include "BenchDstProcessor.h"
+#include "BenchGenerators.h"
+#include "BenchHarness.h"
+#include "BenchUtils.h"
+#include "OutputSettings.h"
+#include "ParameterSet.h"
+#include "Process.h"
+
+namespace {
+
+    /** Histograms and track selection of BenchDstProcessor */
+    void writeDstConfigs(std::string& histCfg, std::string& selectionCfg) {
+        json histos;
+        auto add = [&](const std::string& name, int bins, double min, double max) {
+            histos[name] = {{"bins", bins}, {"minX", min}, {"maxX", max}, {"xtitle", name}, {"ytitle", "Events"}};
+        };
+        add("n_tracks_h", 20, -0.5, 19.5);
+        add("n_hits_h", 100, -0.5, 99.5);
+        add("trk_p_h", 200, 0., 5.);
+        add("trk_d0_h", 200, -5., 5.);
+        add("trk_z0_h", 200, -5., 5.);
+        add("trk_tanLambda_h", 200, -0.1, 0.1);
+        add("trk_chi2ndf_h", 200, 0., 10.);
+        add("trk_time_h", 200, -20., 20.);
+        add("hit_time_h", 200, -40., 40.);
+        add("clu_energy_h", 200, 0., 5.);
+        add("clu_time_h", 200, 20., 60.);
+        add("vtx_z_h", 200, -50., 50.);
+        add("vtx_chi2_h", 200, 0., 50.);
+        histCfg = bench::scratchPath("dst_histos.json");
+        std::ofstream histOut(histCfg);
+        histOut << histos;
+
+        json selection = {
+            {"chi2ndf_lt", {{"cut", 6.}, {"id", 0}, {"info", "#chi^{2}/ndf < 6"}}},
+            {"p_gt", {{"cut", 0.4}, {"id", 1}, {"info", "p > 0.4 GeV"}}}
+        };
+        selectionCfg = bench::scratchPath("dst_selection.json");
+        std::ofstream selectionOut(selectionCfg);
+        selectionOut << selection;
+    }
+
+    /** Storage settings compared by the OutputSettings benchmarks */
+    struct StorageSetting {
+        const char* label;
+        const char* compression;
+        int basket_size;
+        int auto_flush;
+    };
+    const StorageSetting storageSettings[] = {
+        {"default", "", OutputSettings::kUnset, OutputSettings::kUnset},
+        {"none", "none", OutputSettings::kUnset, OutputSettings::kUnset},
+        {"ZLIB:1", "ZLIB:1", OutputSettings::kUnset, OutputSettings::kUnset},
+        {"LZ4:4", "LZ4:4", OutputSettings::kUnset, OutputSettings::kUnset},
+        {"ZSTD:5", "ZSTD:5", OutputSettings::kUnset, OutputSettings::kUnset},
+        {"LZMA:9", "LZMA:9", OutputSettings::kUnset, OutputSettings::kUnset},
+        {"LZ4:4 256kB baskets", "LZ4:4", 256000, -30000000}
+    };
+
+    OutputSettings makeStorageSettings(int isetting) {
+        const StorageSetting& setting = storageSettings[isetting];
+        ParameterSet rule;
+        if (setting.compression[0])
+            rule.insert("compression", std::string(setting.compression));
+        if (setting.basket_size != OutputSettings::kUnset)
+            rule.insert("basket_size", setting.basket_size);
+        if (setting.auto_flush != OutputSettings::kUnset)
+            rule.insert("auto_flush", setting.auto_flush);
+        OutputSettings settings;
+        settings.addRule(rule);
+        return settings;
+    }
+
+    /** @return label with the setting, file size and throughput */
+    std::string storageLabel(int isetting, double sizeMB, double mbPerSecond) {
+        char label[128];
+        snprintf(label, sizeof(label), "%s, %.2f MB, %.1f MB/s", storageSettings[isetting].label,
+                sizeMB, mbPerSecond);
+        return label;
+    }
+}
+
+/**
+ * Process::runOnRoot with BenchDstProcessor on a generated DST, the argument
+ * is the number of events. The DST is written once and reused.
+ */
+static void Process_runOnRoot(bench::State& state) {
+    int nEvents = state.range(0);
+    std::string dst = bench::scratchPath("dst_" + std::to_string(nEvents) + ".root");
+    std::string output = bench::scratchPath("dst_out.root");
+    if (access(dst.c_str(), R_OK) != 0) {
+        bench::EventGenerator generator;
+        generator.writeDst(dst, nEvents);
+    }
+    std::string histCfg, selectionCfg;
+    writeDstConfigs(histCfg, selectionCfg);
+
+    while (state.keepRunning()) {
+        Process process;
+        BenchDstProcessor processor("bench", process);
+        ParameterSet parameters;
+        parameters.insert("histCfg", histCfg);
+        parameters.insert("selectionCfg", selectionCfg);
+        bench::QuietStdout quiet;
+        processor.configure(parameters);
+        process.addToSequence(&processor);
+        process.addFileToProcess(dst);
+        process.addOutputFileName(output);
+        process.runOnRoot();
+    }
+    state.setItemsProcessed(state.iterations()*nEvents);
+    std::remove(output.c_str());
+}
+HPSTR_BENCHMARK_ARGS(Process_runOnRoot, 1000);
+HPSTR_BENCHMARK_ARGS(Process_runOnRoot, 10000);
+
+/**
+ * Write a DST with the storage setting of the argument. The time includes
+ * the generation of the events, which is the same for every setting. The
+ * label holds the file size and the write throughput in file MB/s.
+ */
+static void OutputSettings_writeDst(bench::State& state) {
+    int isetting = state.range(0);
+    int nEvents = 5000;
+    OutputSettings settings = makeStorageSettings(isetting);
+    std::string dst = bench::scratchPath("dst_storage_write.root");
+    bench::EventGenerator generator;
+
+    while (state.keepRunning()) {
+        state.pauseTiming();
+        generator.reseed(12345);
+        state.resumeTiming();
+        generator.writeDst(dst, nEvents, bench::Multiplicity(), &settings);
+    }
+    state.setItemsProcessed(state.iterations()*nEvents);
+    double size = bench::fileSizeMB(dst);
+    state.setLabel(storageLabel(isetting, size, state.getWallTime() > 0 ? size*state.iterations()/state.getWallTime() : 0.));
+    std::remove(dst.c_str());
+}
+HPSTR_BENCHMARK_ARGS(OutputSettings_writeDst, 0);
+HPSTR_BENCHMARK_ARGS(OutputSettings_writeDst, 1);
+HPSTR_BENCHMARK_ARGS(OutputSettings_writeDst, 2);
+HPSTR_BENCHMARK_ARGS(OutputSettings_writeDst, 3);
+HPSTR_BENCHMARK_ARGS(OutputSettings_writeDst, 4);
+HPSTR_BENCHMARK_ARGS(OutputSettings_writeDst, 5);
+HPSTR_BENCHMARK_ARGS(OutputSettings_writeDst, 6);
+
+/**
+ * Read all the branches of a DST written with the storage setting of the
+ * argument. The label holds the file size and the read throughput in
+ * uncompressed MB/s.
+ */
+static void OutputSettings_readDst(bench::State& state) {
+    int isetting = state.range(0);
+    int nEvents = 5000;
+    std::string dst = bench::scratchPath("dst_storage_" + std::to_string(isetting) + ".root");
+    if (access(dst.c_str(), R_OK) != 0) {
+        OutputSettings settings = makeStorageSettings(isetting);
+        bench::EventGenerator generator;
+        generator.writeDst(dst, nEvents, bench::Multiplicity(), &settings);
+    }
+
+    long bytes = 0;
+    while (state.keepRunning()) {
+        TFile file(dst.c_str());
+        TTree* tree = file.IsZombie() ? nullptr : (TTree*)file.Get("HPS_Event");
+        if (!tree) {
+            state.skipWithError("cannot read " + dst);
+            break;
+        }
+        for (long ientry = 0; ientry < tree->GetEntries(); ++ientry)
+            bytes += tree->GetEntry(ientry);
+        file.Close();
+    }
+    state.setItemsProcessed(state.iterations()*nEvents);
+    state.setLabel(storageLabel(isetting, bench::fileSizeMB(dst),
+                state.getWallTime() > 0 ? bytes/1.e6/state.getWallTime() : 0.));
+}
+HPSTR_BENCHMARK_ARGS(OutputSettings_readDst, 0);
+HPSTR_BENCHMARK_ARGS(OutputSettings_readDst, 1);
+HPSTR_BENCHMARK_ARGS(OutputSettings_readDst, 2);
+HPSTR_BENCHMARK_ARGS(OutputSettings_readDst, 3);
+HPSTR_BENCHMARK_ARGS(OutputSettings_readDst, 4);
+HPSTR_BENCHMARK_ARGS(OutputSettings_readDst, 5);
+HPSTR_BENCHMARK_ARGS(OutputSettings_readDst, 6);
@@ -0,0 +1,47 @@
+/**
+ * @file ProcessorsBenchmarks.cxx
+ * @brief Benchmarks of the conversion helpers of the processors module.
+ */
+
+//----------------//
+//   C++ StdLib   //
+//----------------//
+#include <string>
+#include <vector>
+
+//-----------//
+//   hpstr   //
+//-----------//
+#include "BenchGenerators.h"
+#include "BenchHarness.h"
+#include "utilities.h"
+
+/**
+ * utils::buildTrack on the tracks of an event. The first argument adds the
+ * GBL kink and track data relations, the second builds the tracks at the
+ * target instead of the IP.
+ */
+static void utils_buildTrack(bench::State& state) {
+    const int nTracks = 10;
+    bool withData = state.range(0);
+    std::string location = state.range(1) ? "AtTarget" : "";
+    bench::EventGenerator generator;
+    bench::LcioTracks lcio = generator.generateLcioTracks(nTracks);
+    EVENT::LCCollection* kinkRelations = withData ? lcio.kinkRelations.get() : nullptr;
+    EVENT::LCCollection* trackDataRelations = withData ? lcio.trackDataRelations.get() : nullptr;
+    std::vector<EVENT::Track*> lcTracks;
+    for (int itrk = 0; itrk < nTracks; ++itrk)
+        lcTracks.push_back(dynamic_cast<EVENT::Track*>(lcio.tracks->getElementAt(itrk)));
+
+    while (state.keepRunning()) {
+        for (auto lcTrack : lcTracks) {
+            Track* track = utils::buildTrack(lcTrack, location, kinkRelations, trackDataRelations);
+            bench::doNotOptimize(track);
+            delete track;
+        }
+    }
+    state.setItemsProcessed(state.iterations()*nTracks);
+}
+HPSTR_BENCHMARK_ARGS(utils_buildTrack, 0, 0);
+HPSTR_BENCHMARK_ARGS(utils_buildTrack, 1, 0);
+HPSTR_BENCHMARK_ARGS(utils_buildTrack, 1, 1);
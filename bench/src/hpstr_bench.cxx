@@ -0,0 +1,22 @@
+/**
+ *  @file   hpstr_bench.cxx
+ *  @brief  App used to benchmark the hot paths of hpstr.
+ */
+
+//----------//
+//   ROOT   //
+//----------//
+#include "TError.h"
+
+//-----------//
+//   hpstr   //
+//-----------//
+#include "BenchHarness.h"
+
+int main(int argc, char** argv) {
+
+    // Keep the ROOT info messages, e.g. of the fits, out of the results
+    gErrorIgnoreLevel = kWarning;
+
+    return bench::runBenchmarks(argc, argv);
+}
@@ -56,6 +56,12 @@ class CalHit : public TObject {
         /** @return The crystal indices. */ 
         std::vector<int> getCrystalIndices() const { return { index_x_, index_y_ }; }
 
+        /** @return The crystal index along x. */ 
+        int getCrystalIndexX() const { return index_x_; }
+
+        /** @return The crystal index along y. */ 
+        int getCrystalIndexY() const { return index_y_; }
+
     private: 
         
         /** The crystal index along x. */
@@ -0,0 +1,234 @@
+/**
+ * @file CompactEvent.h
+ * @brief Compact on-disk representation of the tracks, particles and vertices.
+ */
+
+#ifndef _COMPACT_EVENT_H_
+#define _COMPACT_EVENT_H_
+
+//----------------//
+//   C++ StdLib   //
+//----------------//
+#include <string>
+#include <vector>
+
+//----------//
+//   ROOT   //
+//----------//
+#include <TRefArray.h>
+#include <Rtypes.h>
+
+//-----------//
+//   hpstr   //
+//-----------//
+#include "CalCluster.h"
+#include "Particle.h"
+#include "Track.h"
+#include "Vertex.h"
+
+/**
+ * @brief Compact Track
+ *
+ * Fixed-size arrays instead of vectors, the hit layers as a bit mask and
+ * reduced precision for the covariance, isolations and kinks. The truth
+ * links, the MC hits and the particle reference are not stored.
+ */
+struct CompactTrack {
+    /** Track id. */
+    Int_t id{0};
+    /** Track type. */
+    Int_t type{-999};
+    /** SVT volume, 0 top, 1 bottom. */
+    Short_t volume{-999};
+    /** Charge. */
+    Char_t charge{0};
+    /** Number of 3D hits. */
+    UChar_t n_hits{0};
+    /** Number of shared hits. */
+    Short_t n_shared{0};
+    /** Shared hit in layer 0. */
+    Bool_t shared_ly0{false};
+    /** Shared hit in layer 1. */
+    Bool_t shared_ly1{false};
+    /** Bit i is set if the track has a hit in layer i. */
+    UInt_t hit_layers{0};
+    /** Set if the covariance was filled. */
+    Bool_t has_cov{false};
+    /** Helix parameters. */
+    Double32_t d0{-999.};
+    Double32_t phi0{-999.};
+    Double32_t omega{-999.};
+    Double32_t tan_lambda{-999.};
+    Double32_t z0{-999.};
+    /** Fit chi2. */
+    Double32_t chi2{-999.};
+    /** Fit ndf. */
+    Double32_t ndf{0.};
+    /** Track time [ns]. */
+    Double32_t time{-999.};
+    /** Position of the track. */
+    Double32_t position[3];
+    /** Position at the Ecal face. */
+    Double32_t position_at_ecal[3];
+    /** Momentum [GeV]. */
+    Double32_t momentum[3];
+    /** Helix covariance, packed lower triangle, reduced precision. */
+    Float16_t cov[15]; //[0,0,12]
+    /** Isolation of each layer, reduced precision. */
+    Float16_t isolation[14]; //[0,0,10]
+    /** Lambda kink of each layer, reduced precision. */
+    Float16_t lambda_kinks[14]; //[0,0,12]
+    /** Phi kink of each layer, reduced precision. */
+    Float16_t phi_kinks[14]; //[0,0,12]
+    /** Tracker hits. */
+    TRefArray hits;
+
+    ClassDefNV(CompactTrack, 1);
+};
+
+/**
+ * @brief Compact Particle
+ *
+ * The track and the cluster are indices into the track and cluster
+ * collections of the event instead of embedded copies.
+ */
+struct CompactParticle {
+    /** PDG id. */
+    Int_t pdg{-9999};
+    /** Particle type. */
+    Int_t type{-9999};
+    /** Charge. */
+    Int_t charge{-9999};
+    /** Index of the track, -1 if none. */
+    Short_t track{-1};
+    /** Index of the cluster, -1 if none. */
+    Short_t cluster{-1};
+    /** Goodness of the PID. */
+    Double32_t goodness_pid{-9999};
+    /** Energy [GeV]. */
+    Double32_t energy{-9999};
+    /** Mass [GeV]. */
+    Double32_t mass{-9999};
+    /** Momentum [GeV]. */
+    Double32_t momentum[3];
+    /** Corrected momentum [GeV]. */
+    Double32_t corr_momentum[3];
+
+    ClassDefNV(CompactParticle, 1);
+};
+
+/**
+ * @brief Compact Vertex
+ *
+ * The kinematics derived from the vertex parameters are recomputed when
+ * it is read, the particles are indices into the particle collection.
+ */
+struct CompactVertex {
+    /** Largest parameter set, 2019 V0s. */
+    static const int kMaxParameters = 24;
+    /** Largest number of particles of a vertex. */
+    static const int kMaxParticles = 4;
+
+    /** Vertex id. */
+    Int_t id{0};
+    /** Fit ndf. */
+    Int_t ndf{-999};
+    /** Vertex type. */
+    std::string type;
+    /** Fit chi2. */
+    Double32_t chi2{-999};
+    /** Fit probability. */
+    Float_t probability{-999};
+    /** Vertex position [mm]. */
+    Double32_t position[3];
+    /** Size of the covariance. */
+    UChar_t n_cov{0};
+    /** Position covariance, packed lower triangle, reduced precision. */
+    Float16_t cov[6]; //[0,0,12]
+    /** Number of parameters. */
+    UChar_t n_parameters{0};
+    /** Vertex parameters. */
+    Float_t parameters[kMaxParameters];
+    /** Number of particles. */
+    UChar_t n_particles{0};
+    /** Indices of the particles, -1 if not in the collection. */
+    Short_t particles[kMaxParticles];
+
+    ClassDefNV(CompactVertex, 1);
+};
+
+/**
+ * @brief Conversion between the event objects and their compact representation
+ *
+ * Compact collections are written to a branch named after the collection
+ * with the kSuffix suffix. The title of the branch names the collections
+ * its references point to, e.g. "CompactParticle tracks=KalmanFullTracks
+ * clusters=RecoEcalClusters", see branchTitle and titleValue.
+ */
+class CompactEvent {
+
+    public:
+
+        /** Suffix of the compact branches */
+        static const std::string kSuffix;
+
+        /** Tracks */
+        static void packTracks(const std::vector<Track*>& tracks, std::vector<CompactTrack>& compact);
+
+        /**
+         * @brief Make the tracks of a compact collection
+         *
+         * @param compact compact tracks
+         * @param tracks new tracks are appended, owned by the caller
+         */
+        static void unpackTracks(const std::vector<CompactTrack>& compact, std::vector<Track*>& tracks);
+
+        /**
+         * @brief Particles, their track and cluster are looked up in the collections
+         *
+         * A track or cluster which is not in its collection, or whose
+         * collection is null, is not stored.
+         */
+        static void packParticles(const std::vector<Particle*>& particles, const std::vector<Track*>* tracks,
+                const std::vector<CalCluster*>* clusters, std::vector<CompactParticle>& compact);
+
+        /**
+         * @brief Make the particles of a compact collection
+         *
+         * @param compact compact particles
+         * @param tracks unpacked track collection the particles point to, may be null
+         * @param clusters cluster collection the particles point to, may be null
+         * @param particles new particles are appended, owned by the caller
+         */
+        static void unpackParticles(const std::vector<CompactParticle>& compact, const std::vector<Track*>* tracks,
+                const std::vector<CalCluster*>* clusters, std::vector<Particle*>& particles);
+
+        /** Vertices, their particles are looked up in the particle collection */
+        static void packVertices(const std::vector<Vertex*>& vertices, const std::vector<Particle*>* particles,
+                std::vector<CompactVertex>& compact);
+
+        /**
+         * @brief Make the vertices of a compact collection
+         *
+         * @param compact compact vertices
+         * @param particles unpacked particle collection the vertices point to, may be null
+         * @param vertices new vertices are appended, owned by the caller
+         */
+        static void unpackVertices(const std::vector<CompactVertex>& compact, const std::vector<Particle*>* particles,
+                std::vector<Vertex*>& vertices);
+
+        /**
+         * @brief Title of a compact branch
+         *
+         * @param type compact class name
+         * @param refs key=collection pairs of the referenced collections
+         * @return std::string
+         */
+        static std::string branchTitle(const std::string& type,
+                const std::vector<std::pair<std::string, std::string>>& refs = {});
+
+        /** @return the value of a key of a branch title, empty if not set */
+        static std::string titleValue(const std::string& title, const std::string& key);
+};
+
+#endif // _COMPACT_EVENT_H_
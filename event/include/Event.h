@@ -60,7 +60,8 @@ class Event : public IEvent {
 
         template<typename T>
             void addCollection(const std::string& name, std::vector<T*>* collection ){
-                branches_[name] = tree_->Branch(name.c_str(),&collection);};
+                branches_[name] = tree_->Branch(name.c_str(), &collection, 32000,
+                        split_level_ < 0 ? 99 : split_level_);};
 
         /** 
          * @param name Name of the collection
@@ -92,6 +93,13 @@ class Event : public IEvent {
         /** @return The ROOT tree containing the event. */
         TTree* getTree() { return tree_; }
 
+        /**
+         * Set the split level of the branches added to the event.
+         *
+         * @param split_level Split level, < 0 for the default of each method.
+         */
+        void setSplitLevel(int split_level) { split_level_ = split_level; };
+
         /** Set the LCIO event. */
         void setLCEvent(EVENT::LCEvent* lc_event) { lc_event_ = lc_event; }; 
 
@@ -137,6 +145,9 @@ class Event : public IEvent {
         /** The current entry. */
         int entry_{0};  
 
+        /** Split level of the added branches, < 0 for the default. */
+        int split_level_{-1};
+
 }; // Event
 
 #endif // __EVENT_H__
@@ -1,6 +1,7 @@
 // Includes for root dictionary creation
 #include "CalCluster.h"
 #include "CalHit.h"
+#include "CompactEvent.h"
 #include "Event.h"
 #include "EventHeader.h"
 #include "HodoCluster.h"
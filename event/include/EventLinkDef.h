@@ -33,6 +33,9 @@
 #pragma link C++ class MCTrackerHit+;
 #pragma link C++ class MCEcalHit+;
 #pragma link C++ class RawSvtHit+;
+#pragma link C++ class CompactTrack+;
+#pragma link C++ class CompactParticle+;
+#pragma link C++ class CompactVertex+;
 
 // This is to create the dictionary for stl containers
 #pragma link C++ class vector<TObject>     +;
@@ -66,4 +69,7 @@
 #pragma link C++ class vector<VTPData::hpsClusterMult>  +;
 #pragma link C++ class vector<VTPData::hpsFEETrig>      +;
 #pragma link C++ class vector<TSData::tsBits>           +;
+#pragma link C++ class vector<CompactTrack>             +;
+#pragma link C++ class vector<CompactParticle>          +;
+#pragma link C++ class vector<CompactVertex>            +;
 #endif
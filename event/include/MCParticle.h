@@ -7,6 +7,12 @@
 #ifndef _MCPARTICLE_H_
 #define _MCPARTICLE_H_
 
+//----------------//
+//   C++ StdLib   //
+//----------------//
+#include <algorithm>
+#include <vector>
+
 //----------//
 //   ROOT   //
 //----------//
@@ -73,6 +79,28 @@ class MCParticle : public TObject {
          */
         void setMomPDG(const int momPDG) { momPDG_ = momPDG; }; 
 
+        /**
+         * Set the LCIO ID of the mother of this particle.
+         *
+         * @param momID The LCIO ID of the mother of this particle
+         */
+        void setMomID(const int momID) { momID_ = momID; }; 
+
+        /**
+         * Set the LCIO ID of the track related to this particle.
+         *
+         * @param trackID The LCIO ID of the track, -1 if none
+         */
+        void setTrackID(const int trackID) { trackID_ = trackID; }; 
+
+        /**
+         * Set the PDG IDs of the ancestors of this particle, among the
+         * ones looked for during the conversion.
+         *
+         * @param ancestorPDGs PDG IDs found in the ancestry of the particle
+         */
+        void setAncestorPDGs(const std::vector<int>& ancestorPDGs) { ancestorPDGs_ = ancestorPDGs; }; 
+
         /**
          * Set the generator status of the particle.
          *
@@ -151,6 +179,23 @@ class MCParticle : public TObject {
         
         /** @return The particle ID of the mother. */
         int getMomPDG() const { return momPDG_; }; 
+
+        /** @return The LCIO ID of the mother. */
+        int getMomID() const { return momID_; }; 
+
+        /** @return The LCIO ID of the related track, -1 if none. */
+        int getTrackID() const { return trackID_; }; 
+
+        /** @return The PDG IDs found in the ancestry, among the ones looked for. */
+        const std::vector<int>& getAncestorPDGs() const { return ancestorPDGs_; }; 
+
+        /**
+         * @param pdg PDG ID, one of the ancestors looked for during the conversion
+         * @return true if the particle descends from a particle with this PDG ID
+         */
+        bool isFrom(const int pdg) const { 
+            return std::find(ancestorPDGs_.begin(), ancestorPDGs_.end(), pdg) != ancestorPDGs_.end(); 
+        }; 
         
         /** @return The particle generator status. */
         int getGenStatus() const { return gen_; }; 
@@ -179,7 +224,7 @@ class MCParticle : public TObject {
         /** @return The vertex position of the particle. */
         std::vector<double> getEndPoint() const;
 
-        ClassDef(MCParticle, 1);
+        ClassDef(MCParticle, 2);
 
     private:
 
@@ -204,6 +249,15 @@ class MCParticle : public TObject {
         /** The PDG ID of this particle */
         int momPDG_{-9999}; 
 
+        /** The LCIO ID of the mother of this particle */
+        int momID_{-9999}; 
+
+        /** The LCIO ID of the track related to this particle */
+        int trackID_{-1}; 
+
+        /** PDG IDs found in the ancestry, among the ones looked for */
+        std::vector<int> ancestorPDGs_; 
+
         /** The generator status of the particle */ 
         int gen_{-9999}; 
 
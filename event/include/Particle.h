@@ -59,7 +59,7 @@ class Particle : public TObject {
          * @return An array of references to the calorimeter clusters associated
          *         with this particle
          */
-        CalCluster getCluster() const { return cluster_; };
+        const CalCluster& getCluster() const { return cluster_; };
 
         /**
          * Add a reference to an Particle object.  This will be used to
@@ -156,6 +156,9 @@ class Particle : public TObject {
 
         ClassDef(Particle, 1);
 
+        /** Packs and unpacks the compact representation, see CompactEvent.h */
+        friend class CompactEvent;
+
     private:
 
         /** The track associated with this particle */
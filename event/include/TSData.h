@@ -77,6 +77,11 @@ class TSData : public TObject {
 
         void Clear(){
             TObject::Clear();
+            header = tsHeader();
+            prescaled = tsBits();
+            ext = tsBits();
+            EN = 0;
+            T = 0;
         };
 
         ClassDef(TSData, 1);
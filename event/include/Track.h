@@ -479,6 +479,9 @@ class Track : public TObject {
         TRef mcp_link_;
         
         ClassDef(Track, 1);
+
+        /** Packs and unpacks the compact representation, see CompactEvent.h */
+        friend class CompactEvent;
 }; // Track
 
 #endif // __TRACK_H__
@@ -127,7 +127,7 @@ class TrackerHit : public TObject {
         std::vector<int> getMCPartIDs() const {return mcPartIDs_;};
 
         /** Return rawhit strip numbers on hit */
-        std::vector<int> getRawHitStripNumbers(){return rawhit_strips_;};
+        const std::vector<int>& getRawHitStripNumbers() const {return rawhit_strips_;};
 
         /** Set rawhit strips on hit */
         void setRawHitStripNumbers(std::vector<int> rawhit_strips){rawhit_strips_ = rawhit_strips;};
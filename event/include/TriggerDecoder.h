@@ -0,0 +1,100 @@
+/**
+ * @file TriggerDecoder.h
+ * @brief Decoder of the raw VTP and TS trigger bank words.
+ */
+
+#ifndef _TRIGGER_DECODER_H_
+#define _TRIGGER_DECODER_H_
+
+//-----------//
+//   hpstr   //
+//-----------//
+#include "TSData.h"
+#include "VTPData.h"
+
+/**
+ * @brief Decodes the raw words of the VTP and TS banks into VTPData and TSData
+ *
+ * The decoder works on plain word arrays, so it does not depend on how the
+ * words were read and can be run on synthetic banks. The VTP words are
+ * decoded in one pass: the type of each header word, and the subtype of the
+ * expansion words, select an entry of a static table of decoding functions.
+ * Two-word records check that their second word is inside the array, a
+ * truncated bank stops the decoding instead of reading past its end. The
+ * record vectors of the VTPData are cleared, keeping their capacity, so a
+ * VTPData reused from event to event does not allocate once it has seen
+ * the largest bank.
+ */
+class TriggerDecoder {
+
+    public:
+
+        /** Summary of the decoding of a VTP bank */
+        struct Status {
+            int nRecords{0}; //!< decoded records
+            int nUnknown{0}; //!< header words of an unknown type or subtype
+            bool truncated{false}; //!< a two-word record was cut by the end of the bank
+        };
+
+        /**
+         * @brief Decode a VTP bank
+         *
+         * @param words raw words
+         * @param nRecordWords number of words in which records start
+         * @param nWords number of words in the array, the second word of a
+         *               record can be beyond nRecordWords but not beyond nWords
+         * @param vtp decoded data, cleared first
+         * @return Status
+         */
+        static Status decodeVTP(const int* words, int nRecordWords, int nWords, VTPData& vtp);
+
+        /**
+         * @brief Decode a TS bank
+         *
+         * @param words raw words
+         * @param nWords number of words in the array
+         * @param ts decoded data
+         * @return false if the bank is too short, ts is then not modified
+         */
+        static bool decodeTS(const int* words, int nWords, TSData& ts);
+
+        /**
+         * @brief Decode a word of TS trigger bits
+         *
+         * @param word
+         * @param bits decoded bits
+         */
+        static void decodeTSBits(unsigned int word, TSData::tsBits& bits);
+
+        /** Number of words of a TS bank read by decodeTS */
+        static const int nTSWords = 7;
+
+    private:
+
+        /**
+         * Decoding function of a VTP record
+         *
+         * @param word first word of the record
+         * @param end end of the array, for the records reading a second word
+         * @param vtp decoded data
+         * @return number of words of the record, 0 if it is truncated
+         */
+        typedef int (*RecordDecoder)(const int* word, const int* end, VTPData& vtp);
+
+        static int decodeBlockHeader(const int* word, const int* end, VTPData& vtp);
+        static int decodeBlockTail(const int* word, const int* end, VTPData& vtp);
+        static int decodeEventHeader(const int* word, const int* end, VTPData& vtp);
+        static int decodeTrigTime(const int* word, const int* end, VTPData& vtp);
+        static int decodeExpansion(const int* word, const int* end, VTPData& vtp);
+        static int decodeCluster(const int* word, const int* end, VTPData& vtp);
+        static int decodeSingleTrig(const int* word, const int* end, VTPData& vtp);
+        static int decodePairTrig(const int* word, const int* end, VTPData& vtp);
+        static int decodeCalibTrig(const int* word, const int* end, VTPData& vtp);
+        static int decodeClusterMult(const int* word, const int* end, VTPData& vtp);
+        static int decodeFEETrig(const int* word, const int* end, VTPData& vtp);
+
+        static const RecordDecoder typeDecoders_[16]; //!< decoders by word type
+        static const RecordDecoder expansionDecoders_[16]; //!< decoders of the expansion words by subtype
+};
+
+#endif // _TRIGGER_DECODER_H_
@@ -149,6 +149,9 @@ class Vertex : public TObject {
         
         ClassDef(Vertex,1);
 
+        /** Packs and unpacks the compact representation, see CompactEvent.h */
+        friend class CompactEvent;
+
     private:
 
         double chi2_{-999};
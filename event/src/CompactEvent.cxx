@@ -0,0 +1,275 @@
+/**
+ * @file CompactEvent.cxx
+ * @brief Compact on-disk representation of the tracks, particles and vertices.
+ */
+
+#include "CompactEvent.h"
+
+//----------------//
+//   C++ StdLib   //
+//----------------//
+#include <algorithm>
+#include <sstream>
+#include <unordered_map>
+
+ClassImp(CompactTrack)
+ClassImp(CompactParticle)
+ClassImp(CompactVertex)
+
+const int CompactVertex::kMaxParameters;
+const int CompactVertex::kMaxParticles;
+
+const std::string CompactEvent::kSuffix = "_compact";
+
+namespace {
+    /** @return index of every object of a collection */
+    template <class T>
+    std::unordered_map<const TObject*, int> indices(const std::vector<T*>* collection) {
+        std::unordered_map<const TObject*, int> index;
+        if (collection) {
+            for (unsigned int i = 0; i < collection->size(); ++i)
+                index[(*collection)[i]] = i;
+        }
+        return index;
+    }
+}
+
+void CompactEvent::packTracks(const std::vector<Track*>& tracks, std::vector<CompactTrack>& compact) {
+    compact.resize(tracks.size());
+    for (unsigned int i = 0; i < tracks.size(); ++i) {
+        const Track& track = *tracks[i];
+        CompactTrack& out = compact[i];
+        out.id = track.id_;
+        out.type = track.type_;
+        out.volume = track.track_volume_;
+        out.charge = track.charge_;
+        out.n_hits = track.n_hits_;
+        out.n_shared = track.nShared_;
+        out.shared_ly0 = track.SharedLy0_;
+        out.shared_ly1 = track.SharedLy1_;
+        out.hit_layers = 0;
+        for (int layer : track.hit_layers_) {
+            if (layer >= 0 && layer < 32)
+                out.hit_layers |= 1u << layer;
+        }
+        out.d0 = track.d0_;
+        out.phi0 = track.phi0_;
+        out.omega = track.omega_;
+        out.tan_lambda = track.tan_lambda_;
+        out.z0 = track.z0_;
+        out.chi2 = track.chi2_;
+        out.ndf = track.ndf_;
+        out.time = track.track_time_;
+        out.position[0] = track.x_;
+        out.position[1] = track.y_;
+        out.position[2] = track.z_;
+        out.position_at_ecal[0] = track.x_at_ecal_;
+        out.position_at_ecal[1] = track.y_at_ecal_;
+        out.position_at_ecal[2] = track.z_at_ecal_;
+        out.momentum[0] = track.px_;
+        out.momentum[1] = track.py_;
+        out.momentum[2] = track.pz_;
+        out.has_cov = track.cov_.size() == 15;
+        for (int j = 0; j < 15; ++j)
+            out.cov[j] = out.has_cov ? track.cov_[j] : 0.;
+        for (int layer = 0; layer < 14; ++layer) {
+            out.isolation[layer] = track.isolation_[layer];
+            out.lambda_kinks[layer] = track.lambda_kinks_[layer];
+            out.phi_kinks[layer] = track.phi_kinks_[layer];
+        }
+        out.hits = track.tracker_hits_;
+    }
+}
+
+void CompactEvent::unpackTracks(const std::vector<CompactTrack>& compact, std::vector<Track*>& tracks) {
+    tracks.reserve(tracks.size() + compact.size());
+    for (auto& in : compact) {
+        Track* track = new Track();
+        track->id_ = in.id;
+        track->type_ = in.type;
+        track->track_volume_ = in.volume;
+        track->charge_ = in.charge;
+        track->n_hits_ = in.n_hits;
+        track->nShared_ = in.n_shared;
+        track->SharedLy0_ = in.shared_ly0;
+        track->SharedLy1_ = in.shared_ly1;
+        for (int layer = 0; layer < 32; ++layer) {
+            if (in.hit_layers & (1u << layer))
+                track->hit_layers_.push_back(layer);
+        }
+        track->d0_ = in.d0;
+        track->phi0_ = in.phi0;
+        track->omega_ = in.omega;
+        track->tan_lambda_ = in.tan_lambda;
+        track->z0_ = in.z0;
+        track->chi2_ = in.chi2;
+        track->ndf_ = in.ndf;
+        track->track_time_ = in.time;
+        track->x_ = in.position[0];
+        track->y_ = in.position[1];
+        track->z_ = in.position[2];
+        track->x_at_ecal_ = in.position_at_ecal[0];
+        track->y_at_ecal_ = in.position_at_ecal[1];
+        track->z_at_ecal_ = in.position_at_ecal[2];
+        track->px_ = in.momentum[0];
+        track->py_ = in.momentum[1];
+        track->pz_ = in.momentum[2];
+        if (in.has_cov)
+            track->cov_.assign(in.cov, in.cov + 15);
+        for (int layer = 0; layer < 14; ++layer) {
+            track->isolation_[layer] = in.isolation[layer];
+            track->lambda_kinks_[layer] = in.lambda_kinks[layer];
+            track->phi_kinks_[layer] = in.phi_kinks[layer];
+        }
+        track->tracker_hits_ = in.hits;
+        tracks.push_back(track);
+    }
+}
+
+void CompactEvent::packParticles(const std::vector<Particle*>& particles, const std::vector<Track*>* tracks,
+        const std::vector<CalCluster*>* clusters, std::vector<CompactParticle>& compact) {
+    compact.resize(particles.size());
+    for (unsigned int i = 0; i < particles.size(); ++i) {
+        const Particle& particle = *particles[i];
+        CompactParticle& out = compact[i];
+        out.pdg = particle.pdg_;
+        out.type = particle.type_;
+        out.charge = particle.charge_;
+        out.goodness_pid = particle.goodness_pid_;
+        out.energy = particle.energy_;
+        out.mass = particle.mass_;
+        out.momentum[0] = particle.px_;
+        out.momentum[1] = particle.py_;
+        out.momentum[2] = particle.pz_;
+        out.corr_momentum[0] = particle.px_corr_;
+        out.corr_momentum[1] = particle.py_corr_;
+        out.corr_momentum[2] = particle.pz_corr_;
+
+        // The particle holds copies, they are matched to the collections by value,
+        // the default track and cluster of a neutral or track-only particle match none
+        const Track& track = particle.track_;
+        out.track = -1;
+        if (tracks) {
+            for (unsigned int j = 0; j < tracks->size(); ++j) {
+                const Track& candidate = *(*tracks)[j];
+                if (candidate.id_ == track.id_ && candidate.d0_ == track.d0_ && candidate.omega_ == track.omega_
+                        && candidate.tan_lambda_ == track.tan_lambda_) {
+                    out.track = j;
+                    break;
+                }
+            }
+        }
+        const CalCluster& cluster = particle.cluster_;
+        out.cluster = -1;
+        if (clusters) {
+            for (unsigned int j = 0; j < clusters->size(); ++j) {
+                const CalCluster& candidate = *(*clusters)[j];
+                if (candidate.getEnergy() == cluster.getEnergy() && candidate.getTime() == cluster.getTime()
+                        && candidate.getPosition() == cluster.getPosition()) {
+                    out.cluster = j;
+                    break;
+                }
+            }
+        }
+    }
+}
+
+void CompactEvent::unpackParticles(const std::vector<CompactParticle>& compact, const std::vector<Track*>* tracks,
+        const std::vector<CalCluster*>* clusters, std::vector<Particle*>& particles) {
+    particles.reserve(particles.size() + compact.size());
+    for (auto& in : compact) {
+        Particle* particle = new Particle();
+        particle->pdg_ = in.pdg;
+        particle->type_ = in.type;
+        particle->charge_ = in.charge;
+        particle->goodness_pid_ = in.goodness_pid;
+        particle->energy_ = in.energy;
+        particle->mass_ = in.mass;
+        particle->px_ = in.momentum[0];
+        particle->py_ = in.momentum[1];
+        particle->pz_ = in.momentum[2];
+        particle->px_corr_ = in.corr_momentum[0];
+        particle->py_corr_ = in.corr_momentum[1];
+        particle->pz_corr_ = in.corr_momentum[2];
+        if (tracks && in.track >= 0 && in.track < (int)tracks->size())
+            particle->setTrack((*tracks)[in.track]);
+        if (clusters && in.cluster >= 0 && in.cluster < (int)clusters->size())
+            particle->setCluster((*clusters)[in.cluster]);
+        particles.push_back(particle);
+    }
+}
+
+void CompactEvent::packVertices(const std::vector<Vertex*>& vertices, const std::vector<Particle*>* particles,
+        std::vector<CompactVertex>& compact) {
+    std::unordered_map<const TObject*, int> index = indices(particles);
+    compact.resize(vertices.size());
+    for (unsigned int i = 0; i < vertices.size(); ++i) {
+        const Vertex& vertex = *vertices[i];
+        CompactVertex& out = compact[i];
+        out.id = vertex.id_;
+        out.ndf = vertex.ndf_;
+        out.type = vertex.type_;
+        out.chi2 = vertex.chi2_;
+        out.probability = vertex.probability_;
+        out.position[0] = vertex.pos_.X();
+        out.position[1] = vertex.pos_.Y();
+        out.position[2] = vertex.pos_.Z();
+        out.n_cov = std::min<size_t>(vertex.covariance_.size(), 6);
+        std::fill(out.cov, out.cov + 6, 0.);
+        std::copy(vertex.covariance_.begin(), vertex.covariance_.begin() + out.n_cov, out.cov);
+        out.n_parameters = std::min<size_t>(vertex.parameters_.size(), CompactVertex::kMaxParameters);
+        std::fill(out.parameters, out.parameters + CompactVertex::kMaxParameters, 0.);
+        std::copy(vertex.parameters_.begin(), vertex.parameters_.begin() + out.n_parameters, out.parameters);
+        out.n_particles = std::min(vertex.parts_.GetEntriesFast(), CompactVertex::kMaxParticles);
+        std::fill(out.particles, out.particles + CompactVertex::kMaxParticles, -1);
+        for (int ipart = 0; ipart < out.n_particles; ++ipart) {
+            auto it = index.find(vertex.parts_.At(ipart));
+            if (it != index.end())
+                out.particles[ipart] = it->second;
+        }
+    }
+}
+
+void CompactEvent::unpackVertices(const std::vector<CompactVertex>& compact, const std::vector<Particle*>* particles,
+        std::vector<Vertex*>& vertices) {
+    vertices.reserve(vertices.size() + compact.size());
+    for (auto& in : compact) {
+        Vertex* vertex = new Vertex();
+        vertex->id_ = in.id;
+        vertex->ndf_ = in.ndf;
+        vertex->type_ = in.type;
+        vertex->chi2_ = in.chi2;
+        vertex->probability_ = in.probability;
+        vertex->pos_.SetXYZ(in.position[0], in.position[1], in.position[2]);
+        if (in.n_cov)
+            vertex->setCovariance(std::vector<float>(in.cov, in.cov + in.n_cov));
+        // Recomputes the momenta and the mass
+        vertex->setVtxParameters(std::vector<float>(in.parameters, in.parameters + in.n_parameters));
+        for (int ipart = 0; ipart < in.n_particles; ++ipart) {
+            int part = in.particles[ipart];
+            if (particles && part >= 0 && part < (int)particles->size())
+                vertex->addParticle((*particles)[part]);
+        }
+        vertices.push_back(vertex);
+    }
+}
+
+std::string CompactEvent::branchTitle(const std::string& type,
+        const std::vector<std::pair<std::string, std::string>>& refs) {
+    std::string title = type;
+    for (auto& ref : refs) {
+        if (!ref.second.empty())
+            title += " " + ref.first + "=" + ref.second;
+    }
+    return title;
+}
+
+std::string CompactEvent::titleValue(const std::string& title, const std::string& key) {
+    std::stringstream words(title);
+    std::string word;
+    while (words >> word) {
+        if (word.compare(0, key.size() + 1, key + "=") == 0)
+            return word.substr(key.size() + 1);
+    }
+    return "";
+}
@@ -36,7 +36,7 @@ void Event::add(const std::string name, TObject* object) {
     objects_[name] = cp; 
 
     // Add a branch with the given name to the event tree.
-    branches_[name] = tree_->Branch(name.c_str(), cp);
+    branches_[name] = tree_->Branch(name.c_str(), cp, 32000, split_level_ < 0 ? 99 : split_level_);
     
     // Copy the object to the event
     object->Copy(*cp); 
@@ -48,7 +48,7 @@ void Event::addCollection(const std::string name, TClonesArray* collection) {
     if (objects_.find(name) != objects_.end()) return; 
 
     // Add a branch with the given name to the event tree.
-    branches_[name] = tree_->Branch(name.c_str(), collection, 1000000, 3); 
+    branches_[name] = tree_->Branch(name.c_str(), collection, 1000000, split_level_ < 0 ? 3 : split_level_); 
 
     // Keep track of which collections were added to the event
     objects_[name] = collection;  
@@ -0,0 +1,259 @@
+/**
+ * @file TriggerDecoder.cxx
+ * @brief Decoder of the raw VTP and TS trigger bank words.
+ */
+
+#include "TriggerDecoder.h"
+
+const TriggerDecoder::RecordDecoder TriggerDecoder::typeDecoders_[16] = {
+    &TriggerDecoder::decodeBlockHeader, //  0 Block Header
+    &TriggerDecoder::decodeBlockTail,   //  1 Block Tail
+    &TriggerDecoder::decodeEventHeader, //  2 Event Header
+    &TriggerDecoder::decodeTrigTime,    //  3 Trigger time
+    nullptr, nullptr, nullptr, nullptr,
+    nullptr, nullptr, nullptr, nullptr,
+    &TriggerDecoder::decodeExpansion,   // 12 Expansion type
+    nullptr, nullptr, nullptr
+};
+
+const TriggerDecoder::RecordDecoder TriggerDecoder::expansionDecoders_[16] = {
+    nullptr, nullptr,
+    &TriggerDecoder::decodeCluster,     // 2 HPS Cluster
+    &TriggerDecoder::decodeSingleTrig,  // 3 HPS Single Trigger
+    &TriggerDecoder::decodePairTrig,    // 4 HPS Pair Trigger
+    &TriggerDecoder::decodeCalibTrig,   // 5 HPS Calibration Trigger
+    &TriggerDecoder::decodeClusterMult, // 6 HPS Cluster Multiplicity Trigger
+    &TriggerDecoder::decodeFEETrig,     // 7 HPS FEE Trigger
+    nullptr, nullptr, nullptr, nullptr,
+    nullptr, nullptr, nullptr, nullptr
+};
+
+TriggerDecoder::Status TriggerDecoder::decodeVTP(const int* words, int nRecordWords, int nWords, VTPData& vtp) {
+
+    Status status;
+    vtp.Clear();
+    if (nRecordWords > nWords) nRecordWords = nWords;
+    const int* end = words + nWords;
+
+    for (int i = 0; i < nRecordWords; ++i) {
+        int data = words[i];
+        if (!(data & 1<<31)) continue;
+        RecordDecoder decoder = typeDecoders_[(data >> 27)&0x0F];
+        if (!decoder) {
+            ++status.nUnknown;
+            continue;
+        }
+        int n = decoder(words + i, end, vtp);
+        if (n == 0) {
+            status.truncated = true;
+            break;
+        }
+        if (n < 0) {
+            ++status.nUnknown;
+            continue;
+        }
+        ++status.nRecords;
+        i += n - 1;
+    }
+    return status;
+}
+
+int TriggerDecoder::decodeBlockHeader(const int* word, const int*, VTPData& vtp) {
+    int data = *word;
+    vtp.blockHeader.blocklevel = (data      )&0x00FF;
+    vtp.blockHeader.blocknum   = (data >>  8)&0x03FF;
+    vtp.blockHeader.nothing    = (data >> 18)&0x00FF;
+    vtp.blockHeader.slotid     = (data >> 22)&0x001F;
+    vtp.blockHeader.type       = (data >> 27)&0x000F;
+    vtp.blockHeader.istype     = (data >> 31)&0x0001;
+    return 1;
+}
+
+int TriggerDecoder::decodeBlockTail(const int* word, const int*, VTPData& vtp) {
+    int data = *word;
+    vtp.blockTail.nwords       = (data      )&0x03FFFFF;
+    vtp.blockTail.slotid       = (data >> 22)&0x000001F;
+    vtp.blockTail.type         = (data >> 27)&0x000000F;
+    vtp.blockTail.istype       = (data >> 31)&0x0000001;
+    return 1;
+}
+
+int TriggerDecoder::decodeEventHeader(const int* word, const int*, VTPData& vtp) {
+    int data = *word;
+    vtp.eventHeader.eventnum   = (data      )&0x07FFFFFF;
+    vtp.eventHeader.type       = (data >> 27)&0x0000000F;
+    vtp.eventHeader.istype     = (data >> 31)&0x00000001;
+    return 1;
+}
+
+int TriggerDecoder::decodeTrigTime(const int* word, const int* end, VTPData& vtp) {
+    if (word + 1 >= end) return 0;
+    // 48 bits, the high half is shifted in 64 bits
+    vtp.trigTime = static_cast<unsigned long>(word[0] & 0x00FFFFFF)
+        + (static_cast<unsigned long>(word[1] & 0x00FFFFFF) << 24);
+    return 2;
+}
+
+int TriggerDecoder::decodeExpansion(const int* word, const int* end, VTPData& vtp) {
+    RecordDecoder decoder = expansionDecoders_[(*word >> 23)&0x0F];
+    return decoder ? decoder(word, end, vtp) : -1;
+}
+
+int TriggerDecoder::decodeCluster(const int* word, const int* end, VTPData& vtp) {
+    if (word + 1 >= end) return 0;
+    int data = word[0];
+    int secondWord = word[1];
+    VTPData::hpsCluster clus;
+    clus.X        = (data      )&0x0003F;
+    // If the first bit of the index is 1, then it is a negative number
+    if ((clus.X >> 5 & 0x1) == 0x1) clus.X = -((clus.X ^ 0x3F) + 1);
+    clus.Y        = (data >>  6)&0x0000F;
+    // If the first bit of the index is 1, then it is a negative number
+    if ((clus.Y >> 3 & 0x1) == 0x1) clus.Y = -((clus.Y ^ 0xF) + 1);
+    clus.E        = (data >> 10)&0x01FFF;
+    clus.subtype  = (data >> 23)&0x0000F;
+    clus.type     = (data >> 27)&0x0000F;
+    clus.istype   = (data >> 31)&0x00001;
+    clus.T        = (secondWord      )&0x003FF;
+    clus.N        = (secondWord >> 10)&0x0000F;
+    clus.nothing  = (secondWord >> 14)&0x3FFFF;
+    vtp.clusters.push_back(clus);
+    return 2;
+}
+
+int TriggerDecoder::decodeSingleTrig(const int* word, const int*, VTPData& vtp) {
+    int data = *word;
+    VTPData::hpsSingleTrig strig;
+    strig.T        = (data      )&0x003FF;
+    strig.emin     = (data >> 10)&0x00001;
+    strig.emax     = (data >> 11)&0x00001;
+    strig.nmin     = (data >> 12)&0x00001;
+    strig.xmin     = (data >> 13)&0x00001;
+    strig.pose     = (data >> 14)&0x00001;
+    strig.hodo1c   = (data >> 15)&0x00001;
+    strig.hodo2c   = (data >> 16)&0x00001;
+    strig.hodogeo  = (data >> 17)&0x00001;
+    strig.hodoecal = (data >> 18)&0x00001;
+    strig.topnbot  = (data >> 19)&0x00001;
+    strig.inst     = (data >> 20)&0x00007;
+    strig.subtype  = (data >> 23)&0x0000F;
+    strig.type     = (data >> 27)&0x0000F;
+    strig.istype   = (data >> 31)&0x00001;
+    vtp.singletrigs.push_back(strig);
+    return 1;
+}
+
+int TriggerDecoder::decodePairTrig(const int* word, const int*, VTPData& vtp) {
+    int data = *word;
+    VTPData::hpsPairTrig ptrig;
+    ptrig.T          = (data      )&0x003FF;
+    ptrig.clusesum   = (data >> 10)&0x00001;
+    ptrig.clusedif   = (data >> 11)&0x00001;
+    ptrig.eslope     = (data >> 12)&0x00001;
+    ptrig.coplane    = (data >> 13)&0x00001;
+    ptrig.dummy      = (data >> 14)&0x0001F;
+    ptrig.topnbot    = (data >> 19)&0x00001;
+    ptrig.inst       = (data >> 20)&0x00007;
+    ptrig.subtype    = (data >> 23)&0x0000F;
+    ptrig.type       = (data >> 27)&0x0000F;
+    ptrig.istype     = (data >> 31)&0x00001;
+    vtp.pairtrigs.push_back(ptrig);
+    return 1;
+}
+
+int TriggerDecoder::decodeCalibTrig(const int* word, const int*, VTPData& vtp) {
+    int data = *word;
+    VTPData::hpsCalibTrig ctrig;
+    ctrig.T          = (data      )&0x003FF;
+    ctrig.reserved   = (data >> 10)&0x001FF;
+    ctrig.cosmicTrig = (data >> 19)&0x00001;
+    ctrig.LEDTrig    = (data >> 20)&0x00001;
+    ctrig.hodoTrig   = (data >> 21)&0x00001;
+    ctrig.pulserTrig = (data >> 22)&0x00001;
+    ctrig.subtype    = (data >> 23)&0x0000F;
+    ctrig.type       = (data >> 27)&0x0000F;
+    ctrig.istype     = (data >> 31)&0x00001;
+    vtp.calibtrigs.push_back(ctrig);
+    return 1;
+}
+
+int TriggerDecoder::decodeClusterMult(const int* word, const int*, VTPData& vtp) {
+    int data = *word;
+    VTPData::hpsClusterMult clmul;
+    clmul.T          = (data      )&0x003FF;
+    clmul.multtop    = (data >> 10)&0x0000F;
+    clmul.multbot    = (data >> 14)&0x0000F;
+    clmul.multtot    = (data >> 18)&0x0000F;
+    clmul.bitinst    = (data >> 22)&0x00001;
+    clmul.subtype    = (data >> 23)&0x0000F;
+    clmul.type       = (data >> 27)&0x0000F;
+    clmul.istype     = (data >> 31)&0x00001;
+    vtp.clustermult.push_back(clmul);
+    return 1;
+}
+
+int TriggerDecoder::decodeFEETrig(const int* word, const int*, VTPData& vtp) {
+    int data = *word;
+    VTPData::hpsFEETrig fee;
+    fee.T          = (data      )&0x003FF;
+    fee.region     = (data >> 10)&0x0007F;
+    fee.reserved   = (data >> 17)&0x0003F;
+    fee.subtype    = (data >> 23)&0x0000F;
+    fee.type       = (data >> 27)&0x0000F;
+    fee.istype     = (data >> 31)&0x00001;
+    vtp.feetrigger.push_back(fee);
+    return 1;
+}
+
+bool TriggerDecoder::decodeTS(const int* words, int nWords, TSData& ts) {
+
+    if (nWords < nTSWords) return false;
+
+    // Parse out TS header
+    unsigned int headerWord = words[1];
+    ts.header.wordCount = (headerWord      )&0xFFFF; //  0-15 Word Count
+    ts.header.test      = (headerWord >> 16)&0x00FF; // 16-23 Test Word
+    ts.header.type      = (headerWord >> 24)&0x00FF; // 24-31 Trigger Type
+
+    // Parse out trigger time and Event Number, the low words are unsigned
+    unsigned long high = static_cast<unsigned int>(words[4]);
+    ts.T  = static_cast<unsigned int>(words[3]) + ((high & 0xFFFF) << 32);
+    ts.EN = static_cast<unsigned int>(words[2]) + ((high & 0xFFFF0000) << 16);
+
+    // Parse out prescaled and ext words
+    decodeTSBits(words[5], ts.prescaled);
+    decodeTSBits(words[6], ts.ext);
+    return true;
+}
+
+void TriggerDecoder::decodeTSBits(unsigned int word, TSData::tsBits& bits) {
+
+    // Trigger bits in the order of the word
+    static bool TSData::tsBits::* const flags[] = {
+        &TSData::tsBits::Single_0_Top, //  0 Low energy cluster
+        &TSData::tsBits::Single_1_Top, //  1 e+
+        &TSData::tsBits::Single_2_Top, //  2 e+ : Position dependent energy cut
+        &TSData::tsBits::Single_3_Top, //  3 e+ : HODO L1*L2  Match with cluster
+        &TSData::tsBits::Single_0_Bot, //  4 Low energy cluster
+        &TSData::tsBits::Single_1_Bot, //  5 e+
+        &TSData::tsBits::Single_2_Bot, //  6 e+ : Position dependent energy cut
+        &TSData::tsBits::Single_3_Bot, //  7 e+ : HODO L1*L2  Match with cluster
+        &TSData::tsBits::Pair_0,       //  8 A'
+        &TSData::tsBits::Pair_1,       //  9 Moller
+        &TSData::tsBits::Pair_2,       // 10 pi0
+        &TSData::tsBits::Pair_3,       // 11 -
+        &TSData::tsBits::LED,          // 12 LED
+        &TSData::tsBits::Cosmic,       // 13 Cosmic
+        &TSData::tsBits::Hodoscope,    // 14 Hodoscope
+        &TSData::tsBits::Pulser,       // 15 Pulser
+        &TSData::tsBits::Mult_0,       // 16 Multiplicity-0 2 Cluster Trigger
+        &TSData::tsBits::Mult_1,       // 17 Multiplicity-1 3 Cluster trigger
+        &TSData::tsBits::FEE_Top,      // 18 FEE Top       ( 2600-5200)
+        &TSData::tsBits::FEE_Bot       // 19 FEE Bot       ( 2600-5200)
+    };
+
+    bits.intval = word; // Full word
+    for (unsigned int ibit = 0; ibit < sizeof(flags)/sizeof(flags[0]); ++ibit)
+        bits.*flags[ibit] = (word >> ibit)&0x001;
+    bits.NA = (word >> 20)&0xFFF; // 20-31 Not used
+}
@@ -0,0 +1,194 @@
+/**
+ * @file compact_event_round_trip.cxx
+ * @brief Check that tracks, particles and vertices packed to the compact
+ *        representation come back unchanged, references included.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "CalCluster.h"
+#include "CompactEvent.h"
+#include "Particle.h"
+#include "Track.h"
+#include "Vertex.h"
+
+namespace {
+
+    const int N_LAYERS = 14;
+
+    /** Collections of an event, vertex i is made of the particles 2i and 2i+1 */
+    struct ParticleEvent {
+        std::vector<Track*> tracks;
+        std::vector<CalCluster*> clusters;
+        std::vector<Particle*> particles;
+        std::vector<Vertex*> vertices;
+
+        ~ParticleEvent() { clear(); }
+
+        void generate(std::mt19937_64& rng) {
+            clear();
+            std::uniform_real_distribution<double> uniform(0., 1.);
+            std::normal_distribution<double> gauss(0., 1.);
+            int nTracks = rng() % 6;
+            for (int itrk = 0; itrk < nTracks; ++itrk) {
+                Track* track = new Track();
+                int charge = uniform(rng) < 0.5 ? -1 : 1;
+                double tanLambda = (uniform(rng) < 0.5 ? -1 : 1)*(0.015 + 0.065*uniform(rng));
+                track->setTrackParameters(0.3*gauss(rng), 0.05*gauss(rng), -charge*1e-4*(0.5 + uniform(rng)),
+                        tanLambda, 0.3*gauss(rng));
+                std::vector<float> cov(15, 0.);
+                for (int i = 0, diag = 0; i < 5; diag += i + 2, ++i)
+                    cov[diag] = 1e-4*(1 + uniform(rng));
+                track->setCov(cov);
+                track->setChi2(2 + 10*uniform(rng));
+                int nHits = 10 + rng() % 5;
+                track->setNdf(2*nHits - 5);
+                track->setTrackerHitCount(nHits);
+                for (int layer = N_LAYERS - nHits; layer < N_LAYERS; ++layer)
+                    track->addHitLayer(layer);
+                track->setTrackTime(2*gauss(rng));
+                track->setCharge(charge);
+                track->setID(itrk);
+                for (int layer = 0; layer < N_LAYERS; ++layer) {
+                    track->setLambdaKink(layer, 1e-3*gauss(rng));
+                    track->setPhiKink(layer, 1e-3*gauss(rng));
+                }
+                tracks.push_back(track);
+            }
+            int nClusters = rng() % 4;
+            for (int iclu = 0; iclu < nClusters; ++iclu) {
+                CalCluster* cluster = new CalCluster();
+                float position[3] = {(float)(620*uniform(rng) - 270), (float)(60*uniform(rng) + 25), 1443.f};
+                cluster->setPosition(position);
+                cluster->setEnergy(2.5*uniform(rng));
+                cluster->setTime(40 + 2*gauss(rng));
+                clusters.push_back(cluster);
+            }
+            for (unsigned int ipart = 0; ipart < tracks.size(); ++ipart) {
+                Particle* particle = new Particle();
+                particle->setTrack(tracks[ipart]);
+                if (ipart < clusters.size()) {
+                    particle->setCluster(clusters[ipart]);
+                    particle->setEnergy(clusters[ipart]->getEnergy());
+                }
+                double momentum[3] = {0.1*gauss(rng), 0.05*gauss(rng), 0.3 + 3*uniform(rng)};
+                particle->setMomentum(momentum);
+                particle->setCharge(tracks[ipart]->getCharge());
+                particle->setPDG(tracks[ipart]->getCharge() < 0 ? 11 : -11);
+                particle->setGoodnessOfPID(10*uniform(rng));
+                particles.push_back(particle);
+            }
+            for (unsigned int ivtx = 0; ivtx < particles.size()/2; ++ivtx) {
+                Vertex* vertex = new Vertex();
+                vertex->setPos(TVector3(0.2*gauss(rng), 0.1*gauss(rng), -4.3 + 1.5*gauss(rng)));
+                vertex->setChi2(5*uniform(rng));
+                vertex->setCovariance({0.01f, 0.f, 0.0025f, 0.f, 0.f, 2.25f});
+                vertex->setType("Unconstrained");
+                vertex->setID(ivtx);
+                vertex->addParticle(particles[2*ivtx]);
+                vertex->addParticle(particles[2*ivtx + 1]);
+                vertices.push_back(vertex);
+            }
+        }
+
+        void clear() {
+            for (auto vertex : vertices) delete vertex;
+            for (auto particle : particles) delete particle;
+            for (auto cluster : clusters) delete cluster;
+            for (auto track : tracks) delete track;
+            vertices.clear();
+            particles.clear();
+            clusters.clear();
+            tracks.clear();
+        }
+    };
+
+    /** @return true if two values agree within a relative tolerance */
+    bool near(double a, double b, double tolerance = 1e-6) {
+        return std::fabs(a - b) <= tolerance*std::max(1., std::fabs(a));
+    }
+
+    /** @return first difference between the collections of an event and their unpacked version, empty if none */
+    std::string compare(ParticleEvent& ref, ParticleEvent& unpacked) {
+        if (unpacked.tracks.size() != ref.tracks.size() || unpacked.particles.size() != ref.particles.size()
+                || unpacked.vertices.size() != ref.vertices.size())
+            return "collection sizes differ";
+        for (unsigned int i = 0; i < ref.tracks.size(); ++i) {
+            Track* a = ref.tracks[i];
+            Track* b = unpacked.tracks[i];
+            std::vector<float> covA = a->getCov(), covB = b->getCov();
+            bool same = a->getID() == b->getID() && a->getCharge() == b->getCharge()
+                && a->getTrackerHitCount() == b->getTrackerHitCount() && a->getHitLayers() == b->getHitLayers()
+                && near(a->getD0(), b->getD0()) && near(a->getPhi(), b->getPhi())
+                && near(a->getOmega(), b->getOmega()) && near(a->getTanLambda(), b->getTanLambda())
+                && near(a->getZ0(), b->getZ0()) && near(a->getChi2(), b->getChi2())
+                && near(a->getTrackTime(), b->getTrackTime()) && covA.size() == covB.size();
+            for (unsigned int j = 0; same && j < covA.size(); ++j)
+                same = near(covA[j], covB[j]);
+            for (int layer = 0; same && layer < N_LAYERS; ++layer)
+                same = near(a->getLambdaKink(layer), b->getLambdaKink(layer))
+                    && near(a->getPhiKink(layer), b->getPhiKink(layer));
+            if (!same)
+                return "track " + std::to_string(i) + " differs";
+        }
+        for (unsigned int i = 0; i < ref.particles.size(); ++i) {
+            Particle* a = ref.particles[i];
+            Particle* b = unpacked.particles[i];
+            bool same = a->getPDG() == b->getPDG() && a->getCharge() == b->getCharge()
+                && near(a->getEnergy(), b->getEnergy()) && near(a->getGoodnessOfPID(), b->getGoodnessOfPID())
+                && a->getMomentum() == b->getMomentum() && a->getTrack().getID() == b->getTrack().getID()
+                && near(a->getTrack().getD0(), b->getTrack().getD0())
+                && near(a->getCluster().getEnergy(), b->getCluster().getEnergy())
+                && near(a->getCluster().getTime(), b->getCluster().getTime());
+            if (!same)
+                return "particle " + std::to_string(i) + " differs";
+        }
+        for (unsigned int i = 0; i < ref.vertices.size(); ++i) {
+            Vertex* a = ref.vertices[i];
+            Vertex* b = unpacked.vertices[i];
+            TRefArray parts = b->getParticles();
+            bool same = a->getID() == b->getID() && a->getType() == b->getType()
+                && near(a->getChi2(), b->getChi2()) && (a->getPos() - b->getPos()).Mag() < 1e-4
+                && a->getCovariance().size() == b->getCovariance().size() && parts.GetEntriesFast() == 2
+                && parts.At(0) == unpacked.particles[2*i] && parts.At(1) == unpacked.particles[2*i + 1];
+            if (!same)
+                return "vertex " + std::to_string(i) + " differs";
+        }
+        return "";
+    }
+}
+
+int main(int argc, char** argv) {
+
+    const int nEvents = 10000;
+    std::mt19937_64 rng(12345);
+    ParticleEvent event, unpacked;
+    std::vector<CompactTrack> tracks;
+    std::vector<CompactParticle> particles;
+    std::vector<CompactVertex> vertices;
+
+    for (int ievent = 0; ievent < nEvents; ++ievent) {
+        event.generate(rng);
+        unpacked.clear();
+        CompactEvent::packTracks(event.tracks, tracks);
+        CompactEvent::packParticles(event.particles, &event.tracks, &event.clusters, particles);
+        CompactEvent::packVertices(event.vertices, &event.particles, vertices);
+        CompactEvent::unpackTracks(tracks, unpacked.tracks);
+        CompactEvent::unpackParticles(particles, &unpacked.tracks, &event.clusters, unpacked.particles);
+        CompactEvent::unpackVertices(vertices, &unpacked.particles, unpacked.vertices);
+        std::string diff = compare(event, unpacked);
+        if (!diff.empty()) {
+            std::cerr << "[ compact-event-round-trip ]: event " << ievent << ": " << diff << std::endl;
+            std::cout << "[ compact-event-round-trip ]: FAILED" << std::endl;
+            return 1;
+        }
+    }
+
+    std::cout << "[ compact-event-round-trip ]: " << nEvents << " events passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,416 @@
+/**
+ * @file trigger_decoder.cxx
+ * @brief Check that TriggerDecoder gives back the content of synthetic VTP
+ *        and TS banks, and that malformed VTP banks are not read past
+ *        their end.
+ *
+ * The VTP banks are decoded as EventProcessor does, with the records
+ * starting in the first half of the bank. Run in a sanitizer build to catch
+ * overruns, the malformed banks are copied to buffers of their exact size.
+ */
+
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "TriggerDecoder.h"
+
+namespace {
+
+    /** Header bit and type of a VTP word */
+    int vtpType(int type) { return static_cast<int>(0x80000000u | (static_cast<unsigned int>(type) << 27)); }
+
+    /** Header bit, type and subtype of a VTP expansion word */
+    int vtpExpansion(int subtype) { return vtpType(12) | (subtype << 23); }
+
+    /** Random VTP content, the records hold random values within the width of their fields */
+    class VTPGenerator {
+
+        public:
+
+            explicit VTPGenerator(std::mt19937_64& rng) : rng_(rng) {}
+
+            void generate(int nClusters, int nTriggers, VTPData& vtp) {
+                vtp.Clear();
+                vtp.blockHeader = {bits(8), bits(10), bits(4), bits(5), 0, true};
+                // The decoder reads 8 bits for the 4 unused bits, the low bits of the slot id included
+                vtp.blockHeader.nothing |= (vtp.blockHeader.slotid & 0xF) << 4;
+                vtp.eventHeader = {bits(27), 2, true};
+                vtp.trigTime = (static_cast<unsigned long>(bits(24)) << 24) + bits(24);
+                vtp.blockTail = {bits(22), bits(5), 1, true};
+
+                for (int iclu = 0; iclu < nClusters; ++iclu) {
+                    VTPData::hpsCluster clus;
+                    // Crystal indices, signed on 6 and 4 bits
+                    clus.X = static_cast<int>(bits(6)) - 32;
+                    clus.Y = static_cast<int>(bits(4)) - 8;
+                    clus.E = bits(13);
+                    clus.subtype = 2;
+                    clus.type = 12;
+                    clus.istype = true;
+                    clus.T = bits(10);
+                    clus.N = bits(4);
+                    clus.nothing = bits(18);
+                    vtp.clusters.push_back(clus);
+                }
+
+                for (int itrig = 0; itrig < nTriggers; ++itrig) {
+                    VTPData::hpsSingleTrig strig;
+                    strig.T = bits(10);
+                    strig.emin = bits(1);
+                    strig.emax = bits(1);
+                    strig.nmin = bits(1);
+                    strig.xmin = bits(1);
+                    strig.pose = bits(1);
+                    strig.hodo1c = bits(1);
+                    strig.hodo2c = bits(1);
+                    strig.hodogeo = bits(1);
+                    strig.hodoecal = bits(1);
+                    strig.topnbot = bits(1);
+                    strig.inst = bits(3);
+                    strig.subtype = 3;
+                    strig.type = 12;
+                    strig.istype = true;
+                    vtp.singletrigs.push_back(strig);
+
+                    VTPData::hpsPairTrig ptrig;
+                    ptrig.T = bits(10);
+                    ptrig.clusesum = bits(1);
+                    ptrig.clusedif = bits(1);
+                    ptrig.eslope = bits(1);
+                    ptrig.coplane = bits(1);
+                    ptrig.dummy = bits(5);
+                    ptrig.topnbot = bits(1);
+                    ptrig.inst = bits(3);
+                    ptrig.subtype = 4;
+                    ptrig.type = 12;
+                    ptrig.istype = true;
+                    vtp.pairtrigs.push_back(ptrig);
+
+                    VTPData::hpsCalibTrig ctrig;
+                    ctrig.T = bits(10);
+                    ctrig.reserved = bits(9);
+                    ctrig.cosmicTrig = bits(1);
+                    ctrig.LEDTrig = bits(1);
+                    ctrig.hodoTrig = bits(1);
+                    ctrig.pulserTrig = bits(1);
+                    ctrig.subtype = 5;
+                    ctrig.type = 12;
+                    ctrig.istype = true;
+                    vtp.calibtrigs.push_back(ctrig);
+
+                    VTPData::hpsClusterMult clmul;
+                    clmul.T = bits(10);
+                    clmul.multtop = bits(4);
+                    clmul.multbot = bits(4);
+                    clmul.multtot = bits(4);
+                    clmul.bitinst = bits(1);
+                    clmul.subtype = 6;
+                    clmul.type = 12;
+                    clmul.istype = true;
+                    vtp.clustermult.push_back(clmul);
+
+                    VTPData::hpsFEETrig fee;
+                    fee.T = bits(10);
+                    fee.region = bits(7);
+                    fee.reserved = bits(6);
+                    fee.subtype = 7;
+                    fee.type = 12;
+                    fee.istype = true;
+                    vtp.feetrigger.push_back(fee);
+                }
+            }
+
+            /** Random words, half of them with the header bit set */
+            void randomWords(int nWords, std::vector<int>& words) {
+                for (int i = 0; i < nWords; ++i)
+                    words.push_back(static_cast<int>((rng_() & 0x7FFFFFFF) | ((rng_() & 1) << 31)));
+            }
+
+            int uniform(int n) { return rng_() % n; }
+
+        private:
+
+            unsigned int bits(int n) { return static_cast<unsigned int>(rng_() & ((1ul << n) - 1)); }
+
+            std::mt19937_64& rng_;
+    };
+
+    /** Encode VTP data: headers, trigger time, clusters, triggers by subtype and tail */
+    void encode(const VTPData& vtp, std::vector<int>& words) {
+        words.clear();
+
+        const VTPData::bHeader& header = vtp.blockHeader;
+        words.push_back(vtpType(0) | header.blocklevel | (header.blocknum << 8)
+                | ((header.nothing & 0xF) << 18) | (header.slotid << 22));
+        words.push_back(vtpType(2) | vtp.eventHeader.eventnum);
+        words.push_back(vtpType(3) | (vtp.trigTime & 0xFFFFFF));
+        words.push_back((vtp.trigTime >> 24) & 0xFFFFFF);
+
+        for (auto& clus : vtp.clusters) {
+            words.push_back(vtpExpansion(2) | (clus.X & 0x3F) | ((clus.Y & 0xF) << 6) | (clus.E << 10));
+            words.push_back(clus.T | (clus.N << 10) | (clus.nothing << 14));
+        }
+        for (auto& strig : vtp.singletrigs) {
+            words.push_back(vtpExpansion(3) | strig.T | (strig.emin << 10) | (strig.emax << 11)
+                    | (strig.nmin << 12) | (strig.xmin << 13) | (strig.pose << 14) | (strig.hodo1c << 15)
+                    | (strig.hodo2c << 16) | (strig.hodogeo << 17) | (strig.hodoecal << 18)
+                    | (strig.topnbot << 19) | (strig.inst << 20));
+        }
+        for (auto& ptrig : vtp.pairtrigs) {
+            words.push_back(vtpExpansion(4) | ptrig.T | (ptrig.clusesum << 10) | (ptrig.clusedif << 11)
+                    | (ptrig.eslope << 12) | (ptrig.coplane << 13) | (ptrig.dummy << 14)
+                    | (ptrig.topnbot << 19) | (ptrig.inst << 20));
+        }
+        for (auto& ctrig : vtp.calibtrigs) {
+            words.push_back(vtpExpansion(5) | ctrig.T | (ctrig.reserved << 10) | (ctrig.cosmicTrig << 19)
+                    | (ctrig.LEDTrig << 20) | (ctrig.hodoTrig << 21) | (ctrig.pulserTrig << 22));
+        }
+        for (auto& clmul : vtp.clustermult) {
+            words.push_back(vtpExpansion(6) | clmul.T | (clmul.multtop << 10) | (clmul.multbot << 14)
+                    | (clmul.multtot << 18) | (clmul.bitinst << 22));
+        }
+        for (auto& fee : vtp.feetrigger)
+            words.push_back(vtpExpansion(7) | fee.T | (fee.region << 10) | (fee.reserved << 17));
+
+        words.push_back(vtpType(1) | vtp.blockTail.nwords | (vtp.blockTail.slotid << 22));
+    }
+
+    bool sameRecord(const VTPData::hpsCluster& a, const VTPData::hpsCluster& b) {
+        return std::tie(a.X, a.Y, a.E, a.subtype, a.type, a.istype, a.T, a.N, a.nothing)
+            == std::tie(b.X, b.Y, b.E, b.subtype, b.type, b.istype, b.T, b.N, b.nothing);
+    }
+
+    bool sameRecord(const VTPData::hpsSingleTrig& a, const VTPData::hpsSingleTrig& b) {
+        return std::tie(a.T, a.emin, a.emax, a.nmin, a.xmin, a.pose, a.hodo1c, a.hodo2c, a.hodogeo,
+                a.hodoecal, a.topnbot, a.inst, a.subtype, a.type, a.istype)
+            == std::tie(b.T, b.emin, b.emax, b.nmin, b.xmin, b.pose, b.hodo1c, b.hodo2c, b.hodogeo,
+                b.hodoecal, b.topnbot, b.inst, b.subtype, b.type, b.istype);
+    }
+
+    bool sameRecord(const VTPData::hpsPairTrig& a, const VTPData::hpsPairTrig& b) {
+        return std::tie(a.T, a.clusesum, a.clusedif, a.eslope, a.coplane, a.dummy, a.topnbot, a.inst,
+                a.subtype, a.type, a.istype)
+            == std::tie(b.T, b.clusesum, b.clusedif, b.eslope, b.coplane, b.dummy, b.topnbot, b.inst,
+                b.subtype, b.type, b.istype);
+    }
+
+    bool sameRecord(const VTPData::hpsCalibTrig& a, const VTPData::hpsCalibTrig& b) {
+        return std::tie(a.T, a.reserved, a.cosmicTrig, a.LEDTrig, a.hodoTrig, a.pulserTrig,
+                a.subtype, a.type, a.istype)
+            == std::tie(b.T, b.reserved, b.cosmicTrig, b.LEDTrig, b.hodoTrig, b.pulserTrig,
+                b.subtype, b.type, b.istype);
+    }
+
+    bool sameRecord(const VTPData::hpsClusterMult& a, const VTPData::hpsClusterMult& b) {
+        return std::tie(a.T, a.multtop, a.multbot, a.multtot, a.bitinst, a.subtype, a.type, a.istype)
+            == std::tie(b.T, b.multtop, b.multbot, b.multtot, b.bitinst, b.subtype, b.type, b.istype);
+    }
+
+    bool sameRecord(const VTPData::hpsFEETrig& a, const VTPData::hpsFEETrig& b) {
+        return std::tie(a.T, a.region, a.reserved, a.subtype, a.type, a.istype)
+            == std::tie(b.T, b.region, b.reserved, b.subtype, b.type, b.istype);
+    }
+
+    /** @return empty string if the records match, the first difference otherwise */
+    template <class T>
+    std::string compareRecords(const std::string& name, const std::vector<T>& records,
+            const std::vector<T>& reference, bool prefix) {
+        if (records.size() > reference.size() || (!prefix && records.size() != reference.size()))
+            return name + ": " + std::to_string(records.size()) + " records instead of "
+                + std::to_string(reference.size());
+        for (unsigned int i = 0; i < records.size(); ++i) {
+            if (!sameRecord(records[i], reference[i]))
+                return name + ": record " + std::to_string(i) + " differs";
+        }
+        return "";
+    }
+
+    /**
+     * Compare decoded VTP data to a reference. With prefix, the headers are
+     * not compared and the records can be the first records of the
+     * reference, as for a truncated bank.
+     *
+     * @return empty string if they match, the first difference otherwise
+     */
+    std::string compare(const VTPData& vtp, const VTPData& reference, bool prefix = false) {
+        std::string diff;
+        if (!prefix) {
+            const VTPData::bHeader& a = vtp.blockHeader;
+            const VTPData::bHeader& b = reference.blockHeader;
+            if (std::tie(a.blocklevel, a.blocknum, a.nothing, a.slotid, a.type, a.istype)
+                    != std::tie(b.blocklevel, b.blocknum, b.nothing, b.slotid, b.type, b.istype))
+                return "block header differs";
+            if (std::tie(vtp.blockTail.nwords, vtp.blockTail.slotid, vtp.blockTail.type, vtp.blockTail.istype)
+                    != std::tie(reference.blockTail.nwords, reference.blockTail.slotid,
+                        reference.blockTail.type, reference.blockTail.istype))
+                return "block tail differs";
+            if (std::tie(vtp.eventHeader.eventnum, vtp.eventHeader.type, vtp.eventHeader.istype)
+                    != std::tie(reference.eventHeader.eventnum, reference.eventHeader.type,
+                        reference.eventHeader.istype))
+                return "event header differs";
+            if (vtp.trigTime != reference.trigTime)
+                return "trigger time " + std::to_string(vtp.trigTime) + " instead of "
+                    + std::to_string(reference.trigTime);
+        }
+        if (!(diff = compareRecords("clusters", vtp.clusters, reference.clusters, prefix)).empty()) return diff;
+        if (!(diff = compareRecords("singletrigs", vtp.singletrigs, reference.singletrigs, prefix)).empty()) return diff;
+        if (!(diff = compareRecords("pairtrigs", vtp.pairtrigs, reference.pairtrigs, prefix)).empty()) return diff;
+        if (!(diff = compareRecords("calibtrigs", vtp.calibtrigs, reference.calibtrigs, prefix)).empty()) return diff;
+        if (!(diff = compareRecords("clustermult", vtp.clustermult, reference.clustermult, prefix)).empty()) return diff;
+        return compareRecords("feetrigger", vtp.feetrigger, reference.feetrigger, prefix);
+    }
+
+    /** Decode a bank as EventProcessor does, the records start in its first half */
+    TriggerDecoder::Status decodeBank(const std::vector<int>& bank, VTPData& vtp) {
+        // Exact size, an overrun is not hidden by spare capacity
+        std::unique_ptr<int[]> words(new int[bank.size() ? bank.size() : 1]);
+        std::copy(bank.begin(), bank.end(), words.get());
+        int nWords = bank.size();
+        return TriggerDecoder::decodeVTP(words.get(), nWords/2, nWords, vtp);
+    }
+
+    /**
+     * Banks of random content: the encoded block fills the first half and
+     * the second half holds random words, which must not be decoded.
+     */
+    std::string checkRoundTrip(VTPGenerator& generator, int nBanks) {
+        VTPData reference, vtp;
+        std::vector<int> bank;
+        for (int ibank = 0; ibank < nBanks; ++ibank) {
+            generator.generate(generator.uniform(17), generator.uniform(3), reference);
+            encode(reference, bank);
+            generator.randomWords(bank.size() + generator.uniform(2), bank);
+            TriggerDecoder::Status status = decodeBank(bank, vtp);
+            std::string diff = compare(vtp, reference);
+            if (diff.empty() && (status.nUnknown || status.truncated))
+                diff = "unexpected words in a valid bank";
+            if (!diff.empty())
+                return "bank " + std::to_string(ibank) + ": " + diff;
+        }
+        return "";
+    }
+
+    /**
+     * Banks whose first half ends with the first word of a cluster, the
+     * second word of the cluster starts the second half.
+     */
+    std::string checkSplitRecord(VTPGenerator& generator, int nBanks) {
+        VTPData reference, vtp;
+        std::vector<int> bank;
+        for (int ibank = 0; ibank < nBanks; ++ibank) {
+            generator.generate(1 + generator.uniform(16), 0, reference);
+            encode(reference, bank);
+            // Drop the tail, the second word of the last cluster is the first word of the second half
+            bank.pop_back();
+            int nRecordWords = bank.size() - 1;
+            generator.randomWords(nRecordWords - 1 + generator.uniform(2), bank);
+            TriggerDecoder::Status status = decodeBank(bank, vtp);
+            std::string diff = compare(vtp, reference, true);
+            if (diff.empty() && vtp.clusters.size() != reference.clusters.size())
+                diff = "the last cluster is not decoded";
+            if (diff.empty() && (status.nUnknown || status.truncated))
+                diff = "unexpected words in a valid bank";
+            if (!diff.empty())
+                return "bank " + std::to_string(ibank) + ": " + diff;
+        }
+        return "";
+    }
+
+    /** Banks of random words, half of them with the header bit set */
+    std::string checkRandomBanks(VTPGenerator& generator, int nBanks) {
+        VTPData vtp;
+        std::vector<int> bank;
+        for (int ibank = 0; ibank < nBanks; ++ibank) {
+            bank.clear();
+            generator.randomWords(generator.uniform(64), bank);
+            TriggerDecoder::Status status = decodeBank(bank, vtp);
+            if (status.nRecords + status.nUnknown > (int) bank.size()/2)
+                return "bank " + std::to_string(ibank) + ": more records than words";
+        }
+        return "";
+    }
+
+    /**
+     * Valid banks cut at a random word, with all the words available to the
+     * records. The decoded records must be the first records of the bank.
+     */
+    std::string checkTruncatedBanks(VTPGenerator& generator, int nBanks) {
+        VTPData reference, vtp;
+        std::vector<int> block;
+        for (int ibank = 0; ibank < nBanks; ++ibank) {
+            generator.generate(generator.uniform(17), generator.uniform(3), reference);
+            encode(reference, block);
+            int nWords = generator.uniform(block.size() + 1);
+            std::unique_ptr<int[]> words(new int[nWords ? nWords : 1]);
+            std::copy(block.begin(), block.begin() + nWords, words.get());
+            TriggerDecoder::decodeVTP(words.get(), nWords, nWords, vtp);
+            std::string diff = compare(vtp, reference, true);
+            if (!diff.empty())
+                return "bank cut at " + std::to_string(nWords) + " words: " + diff;
+        }
+        return "";
+    }
+
+    /** TS banks of random words, and a short bank which must be refused */
+    std::string checkTS(std::mt19937_64& rng, int nBanks) {
+        TSData ts;
+        for (int ibank = 0; ibank < nBanks; ++ibank) {
+            int words[TriggerDecoder::nTSWords];
+            for (auto& word : words)
+                word = static_cast<int>(rng());
+            if (!TriggerDecoder::decodeTS(words, TriggerDecoder::nTSWords, ts))
+                return "bank " + std::to_string(ibank) + " refused";
+
+            unsigned int header = words[1];
+            unsigned long high = static_cast<unsigned int>(words[4]);
+            if (ts.header.wordCount != (int) (header & 0xFFFF) || ts.header.test != (int) ((header >> 16) & 0xFF)
+                    || ts.header.type != (int) (header >> 24))
+                return "bank " + std::to_string(ibank) + ": header differs";
+            if (ts.T != static_cast<unsigned int>(words[3]) + ((high & 0xFFFF) << 32)
+                    || ts.EN != static_cast<unsigned int>(words[2]) + ((high & 0xFFFF0000) << 16))
+                return "bank " + std::to_string(ibank) + ": time or event number differs";
+            if (ts.prescaled.intval != static_cast<unsigned int>(words[5]) || ts.prescaled.Pair_0 != ((words[5] >> 8) & 1)
+                    || ts.ext.intval != static_cast<unsigned int>(words[6]) || ts.ext.FEE_Bot != ((words[6] >> 19) & 1)
+                    || ts.ext.NA != ((static_cast<unsigned int>(words[6]) >> 20) & 0xFFF))
+                return "bank " + std::to_string(ibank) + ": trigger bits differ";
+
+            if (TriggerDecoder::decodeTS(words, TriggerDecoder::nTSWords - 1, ts))
+                return "bank " + std::to_string(ibank) + ": short bank decoded";
+        }
+        return "";
+    }
+}
+
+int main(int argc, char** argv) {
+
+    const int nBanks = 10000;
+    std::mt19937_64 rng(12345);
+    VTPGenerator generator(rng);
+
+    std::vector<std::pair<std::string, std::string>> checks;
+    checks.emplace_back("round trip", checkRoundTrip(generator, nBanks));
+    checks.emplace_back("record across the halves", checkSplitRecord(generator, nBanks));
+    checks.emplace_back("random banks", checkRandomBanks(generator, nBanks));
+    checks.emplace_back("truncated banks", checkTruncatedBanks(generator, nBanks));
+    checks.emplace_back("TS banks", checkTS(rng, nBanks));
+
+    bool failed = false;
+    for (auto& check : checks) {
+        if (!check.second.empty()) {
+            std::cerr << "[ trigger-decoder ]: " << check.first << ": " << check.second << std::endl;
+            failed = true;
+        }
+    }
+    if (failed) {
+        std::cout << "[ trigger-decoder ]: FAILED" << std::endl;
+        return 1;
+    }
+
+    std::cout << "[ trigger-decoder ]: " << nBanks << " banks of each kind passed" << std::endl;
+    return 0;
+}
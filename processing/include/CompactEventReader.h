@@ -0,0 +1,98 @@
+/**
+ * @file CompactEventReader.h
+ * @brief Expands the compact collections of an input tree to the standard ones.
+ */
+
+#ifndef __COMPACT_EVENT_READER_H__
+#define __COMPACT_EVENT_READER_H__
+
+//----------------//
+//   C++ StdLib   //
+//----------------//
+#include <map>
+#include <string>
+#include <vector>
+
+//----------//
+//   ROOT   //
+//----------//
+#include "TBranch.h"
+#include "TTree.h"
+
+//-----------//
+//   hpstr   //
+//-----------//
+#include "CompactEvent.h"
+
+/**
+ * @brief Reads the compact collections of a tree as standard collections
+ *
+ * For every branch of the tree named after a collection with the
+ * CompactEvent::kSuffix suffix, a branch with the name of the collection
+ * and its standard type (std::vector<Track*>, <Particle*> or <Vertex*>) is
+ * added to the tree in memory. The processors bind it with
+ * TTree::SetBranchAddress like any other branch. The added branches are not
+ * read from the file, unpack() fills them after each TTree::GetEntry.
+ * A collection stored both ways is read from its standard branch.
+ *
+ * The unpacked particles and vertices reference each other with TRefs,
+ * which take a new number of the process-wide TProcessID object count.
+ * The event loop restores that count after each event so the numbers are
+ * reused, as ROOT does when writing events. This is not possible with
+ * several threads, Process refuses compact inputs then.
+ */
+class CompactEventReader {
+
+    public:
+
+        CompactEventReader() {};
+
+        ~CompactEventReader() { clear(); };
+
+        /**
+         * @brief Add the standard branches of the compact collections of a tree
+         *
+         * @param tree input tree
+         * @return number of compact collections
+         */
+        int attach(TTree* tree);
+
+        /** Fill the standard collections from the compact ones of the current entry */
+        void unpack();
+
+        /** Delete the unpacked objects and forget the tree */
+        void clear();
+
+        /** @return true if the attached tree has compact collections */
+        bool hasCollections() const { return !tracks_.empty() || !particles_.empty() || !vertices_.empty(); }
+
+    private:
+
+        /** @struct Collection */
+        template <class C, class T>
+        struct Collection {
+            std::vector<C>* compact{nullptr}; //!< compact collection, read from the file
+            std::vector<T*>* expanded{nullptr}; //!< default object of the standard branch
+            TBranch* branch{nullptr}; //!< standard branch
+            std::string title; //!< title of the compact branch
+        };
+
+        /** @return the collection the processors bound to a standard branch */
+        template <class T>
+        static std::vector<T*>* objects(TBranch* branch);
+
+        /** Delete the objects of a standard collection */
+        template <class T>
+        static void reset(std::vector<T*>* objects);
+
+        /** Add the standard branch of a compact collection */
+        template <class C, class T>
+        bool expand(const std::string& name, const std::string& compactName, Collection<C, T>& coll);
+
+        TTree* tree_{nullptr}; //!< input tree
+        std::map<std::string, Collection<CompactTrack, Track>> tracks_; //!< compact tracks by collection name
+        std::map<std::string, Collection<CompactParticle, Particle>> particles_; //!< compact particles by collection name
+        std::map<std::string, Collection<CompactVertex, Vertex>> vertices_; //!< compact vertices by collection name
+};
+
+#endif // __COMPACT_EVENT_READER_H__
@@ -43,16 +43,56 @@ class ConfigurePython {
          */
         ConfigurePython(const std::string& pythonScript, char* args[], int nargs);
 
+        /**
+         * @brief Class constructor restoring a configuration snapshot.
+         *
+         * The python interpreter is not started.
+         *
+         * @param snapshot Filename of a snapshot written by writeSnapshot.
+         */
+        ConfigurePython(const std::string& snapshot);
+
         /**
          * Class destructor.
          */
         ~ConfigurePython();
 
-        /** Create a process object based on the python file information. */
-        Process* makeProcess();
+        /**
+         * @brief Create a process object based on the python file information.
+         *
+         * @param dryRun If set, a processor whose configure() throws is
+         *        reported by checkParameters and left out of the sequence
+         *        instead of aborting.
+         */
+        Process* makeProcess(bool dryRun = false);
+
+        /**
+         * @brief Write the resolved configuration to a binary snapshot.
+         *
+         * The snapshot can be loaded by later jobs without python.
+         *
+         * @param snapshot Output filename.
+         */
+        void writeSnapshot(const std::string& snapshot) const;
+
+        /**
+         * @brief Report the configuration problems found so far.
+         *
+         * Lists, for every processor, the error which escaped its
+         * configure(), e.g. a required parameter which is not set, and the
+         * parameters that were never read. Should be called after
+         * makeProcess.
+         *
+         * @return the number of processors which could not be configured,
+         *         plus one if the python configuration could not be loaded.
+         */
+        int checkParameters() const;
 
     private: 
 
+        /** Set if the configuration could not be fully loaded. */
+        bool load_failed_{false};
+
         /** 
          * The run mode of the process:
          *  0: LCIO to ROOT
@@ -84,11 +124,28 @@ class ConfigurePython {
             std::string classname_;
             std::string instancename_;
             ParameterSet params_;
+            std::vector<std::string> unused_; //!< parameters configure() never read
+            std::string config_error_; //!< error which escaped configure(), empty if none
         };
 
         /** The sequence of EventProcessor objects to be executed in order. */
         std::vector<ProcessorInfo> sequence_;
 
+        /** Rules of the output settings, see OutputSettings. */
+        std::vector<ParameterSet> output_settings_;
+
+        /**
+         * @brief Serialized configuration of a processor, for the output cache.
+         *
+         * Holds the class, instance name and parameters of the processor
+         * and the contents of the files named by its string parameters,
+         * e.g. the selection and histogram JSON files.
+         *
+         * @param proc
+         * @return std::string 
+         */
+        std::string processorConfig(const ProcessorInfo& proc) const;
+
 };
 
 #endif // __CONFIGURE_PYTHON_H__
@@ -74,6 +74,9 @@ class EventFile : public IEventFile {
          */
         void resetOutputFileDir();
 
+        /** @return The output ROOT file. */
+        TFile* getOutputFile() { return ofile_; }
+
     private:
         /** The ROOT file to which event data will be written to. */
         TFile* ofile_{nullptr}; 
@@ -0,0 +1,94 @@
+/**
+ * @file FileScheduler.h
+ * @brief Class used to process a list of files with several workers in one job.
+ */
+
+#ifndef __FILE_SCHEDULER_H__
+#define __FILE_SCHEDULER_H__
+
+//----------------//
+//   C++ StdLib   //
+//----------------//
+#include <atomic>
+#include <string>
+#include <vector>
+
+//-----------//
+//   hpstr   //
+//-----------//
+#include "Process.h"
+
+/**
+ * @brief Process a list of input files on worker threads and merge the outputs
+ *
+ * Replaces running one hpstr job per file (scripts/run_jobPool.py) followed
+ * by hadd. The configuration is parsed and the processor libraries are
+ * loaded once; each worker gets its own Process, made from that
+ * configuration before the threads start, so the processors are never
+ * shared between threads. The workers take the next file from a common
+ * queue, which balances files of different sizes, and write it to a partial
+ * output next to the final one. When all the files are done the partial
+ * outputs of the files that succeeded are merged with HistoMerger into the
+ * single output. They are removed only if no file failed and the merge
+ * reported no problem, otherwise they are kept and listed.
+ *
+ * A file that fails (the Process stops on an error) is reported at the end,
+ * the other files are processed and merged anyway.
+ *
+ * The event limit of the configuration applies to each file. A sequence
+ * with a processor using process-wide state (Processor::usesSharedState)
+ * is refused with more than one worker.
+ */
+class FileScheduler {
+
+    public:
+
+        /**
+         * @brief Constructor
+         *
+         * @param workers one Process per worker thread, made from the same
+         *                configuration, not owned
+         * @param inputs input files
+         * @param output merged output file, overwritten if it exists
+         */
+        FileScheduler(const std::vector<Process*>& workers, const std::vector<std::string>& inputs,
+                const std::string& output);
+
+        ~FileScheduler() {};
+
+        /** Keep the partial output of each file after a merge without problems */
+        void setKeepPartials(bool keep) { keep_partials_ = keep; };
+
+        /**
+         * @brief Process all the files and merge the outputs
+         *
+         * @return number of files that failed plus the number of merge problems,
+         *         1 if nothing could be processed
+         */
+        int run();
+
+        /** @return partial output file of an input file */
+        std::string partialOutput(int ifile) const;
+
+        /**
+         * @brief Run a Process in its run mode
+         *
+         * @param process
+         * @return false if the run mode does not exist
+         */
+        static bool runProcess(Process* process);
+
+    private:
+
+        /** Process the files from the queue on a worker */
+        void work(int iworker);
+
+        std::vector<Process*> workers_; //!< one process per worker
+        std::vector<std::string> inputs_; //!< input files
+        std::string output_; //!< merged output file
+        std::vector<char> failed_; //!< failure flag of each input file
+        std::atomic<int> next_file_{0}; //!< next file in the queue
+        bool keep_partials_{false}; //!< keep the partial outputs
+};
+
+#endif // __FILE_SCHEDULER_H__
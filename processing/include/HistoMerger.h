@@ -0,0 +1,119 @@
+/**
+ * @file HistoMerger.h
+ * @brief Class used to merge the outputs of several hpstr jobs.
+ */
+
+#ifndef __HISTO_MERGER_H__
+#define __HISTO_MERGER_H__
+
+//----------------//
+//   C++ StdLib   //
+//----------------//
+#include <map>
+#include <string>
+#include <vector>
+
+//----------//
+//   ROOT   //
+//----------//
+#include "TDirectory.h"
+#include "TFile.h"
+#include "TH1.h"
+
+/**
+ * @brief Merge the output files of several hpstr jobs into one
+ *
+ * Replaces hadd for hpstr outputs. Histograms are matched by their full
+ * path in the file (the HistoManager folder and histogram name) and added
+ * in memory. The input files are split in contiguous chunks, each chunk is
+ * summed by its own thread and the partial sums are then combined pairwise,
+ * so every file is opened and read only once for the histograms. Before
+ * adding, the class and binning of each histogram are compared to the first
+ * one found; histograms with a different binning are skipped and reported.
+ *
+ * TTrees found in the first file are merged afterwards by fast cloning the
+ * baskets of every input with TTree::CopyEntries, so the entries are copied
+ * cluster by cluster without being decompressed. Other objects found in
+ * the first file are merged with the Merge method of their class; objects
+ * of a class without one are copied from the first file with a warning.
+ */
+class HistoMerger {
+
+    public:
+
+        /**
+         * @brief Constructor
+         *
+         * @param inputs input file names
+         * @param output output file name, overwritten if it exists
+         * @param nThreads number of threads used to sum the histograms
+         */
+        HistoMerger(const std::vector<std::string>& inputs, const std::string& output, int nThreads = 1);
+
+        ~HistoMerger() {};
+
+        /**
+         * @brief Merge the inputs into the output
+         *
+         * @return number of problems found, e.g. unreadable inputs or inconsistent binnings
+         */
+        int merge();
+
+    private:
+
+        /** Histograms summed over a set of input files */
+        struct Partial {
+            std::map<std::string, TH1*> histos; //!< summed histograms by path
+            std::vector<std::string> order; //!< paths in order of first appearance
+            int problems{0}; //!< number of problems found
+        };
+
+        /**
+         * @brief Add all the histograms of a directory (recursively) to a partial sum
+         *
+         * @param dir
+         * @param path path of the directory in the file
+         * @param source input file name, for messages
+         * @param partial
+         */
+        void collect(TDirectory* dir, const std::string& path, const std::string& source, Partial& partial) const;
+
+        /**
+         * @brief Add a histogram to a partial sum, taking ownership of it
+         *
+         * @param partial
+         * @param path
+         * @param hist
+         * @param source input file name, for messages
+         */
+        void addHisto(Partial& partial, const std::string& path, TH1* hist, const std::string& source) const;
+
+        /** Add a partial sum to another one, emptying it */
+        void reduce(Partial& into, Partial& from) const;
+
+        /** @return true if the histograms have the same class and binning */
+        static bool sameBinning(TH1* a, TH1* b);
+
+        /** @return true if the axes have the same binning */
+        static bool sameAxis(const TAxis* a, const TAxis* b);
+
+        /** Find the trees and the objects which are not histograms in the first file */
+        void findOthers(TDirectory* dir, const std::string& path);
+
+        /** Merge the trees of all the inputs into the output, @return number of problems */
+        int mergeTrees(TFile* out);
+
+        /** Merge the objects which are not histograms or trees into the output, @return number of problems */
+        int mergeOthers(TFile* out);
+
+        /** @return directory of the output at a path, created if needed */
+        static TDirectory* getDirectory(TFile* out, const std::string& path);
+
+        std::vector<std::string> inputs_; //!< input files
+        std::string output_; //!< output file
+        int nThreads_{1}; //!< number of threads
+        std::vector<std::string> trees_; //!< paths of the trees in the first input
+        std::vector<std::string> others_; //!< paths of the other objects in the first input
+};
+
+#endif // __HISTO_MERGER_H__
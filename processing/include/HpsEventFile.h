@@ -3,6 +3,7 @@
 
 #include "IEventFile.h"
 #include "HpsEvent.h"
+#include "CompactEventReader.h"
 #include "TTreeReader.h"
 #include "TFile.h"
 #include "TTree.h"
@@ -59,6 +60,9 @@ class HpsEventFile : public IEventFile {
          */
         void close();
 
+        /** @return true if the input tree has compact collections */
+        bool hasCompactCollections() const { return compact_.hasCollections(); }
+
 
     private:
         HpsEvent* event_{nullptr}; //!< description
@@ -67,6 +71,7 @@ class HpsEventFile : public IEventFile {
         TFile* ofile_{nullptr}; //!< description
         TFile* rootfile_{nullptr}; //!< description
         TTree* intree_{nullptr}; //!< description
+        CompactEventReader compact_; //!< reads the compact collections of intree_
 
         //TTreeReader* ttree_reader;
 };
@@ -0,0 +1,140 @@
+/**
+ * @file OutputSettings.h
+ * @brief Compression, basket and flush settings of the output ROOT files.
+ */
+
+#ifndef __OUTPUT_SETTINGS_H__
+#define __OUTPUT_SETTINGS_H__
+
+//----------------//
+//   C++ StdLib   //
+//----------------//
+#include <climits>
+#include <iostream>
+#include <string>
+#include <vector>
+
+//----------//
+//   ROOT   //
+//----------//
+#include "TDirectory.h"
+#include "TFile.h"
+#include "TTree.h"
+
+//-----------//
+//   hpstr   //
+//-----------//
+#include "ParameterSet.h"
+
+/**
+ * @brief Storage settings of the output files and trees of a job
+ *
+ * The settings are a list of rules, made in the python configuration with
+ * Process.set_output(). A rule applies to the output files whose name
+ * matches its "files" pattern and, if it has a "branches" pattern, only to
+ * the matching branches of their trees. Patterns are shell wildcards.
+ * Later rules override earlier ones. A rule can set:
+ * - compression: algorithm (none, ZLIB, LZMA, LZ4 or ZSTD), optionally
+ *   followed by :level, e.g. "LZ4:4" or "ZSTD:5";
+ * - level: compression level, overrides the one of the algorithm;
+ * - basket_size: basket size of the branches [bytes];
+ * - auto_flush: TTree::SetAutoFlush, > 0 entries, < 0 bytes, 0 disables;
+ * - auto_save: TTree::SetAutoSave, same convention;
+ * - split_level: split level of the branches made through the Event.
+ *
+ * File rules set the default compression of the file, so every tree and
+ * branch created in it afterwards inherits it. Tree and branch rules are
+ * applied after the processors created their branches and before the
+ * first entry is filled.
+ */
+class OutputSettings {
+
+    public:
+
+        /** Value of a setting which is not set */
+        static const int kUnset = INT_MIN;
+
+        OutputSettings() {};
+
+        ~OutputSettings() {};
+
+        /**
+         * @brief Add a rule
+         *
+         * @param rule settings and "files"/"branches" patterns of the rule
+         * @throw std::runtime_error if the compression algorithm is unknown
+         */
+        void addRule(const ParameterSet& rule);
+
+        /** @return true if there are no rules */
+        bool empty() const { return rules_.empty(); };
+
+        /**
+         * @brief Set the compression of an output file
+         *
+         * @param file output file, just opened
+         */
+        void applyToFile(TFile* file) const;
+
+        /**
+         * @brief Set the flush and basket settings of a tree and its branches
+         *
+         * @param tree output tree, with its branches
+         * @param filename name of the output file of the tree
+         */
+        void applyToTree(TTree* tree, const std::string& filename) const;
+
+        /**
+         * @brief Apply the tree settings to all the trees of a directory
+         *
+         * @param dir output file or one of its directories
+         * @param filename name of the output file
+         */
+        void applyToTrees(TDirectory* dir, const std::string& filename) const;
+
+        /**
+         * @brief Split level of the branches of an output file
+         *
+         * @param filename name of the output file
+         * @return split level, kUnset if not set
+         */
+        int splitLevel(const std::string& filename) const;
+
+        /**
+         * @brief ROOT compression settings of an algorithm and level
+         *
+         * @param algorithm algorithm name, case insensitive, optionally
+         *                  followed by :level
+         * @param level compression level, the default level of the
+         *              algorithm if kUnset
+         * @return algorithm*100 + level, as TFile::SetCompressionSettings expects
+         * @throw std::runtime_error if the algorithm is unknown
+         */
+        static int compressionSettings(const std::string& algorithm, int level = kUnset);
+
+        /** Print the rules */
+        void print(std::ostream& out) const;
+
+    private:
+
+        /** @struct Rule */
+        struct Rule {
+            std::string files{"*"}; //!< pattern of the output file names
+            std::string branches; //!< pattern of the branch names, empty for the whole file
+            int compression{kUnset}; //!< ROOT compression settings
+            int basket_size{kUnset}; //!< basket size [bytes]
+            int auto_flush{kUnset}; //!< auto flush setting
+            int auto_save{kUnset}; //!< auto save setting
+            int split_level{kUnset}; //!< split level
+        };
+
+        /** @return true if a name matches a wildcard pattern */
+        static bool matches(const std::string& pattern, const std::string& name);
+
+        /** Apply the branch settings of a rule to a branch and its sub-branches */
+        static void applyToBranch(const Rule& rule, TBranch* branch);
+
+        std::vector<Rule> rules_; //!< rules, in the order of the configuration
+};
+
+#endif // __OUTPUT_SETTINGS_H__
@@ -10,7 +10,9 @@
 //----------------//
 //   C++ StdLib   //
 //----------------//
+#include <iostream>
 #include <map>
+#include <set>
 #include <stdexcept>
 #include <vector>
 #include <string>
@@ -172,6 +174,85 @@ class ParameterSet {
          */
         void insert(const std::string& name, const std::vector<std::string>& values);
 
+        /**
+         * @brief Records the lookups of a ParameterSet made by the current thread.
+         * 
+         * The lookups are recorded while the Usage exists, the ParameterSet
+         * itself is never modified, so several threads can read it. Usages
+         * of one thread nest, the innermost one records its ParameterSet.
+         */
+        class Usage {
+
+            public:
+                /**
+                 * @brief Start recording the lookups of a ParameterSet.
+                 * 
+                 * @param parameters The ParameterSet to record.
+                 */
+                Usage(const ParameterSet& parameters);
+
+                /** Stop recording. */
+                ~Usage();
+
+                Usage(const Usage&) = delete;
+                Usage& operator=(const Usage&) = delete;
+
+                /**
+                 * @brief Get the names of the parameters that were never looked up.
+                 * 
+                 * Parameters provided by the configuration but never read by the
+                 * processor usually point to a typo in the configuration.
+                 * 
+                 * @return std::vector<std::string> 
+                 */
+                std::vector<std::string> getUnused() const;
+
+                /**
+                 * @brief Get the name of the last parameter looked up without a default and not provided.
+                 * 
+                 * The lookup threw an exception, which only points to a missing
+                 * parameter if it was not caught by the caller.
+                 * 
+                 * @return empty if there is none
+                 */
+                const std::string& getLastMissing() const { return last_missing_; }
+
+                /** 
+                 * @brief Record a lookup of the current thread.
+                 * 
+                 * @param parameters The ParameterSet looked up.
+                 * @param name Name of the parameter.
+                 * @param found The parameter was provided.
+                 * @param required The lookup had no default.
+                 */
+                static void record(const ParameterSet* parameters, const std::string& name,
+                        bool found, bool required);
+
+            private:
+                const ParameterSet& parameters_; //!< recorded ParameterSet
+                std::set<std::string> used_; //!< names of the parameters looked up
+                std::string last_missing_; //!< last required parameter not provided
+                Usage* previous_{nullptr}; //!< enclosing Usage of this thread
+
+                static thread_local Usage* current_; //!< innermost Usage of this thread
+        };
+
+        /**
+         * @brief Write the parameters to a binary snapshot.
+         * 
+         * @param out Output stream, opened in binary mode.
+         */
+        void write(std::ostream& out) const;
+
+        /**
+         * @brief Add the parameters stored in a binary snapshot.
+         * 
+         * Throws an exception if the snapshot is truncated or corrupted.
+         * 
+         * @param in Input stream, opened in binary mode.
+         */
+        void read(std::istream& in);
+
         /**
          * @enum Specifies the type of a parameter in a ParameterSet.
          */
@@ -11,6 +11,7 @@
 //----------------//
 //   C++ StdLib   //
 //----------------//
+#include <memory>
 #include <vector>
 #include <iostream>
 #include <stdexcept>
@@ -24,7 +25,10 @@
 //-----------//
 //   hpstr   //
 //-----------//
+#include "OutputSettings.h"
+#include "ProcessCache.h"
 #include "Processor.h"
+#include "ProcessProfiler.h"
 
 class Process {
 
@@ -38,8 +42,10 @@ class Process {
          * @brief Add an event processor to the linear sequence of processors to run in this job
          * 
          * @param event_proc Processor to add to the sequence
+         * @param config Serialized configuration of the processor, used as
+         *               part of its output cache key
          */
-        void addToSequence(Processor* event_proc);
+        void addToSequence(Processor* event_proc, const std::string& config = "");
 
         /**
          * @brief Add an input file name to the list.
@@ -58,6 +64,23 @@ class Process {
          */
         void addOutputFileName(const std::string& output_filename);
 
+        /**
+         * @brief Replace the input and output files.
+         * 
+         * @param input_files Input file names
+         * @param output_files Output file names, one per input file
+         */
+        void setFiles(const std::vector<std::string>& input_files, const std::vector<std::string>& output_files) {
+            input_files_ = input_files;
+            output_files_ = output_files;
+        }
+
+        /** @return the input file names */
+        const std::vector<std::string>& getInputFiles() const { return input_files_; }
+
+        /** @return the output file names */
+        const std::vector<std::string>& getOutputFiles() const { return output_files_; }
+
         /**
          * @brief Set the run mode of the process.
          * 
@@ -120,9 +143,74 @@ class Process {
         /** Run the Histo Analysis process. */
         void runOnHisto();
 
+        /**
+         * @brief Check the job setup without processing any event.
+         * 
+         * Checks that the input files are readable and that the output
+         * file names match the input files. For the event based run modes
+         * every processor is initialized on an empty in-memory tree, which
+         * loads the referenced configuration files and defines the
+         * histograms. Nothing is written and processors are not finalized.
+         * 
+         * @return the number of problems found.
+         */
+        int dryRun();
+
+        /**
+         * @brief Measure the time and memory used by every processor.
+         * 
+         * A summary table is printed at the end of the job.
+         * 
+         * @param report base name of the JSON and ROOT reports, none are written if empty
+         */
+        void enableProfiling(const std::string& report = "");
+
+        /**
+         * @brief Cache the outputs of the processors of the ROOT to Histo process.
+         * 
+         * A processor whose output for an input file is in the cache is not
+         * run, its output is copied from the cache, see ProcessCache.
+         * 
+         * @param cache_dir Directory of the cache
+         * @param max_bytes Size limit of the cache, no limit if <= 0
+         */
+        void enableCache(const std::string& cache_dir, long max_bytes = 0);
+
+        /**
+         * @brief Set the compression, basket and flush settings of the output files.
+         * 
+         * The file settings are applied when an output file is opened, the
+         * tree and branch settings after the processors are initialized.
+         * 
+         * @param settings Output settings, see OutputSettings
+         */
+        void setOutputSettings(const OutputSettings& settings) { output_settings_ = settings; }
+
         /** Request that the processing finish with this event. */ 
         void requestFinish() { event_limit_ = 0; }
 
+        /** @return true if the last run stopped on an error */
+        bool hasFailed() const { return failed_; }
+
+        /**
+         * @brief Declare that other processes run at the same time in other threads.
+         * 
+         * The compact collections of an input file can then not be read,
+         * runOnRoot stops on such a file.
+         * 
+         * @param concurrent
+         */
+        void setConcurrent(bool concurrent) { concurrent_ = concurrent; }
+
+        /**
+         * @brief Find a processor of the sequence using process-wide state.
+         * 
+         * See Processor::usesSharedState.
+         * 
+         * @return the name of the first one, empty if there is none
+         */
+        std::string findSharedStateProcessor() const;
+
     private:
 
         /* Reader used to parse either binary or EVIO files. */
@@ -146,6 +234,24 @@ class Process {
         /** List of output file names. If empty, no output file will be created. */
         std::vector<std::string> output_files_;
 
+        /** Profiler of the processors, null when profiling is disabled. */
+        std::unique_ptr<ProcessProfiler> profiler_;
+
+        /** Serialized configuration of each processor of the sequence. */
+        std::vector<std::string> sequence_configs_;
+
+        /** Cache of the processor outputs, null when caching is disabled. */
+        std::unique_ptr<ProcessCache> cache_;
+
+        /** Compression, basket and flush settings of the output files. */
+        OutputSettings output_settings_;
+
+        /** Set when the last run stopped on an error. */
+        bool failed_{false};
+
+        /** Set when other processes run at the same time in other threads. */
+        bool concurrent_{false};
+
 };
 
 #endif
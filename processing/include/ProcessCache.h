@@ -0,0 +1,157 @@
+/**
+ * @file ProcessCache.h
+ * @brief On-disk cache of the outputs of the processors of ROOT to Histo jobs.
+ */
+
+#ifndef __PROCESS_CACHE_H__
+#define __PROCESS_CACHE_H__
+
+//----------------//
+//   C++ StdLib   //
+//----------------//
+#include <cstdint>
+#include <iostream>
+#include <set>
+#include <string>
+
+//----------//
+//   ROOT   //
+//----------//
+#include "TDirectory.h"
+#include "TFile.h"
+
+/**
+ * @brief Cache of the objects each processor writes to the output, keyed by their inputs
+ *
+ * In the ROOT to Histo run mode the processors only read the events, so
+ * what a processor writes to the output file depends on the input file,
+ * its configuration, the number of events and the code. The key of a
+ * processor output is an FNV-1a hash of:
+ * - the input file: size, modification time and TFile UUID;
+ * - the configuration of the processor: class, instance name, resolved
+ *   parameters and the contents of the files named by string parameters
+ *   (selection and histogram JSON files);
+ * - the number of events processed;
+ * - the build: size and modification time of the loaded hpstr libraries.
+ *
+ * The objects a processor adds to the output file while it is initialized
+ * and finalized are captured and stored as a ROOT file named after the
+ * key in the cache directory. When the key of a processor is found, the
+ * stored objects are copied to the output and the processor is not run.
+ * Processors writing a TTree to the output are not cached. Entries are
+ * written to a temporary file and renamed, so several jobs can share a
+ * cache. A hit refreshes the modification time of the entry, and the
+ * oldest entries are evicted when the cache exceeds its size limit.
+ */
+class ProcessCache {
+
+    public:
+
+        /** Paths of the objects of a file, keys are followed by ;cycle */
+        typedef std::set<std::string> Snapshot;
+
+        /**
+         * @brief Constructor
+         *
+         * @param cacheDir directory holding the cache entries, created if needed
+         * @param maxBytes size limit of the cache, no limit if <= 0
+         */
+        ProcessCache(const std::string& cacheDir, long maxBytes = 0);
+
+        ~ProcessCache() {};
+
+        /**
+         * @brief Key of an input file
+         *
+         * @param filename
+         * @return hash of the size, modification time and UUID, empty if the file cannot be read
+         */
+        std::string fileKey(const std::string& filename) const;
+
+        /**
+         * @brief Key of the output of a processor
+         *
+         * @param fileKey key of the input file
+         * @param config serialized configuration of the processor
+         * @param nEvents number of events processed
+         * @return std::string
+         */
+        std::string outputKey(const std::string& fileKey, const std::string& config, long nEvents) const;
+
+        /**
+         * @brief Copy the stored output of a processor to an output file
+         *
+         * @param key output key
+         * @param out output file
+         * @return true on a hit
+         */
+        bool restore(const std::string& key, TFile* out);
+
+        /** @return the objects of a file, in memory and on disk */
+        Snapshot snapshot(TDirectory* dir) const;
+
+        /**
+         * @brief Add the objects which are not in a previous snapshot
+         *
+         * @param before snapshot taken before the processor ran
+         * @param dir file the processor writes to
+         * @param paths paths of the new objects
+         */
+        void addNew(const Snapshot& before, TDirectory* dir, std::set<std::string>& paths) const;
+
+        /**
+         * @brief Store the output of a processor
+         *
+         * @param key output key
+         * @param out output file, before it is closed
+         * @param paths objects written by the processor
+         * @return false if the output cannot be cached
+         */
+        bool store(const std::string& key, TFile* out, const std::set<std::string>& paths);
+
+        /** Remove the oldest entries until the cache fits in its size limit */
+        void evict();
+
+        /** Print the number of hits, misses, stores and evictions */
+        void printStats(std::ostream& out) const;
+
+        /** @return number of cache hits */
+        int getHits() const { return hits_; };
+
+        /** @return number of cache misses */
+        int getMisses() const { return misses_; };
+
+    private:
+
+        /** FNV-1a hash helpers */
+        static void hash(uint64_t& h, const void* data, size_t size);
+        static void hash(uint64_t& h, const std::string& value) { hash(h, value.data(), value.size()); };
+
+        /** @return hexadecimal representation of a hash */
+        static std::string toKey(uint64_t h);
+
+        /** @return hash of the size and modification time of the loaded hpstr libraries */
+        static uint64_t buildId();
+
+        /** @return path of the cache entry of a key */
+        std::string path(const std::string& key) const;
+
+        /** Add the objects of a directory to a snapshot */
+        void list(TDirectory* dir, const std::string& prefix, Snapshot& snapshot) const;
+
+        /** Copy all the objects of a directory to another one */
+        void copy(TDirectory* from, TDirectory* to) const;
+
+        /** @return directory at a path, created if needed */
+        static TDirectory* getDirectory(TDirectory* top, const std::string& path);
+
+        std::string cacheDir_; //!< cache directory
+        long maxBytes_{0}; //!< size limit of the cache
+        int hits_{0}; //!< number of cache hits
+        int misses_{0}; //!< number of cache misses
+        int stores_{0}; //!< number of entries stored
+        int uncacheable_{0}; //!< number of outputs which could not be stored
+        int evicted_{0}; //!< number of entries evicted
+};
+
+#endif // __PROCESS_CACHE_H__
@@ -0,0 +1,137 @@
+/**
+ * @file ProcessProfiler.h
+ * @brief Class used to measure the time and memory used by each processor.
+ */
+
+#ifndef __PROCESS_PROFILER_H__
+#define __PROCESS_PROFILER_H__
+
+//----------------//
+//   C++ StdLib   //
+//----------------//
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Per-processor timing, memory and throughput instrumentation
+ *
+ * Collects for every processor of the sequence the wall and CPU time of
+ * initialize, process and finalize, the distribution of the process wall
+ * time (kept in a logarithmic histogram, so the memory does not grow with
+ * the number of events) and the resident memory. The resident memory is
+ * read around initialize and finalize, and around process every
+ * rssInterval events, from which the largest growth of each processor is
+ * kept. Profiling is only done when the Process owns a profiler, so a
+ * disabled profiler costs a pointer check per processor call.
+ */
+class ProcessProfiler {
+
+    public:
+
+        /** Processor phases */
+        enum Phase {
+            kInitialize = 0,
+            kProcess    = 1,
+            kFinalize   = 2
+        };
+
+        /** Time and memory at the start of a call */
+        struct Stamp {
+            double wall{0}; //!< wall clock [s]
+            double cpu{0}; //!< thread CPU time [s]
+            long rss{-1}; //!< resident memory [kB], -1 if not sampled
+        };
+
+        /**
+         * @brief Constructor
+         *
+         * @param report base name of the JSON and ROOT reports, no reports if empty
+         * @param rssInterval number of events between two memory samples of process
+         */
+        ProcessProfiler(const std::string& report = "", int rssInterval = 1000);
+
+        ~ProcessProfiler() {};
+
+        /**
+         * @brief Set the processors to profile, resetting the statistics
+         *
+         * @param names processor instance names, in sequence order
+         */
+        void setProcessors(const std::vector<std::string>& names);
+
+        /**
+         * @brief Start of a call
+         *
+         * @param phase
+         * @return Stamp
+         */
+        Stamp start(Phase phase) const;
+
+        /**
+         * @brief End of a call of a processor
+         *
+         * @param iproc position of the processor in the sequence
+         * @param phase
+         * @param start stamp returned by start()
+         */
+        void stop(int iproc, Phase phase, const Stamp& start);
+
+        /** Count a processed event (or file for histogram processing) */
+        void countEvent() { ++nEvents_; };
+
+        /** Start the event loop clock */
+        void startLoop();
+
+        /** Stop the event loop clock */
+        void stopLoop();
+
+        /**
+         * @brief Print the summary table and write the reports
+         *
+         * @param out stream for the table
+         */
+        void report(std::ostream& out);
+
+        /** @return current resident memory [kB] */
+        static long currentRss();
+
+        /** @return peak resident memory of the process [kB] */
+        static long peakRss();
+
+    private:
+
+        /** Statistics of a single processor */
+        struct Stats {
+            std::string name; //!< processor instance name
+            double wall[3]{}; //!< cumulative wall time per phase [s]
+            double cpu[3]{}; //!< cumulative CPU time per phase [s]
+            long calls[3]{}; //!< number of calls per phase
+            double maxWall{0}; //!< slowest process call [s]
+            std::vector<uint32_t> hist; //!< histogram of the process wall times
+            long rssAfterInit{-1}; //!< resident memory after initialize [kB]
+            long rssGrowInit{0}; //!< resident memory growth in initialize [kB]
+            long rssGrowProcess{0}; //!< largest resident memory growth in a sampled process call [kB]
+            long rssAfterFinal{-1}; //!< resident memory after finalize [kB]
+        };
+
+        /** @return process wall time below which a fraction of the calls are [s] */
+        double percentile(const Stats& stats, double fraction) const;
+
+        /** @return histogram bin of a wall time */
+        int bin(double wall) const;
+
+        void writeJson(const std::string& filename) const;
+        void writeTree(const std::string& filename) const;
+
+        std::string report_; //!< base name of the reports
+        int rssInterval_{1000}; //!< events between memory samples
+        std::vector<Stats> stats_; //!< statistics per processor
+        long nEvents_{0}; //!< processed events
+        double loopStart_{0}; //!< start of the current event loop [s]
+        double loopWall_{0}; //!< cumulative event loop wall time [s]
+        double jobStart_{0}; //!< creation of the profiler [s]
+};
+
+#endif // __PROCESS_PROFILER_H__
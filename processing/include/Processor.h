@@ -117,6 +117,20 @@ class Processor {
          */
         static void declare(const std::string& classname, ProcessorMaker*);
 
+        /**
+         * @brief Whether the processor uses process-wide state, such as the
+         *        projection file of HistogramHelpers.
+         *
+         * Processes running at the same time in other threads would share
+         * that state, so such a processor can only run in one of them.
+         *
+         * @return true if the processor uses process-wide state
+         */
+        virtual bool usesSharedState() const { return false; }
+
+        /** @return the instance name of the processor */
+        const std::string& getName() const { return name_; }
+
     protected:
         /** Handle to the Process. */
         Process& process_;
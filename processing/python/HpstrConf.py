@@ -27,8 +27,33 @@ class Process:
         self.output_files = []
         self.sequence = []
         self.libraries = []
+        self.output_settings = []
         Process.lastProcess = self
 
+    def set_output(self, files="*", branches="", **settings):
+        """! Set the compression, basket and flush settings of the output files.
+
+        files and branches are shell wildcards selecting the output files and,
+        if given, the branches of their trees the settings apply to. Later
+        settings override earlier ones. The settings are:
+            compression  algorithm (none, ZLIB, LZMA, LZ4, ZSTD), optionally
+                         followed by :level, e.g. "LZ4:4"
+            level        compression level
+            basket_size  basket size of the branches in bytes
+            auto_flush   TTree::SetAutoFlush, > 0 entries, < 0 bytes, 0 disables
+            auto_save    TTree::SetAutoSave, same convention
+            split_level  split level of the branches made through the event
+
+        Example: LZ4 for the DSTs, LZMA and large baskets for the tracks
+            p.set_output(compression="LZ4:4", auto_flush=-30000000)
+            p.set_output(branches="GBLTracks*", compression="LZMA:9", basket_size=256000)
+        """
+        rule = {"files": files}
+        if branches:
+            rule["branches"] = branches
+        rule.update(settings)
+        self.output_settings.append(rule)
+
     def add_library(self, lib):
         """! Add a libraries to the list of libraries to load, searching the appropriate paths to find it,
         and adding the correct file extension"""
@@ -64,6 +89,10 @@ class Process:
                     print("Output file:", self.output_files[0])
         elif len(self.output_files) > 0:
             print("Output file:", self.output_files[0])
+        if len(self.output_settings) > 0:
+            print("Output settings:")
+            for rule in self.output_settings:
+                print("   %s" % (rule))
         if len(self.libraries) > 0:
             print("Shared libraries to load:")
             for afile in self.libraries:
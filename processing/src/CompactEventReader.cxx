@@ -0,0 +1,172 @@
+/**
+ * @file CompactEventReader.cxx
+ * @brief Expands the compact collections of an input tree to the standard ones.
+ */
+
+#include "CompactEventReader.h"
+
+//----------------//
+//   C++ StdLib   //
+//----------------//
+#include <iostream>
+
+//----------//
+//   ROOT   //
+//----------//
+#include "TBranchElement.h"
+
+namespace {
+    /** A compact branch of the input tree */
+    struct CompactBranch {
+        std::string name;
+        std::string className;
+    };
+}
+
+template <class T>
+std::vector<T*>* CompactEventReader::objects(TBranch* branch) {
+    TBranchElement* element = dynamic_cast<TBranchElement*>(branch);
+    if (!element)
+        return nullptr;
+    return reinterpret_cast<std::vector<T*>*>(element->GetObject());
+}
+
+template <class T>
+void CompactEventReader::reset(std::vector<T*>* objects) {
+    if (!objects)
+        return;
+    for (auto obj : *objects)
+        delete obj;
+    objects->clear();
+}
+
+template <class C, class T>
+bool CompactEventReader::expand(const std::string& name, const std::string& compactName, Collection<C, T>& coll) {
+    coll.title = tree_->GetBranch(compactName.c_str())->GetTitle();
+    tree_->SetBranchAddress(compactName.c_str(), &coll.compact);
+    coll.expanded = new std::vector<T*>();
+    coll.branch = tree_->Branch(name.c_str(), &coll.expanded);
+    if (!coll.branch) {
+        delete coll.expanded;
+        coll.expanded = nullptr;
+        return false;
+    }
+    // Filled by unpack(), never read from the file
+    tree_->SetBranchStatus(name.c_str(), 0);
+    return true;
+}
+
+int CompactEventReader::attach(TTree* tree) {
+    clear();
+    tree_ = tree;
+    if (!tree_)
+        return 0;
+
+    // Branches are added below, collect the compact ones first
+    const std::string& suffix = CompactEvent::kSuffix;
+    std::vector<CompactBranch> compact;
+    TIter next(tree_->GetListOfBranches());
+    while (TBranch* branch = (TBranch*)next()) {
+        std::string name = branch->GetName();
+        if (name.size() > suffix.size() && name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0)
+            compact.push_back({name, branch->GetClassName()});
+    }
+
+    int n_compact = 0;
+    for (auto& branch : compact) {
+        std::string name = branch.name.substr(0, branch.name.size() - suffix.size());
+        if (tree_->GetBranch(name.c_str())) {
+            std::cout << "[ CompactEventReader ]: WARNING: " << name
+                << " is stored in both representations, " << branch.name << " is ignored" << std::endl;
+            continue;
+        }
+        bool expanded = false;
+        if (branch.className == "vector<CompactTrack>") {
+            expanded = expand(name, branch.name, tracks_[name]);
+            if (!expanded) tracks_.erase(name);
+        } else if (branch.className == "vector<CompactParticle>") {
+            expanded = expand(name, branch.name, particles_[name]);
+            if (!expanded) particles_.erase(name);
+        } else if (branch.className == "vector<CompactVertex>") {
+            expanded = expand(name, branch.name, vertices_[name]);
+            if (!expanded) vertices_.erase(name);
+        }
+        if (!expanded) {
+            std::cout << "[ CompactEventReader ]: WARNING: cannot read " << branch.name
+                << " of type " << branch.className << std::endl;
+            continue;
+        }
+        std::cout << "[ CompactEventReader ]: Reading " << name << " from " << branch.name << std::endl;
+        ++n_compact;
+    }
+
+    return n_compact;
+}
+
+void CompactEventReader::unpack() {
+    if (!tree_)
+        return;
+
+    // The objects of the previous entry release their object numbers first
+    for (auto& coll : tracks_)
+        reset(objects<Track>(coll.second.branch));
+    for (auto& coll : particles_)
+        reset(objects<Particle>(coll.second.branch));
+    for (auto& coll : vertices_)
+        reset(objects<Vertex>(coll.second.branch));
+
+    // Referenced collections are unpacked first
+    for (auto& coll : tracks_) {
+        std::vector<Track*>* tracks = objects<Track>(coll.second.branch);
+        if (tracks && coll.second.compact)
+            CompactEvent::unpackTracks(*coll.second.compact, *tracks);
+    }
+    for (auto& coll : particles_) {
+        std::vector<Particle*>* particles = objects<Particle>(coll.second.branch);
+        if (!particles || !coll.second.compact)
+            continue;
+        // Tracks are compacted with the particles, clusters are standard branches
+        std::vector<Track*>* tracks = nullptr;
+        auto trks = tracks_.find(CompactEvent::titleValue(coll.second.title, "tracks"));
+        if (trks != tracks_.end())
+            tracks = objects<Track>(trks->second.branch);
+        std::vector<CalCluster*>* clusters = nullptr;
+        std::string clusterName = CompactEvent::titleValue(coll.second.title, "clusters");
+        if (!clusterName.empty())
+            clusters = objects<CalCluster>(tree_->GetBranch(clusterName.c_str()));
+        CompactEvent::unpackParticles(*coll.second.compact, tracks, clusters, *particles);
+    }
+    for (auto& coll : vertices_) {
+        std::vector<Vertex*>* vertices = objects<Vertex>(coll.second.branch);
+        if (!vertices || !coll.second.compact)
+            continue;
+        std::vector<Particle*>* particles = nullptr;
+        auto parts = particles_.find(CompactEvent::titleValue(coll.second.title, "particles"));
+        if (parts != particles_.end())
+            particles = objects<Particle>(parts->second.branch);
+        CompactEvent::unpackVertices(*coll.second.compact, particles, *vertices);
+    }
+}
+
+void CompactEventReader::clear() {
+    // The compact objects and the collections the processors bound are owned by the tree
+    for (auto& coll : vertices_) {
+        reset(objects<Vertex>(coll.second.branch));
+        reset(coll.second.expanded);
+        delete coll.second.expanded;
+    }
+    for (auto& coll : particles_) {
+        reset(objects<Particle>(coll.second.branch));
+        reset(coll.second.expanded);
+        delete coll.second.expanded;
+    }
+    for (auto& coll : tracks_) {
+        reset(objects<Track>(coll.second.branch));
+        reset(coll.second.expanded);
+        delete coll.second.expanded;
+    }
+    vertices_.clear();
+    particles_.clear();
+    tracks_.clear();
+    tree_ = nullptr;
+}
@@ -7,6 +7,17 @@
 
 #include "ConfigurePython.h"
 
+#include <fstream>
+#include <sstream>
+
+#include <sys/stat.h>
+
+/** Identifies hpstr configuration snapshots. */
+static const std::string snapshot_magic = "HPSTRCFG";
+
+/** Version of the snapshot layout, bump when it changes. */
+static const int snapshot_version = 2;
+
 static std::string stringMember(PyObject* owner, const std::string& name) {
 
     std::string retval;
@@ -37,6 +48,96 @@ static long intMember(PyObject* owner, const std::string& name) {
 }
 
 
+/** Read a python dictionary of parameters into a ParameterSet. */
+static void readParameters(PyObject* params, ParameterSet& ps) {
+    if (params == 0 || !PyDict_Check(params))
+        return;
+    PyObject *key(0), *value(0);
+    Py_ssize_t pos = 0;
+
+    while (PyDict_Next(params, &pos, &key, &value)) {
+#if PY_MAJOR_VERSION >= 3
+      PyObject* pyStr = PyUnicode_AsEncodedString(key, "utf-8","Error ~");
+      std::string skey = PyBytes_AS_STRING(pyStr);
+
+       if (PyLong_Check(value)) {
+           ps.insert(skey, int(PyLong_AsLong(value)));
+           //printf("Int Key: %s\n",skey.c_str());
+       } else if (PyFloat_Check(value)) {
+           ps.insert(skey, PyFloat_AsDouble(value));
+           //printf("Double Key: %s\n",skey.c_str());
+       } else if (PyUnicode_Check(value)) {
+           PyObject* pyStr = PyUnicode_AsEncodedString(value, "utf-8","Error ~");
+           ps.insert(skey, PyBytes_AS_STRING(pyStr));
+           Py_XDECREF(pyStr);
+           //printf("String Key: %s\n",skey.c_str());
+       } else if (PyList_Check(value)) { // assume everything is same value as first value
+           if (PyList_Size(value) > 0) {
+               PyObject* vec0 = PyList_GetItem(value, 0);
+               if (PyLong_Check(vec0)) {
+                   std::vector<int> vals;
+                   for (Py_ssize_t j = 0; j < PyList_Size(value); j++)
+                       vals.push_back(PyLong_AsLong(PyList_GetItem(value, j)));
+                   ps.insert(skey, vals);
+                   //printf("VInt Key: %s\n",skey.c_str());
+               } else if (PyFloat_Check(vec0)) {
+                   std::vector<double> vals;
+                   for (Py_ssize_t j = 0; j < PyList_Size(value); j++)
+                       vals.push_back(PyFloat_AsDouble(PyList_GetItem(value, j)));
+                   ps.insert(skey, vals);
+                   //printf("VDouble Key: %s\n",skey.c_str());
+               } else if (PyUnicode_Check(vec0)) {
+                   std::vector<std::string> vals;
+                   for (Py_ssize_t j = 0; j < PyList_Size(value); j++){
+                       PyObject* pyStr = PyUnicode_AsEncodedString(PyList_GetItem(value, j), "utf-8","Error ~");
+                       vals.push_back( PyBytes_AS_STRING(pyStr));
+                        Py_XDECREF(pyStr);
+                   }
+                   ps.insert(skey, vals);
+                   //printf("VString Key: %s\n",skey.c_str());
+               }
+           }
+       }
+
+#else
+        std::string skey = PyString_AsString(key);
+        if (PyInt_Check(value)) {
+            ps.insert(skey, int(PyInt_AsLong(value)));
+            //printf("Int Key: %s\n",skey.c_str());
+        } else if (PyFloat_Check(value)) {
+            ps.insert(skey, PyFloat_AsDouble(value));
+            //printf("Double Key: %s\n",skey.c_str());
+        } else if (PyString_Check(value)) {
+            ps.insert(skey, PyString_AsString(value));
+            //printf("String Key: %s\n",skey.c_str());
+        } else if (PyList_Check(value)) { // assume everything is same value as first value
+            if (PyList_Size(value) > 0) {
+                PyObject* vec0 = PyList_GetItem(value, 0);
+                if (PyInt_Check(vec0)) {
+                    std::vector<int> vals;
+                    for (Py_ssize_t j = 0; j < PyList_Size(value); j++)
+                        vals.push_back(PyInt_AsLong(PyList_GetItem(value, j)));
+                    ps.insert(skey, vals);
+                    //printf("VInt Key: %s\n",skey.c_str());
+                } else if (PyFloat_Check(vec0)) {
+                    std::vector<double> vals;
+                    for (Py_ssize_t j = 0; j < PyList_Size(value); j++)
+                        vals.push_back(PyFloat_AsDouble(PyList_GetItem(value, j)));
+                    ps.insert(skey, vals);
+                    //printf("VDouble Key: %s\n",skey.c_str());
+                } else if (PyString_Check(vec0)) {
+                    std::vector<std::string> vals;
+                    for (Py_ssize_t j = 0; j < PyList_Size(value); j++)
+                        vals.push_back(PyString_AsString(PyList_GetItem(value, j)));
+                    ps.insert(skey, vals);
+                    //printf("VString Key: %s\n",skey.c_str());
+                }
+            }
+        }
+#endif
+    }
+}
+
 ConfigurePython::ConfigurePython(const std::string& python_script, char* args[], int nargs) {
 
     std::string path(".");
@@ -144,92 +245,8 @@ ConfigurePython::ConfigurePython(const std::string& python_script, char* args[],
         std::cout << pi.classname_ << std::endl;
         
         PyObject* params = PyObject_GetAttrString(processor, "parameters");
-        if (params != 0 && PyDict_Check(params)) {
-            PyObject *key(0), *value(0);
-            Py_ssize_t pos = 0;
-
-            while (PyDict_Next(params, &pos, &key, &value)) {
-#if PY_MAJOR_VERSION >= 3
-              PyObject* pyStr = PyUnicode_AsEncodedString(key, "utf-8","Error ~");
-              std::string skey = PyBytes_AS_STRING(pyStr);
-
-               if (PyLong_Check(value)) {
-                   pi.params_.insert(skey, int(PyLong_AsLong(value)));
-                   //printf("Int Key: %s\n",skey.c_str());
-               } else if (PyFloat_Check(value)) {
-                   pi.params_.insert(skey, PyFloat_AsDouble(value));
-                   //printf("Double Key: %s\n",skey.c_str());
-               } else if (PyUnicode_Check(value)) {
-                   PyObject* pyStr = PyUnicode_AsEncodedString(value, "utf-8","Error ~");
-                   pi.params_.insert(skey, PyBytes_AS_STRING(pyStr));
-                   Py_XDECREF(pyStr);
-                   //printf("String Key: %s\n",skey.c_str());
-               } else if (PyList_Check(value)) { // assume everything is same value as first value
-                   if (PyList_Size(value) > 0) {
-                       PyObject* vec0 = PyList_GetItem(value, 0);
-                       if (PyLong_Check(vec0)) {
-                           std::vector<int> vals;
-                           for (Py_ssize_t j = 0; j < PyList_Size(value); j++)
-                               vals.push_back(PyLong_AsLong(PyList_GetItem(value, j)));
-                           pi.params_.insert(skey, vals);
-                           //printf("VInt Key: %s\n",skey.c_str());
-                       } else if (PyFloat_Check(vec0)) {
-                           std::vector<double> vals;
-                           for (Py_ssize_t j = 0; j < PyList_Size(value); j++)
-                               vals.push_back(PyFloat_AsDouble(PyList_GetItem(value, j)));
-                           pi.params_.insert(skey, vals);
-                           //printf("VDouble Key: %s\n",skey.c_str());
-                       } else if (PyUnicode_Check(vec0)) {
-                           std::vector<std::string> vals;
-                           for (Py_ssize_t j = 0; j < PyList_Size(value); j++){
-                               PyObject* pyStr = PyUnicode_AsEncodedString(PyList_GetItem(value, j), "utf-8","Error ~");
-                               vals.push_back( PyBytes_AS_STRING(pyStr));
-                                Py_XDECREF(pyStr);
-                           }
-                           pi.params_.insert(skey, vals);
-                           //printf("VString Key: %s\n",skey.c_str());
-                       }
-                   }
-               }
-
-#else
-                std::string skey = PyString_AsString(key);
-                if (PyInt_Check(value)) {
-                    pi.params_.insert(skey, int(PyInt_AsLong(value)));
-                    //printf("Int Key: %s\n",skey.c_str());
-                } else if (PyFloat_Check(value)) {
-                    pi.params_.insert(skey, PyFloat_AsDouble(value));
-                    //printf("Double Key: %s\n",skey.c_str());
-                } else if (PyString_Check(value)) {
-                    pi.params_.insert(skey, PyString_AsString(value));
-                    //printf("String Key: %s\n",skey.c_str());
-                } else if (PyList_Check(value)) { // assume everything is same value as first value
-                    if (PyList_Size(value) > 0) {
-                        PyObject* vec0 = PyList_GetItem(value, 0);
-                        if (PyInt_Check(vec0)) {
-                            std::vector<int> vals;
-                            for (Py_ssize_t j = 0; j < PyList_Size(value); j++)
-                                vals.push_back(PyInt_AsLong(PyList_GetItem(value, j)));
-                            pi.params_.insert(skey, vals);
-                            //printf("VInt Key: %s\n",skey.c_str());
-                        } else if (PyFloat_Check(vec0)) {
-                            std::vector<double> vals;
-                            for (Py_ssize_t j = 0; j < PyList_Size(value); j++)
-                                vals.push_back(PyFloat_AsDouble(PyList_GetItem(value, j)));
-                            pi.params_.insert(skey, vals);
-                            //printf("VDouble Key: %s\n",skey.c_str());
-                        } else if (PyString_Check(vec0)) {
-                            std::vector<std::string> vals;
-                            for (Py_ssize_t j = 0; j < PyList_Size(value); j++)
-                                vals.push_back(PyString_AsString(PyList_GetItem(value, j)));
-                            pi.params_.insert(skey, vals);
-                            //printf("VString Key: %s\n",skey.c_str());
-                        }
-                    }
-                }
-#endif
-            }
-        }
+        readParameters(params, pi.params_);
+        Py_XDECREF(params);
 
         sequence_.push_back(pi);
     }
@@ -287,30 +304,197 @@ ConfigurePython::ConfigurePython(const std::string& python_script, char* args[],
     }
     Py_DECREF(py_list);
 
+    // Output settings are optional, configurations may predate them
+    if (PyObject_HasAttrString(p_process, "output_settings")) {
+        py_list = PyObject_GetAttrString(p_process, "output_settings");
+        if (!PyList_Check(py_list)) {
+            throw std::runtime_error("[ ConfigurePython ]: output_settings is not a python list as expected."); 
+        }
+        for (Py_ssize_t i = 0; i < PyList_Size(py_list); i++) {
+            ParameterSet rule;
+            readParameters(PyList_GetItem(py_list, i), rule);
+            output_settings_.push_back(rule);
+        }
+        Py_DECREF(py_list);
+    }
+
     } catch (std::exception& e) { 
         std::cout << e.what() << std::endl;
+        load_failed_ = true;
+    }
+
+}
+
+ConfigurePython::ConfigurePython(const std::string& snapshot) {
+
+    std::ifstream in(snapshot, std::ios::binary);
+    if (!in.is_open()) {
+        throw std::runtime_error("[ ConfigurePython ]: Unable to open configuration snapshot " + snapshot);
     }
 
+    std::string magic(snapshot_magic.size(), '\0');
+    in.read(&magic[0], magic.size());
+    if (!in || magic != snapshot_magic) {
+        throw std::runtime_error("[ ConfigurePython ]: " + snapshot + " is not a configuration snapshot");
+    }
+
+    ParameterSet process;
+    process.read(in);
+    int version = process.getInteger("snapshot_version");
+    if (version < 1 || version > snapshot_version) {
+        throw std::runtime_error("[ ConfigurePython ]: Unsupported configuration snapshot version in " + snapshot);
+    }
+
+    run_mode_    = process.getInteger("run_mode");
+    skip_events_ = process.getInteger("skip_events");
+    event_limit_ = process.getInteger("max_events");
+    input_files_  = process.getVString("input_files");
+    output_files_ = process.getVString("output_files");
+    libraries_    = process.getVString("libraries");
+
+    const std::vector<std::string>& classes = process.getVString("class_names");
+    const std::vector<std::string>& instances = process.getVString("instance_names");
+    if (classes.size() != instances.size()) {
+        throw std::runtime_error("[ ConfigurePython ]: Corrupted configuration snapshot " + snapshot);
+    }
+    for (unsigned int i = 0; i < classes.size(); i++) {
+        ProcessorInfo pi;
+        pi.classname_ = classes[i];
+        pi.instancename_ = instances[i];
+        pi.params_.read(in);
+        std::cout << pi.classname_ << std::endl;
+        sequence_.push_back(pi);
+    }
+
+    // Version 1 snapshots have no output settings
+    int n_output_settings = version > 1 ? process.getInteger("n_output_settings") : 0;
+    for (int i = 0; i < n_output_settings; i++) {
+        ParameterSet rule;
+        rule.read(in);
+        output_settings_.push_back(rule);
+    }
 }
 
 ConfigurePython::~ConfigurePython() {
-    Py_Finalize();
+    if (Py_IsInitialized())
+        Py_Finalize();
 }
 
-Process* ConfigurePython::makeProcess() { 
+void ConfigurePython::writeSnapshot(const std::string& snapshot) const {
+
+    if (load_failed_) {
+        throw std::runtime_error("[ ConfigurePython ]: Not writing a snapshot of an incomplete configuration");
+    }
+
+    ParameterSet process;
+    process.insert("snapshot_version", snapshot_version);
+    process.insert("run_mode", run_mode_);
+    process.insert("skip_events", skip_events_);
+    process.insert("max_events", event_limit_);
+    process.insert("input_files", input_files_);
+    process.insert("output_files", output_files_);
+    process.insert("libraries", libraries_);
+
+    std::vector<std::string> classes, instances;
+    for (auto& proc : sequence_) {
+        classes.push_back(proc.classname_);
+        instances.push_back(proc.instancename_);
+    }
+    process.insert("class_names", classes);
+    process.insert("instance_names", instances);
+    process.insert("n_output_settings", int(output_settings_.size()));
+
+    std::ofstream out(snapshot, std::ios::binary);
+    if (!out.is_open()) {
+        throw std::runtime_error("[ ConfigurePython ]: Unable to write configuration snapshot " + snapshot);
+    }
+    out.write(snapshot_magic.data(), snapshot_magic.size());
+    process.write(out);
+    for (auto& proc : sequence_) {
+        proc.params_.write(out);
+    }
+    for (auto& rule : output_settings_) {
+        rule.write(out);
+    }
+    if (!out) {
+        throw std::runtime_error("[ ConfigurePython ]: Error writing configuration snapshot " + snapshot);
+    }
+    std::cout << "[ ConfigurePython ]: Configuration snapshot written to " << snapshot << std::endl;
+}
+
+int ConfigurePython::checkParameters() const {
+
+    int nproblems = load_failed_ ? 1 : 0;
+    if (load_failed_) {
+        std::cout << "[ ConfigurePython ]: ERROR: The configuration could not be fully loaded" << std::endl;
+    }
+
+    for (auto& proc : sequence_) {
+        if (!proc.config_error_.empty()) {
+            std::cout << "[ ConfigurePython ]: ERROR: " << proc.instancename_ << " (" << proc.classname_
+                << ") " << proc.config_error_ << std::endl;
+            nproblems++;
+        }
+        for (auto& name : proc.unused_) {
+            std::cout << "[ ConfigurePython ]: WARNING: " << proc.instancename_ << " (" << proc.classname_
+                << ") never reads parameter '" << name << "'" << std::endl;
+        }
+    }
+    return nproblems;
+}
+
+std::string ConfigurePython::processorConfig(const ProcessorInfo& proc) const {
+    std::stringstream config(std::ios::out | std::ios::binary);
+    config << proc.classname_ << '\0' << proc.instancename_ << '\0';
+    proc.params_.write(config);
+    for (auto& element : proc.params_.elements_) {
+        std::vector<std::string> names;
+        if (element.second.et_ == ParameterSet::et_String)
+            names.push_back(element.second.strval_);
+        else if (element.second.et_ == ParameterSet::et_VString)
+            names = element.second.svecVal_;
+        for (auto& name : names) {
+            struct stat st;
+            if (name.empty() || stat(name.c_str(), &st) || !S_ISREG(st.st_mode))
+                continue;
+            config << '\0' << name << '\0';
+            std::ifstream in(name, std::ios::binary);
+            if (st.st_size > 0)
+                config << in.rdbuf();
+        }
+    }
+    return config.str();
+}
+
+Process* ConfigurePython::makeProcess(bool dryRun) { 
     Process* p = new Process();
 
     for (auto lib : libraries_) {
       ProcessorFactory::instance().loadLibrary(lib);
     }
 
-    for (auto proc : sequence_) {
+    for (auto& proc : sequence_) {
         Processor* ep = ProcessorFactory::instance().createProcessor(proc.classname_, proc.instancename_, *p);
         if (ep == 0) {
             throw std::runtime_error("[ ConfigurePython ]: Unable to create instance of " + proc.instancename_); 
         }
-        ep->configure(proc.params_);
-        p->addToSequence(ep);    
+        ParameterSet::Usage usage(proc.params_);
+        proc.config_error_.clear();
+        try {
+            ep->configure(proc.params_);
+        } catch (std::exception& e) {
+            if (!dryRun) throw;
+            // A required parameter is only missing if its lookup error escaped configure()
+            const std::string& missing = usage.getLastMissing();
+            if (!missing.empty() && std::string(e.what()).find("'" + missing + "'") != std::string::npos)
+                proc.config_error_ = "requires parameter '" + missing + "' which is not set";
+            else
+                proc.config_error_ = std::string("configuration failed: ") + e.what();
+            delete ep;
+            continue;
+        }
+        proc.unused_ = usage.getUnused();
+        p->addToSequence(ep, processorConfig(proc));
     }
         
     for (auto file : input_files_) {
@@ -321,6 +505,12 @@ Process* ConfigurePython::makeProcess() {
         p->addOutputFileName(file); 
     }
 
+    OutputSettings output_settings;
+    for (auto& rule : output_settings_) {
+        output_settings.addRule(rule);
+    }
+    p->setOutputSettings(output_settings);
+
     p->setEventLimit(event_limit_);
     p->setRunMode(run_mode_);
     p->setSkipEvents(skip_events_);
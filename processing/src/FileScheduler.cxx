@@ -0,0 +1,168 @@
+/**
+ * @file FileScheduler.cxx
+ * @brief Class used to process a list of files with several workers in one job.
+ */
+
+#include "FileScheduler.h"
+
+//----------------//
+//   C++ StdLib   //
+//----------------//
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include <unistd.h>
+
+//----------//
+//   ROOT   //
+//----------//
+#include "TDirectory.h"
+#include "TROOT.h"
+
+//-----------//
+//   hpstr   //
+//-----------//
+#include "HistoMerger.h"
+
+namespace {
+    /** Serializes the messages of the workers */
+    std::mutex print_mutex;
+}
+
+FileScheduler::FileScheduler(const std::vector<Process*>& workers, const std::vector<std::string>& inputs,
+        const std::string& output)
+    : workers_(workers), inputs_(inputs), output_(output) {
+}
+
+std::string FileScheduler::partialOutput(int ifile) const {
+    std::string base = output_;
+    if (base.size() > 5 && base.compare(base.size() - 5, 5, ".root") == 0)
+        base.erase(base.size() - 5);
+    return base + "_part" + std::to_string(ifile) + ".root";
+}
+
+bool FileScheduler::runProcess(Process* process) {
+    int run_mode = process->getRunMode();
+    if (run_mode == 0)
+        process->run();
+    else if (run_mode == 1)
+        process->runOnRoot();
+    else if (run_mode == 2)
+        process->runOnHisto();
+    else
+        return false;
+    return true;
+}
+
+void FileScheduler::work(int iworker) {
+    Process* process = workers_[iworker];
+    for (int ifile = next_file_++; ifile < (int)inputs_.size(); ifile = next_file_++) {
+        {
+            std::lock_guard<std::mutex> lock(print_mutex);
+            std::cout << "---- [ hpstr ][ FileScheduler ]: Worker " << iworker << " processing "
+                << inputs_[ifile] << std::endl;
+        }
+        process->setFiles({inputs_[ifile]}, {partialOutput(ifile)});
+        bool done = false;
+        try {
+            done = runProcess(process) && !process->hasFailed();
+        } catch (std::exception& e) {
+            std::lock_guard<std::mutex> lock(print_mutex);
+            std::cerr << "---- [ hpstr ][ FileScheduler ]: Error! " << e.what() << std::endl;
+        }
+        failed_[ifile] = !done;
+        if (!done) {
+            std::lock_guard<std::mutex> lock(print_mutex);
+            std::cerr << "---- [ hpstr ][ FileScheduler ]: Processing of " << inputs_[ifile]
+                << " failed" << std::endl;
+        }
+    }
+}
+
+int FileScheduler::run() {
+
+    if (workers_.empty() || inputs_.empty()) {
+        std::cerr << "---- [ hpstr ][ FileScheduler ]: No workers or no input files." << std::endl;
+        return 1;
+    }
+
+    // The processors using process-wide state would share it between the workers
+    if (workers_.size() > 1) {
+        std::string shared = workers_[0]->findSharedStateProcessor();
+        if (!shared.empty()) {
+            std::cerr << "---- [ hpstr ][ FileScheduler ]: Processor " << shared << " uses process-wide"
+                << " state and cannot run on several workers, use one worker." << std::endl;
+            return 1;
+        }
+    }
+
+    failed_.assign(inputs_.size(), 0);
+    next_file_ = 0;
+
+    for (auto worker : workers_)
+        worker->setConcurrent(workers_.size() > 1);
+
+    if (workers_.size() == 1) {
+        work(0);
+    } else {
+        ROOT::EnableThreadSafety();
+        // The objects created by the processors outside of their output
+        // files go to a directory of their worker instead of gROOT
+        std::vector<std::unique_ptr<TDirectory>> dirs;
+        for (unsigned int iworker = 0; iworker < workers_.size(); ++iworker) {
+            std::string name = "hpstr_worker" + std::to_string(iworker);
+            dirs.emplace_back(new TDirectory(name.c_str(), name.c_str()));
+        }
+        TDirectory* cwd = gDirectory;
+        std::vector<std::thread> threads;
+        for (unsigned int iworker = 0; iworker < workers_.size(); ++iworker) {
+            threads.emplace_back([this, iworker, &dirs]() {
+                dirs[iworker]->cd();
+                work(iworker);
+            });
+        }
+        for (auto& thread : threads)
+            thread.join();
+        cwd->cd();
+    }
+
+    std::vector<std::string> partials;
+    int nfailed = 0;
+    for (unsigned int ifile = 0; ifile < inputs_.size(); ++ifile) {
+        if (failed_[ifile]) {
+            std::cerr << "---- [ hpstr ][ FileScheduler ]: Failed: " << inputs_[ifile] << std::endl;
+            nfailed++;
+        } else {
+            partials.push_back(partialOutput(ifile));
+        }
+    }
+
+    int nproblems = nfailed;
+    if (!partials.empty()) {
+        std::cout << "---- [ hpstr ][ FileScheduler ]: Merging " << partials.size() << " outputs into "
+            << output_ << std::endl;
+        HistoMerger merger(partials, output_, workers_.size());
+        nproblems += merger.merge();
+    }
+
+    // The outputs of the files are the only copy of the results the merge may have lost
+    if (nproblems > 0) {
+        std::cerr << "---- [ hpstr ][ FileScheduler ]: " << nproblems << " problems, keeping the outputs of the files:"
+            << std::endl;
+        for (unsigned int ifile = 0; ifile < inputs_.size(); ++ifile) {
+            std::string partial = partialOutput(ifile);
+            if (access(partial.c_str(), F_OK) == 0)
+                std::cerr << "---- [ hpstr ][ FileScheduler ]:   " << partial << std::endl;
+        }
+    } else if (!keep_partials_) {
+        for (unsigned int ifile = 0; ifile < inputs_.size(); ++ifile)
+            std::remove(partialOutput(ifile).c_str());
+    }
+
+    std::cout << "---- [ hpstr ][ FileScheduler ]: " << inputs_.size() - nfailed << " of "
+        << inputs_.size() << " files processed" << std::endl;
+    return nproblems;
+}
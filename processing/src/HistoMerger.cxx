@@ -0,0 +1,346 @@
+/**
+ * @file HistoMerger.cxx
+ * @brief Class used to merge the outputs of several hpstr jobs.
+ */
+
+#include "HistoMerger.h"
+
+//----------------//
+//   C++ StdLib   //
+//----------------//
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <set>
+#include <thread>
+
+//----------//
+//   ROOT   //
+//----------//
+#include "TClass.h"
+#include "TFileMergeInfo.h"
+#include "TKey.h"
+#include "TList.h"
+#include "TROOT.h"
+#include "TTree.h"
+
+namespace {
+    /** @return directory part of a path */
+    std::string dirName(const std::string& path) {
+        size_t pos = path.find_last_of('/');
+        return pos == std::string::npos ? "" : path.substr(0, pos);
+    }
+
+    /** @return object name part of a path */
+    std::string baseName(const std::string& path) {
+        size_t pos = path.find_last_of('/');
+        return pos == std::string::npos ? path : path.substr(pos+1);
+    }
+
+    /** @return highest cycle of every key of a directory */
+    std::vector<TKey*> getKeys(TDirectory* dir) {
+        std::vector<TKey*> keys;
+        std::set<std::string> seen;
+        TIter next(dir->GetListOfKeys());
+        while (TKey* key = (TKey*)next()) {
+            if (!seen.insert(key->GetName()).second)
+                continue;
+            keys.push_back(dir->GetKey(key->GetName()));
+        }
+        return keys;
+    }
+}
+
+HistoMerger::HistoMerger(const std::vector<std::string>& inputs, const std::string& output, int nThreads)
+    : inputs_(inputs), output_(output), nThreads_(nThreads) {
+    if (nThreads_ < 1)
+        nThreads_ = 1;
+    if (nThreads_ > (int)inputs_.size())
+        nThreads_ = std::max(1, (int)inputs_.size());
+}
+
+bool HistoMerger::sameAxis(const TAxis* a, const TAxis* b) {
+    if (a->GetNbins() != b->GetNbins())
+        return false;
+    if (a->GetXmin() != b->GetXmin() || a->GetXmax() != b->GetXmax())
+        return false;
+    const TArrayD* edgesA = a->GetXbins();
+    const TArrayD* edgesB = b->GetXbins();
+    if (edgesA->GetSize() != edgesB->GetSize())
+        return false;
+    for (int i = 0; i < edgesA->GetSize(); ++i) {
+        if (edgesA->GetAt(i) != edgesB->GetAt(i))
+            return false;
+    }
+    return true;
+}
+
+bool HistoMerger::sameBinning(TH1* a, TH1* b) {
+    if (a->IsA() != b->IsA() || a->GetDimension() != b->GetDimension())
+        return false;
+    if (!sameAxis(a->GetXaxis(), b->GetXaxis()))
+        return false;
+    if (a->GetDimension() > 1 && !sameAxis(a->GetYaxis(), b->GetYaxis()))
+        return false;
+    if (a->GetDimension() > 2 && !sameAxis(a->GetZaxis(), b->GetZaxis()))
+        return false;
+    return true;
+}
+
+void HistoMerger::addHisto(Partial& partial, const std::string& path, TH1* hist,
+        const std::string& source) const {
+    auto it = partial.histos.find(path);
+    if (it == partial.histos.end()) {
+        partial.histos[path] = hist;
+        partial.order.push_back(path);
+        return;
+    }
+    if (!sameBinning(it->second, hist)) {
+        std::cerr << "[ HistoMerger ]: ERROR: " << path << " in " << source
+            << " has a different type or binning, skipped" << std::endl;
+        partial.problems++;
+    } else {
+        it->second->Add(hist);
+    }
+    delete hist;
+}
+
+void HistoMerger::collect(TDirectory* dir, const std::string& path, const std::string& source,
+        Partial& partial) const {
+    for (TKey* key : getKeys(dir)) {
+        TClass* cl = TClass::GetClass(key->GetClassName());
+        if (cl == nullptr)
+            continue;
+        std::string keyPath = path.empty() ? key->GetName() : path + "/" + key->GetName();
+        if (cl->InheritsFrom(TDirectory::Class())) {
+            TDirectory* subdir = dir->GetDirectory(key->GetName());
+            if (subdir)
+                collect(subdir, keyPath, source, partial);
+        } else if (cl->InheritsFrom(TH1::Class())) {
+            TH1* hist = (TH1*)key->ReadObj();
+            if (hist)
+                addHisto(partial, keyPath, hist, source);
+        }
+    }
+}
+
+void HistoMerger::reduce(Partial& into, Partial& from) const {
+    for (auto& path : from.order)
+        addHisto(into, path, from.histos[path], "partial sum");
+    into.problems += from.problems;
+    from.histos.clear();
+    from.order.clear();
+    from.problems = 0;
+}
+
+void HistoMerger::findOthers(TDirectory* dir, const std::string& path) {
+    for (TKey* key : getKeys(dir)) {
+        TClass* cl = TClass::GetClass(key->GetClassName());
+        if (cl == nullptr)
+            continue;
+        std::string keyPath = path.empty() ? key->GetName() : path + "/" + key->GetName();
+        if (cl->InheritsFrom(TDirectory::Class())) {
+            TDirectory* subdir = dir->GetDirectory(key->GetName());
+            if (subdir)
+                findOthers(subdir, keyPath);
+        } else if (cl->InheritsFrom(TTree::Class())) {
+            trees_.push_back(keyPath);
+        } else if (!cl->InheritsFrom(TH1::Class())) {
+            others_.push_back(keyPath);
+        }
+    }
+}
+
+TDirectory* HistoMerger::getDirectory(TFile* out, const std::string& path) {
+    if (path.empty())
+        return out;
+    TDirectory* dir = out->GetDirectory(path.c_str());
+    if (dir == nullptr) {
+        TDirectory* parent = getDirectory(out, dirName(path));
+        dir = parent->mkdir(baseName(path).c_str());
+    }
+    return dir;
+}
+
+int HistoMerger::mergeTrees(TFile* out) {
+    int problems = 0;
+    for (auto& path : trees_) {
+        TDirectory* dir = getDirectory(out, dirName(path));
+        TTree* outTree = nullptr;
+        Long64_t nentries = 0;
+        // The output tree is cloned from the first input having it, which stays open until the tree is written
+        std::unique_ptr<TFile> source;
+        for (auto& input : inputs_) {
+            std::unique_ptr<TFile> in(TFile::Open(input.c_str()));
+            if (!in || in->IsZombie())
+                continue;
+            TTree* tree = (TTree*)in->Get(path.c_str());
+            if (tree == nullptr) {
+                std::cerr << "[ HistoMerger ]: ERROR: " << input << " has no tree " << path << std::endl;
+                problems++;
+                continue;
+            }
+            if (outTree == nullptr) {
+                dir->cd();
+                outTree = tree->CloneTree(0);
+                outTree->SetDirectory(dir);
+                source = std::move(in);
+            }
+            // Fast cloning copies whole baskets, i.e. the input clusters, without unzipping them
+            nentries += outTree->CopyEntries(tree, -1, "fast");
+        }
+        if (outTree) {
+            dir->cd();
+            outTree->Write("", TObject::kOverwrite);
+            std::cout << "[ HistoMerger ]: Merged tree " << path << " with " << nentries << " entries" << std::endl;
+            delete outTree;
+        }
+    }
+    return problems;
+}
+
+int HistoMerger::mergeOthers(TFile* out) {
+    if (others_.empty())
+        return 0;
+    std::unique_ptr<TFile> first(TFile::Open(inputs_[0].c_str()));
+    if (!first || first->IsZombie())
+        return 0;
+
+    int problems = 0;
+    std::vector<TObject*> objects;
+    for (auto& path : others_)
+        objects.push_back(first->Get(path.c_str()));
+
+    // Add the versions of the other inputs one file at a time with the Merge method of their class
+    TFileMergeInfo info(out);
+    std::vector<bool> dropped(others_.size(), false);
+    for (size_t ifile = 1; ifile < inputs_.size(); ++ifile) {
+        std::unique_ptr<TFile> in(TFile::Open(inputs_[ifile].c_str()));
+        if (!in || in->IsZombie())
+            continue;
+        for (size_t iobj = 0; iobj < others_.size(); ++iobj) {
+            if (objects[iobj] == nullptr)
+                continue;
+            ROOT::MergeFunc_t mergeFunc = objects[iobj]->IsA()->GetMerge();
+            if (mergeFunc == nullptr) {
+                dropped[iobj] = true;
+                continue;
+            }
+            TObject* obj = in->Get(others_[iobj].c_str());
+            if (obj == nullptr)
+                continue;
+            if (obj->IsA() != objects[iobj]->IsA()) {
+                std::cerr << "[ HistoMerger ]: ERROR: " << others_[iobj] << " in " << inputs_[ifile]
+                    << " is a " << obj->ClassName() << " instead of a " << objects[iobj]->ClassName()
+                    << ", skipped" << std::endl;
+                problems++;
+            } else {
+                TList list;
+                list.Add(obj);
+                if (mergeFunc(objects[iobj], &list, &info) < 0) {
+                    std::cerr << "[ HistoMerger ]: ERROR: cannot merge " << others_[iobj] << " of "
+                        << inputs_[ifile] << std::endl;
+                    problems++;
+                }
+            }
+            delete obj;
+        }
+    }
+
+    int nMerged = 0;
+    for (size_t iobj = 0; iobj < others_.size(); ++iobj) {
+        if (objects[iobj] == nullptr)
+            continue;
+        if (dropped[iobj]) {
+            std::cerr << "[ HistoMerger ]: WARNING: " << objects[iobj]->ClassName() << " " << others_[iobj]
+                << " cannot be merged, it is copied from " << inputs_[0]
+                << " and the versions of the other inputs are dropped" << std::endl;
+        } else {
+            nMerged++;
+        }
+        getDirectory(out, dirName(others_[iobj]))->WriteTObject(objects[iobj], baseName(others_[iobj]).c_str());
+        delete objects[iobj];
+    }
+    std::cout << "[ HistoMerger ]: Merged " << nMerged << " objects which are not histograms or trees" << std::endl;
+    return problems;
+}
+
+int HistoMerger::merge() {
+
+    if (inputs_.empty()) {
+        std::cerr << "[ HistoMerger ]: ERROR: no input files" << std::endl;
+        return 1;
+    }
+
+    bool addDirectory = TH1::AddDirectoryStatus();
+    TH1::AddDirectory(kFALSE);
+    if (nThreads_ > 1)
+        ROOT::EnableThreadSafety();
+
+    std::cout << "[ HistoMerger ]: Merging " << inputs_.size() << " files into " << output_
+        << " using " << nThreads_ << " threads" << std::endl;
+
+    // Sum the histograms of contiguous chunks of files, one chunk per thread
+    std::vector<Partial> partials(nThreads_);
+    auto sumChunk = [&](int ithread) {
+        size_t first = inputs_.size()*ithread/nThreads_;
+        size_t last = inputs_.size()*(ithread+1)/nThreads_;
+        for (size_t ifile = first; ifile < last; ++ifile) {
+            std::unique_ptr<TFile> in(TFile::Open(inputs_[ifile].c_str()));
+            if (!in || in->IsZombie()) {
+                std::cerr << "[ HistoMerger ]: ERROR: cannot open " << inputs_[ifile] << std::endl;
+                partials[ithread].problems++;
+                continue;
+            }
+            collect(in.get(), "", inputs_[ifile], partials[ithread]);
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (int ithread = 1; ithread < nThreads_; ++ithread)
+        workers.emplace_back(sumChunk, ithread);
+    sumChunk(0);
+    for (auto& worker : workers)
+        worker.join();
+
+    // Combine the partial sums pairwise, keeping the file order
+    for (int step = 1; step < nThreads_; step *= 2) {
+        workers.clear();
+        for (int ithread = 0; ithread + step < nThreads_; ithread += 2*step)
+            workers.emplace_back([&, ithread, step]() { reduce(partials[ithread], partials[ithread+step]); });
+        for (auto& worker : workers)
+            worker.join();
+    }
+    Partial& total = partials[0];
+    int problems = total.problems;
+
+    {
+        std::unique_ptr<TFile> first(TFile::Open(inputs_[0].c_str()));
+        if (first && !first->IsZombie())
+            findOthers(first.get(), "");
+    }
+
+    TFile* out = TFile::Open(output_.c_str(), "RECREATE");
+    if (out == nullptr || out->IsZombie()) {
+        std::cerr << "[ HistoMerger ]: ERROR: cannot create " << output_ << std::endl;
+        for (auto& entry : total.histos)
+            delete entry.second;
+        TH1::AddDirectory(addDirectory);
+        return problems + 1;
+    }
+
+    for (auto& path : total.order) {
+        TH1* hist = total.histos[path];
+        getDirectory(out, dirName(path))->WriteTObject(hist, baseName(path).c_str());
+        delete hist;
+    }
+    std::cout << "[ HistoMerger ]: Merged " << total.order.size() << " histograms" << std::endl;
+
+    problems += mergeOthers(out);
+    problems += mergeTrees(out);
+
+    out->Close();
+    delete out;
+    TH1::AddDirectory(addDirectory);
+    return problems;
+}
@@ -4,6 +4,8 @@ HpsEventFile::HpsEventFile(const std::string ifilename, const std::string& ofile
   rootfile_ = new TFile(ifilename.c_str());
   //ttree_reader = new ("HPS_Event",_rootfile);
   intree_ = (TTree*)rootfile_->Get("HPS_Event");
+  if (intree_)
+    compact_.attach(intree_);
   ofile_    = new TFile(ofilename.c_str(),"recreate");
   
 }
@@ -22,6 +24,7 @@ void HpsEventFile::setupEvent(IEvent* ievent) {
 }
 
 void HpsEventFile::close() {
+  compact_.clear();
   rootfile_->cd();
   rootfile_->Close();
   ofile_->cd();
@@ -36,6 +39,7 @@ bool HpsEventFile::nextEvent() {
 
   //TODO Really don't like having the tree associated to the event object. Should be associated to the EventFile.
   intree_->GetEntry(entry_++);
+  compact_.unpack();
   
   return true;
 }
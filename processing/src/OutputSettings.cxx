@@ -0,0 +1,195 @@
+/**
+ * @file OutputSettings.cxx
+ * @brief Compression, basket and flush settings of the output ROOT files.
+ */
+
+#include "OutputSettings.h"
+
+//----------------//
+//   C++ StdLib   //
+//----------------//
+#include <algorithm>
+#include <cctype>
+#include <stdexcept>
+
+#include <fnmatch.h>
+
+//----------//
+//   ROOT   //
+//----------//
+#include "TBranch.h"
+
+namespace {
+    /** ROOT compression algorithms and their default levels, see ROOT::RCompressionSetting */
+    struct Algorithm {
+        const char* name;
+        int id;
+        int defaultLevel;
+    };
+    const Algorithm algorithms[] = {
+        {"none", 0, 0},
+        {"zlib", 1, 1},
+        {"lzma", 2, 7},
+        {"lz4", 4, 4},
+        {"zstd", 5, 5}
+    };
+
+    /** @return file name without its directory */
+    std::string baseName(const std::string& path) {
+        size_t pos = path.find_last_of('/');
+        return pos == std::string::npos ? path : path.substr(pos+1);
+    }
+}
+
+int OutputSettings::compressionSettings(const std::string& algorithm, int level) {
+    std::string name = algorithm;
+    size_t colon = name.find(':');
+    if (colon != std::string::npos) {
+        if (level == kUnset) {
+            try {
+                level = std::stoi(name.substr(colon+1));
+            } catch (std::exception&) {
+                throw std::runtime_error("[ OutputSettings ]: Bad compression level in " + algorithm);
+            }
+        }
+        name.erase(colon);
+    }
+    std::transform(name.begin(), name.end(), name.begin(), [](unsigned char c) { return std::tolower(c); });
+
+    // Only a level: the algorithm is ROOT's default
+    if (name.empty())
+        return level == kUnset ? kUnset : std::max(0, std::min(level, 99));
+
+    for (auto& alg : algorithms) {
+        if (name != alg.name)
+            continue;
+        if (alg.id == 0)
+            return 0;
+        if (level == kUnset)
+            level = alg.defaultLevel;
+        if (level < 0 || level > 99)
+            throw std::runtime_error("[ OutputSettings ]: Bad compression level in " + algorithm);
+        return alg.id*100 + level;
+    }
+    throw std::runtime_error("[ OutputSettings ]: Unknown compression algorithm " + algorithm);
+}
+
+void OutputSettings::addRule(const ParameterSet& parameters) {
+    ParameterSet::Usage usage(parameters);
+    Rule rule;
+    rule.files = parameters.getString("files", rule.files);
+    rule.branches = parameters.getString("branches", rule.branches);
+    rule.compression = compressionSettings(parameters.getString("compression", ""),
+            parameters.getInteger("level", kUnset));
+    rule.basket_size = parameters.getInteger("basket_size", rule.basket_size);
+    rule.auto_flush = parameters.getInteger("auto_flush", rule.auto_flush);
+    rule.auto_save = parameters.getInteger("auto_save", rule.auto_save);
+    rule.split_level = parameters.getInteger("split_level", rule.split_level);
+
+    for (auto& unused : usage.getUnused()) {
+        std::cout << "[ OutputSettings ]: WARNING: unknown output setting " << unused
+            << " ignored" << std::endl;
+    }
+    if (!rule.branches.empty() && (rule.auto_flush != kUnset || rule.auto_save != kUnset
+                || rule.split_level != kUnset)) {
+        std::cout << "[ OutputSettings ]: WARNING: auto_flush, auto_save and split_level apply to "
+            << "whole files, ignored for branches " << rule.branches << std::endl;
+    }
+    rules_.push_back(rule);
+}
+
+bool OutputSettings::matches(const std::string& pattern, const std::string& name) {
+    return fnmatch(pattern.c_str(), name.c_str(), 0) == 0;
+}
+
+void OutputSettings::applyToFile(TFile* file) const {
+    if (!file)
+        return;
+    std::string filename = file->GetName();
+    for (auto& rule : rules_) {
+        if (!rule.branches.empty() || rule.compression == kUnset)
+            continue;
+        if (matches(rule.files, filename) || matches(rule.files, baseName(filename)))
+            file->SetCompressionSettings(rule.compression);
+    }
+}
+
+void OutputSettings::applyToBranch(const Rule& rule, TBranch* branch) {
+    if (rule.compression != kUnset)
+        branch->SetCompressionSettings(rule.compression);
+    if (rule.basket_size != kUnset)
+        branch->SetBasketSize(rule.basket_size);
+    TIter next(branch->GetListOfBranches());
+    while (TBranch* sub = (TBranch*)next())
+        applyToBranch(rule, sub);
+}
+
+void OutputSettings::applyToTree(TTree* tree, const std::string& filename) const {
+    if (!tree)
+        return;
+    for (auto& rule : rules_) {
+        if (!matches(rule.files, filename) && !matches(rule.files, baseName(filename)))
+            continue;
+        if (rule.branches.empty()) {
+            if (rule.auto_flush != kUnset)
+                tree->SetAutoFlush(rule.auto_flush);
+            if (rule.auto_save != kUnset)
+                tree->SetAutoSave(rule.auto_save);
+            // The compression of the file was inherited when the branches were made
+            if (rule.basket_size != kUnset) {
+                Rule baskets;
+                baskets.basket_size = rule.basket_size;
+                TIter next(tree->GetListOfBranches());
+                while (TBranch* branch = (TBranch*)next())
+                    applyToBranch(baskets, branch);
+            }
+            continue;
+        }
+        TIter next(tree->GetListOfBranches());
+        while (TBranch* branch = (TBranch*)next()) {
+            if (matches(rule.branches, branch->GetName()))
+                applyToBranch(rule, branch);
+        }
+    }
+}
+
+void OutputSettings::applyToTrees(TDirectory* dir, const std::string& filename) const {
+    if (!dir)
+        return;
+    TIter next(dir->GetList());
+    while (TObject* obj = next()) {
+        if (TTree* tree = dynamic_cast<TTree*>(obj))
+            applyToTree(tree, filename);
+        else if (TDirectory* sub = dynamic_cast<TDirectory*>(obj))
+            applyToTrees(sub, filename);
+    }
+}
+
+int OutputSettings::splitLevel(const std::string& filename) const {
+    int split = kUnset;
+    for (auto& rule : rules_) {
+        if (rule.branches.empty() && rule.split_level != kUnset
+                && (matches(rule.files, filename) || matches(rule.files, baseName(filename))))
+            split = rule.split_level;
+    }
+    return split;
+}
+
+void OutputSettings::print(std::ostream& out) const {
+    for (auto& rule : rules_) {
+        out << "[ OutputSettings ]: files " << rule.files;
+        if (!rule.branches.empty())
+            out << " branches " << rule.branches;
+        if (rule.compression != kUnset)
+            out << " compression " << rule.compression;
+        if (rule.basket_size != kUnset)
+            out << " basket_size " << rule.basket_size;
+        if (rule.auto_flush != kUnset)
+            out << " auto_flush " << rule.auto_flush;
+        if (rule.auto_save != kUnset)
+            out << " auto_save " << rule.auto_save;
+        if (rule.split_level != kUnset)
+            out << " split_level " << rule.split_level;
+        out << std::endl;
+    }
+}
@@ -1,12 +1,60 @@
 
 #include "ParameterSet.h"
 
+#include <cstdint>
+
+namespace {
+
+    template <typename T>
+    void writeValue(std::ostream& out, const T& value) {
+        out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    template <typename T>
+    T readValue(std::istream& in) {
+        T value{};
+        in.read(reinterpret_cast<char*>(&value), sizeof(T));
+        if (!in)
+            throw std::runtime_error("[ ParameterSet ]: Unexpected end of parameter snapshot");
+        return value;
+    }
+
+    void writeString(std::ostream& out, const std::string& value) {
+        writeValue<uint32_t>(out, value.size());
+        out.write(value.data(), value.size());
+    }
+
+    std::string readString(std::istream& in) {
+        std::string value(readValue<uint32_t>(in), '\0');
+        in.read(&value[0], value.size());
+        if (!in)
+            throw std::runtime_error("[ ParameterSet ]: Unexpected end of parameter snapshot");
+        return value;
+    }
+
+    template <typename T>
+    void writeVector(std::ostream& out, const std::vector<T>& values) {
+        writeValue<uint32_t>(out, values.size());
+        for (const T& value : values)
+            writeValue<T>(out, value);
+    }
+
+    template <typename T>
+    std::vector<T> readVector(std::istream& in) {
+        std::vector<T> values(readValue<uint32_t>(in));
+        for (T& value : values)
+            value = readValue<T>(in);
+        return values;
+    }
+}
+
 void ParameterSet::insert(const std::string& name, int value) {
     elements_[name] = Element(value);
 }
 
 int ParameterSet::getInteger(const std::string& name) const {
     std::map<std::string, Element>::const_iterator ptr = elements_.find(name);
+    Usage::record(this, name, ptr != elements_.end(), true);
     if (ptr == elements_.end()) {
         throw std::runtime_error("[ Parameter Not Found ]: Integer parameter '" + name + "' not found");
     }
@@ -18,6 +66,7 @@ int ParameterSet::getInteger(const std::string& name) const {
 
 int ParameterSet::getInteger(const std::string& name, int defaultValue) const {
     std::map<std::string, Element>::const_iterator ptr = elements_.find(name);
+    Usage::record(this, name, ptr != elements_.end(), false);
     if (ptr == elements_.end()) {
         return defaultValue;
     }
@@ -33,6 +82,7 @@ void ParameterSet::insert(const std::string& name, double value) {
 
 double ParameterSet::getDouble(const std::string& name) const {
     std::map<std::string, Element>::const_iterator ptr = elements_.find(name);
+    Usage::record(this, name, ptr != elements_.end(), true);
     if (ptr == elements_.end()) {
         throw std::runtime_error("[ Parameter Not Found ]: Double parameter '" + name + "' not found");
     }
@@ -44,6 +94,7 @@ double ParameterSet::getDouble(const std::string& name) const {
 
 double ParameterSet::getDouble(const std::string& name, double defaultValue) const {
     std::map<std::string, Element>::const_iterator ptr = elements_.find(name);
+    Usage::record(this, name, ptr != elements_.end(), false);
     if (ptr == elements_.end()) {
         return defaultValue;
     }
@@ -59,6 +110,7 @@ void ParameterSet::insert(const std::string& name, const std::string& value) {
 
 const std::string& ParameterSet::getString(const std::string& name) const {
     std::map<std::string, Element>::const_iterator ptr = elements_.find(name);
+    Usage::record(this, name, ptr != elements_.end(), true);
     if (ptr == elements_.end()) {
         throw std::runtime_error("[ Parameter Not Found ]: String parameter '" + name + "' not found");
     }
@@ -70,6 +122,7 @@ const std::string& ParameterSet::getString(const std::string& name) const {
 
 const std::string& ParameterSet::getString(const std::string& name, const std::string& defaultValue) const {
     std::map<std::string, Element>::const_iterator ptr = elements_.find(name);
+    Usage::record(this, name, ptr != elements_.end(), false);
     if (ptr == elements_.end()) {
         return defaultValue;
     }
@@ -90,6 +143,7 @@ void ParameterSet::insert(const std::string& name, const std::vector<int>& value
 
 const std::vector<int>& ParameterSet::getVInteger(const std::string& name) const {
     std::map<std::string, Element>::const_iterator ptr = elements_.find(name);
+    Usage::record(this, name, ptr != elements_.end(), true);
     if (ptr == elements_.end()) {
         throw std::runtime_error("[ Parameter Not Found ]: Parameter '" + name + "' not found");
     }
@@ -101,6 +155,7 @@ const std::vector<int>& ParameterSet::getVInteger(const std::string& name) const
 
 const std::vector<int>& ParameterSet::getVInteger(const std::string& name, const std::vector<int>& defaultValue) const {
     std::map<std::string, Element>::const_iterator ptr = elements_.find(name);
+    Usage::record(this, name, ptr != elements_.end(), false);
     if (ptr == elements_.end()) {
         return defaultValue;
     }
@@ -121,6 +176,7 @@ void ParameterSet::insert(const std::string& name, const std::vector<double>& va
 
 const std::vector<double>& ParameterSet::getVDouble(const std::string& name) const {
     std::map<std::string, Element>::const_iterator ptr = elements_.find(name);
+    Usage::record(this, name, ptr != elements_.end(), true);
     if (ptr == elements_.end()) {
         throw std::runtime_error("[ Parameter Not Found ]: Parameter '" + name + "' not found");
     }
@@ -132,6 +188,7 @@ const std::vector<double>& ParameterSet::getVDouble(const std::string& name) con
 
 const std::vector<double>& ParameterSet::getVDouble(const std::string& name, const std::vector<double>& defaultValue) const {
     std::map<std::string, Element>::const_iterator ptr = elements_.find(name);
+    Usage::record(this, name, ptr != elements_.end(), false);
     if (ptr == elements_.end()) {
         return defaultValue;
     }
@@ -152,6 +209,7 @@ void ParameterSet::insert(const std::string& name, const std::vector<std::string
 
 const std::vector<std::string>& ParameterSet::getVString(const std::string& name) const {
     std::map<std::string, Element>::const_iterator ptr = elements_.find(name);
+    Usage::record(this, name, ptr != elements_.end(), true);
     if (ptr == elements_.end()) {
         throw std::runtime_error("[ Parameter Not Found ]: Parameter '" + name + "' not found");
     }
@@ -163,6 +221,7 @@ const std::vector<std::string>& ParameterSet::getVString(const std::string& name
 
 const std::vector<std::string>& ParameterSet::getVString(const std::string& name, const std::vector<std::string>& defaultValue) const {
     std::map<std::string, Element>::const_iterator ptr = elements_.find(name);
+    Usage::record(this, name, ptr != elements_.end(), false);
     if (ptr == elements_.end()) {
         return defaultValue;
     }
@@ -171,3 +230,82 @@ const std::vector<std::string>& ParameterSet::getVString(const std::string& name
     }
     return ptr->second.svecVal_;
 }
+
+/* --------------- Bookkeeping ------------------------*/
+thread_local ParameterSet::Usage* ParameterSet::Usage::current_{nullptr};
+
+ParameterSet::Usage::Usage(const ParameterSet& parameters) : parameters_(parameters), previous_(current_) {
+    current_ = this;
+}
+
+ParameterSet::Usage::~Usage() {
+    current_ = previous_;
+}
+
+void ParameterSet::Usage::record(const ParameterSet* parameters, const std::string& name,
+        bool found, bool required) {
+    Usage* usage = current_;
+    if (!usage || &usage->parameters_ != parameters)
+        return;
+    usage->used_.insert(name);
+    if (!found && required)
+        usage->last_missing_ = name;
+}
+
+std::vector<std::string> ParameterSet::Usage::getUnused() const {
+    std::vector<std::string> unused;
+    for (auto& element : parameters_.elements_) {
+        if (used_.find(element.first) == used_.end())
+            unused.push_back(element.first);
+    }
+    return unused;
+}
+
+/* --------------- Snapshots ------------------------*/
+void ParameterSet::write(std::ostream& out) const {
+    writeValue<uint32_t>(out, elements_.size());
+    for (auto& element : elements_) {
+        const Element& e = element.second;
+        writeString(out, element.first);
+        writeValue<int32_t>(out, e.et_);
+        switch (e.et_) {
+            case et_Bool:     writeValue<bool>(out, e.boolval_); break;
+            case et_Integer:  writeValue<int>(out, e.intval_); break;
+            case et_Double:   writeValue<double>(out, e.doubleval_); break;
+            case et_String:   writeString(out, e.strval_); break;
+            case et_VInteger: writeVector<int>(out, e.ivecVal_); break;
+            case et_VDouble:  writeVector<double>(out, e.dvecVal_); break;
+            case et_VString:
+                writeValue<uint32_t>(out, e.svecVal_.size());
+                for (auto& value : e.svecVal_)
+                    writeString(out, value);
+                break;
+            default:
+                throw std::runtime_error("[ ParameterSet ]: Parameter '" + element.first + "' cannot be written to a snapshot");
+        }
+    }
+}
+
+void ParameterSet::read(std::istream& in) {
+    uint32_t nelements = readValue<uint32_t>(in);
+    for (uint32_t i = 0; i < nelements; ++i) {
+        std::string name = readString(in);
+        switch (readValue<int32_t>(in)) {
+            case et_Bool:     elements_[name] = Element(readValue<bool>(in)); break;
+            case et_Integer:  insert(name, readValue<int>(in)); break;
+            case et_Double:   insert(name, readValue<double>(in)); break;
+            case et_String:   insert(name, readString(in)); break;
+            case et_VInteger: insert(name, readVector<int>(in)); break;
+            case et_VDouble:  insert(name, readVector<double>(in)); break;
+            case et_VString: {
+                std::vector<std::string> values(readValue<uint32_t>(in));
+                for (auto& value : values)
+                    value = readString(in);
+                insert(name, values);
+                break;
+            }
+            default:
+                throw std::runtime_error("[ ParameterSet ]: Parameter '" + name + "' has an unknown type in the snapshot");
+        }
+    }
+}
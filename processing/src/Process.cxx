@@ -10,21 +10,44 @@
 #include "EventFile.h"
 #include "HpsEventFile.h"
 #include "TH1.h"
+#include "TProcessID.h"
+#include "TSystem.h"
+
+#include <algorithm>
+#include <set>
 
 Process::Process() {}
 
 //TODO Fix this better
 
 void Process::runOnHisto() {
+    failed_ = false;
     try {
         int cfile = 0;
         for (auto ifile : input_files_) {
             std::cout << "Processing file " << ifile << std::endl;
 
-            for (auto module : sequence_) {
+            if (profiler_) profiler_->startLoop();
+            for (unsigned int imod = 0; imod < sequence_.size(); ++imod) {
+                Processor* module = sequence_[imod];
+                ProcessProfiler::Stamp start;
+                if (profiler_) start = profiler_->start(ProcessProfiler::kInitialize);
                 module->initialize(ifile, output_files_[cfile]);
+                if (profiler_) {
+                    profiler_->stop(imod, ProcessProfiler::kInitialize, start);
+                    start = profiler_->start(ProcessProfiler::kProcess);
+                }
                 module->process();
+                if (profiler_) {
+                    profiler_->stop(imod, ProcessProfiler::kProcess, start);
+                    start = profiler_->start(ProcessProfiler::kFinalize);
+                }
                 module->finalize();
+                if (profiler_) profiler_->stop(imod, ProcessProfiler::kFinalize, start);
+            }
+            if (profiler_) {
+                profiler_->stopLoop();
+                profiler_->countEvent();
             }
             //Pass to next file
             ++cfile;
@@ -32,10 +55,13 @@ void Process::runOnHisto() {
         } //ifile
     } catch (std::exception& e) {
         std::cerr<<"Error:"<<e.what()<<std::endl;
+        failed_ = true;
     }
+    if (profiler_) profiler_->report(std::cout);
 } //Process::runOnHisto
 
 void Process::runOnRoot() {
+    failed_ = false;
     try {
         int n_events_processed = 0;
         HpsEvent event;
@@ -43,27 +69,84 @@ void Process::runOnRoot() {
         int cfile =0 ;
         for (auto ifile : input_files_) {
             std::cout<<"Processing file "<<ifile<<std::endl;
+            std::string file_key = cache_ ? cache_->fileKey(ifile) : "";
             HpsEventFile* file(nullptr);
             if (!output_files_.empty()) {
                 file = new HpsEventFile(ifile, output_files_[cfile]);
+                output_settings_.applyToFile(file->getOutputFile());
                 file->setupEvent(&event);
             }
-            for (auto module : sequence_) {
+
+            // Processors whose output for this file is cached are not run
+            long n_file_events = event.getTree() ? event.getTree()->GetEntriesFast() : 0;
+            if (event_limit_ >= 0)
+                n_file_events = std::min(n_file_events, (long)std::max(0, event_limit_ - n_events_processed));
+            std::vector<std::string> keys(sequence_.size());
+            std::vector<std::set<std::string>> outputs(sequence_.size());
+            std::vector<unsigned int> active;
+            for (unsigned int imod = 0; imod < sequence_.size(); ++imod) {
+                if (!file_key.empty()) {
+                    keys[imod] = cache_->outputKey(file_key, sequence_configs_[imod], n_file_events);
+                    if (cache_->restore(keys[imod], file->getOutputFile())) {
+                        std::cout << "Using the cached output of " << sequence_[imod]->getName() << std::endl;
+                        continue;
+                    }
+                }
+                active.push_back(imod);
+            }
+            file->resetOutputFileDir();
+
+            for (unsigned int imod : active) {
+                Processor* module = sequence_[imod];
+                ProcessProfiler::Stamp start;
+                ProcessCache::Snapshot before;
+                if (!file_key.empty()) before = cache_->snapshot(file->getOutputFile());
+                if (profiler_) start = profiler_->start(ProcessProfiler::kInitialize);
                 module->initialize(event.getTree());
                 module->setFile(file->getOutputFile());
+                if (profiler_) profiler_->stop(imod, ProcessProfiler::kInitialize, start);
+                if (!file_key.empty()) cache_->addNew(before, file->getOutputFile(), outputs[imod]);
             }
-            while (file->nextEvent() && (event_limit_ < 0 || (n_events_processed < event_limit_))) {
+            // Trees the processors write to the output, e.g. flat tuples
+            output_settings_.applyToTrees(file->getOutputFile(), output_files_[cfile]);
+            if (profiler_) profiler_->startLoop();
+            // The unpacked compact collections reference each other with
+            // TRefs, the object numbers are given back after each event
+            bool restore_object_count = !active.empty() && file->hasCompactCollections();
+            if (restore_object_count && concurrent_)
+                throw std::runtime_error("The compact collections of " + ifile
+                        + " cannot be read by several workers, run with one worker");
+            UInt_t object_count = TProcessID::GetObjectCount();
+            if (active.empty()) {
+                // Nothing to run, only count the events
+                for (long ievent = 0; ievent < n_file_events; ++ievent)
+                    event_h->Fill(0.0);
+                n_events_processed += n_file_events;
+            }
+            while (!active.empty() && file->nextEvent() && (event_limit_ < 0 || (n_events_processed < event_limit_))) {
                 if (n_events_processed%1000 == 0)
                     std::cout<<"Event:"<<n_events_processed<<std::endl;
 
                 //In this way if the processing fails (like an event doesn't pass the selection, the other modules aren't run on that event)
-                for (auto module : sequence_) {
-                    module->process(&event);
+                if (profiler_) {
+                    for (unsigned int imod : active) {
+                        ProcessProfiler::Stamp start = profiler_->start(ProcessProfiler::kProcess);
+                        sequence_[imod]->process(&event);
+                        profiler_->stop(imod, ProcessProfiler::kProcess, start);
+                    }
+                    profiler_->countEvent();
+                } else {
+                    for (unsigned int imod : active) {
+                        sequence_[imod]->process(&event);
+                    }
                 }
                 //event.Clear();
                 event_h->Fill(0.0);
                 ++n_events_processed;
+                if (restore_object_count)
+                    TProcessID::SetObjectCount(object_count);
             }
+            if (profiler_) profiler_->stopLoop();
             //Pass to next file
             ++cfile;
             // Finalize all modules
@@ -71,9 +154,20 @@ void Process::runOnRoot() {
             //Select the output file for storing the results of the processors.
             file->resetOutputFileDir();
             event_h->Write();
-            for (auto module : sequence_) {
+            for (unsigned int imod : active) {
+                ProcessProfiler::Stamp start;
+                ProcessCache::Snapshot before;
+                if (!file_key.empty()) before = cache_->snapshot(file->getOutputFile());
+                if (profiler_) start = profiler_->start(ProcessProfiler::kFinalize);
                 //TODO:Change the finalize method
-                module->finalize();
+                sequence_[imod]->finalize();
+                if (profiler_) profiler_->stop(imod, ProcessProfiler::kFinalize, start);
+                if (!file_key.empty()) cache_->addNew(before, file->getOutputFile(), outputs[imod]);
+            }
+            if (!file_key.empty()) {
+                for (unsigned int imod : active)
+                    cache_->store(keys[imod], file->getOutputFile(), outputs[imod]);
+                file->resetOutputFileDir();
             }
             // TODO Check all these destructors
             if (file) {
@@ -86,11 +180,18 @@ void Process::runOnRoot() {
         }
     } catch (std::exception& e) {
         std::cerr<<"Error:"<<e.what()<<std::endl;
+        failed_ = true;
+    }
+    if (profiler_) profiler_->report(std::cout);
+    if (cache_) {
+        cache_->evict();
+        cache_->printStats(std::cout);
     }
 }
 
 void Process::run() {
 
+    failed_ = false;
     try {
 
         int n_events_processed = 0;
@@ -115,31 +216,49 @@ void Process::run() {
             EventFile* file{nullptr};  
             if (!output_files_.empty()) { 
                 file = new EventFile(ifile, output_files_[cfile]);
+                output_settings_.applyToFile(file->getOutputFile());
                 file->setupEvent(&event);  
             }
 
             TTree* tree = new TTree("HPS_Event","HPS event tree");
             event.setTree(tree); 
+            event.setSplitLevel(output_settings_.splitLevel(output_files_[cfile]));
             // first, notify everyone that we are starting
-            for (auto module : sequence_) {
-                module->initialize(tree);
+            for (unsigned int imod = 0; imod < sequence_.size(); ++imod) {
+                ProcessProfiler::Stamp start;
+                if (profiler_) start = profiler_->start(ProcessProfiler::kInitialize);
+                sequence_[imod]->initialize(tree);
+                if (profiler_) profiler_->stop(imod, ProcessProfiler::kInitialize, start);
             }
 
             //In the case of additional output files from the processors this restores the correct ProcessID storage
             file->resetOutputFileDir();
+            output_settings_.applyToTree(tree, output_files_[cfile]);
 
             // Process all events.
+            if (profiler_) profiler_->startLoop();
             while (file->nextEvent() && (event_limit_ < 0 || (n_events_processed < event_limit_))) {
                 if (n_events_processed%1000 == 0)
                     std::cout << "---- [ hpstr ][ Process ]: Event: " << n_events_processed << std::endl;
                 event.Clear(); 
                 bool passEvent = true;
                 
-                for (auto module : sequence_) {
-                    passEvent = passEvent && module->process(&event);
-                    //if (!module->process(&event))
-                    if (!passEvent)
-                        break;
+                if (profiler_) {
+                    for (unsigned int imod = 0; imod < sequence_.size(); ++imod) {
+                        ProcessProfiler::Stamp start = profiler_->start(ProcessProfiler::kProcess);
+                        passEvent = sequence_[imod]->process(&event);
+                        profiler_->stop(imod, ProcessProfiler::kProcess, start);
+                        if (!passEvent)
+                            break;
+                    }
+                    profiler_->countEvent();
+                } else {
+                    for (auto module : sequence_) {
+                        passEvent = passEvent && module->process(&event);
+                        //if (!module->process(&event))
+                        if (!passEvent)
+                            break;
+                    }
                 }
                 ++n_events_processed;
                 event_h->Fill(0.0);
@@ -147,14 +266,18 @@ void Process::run() {
                     file->FillEvent();
                 }
             }
+            if (profiler_) profiler_->stopLoop();
             ++cfile; 
 
             //Prepare to write to file
             file->resetOutputFileDir();
             event_h->Write();
             // Finalize all modules. 
-            for (auto module : sequence_) { 
-                module->finalize(); 
+            for (unsigned int imod = 0; imod < sequence_.size(); ++imod) { 
+                ProcessProfiler::Stamp start;
+                if (profiler_) start = profiler_->start(ProcessProfiler::kFinalize);
+                sequence_[imod]->finalize(); 
+                if (profiler_) profiler_->stop(imod, ProcessProfiler::kFinalize, start);
             }
 
             if (file) {
@@ -169,7 +292,56 @@ void Process::run() {
 
     } catch (std::exception& e) {
         std::cerr << "---- [ hpstr ][ Process ]: Error! " << e.what() << std::endl;
+        failed_ = true;
     }
+    if (profiler_) profiler_->report(std::cout);
+}
+
+int Process::dryRun() {
+    int nproblems = 0;
+
+    if (input_files_.empty()) {
+        std::cerr << "---- [ hpstr ][ Process ]: Dry run: no input files specified." << std::endl;
+        nproblems++;
+    }
+    for (auto ifile : input_files_) {
+        if (gSystem->AccessPathName(ifile.c_str(), kReadPermission)) {
+            std::cerr << "---- [ hpstr ][ Process ]: Dry run: cannot read input file " << ifile << std::endl;
+            nproblems++;
+        }
+    }
+    if (output_files_.size() < input_files_.size()) {
+        std::cerr << "---- [ hpstr ][ Process ]: Dry run: " << input_files_.size() << " input files but only "
+            << output_files_.size() << " output files." << std::endl;
+        nproblems++;
+    }
+
+    // The Histo Analysis processors read their inputs at initialization, nothing more can be checked without them
+    if (run_mode_ != 0 && run_mode_ != 1)
+        return nproblems;
+
+    TDirectory* cwd = gDirectory;
+    TTree* tree = new TTree("HPS_Event","HPS event tree");
+    tree->SetDirectory(0);
+    for (auto module : sequence_) {
+        try {
+            module->initialize(tree);
+        } catch (std::exception& e) {
+            std::cerr << "---- [ hpstr ][ Process ]: Dry run: initialization failed: " << e.what() << std::endl;
+            nproblems++;
+        }
+    }
+    cwd->cd();
+
+    return nproblems;
+}
+
+void Process::enableProfiling(const std::string& report) {
+    std::vector<std::string> names;
+    for (auto module : sequence_)
+        names.push_back(module->getName());
+    profiler_.reset(new ProcessProfiler(report));
+    profiler_->setProcessors(names);
 }
 
 void Process::addFileToProcess(const std::string& filename) {
@@ -180,7 +352,20 @@ void Process::addOutputFileName(const std::string& output_filename) {
     output_files_.push_back(output_filename);
 }
 
-void Process::addToSequence(Processor* mod) {
+void Process::addToSequence(Processor* mod, const std::string& config) {
     sequence_.push_back(mod);
+    sequence_configs_.push_back(config);
+}
+
+void Process::enableCache(const std::string& cache_dir, long max_bytes) {
+    cache_.reset(new ProcessCache(cache_dir, max_bytes));
 }
 
+
+std::string Process::findSharedStateProcessor() const {
+    for (auto module : sequence_) {
+        if (module->usesSharedState())
+            return module->getName();
+    }
+    return "";
+}
@@ -0,0 +1,340 @@
+/**
+ * @file ProcessCache.cxx
+ * @brief On-disk cache of the outputs of the processors of ROOT to Histo jobs.
+ */
+
+#include "ProcessCache.h"
+
+//----------------//
+//   C++ StdLib   //
+//----------------//
+#include <algorithm>
+#include <cstdio>
+#include <iomanip>
+#include <memory>
+#include <sstream>
+#include <vector>
+
+#include <dirent.h>
+#include <dlfcn.h>
+#include <link.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utime.h>
+
+//----------//
+//   ROOT   //
+//----------//
+#include "TClass.h"
+#include "TH1.h"
+#include "TKey.h"
+#include "TSystem.h"
+#include "TTree.h"
+
+namespace {
+    /** Version of the cache entries, bump when the layout or the key changes */
+    const int CACHE_VERSION = 1;
+
+    /** Directory of the hpstr libraries and hash of the ones loaded from it */
+    struct LibraryScan {
+        std::string dir;
+        std::vector<std::string> libs;
+    };
+
+    int addLibrary(struct dl_phdr_info* info, size_t, void* data) {
+        LibraryScan* scan = static_cast<LibraryScan*>(data);
+        std::string name = info->dlpi_name ? info->dlpi_name : "";
+        if (!name.empty() && name.compare(0, scan->dir.size(), scan->dir) == 0)
+            scan->libs.push_back(name);
+        return 0;
+    }
+
+    /** @return directory part of a path */
+    std::string dirName(const std::string& path) {
+        size_t pos = path.find_last_of('/');
+        return pos == std::string::npos ? "" : path.substr(0, pos);
+    }
+
+    /** @return object name part of a path */
+    std::string baseName(const std::string& path) {
+        size_t pos = path.find_last_of('/');
+        return pos == std::string::npos ? path : path.substr(pos+1);
+    }
+}
+
+ProcessCache::ProcessCache(const std::string& cacheDir, long maxBytes)
+    : cacheDir_(cacheDir), maxBytes_(maxBytes) {
+    if (gSystem->AccessPathName(cacheDir_.c_str()))
+        gSystem->mkdir(cacheDir_.c_str(), kTRUE);
+    std::cout << "[ ProcessCache ]: Using output cache in " << cacheDir_ << std::endl;
+}
+
+void ProcessCache::hash(uint64_t& h, const void* data, size_t size) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; ++i) {
+        h ^= bytes[i];
+        h *= 1099511628211ULL;
+    }
+}
+
+std::string ProcessCache::toKey(uint64_t h) {
+    std::stringstream hex;
+    hex << std::hex << std::setw(16) << std::setfill('0') << h;
+    return hex.str();
+}
+
+uint64_t ProcessCache::buildId() {
+    static uint64_t id = 0;
+    if (id)
+        return id;
+    LibraryScan scan;
+    Dl_info info;
+    if (dladdr(reinterpret_cast<void*>(&addLibrary), &info) && info.dli_fname)
+        scan.dir = dirName(info.dli_fname) + "/";
+    if (!scan.dir.empty())
+        dl_iterate_phdr(&addLibrary, &scan);
+    std::sort(scan.libs.begin(), scan.libs.end());
+
+    uint64_t h = 14695981039346656037ULL;
+    for (auto& lib : scan.libs) {
+        struct stat st;
+        if (stat(lib.c_str(), &st))
+            continue;
+        hash(h, lib);
+        long size = st.st_size;
+        long mtime = st.st_mtime;
+        hash(h, &size, sizeof(size));
+        hash(h, &mtime, sizeof(mtime));
+    }
+    id = h;
+    return id;
+}
+
+std::string ProcessCache::fileKey(const std::string& filename) const {
+    struct stat st;
+    if (stat(filename.c_str(), &st))
+        return "";
+    std::unique_ptr<TFile> file(TFile::Open(filename.c_str()));
+    if (!file || file->IsZombie())
+        return "";
+    uint64_t h = 14695981039346656037ULL;
+    long size = st.st_size;
+    long mtime = st.st_mtime;
+    hash(h, &size, sizeof(size));
+    hash(h, &mtime, sizeof(mtime));
+    hash(h, std::string(file->GetUUID().AsString()));
+    file->Close();
+    return toKey(h);
+}
+
+std::string ProcessCache::outputKey(const std::string& fileKey, const std::string& config, long nEvents) const {
+    uint64_t h = 14695981039346656037ULL;
+    hash(h, &CACHE_VERSION, sizeof(CACHE_VERSION));
+    hash(h, fileKey);
+    hash(h, config);
+    hash(h, &nEvents, sizeof(nEvents));
+    uint64_t build = buildId();
+    hash(h, &build, sizeof(build));
+    return toKey(h);
+}
+
+std::string ProcessCache::path(const std::string& key) const {
+    return cacheDir_ + "/" + key + ".root";
+}
+
+void ProcessCache::list(TDirectory* dir, const std::string& prefix, Snapshot& snapshot) const {
+    std::set<std::string> subdirs;
+    TIter nextObject(dir->GetList());
+    while (TObject* obj = nextObject()) {
+        if (obj->InheritsFrom(TDirectory::Class()))
+            subdirs.insert(obj->GetName());
+        else
+            snapshot.insert(prefix + obj->GetName());
+    }
+    TIter nextKey(dir->GetListOfKeys());
+    while (TKey* key = (TKey*)nextKey()) {
+        TClass* cls = TClass::GetClass(key->GetClassName());
+        if (cls && cls->InheritsFrom(TDirectory::Class()))
+            subdirs.insert(key->GetName());
+        else
+            snapshot.insert(prefix + key->GetName() + ";" + std::to_string(key->GetCycle()));
+    }
+    for (auto& name : subdirs) {
+        if (TDirectory* sub = dir->GetDirectory(name.c_str()))
+            list(sub, prefix + name + "/", snapshot);
+    }
+}
+
+ProcessCache::Snapshot ProcessCache::snapshot(TDirectory* dir) const {
+    Snapshot snap;
+    list(dir, "", snap);
+    return snap;
+}
+
+void ProcessCache::addNew(const Snapshot& before, TDirectory* dir, std::set<std::string>& paths) const {
+    for (auto& entry : snapshot(dir)) {
+        if (before.count(entry))
+            continue;
+        paths.insert(entry.substr(0, entry.find(';')));
+    }
+}
+
+TDirectory* ProcessCache::getDirectory(TDirectory* top, const std::string& path) {
+    TDirectory* dir = top;
+    std::stringstream parts(path);
+    std::string part;
+    while (std::getline(parts, part, '/')) {
+        if (part.empty())
+            continue;
+        TDirectory* sub = dir->GetDirectory(part.c_str());
+        dir = sub ? sub : dir->mkdir(part.c_str());
+    }
+    return dir;
+}
+
+bool ProcessCache::store(const std::string& key, TFile* out, const std::set<std::string>& paths) {
+
+    // Collect the objects first, an output with a tree is not cached
+    std::vector<std::pair<std::string, TObject*>> objects;
+    std::vector<TObject*> owned;
+    bool cacheable = true;
+    for (auto& objPath : paths) {
+        std::string dirPath = dirName(objPath);
+        TDirectory* dir = dirPath.empty() ? out : out->GetDirectory(dirPath.c_str());
+        if (!dir)
+            continue;
+        std::string name = baseName(objPath);
+        TObject* obj = dir->GetList()->FindObject(name.c_str());
+        if (!obj) {
+            TKey* key = dir->GetKey(name.c_str());
+            if (!key)
+                continue;
+            obj = key->ReadObj();
+            if (!obj)
+                continue;
+            if (TH1* hist = dynamic_cast<TH1*>(obj))
+                hist->SetDirectory(nullptr);
+            owned.push_back(obj);
+        }
+        if (obj->InheritsFrom(TTree::Class())) {
+            cacheable = false;
+            break;
+        }
+        objects.push_back({objPath, obj});
+    }
+
+    if (cacheable) {
+        TDirectory* cwd = gDirectory;
+        std::string tmp = path(key) + ".tmp" + std::to_string(getpid());
+        std::unique_ptr<TFile> entry(TFile::Open(tmp.c_str(), "RECREATE"));
+        if (entry && !entry->IsZombie()) {
+            for (auto& object : objects)
+                getDirectory(entry.get(), dirName(object.first))->WriteTObject(object.second, baseName(object.first).c_str());
+            entry->Close();
+            std::rename(tmp.c_str(), path(key).c_str());
+            stores_++;
+        } else {
+            std::cout << "[ ProcessCache ]: WARNING: cannot write " << tmp << std::endl;
+            cacheable = false;
+        }
+        cwd->cd();
+    }
+    if (!cacheable)
+        uncacheable_++;
+
+    for (auto obj : owned)
+        delete obj;
+    return cacheable;
+}
+
+void ProcessCache::copy(TDirectory* from, TDirectory* to) const {
+    std::set<std::string> seen;
+    TIter nextKey(from->GetListOfKeys());
+    while (TKey* key = (TKey*)nextKey()) {
+        // Highest cycle only
+        if (!seen.insert(key->GetName()).second)
+            continue;
+        TClass* cls = TClass::GetClass(key->GetClassName());
+        if (cls && cls->InheritsFrom(TDirectory::Class())) {
+            copy(from->GetDirectory(key->GetName()), getDirectory(to, key->GetName()));
+            continue;
+        }
+        TObject* obj = from->GetKey(key->GetName())->ReadObj();
+        if (!obj)
+            continue;
+        if (TH1* hist = dynamic_cast<TH1*>(obj))
+            hist->SetDirectory(nullptr);
+        to->WriteTObject(obj, key->GetName());
+        delete obj;
+    }
+}
+
+bool ProcessCache::restore(const std::string& key, TFile* out) {
+    std::string entryPath = path(key);
+    if (gSystem->AccessPathName(entryPath.c_str())) {
+        misses_++;
+        return false;
+    }
+    TDirectory* cwd = gDirectory;
+    std::unique_ptr<TFile> entry(TFile::Open(entryPath.c_str()));
+    if (!entry || entry->IsZombie()) {
+        cwd->cd();
+        misses_++;
+        return false;
+    }
+    copy(entry.get(), out);
+    entry->Close();
+    cwd->cd();
+    // Most recently used entries are evicted last
+    utime(entryPath.c_str(), nullptr);
+    hits_++;
+    return true;
+}
+
+void ProcessCache::evict() {
+    if (maxBytes_ <= 0)
+        return;
+    DIR* dir = opendir(cacheDir_.c_str());
+    if (!dir)
+        return;
+    struct Entry {
+        std::string path;
+        long size;
+        long mtime;
+    };
+    std::vector<Entry> entries;
+    long total = 0;
+    while (struct dirent* ent = readdir(dir)) {
+        std::string name = ent->d_name;
+        if (name.size() < 5 || name.compare(name.size() - 5, 5, ".root") != 0)
+            continue;
+        std::string entryPath = cacheDir_ + "/" + name;
+        struct stat st;
+        if (stat(entryPath.c_str(), &st))
+            continue;
+        entries.push_back({entryPath, (long)st.st_size, (long)st.st_mtime});
+        total += st.st_size;
+    }
+    closedir(dir);
+
+    std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.mtime < b.mtime; });
+    for (auto& entry : entries) {
+        if (total <= maxBytes_)
+            break;
+        if (std::remove(entry.path.c_str()) == 0) {
+            total -= entry.size;
+            evicted_++;
+        }
+    }
+}
+
+void ProcessCache::printStats(std::ostream& out) const {
+    int lookups = hits_ + misses_;
+    std::stringstream stats;
+    stats << "[ ProcessCache ]: " << hits_ << " hits, " << misses_ << " misses";
+    if (lookups)
+        stats << " (" << std::fixed << std::setprecision(1) << 100.*hits_/lookups << "% hit rate)";
+    stats << ", " << stores_ << " stored, " << uncacheable_ << " not cacheable, "
+        << evicted_ << " evicted";
+    out << stats.str() << std::endl;
+}
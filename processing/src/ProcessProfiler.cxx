@@ -0,0 +1,304 @@
+/**
+ * @file ProcessProfiler.cxx
+ * @brief Class used to measure the time and memory used by each processor.
+ */
+
+#include "ProcessProfiler.h"
+
+//----------------//
+//   C++ StdLib   //
+//----------------//
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+#include <sys/resource.h>
+#include <unistd.h>
+
+//----------//
+//   ROOT   //
+//----------//
+#include "TDirectory.h"
+#include "TFile.h"
+#include "TTree.h"
+
+namespace {
+    /** Logarithmic histogram of the process wall times */
+    const double HIST_MIN = 1e-8;
+    const int BINS_PER_DECADE = 50;
+    const int HIST_BINS = 12*BINS_PER_DECADE;
+
+    const char* PHASE_NAMES[3] = {"initialize", "process", "finalize"};
+
+    double wallNow() {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    double cpuNow() {
+        timespec ts;
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+        return ts.tv_sec + 1e-9*ts.tv_nsec;
+    }
+
+    /** @return string with the JSON special characters escaped */
+    std::string jsonEscape(const std::string& s) {
+        std::string escaped;
+        for (char c : s) {
+            if (c == '"' || c == '\\')
+                escaped += '\\';
+            escaped += c;
+        }
+        return escaped;
+    }
+}
+
+ProcessProfiler::ProcessProfiler(const std::string& report, int rssInterval)
+    : report_(report), rssInterval_(std::max(1, rssInterval)) {
+    jobStart_ = wallNow();
+}
+
+void ProcessProfiler::setProcessors(const std::vector<std::string>& names) {
+    stats_.clear();
+    stats_.resize(names.size());
+    for (unsigned int iproc = 0; iproc < names.size(); ++iproc) {
+        stats_[iproc].name = names[iproc];
+        stats_[iproc].hist.assign(HIST_BINS, 0);
+    }
+    nEvents_ = 0;
+    loopWall_ = 0;
+}
+
+long ProcessProfiler::currentRss() {
+    long pages = 0, resident = 0;
+    FILE* statm = fopen("/proc/self/statm", "r");
+    if (statm == nullptr)
+        return -1;
+    int nread = fscanf(statm, "%ld %ld", &pages, &resident);
+    fclose(statm);
+    if (nread != 2)
+        return -1;
+    return resident*(sysconf(_SC_PAGESIZE)/1024);
+}
+
+long ProcessProfiler::peakRss() {
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return -1;
+    return usage.ru_maxrss;
+}
+
+ProcessProfiler::Stamp ProcessProfiler::start(Phase phase) const {
+    Stamp stamp;
+    if (phase != kProcess || nEvents_ % rssInterval_ == 0)
+        stamp.rss = currentRss();
+    stamp.cpu = cpuNow();
+    stamp.wall = wallNow();
+    return stamp;
+}
+
+int ProcessProfiler::bin(double wall) const {
+    if (wall <= HIST_MIN)
+        return 0;
+    int ibin = (int)(std::log10(wall/HIST_MIN)*BINS_PER_DECADE);
+    return std::min(ibin, HIST_BINS-1);
+}
+
+void ProcessProfiler::stop(int iproc, Phase phase, const Stamp& start) {
+    double wall = wallNow() - start.wall;
+    double cpu = cpuNow() - start.cpu;
+    Stats& stats = stats_[iproc];
+    stats.wall[phase] += wall;
+    stats.cpu[phase] += cpu;
+    stats.calls[phase]++;
+
+    long rss = start.rss >= 0 ? currentRss() : -1;
+    if (phase == kProcess) {
+        stats.hist[bin(wall)]++;
+        stats.maxWall = std::max(stats.maxWall, wall);
+        if (rss >= 0)
+            stats.rssGrowProcess = std::max(stats.rssGrowProcess, rss - start.rss);
+    } else if (phase == kInitialize) {
+        stats.rssAfterInit = rss;
+        stats.rssGrowInit += rss - start.rss;
+    } else {
+        stats.rssAfterFinal = rss;
+    }
+}
+
+void ProcessProfiler::startLoop() {
+    loopStart_ = wallNow();
+}
+
+void ProcessProfiler::stopLoop() {
+    loopWall_ += wallNow() - loopStart_;
+}
+
+double ProcessProfiler::percentile(const Stats& stats, double fraction) const {
+    long calls = stats.calls[kProcess];
+    if (calls == 0)
+        return 0;
+    long target = (long)std::ceil(fraction*calls);
+    long sum = 0;
+    for (int ibin = 0; ibin < HIST_BINS; ++ibin) {
+        sum += stats.hist[ibin];
+        if (sum >= target) {
+            // Geometric center of the bin, bins are 4.7% wide
+            double center = HIST_MIN*std::pow(10., (ibin + 0.5)/BINS_PER_DECADE);
+            return std::min(center, stats.maxWall);
+        }
+    }
+    return stats.maxWall;
+}
+
+void ProcessProfiler::report(std::ostream& out) {
+    double jobWall = wallNow() - jobStart_;
+    double totalProcess = 0;
+    for (auto& stats : stats_)
+        totalProcess += stats.wall[kProcess];
+
+    std::ios_base::fmtflags flags = out.flags();
+    std::streamsize precision = out.precision();
+
+    out << "---- [ hpstr ][ Profiler ]: Processor summary --------" << std::endl;
+    out << std::left << std::setw(28) << "processor" << std::right
+        << std::setw(10) << "init[s]"
+        << std::setw(12) << "proc[s]"
+        << std::setw(12) << "cpu[s]"
+        << std::setw(8) << "frac"
+        << std::setw(11) << "p50[us]"
+        << std::setw(11) << "p90[us]"
+        << std::setw(11) << "p99[us]"
+        << std::setw(12) << "max[us]"
+        << std::setw(10) << "final[s]"
+        << std::setw(12) << "rssInit[MB]"
+        << std::setw(12) << "rssProc[MB]" << std::endl;
+    out << std::fixed;
+    for (auto& stats : stats_) {
+        out << std::left << std::setw(28) << stats.name.substr(0, 27) << std::right
+            << std::setprecision(3) << std::setw(10) << stats.wall[kInitialize]
+            << std::setw(12) << stats.wall[kProcess]
+            << std::setw(12) << stats.cpu[kProcess]
+            << std::setprecision(1) << std::setw(7) << (totalProcess > 0 ? 100.*stats.wall[kProcess]/totalProcess : 0.) << "%"
+            << std::setw(11) << 1e6*percentile(stats, 0.5)
+            << std::setw(11) << 1e6*percentile(stats, 0.9)
+            << std::setw(11) << 1e6*percentile(stats, 0.99)
+            << std::setw(12) << 1e6*stats.maxWall
+            << std::setprecision(3) << std::setw(10) << stats.wall[kFinalize]
+            << std::setprecision(1) << std::setw(12) << stats.rssGrowInit/1024.
+            << std::setw(12) << stats.rssGrowProcess/1024. << std::endl;
+    }
+    out << std::setprecision(3);
+    out << "---- [ hpstr ][ Profiler ]: " << nEvents_ << " events in " << loopWall_ << " s";
+    if (loopWall_ > 0)
+        out << " (" << std::setprecision(1) << nEvents_/loopWall_ << " events/s)";
+    out << std::setprecision(3) << ", job " << jobWall << " s, peak RSS "
+        << peakRss()/1024. << " MB --------" << std::endl;
+
+    out.flags(flags);
+    out.precision(precision);
+
+    if (!report_.empty()) {
+        writeJson(report_ + ".json");
+        writeTree(report_ + ".root");
+        out << "---- [ hpstr ][ Profiler ]: Reports written to " << report_ << ".json and "
+            << report_ << ".root --------" << std::endl;
+    }
+}
+
+void ProcessProfiler::writeJson(const std::string& filename) const {
+    std::ofstream out(filename);
+    if (!out.is_open()) {
+        std::cerr << "---- [ hpstr ][ Profiler ]: Cannot write " << filename << std::endl;
+        return;
+    }
+    out << std::setprecision(9);
+    out << "{\n"
+        << "  \"events\": " << nEvents_ << ",\n"
+        << "  \"eventLoopWall\": " << loopWall_ << ",\n"
+        << "  \"eventsPerSecond\": " << (loopWall_ > 0 ? nEvents_/loopWall_ : 0.) << ",\n"
+        << "  \"jobWall\": " << wallNow() - jobStart_ << ",\n"
+        << "  \"peakRssKB\": " << peakRss() << ",\n"
+        << "  \"processors\": [";
+    for (unsigned int iproc = 0; iproc < stats_.size(); ++iproc) {
+        const Stats& stats = stats_[iproc];
+        out << (iproc ? "," : "") << "\n    {\n"
+            << "      \"name\": \"" << jsonEscape(stats.name) << "\",\n";
+        for (int phase = kInitialize; phase <= kFinalize; ++phase) {
+            out << "      \"" << PHASE_NAMES[phase] << "\": {\"wall\": " << stats.wall[phase]
+                << ", \"cpu\": " << stats.cpu[phase] << ", \"calls\": " << stats.calls[phase];
+            if (phase == kProcess) {
+                out << ", \"p50\": " << percentile(stats, 0.5)
+                    << ", \"p90\": " << percentile(stats, 0.9)
+                    << ", \"p99\": " << percentile(stats, 0.99)
+                    << ", \"max\": " << stats.maxWall;
+            }
+            out << "},\n";
+        }
+        out << "      \"rssAfterInitializeKB\": " << stats.rssAfterInit << ",\n"
+            << "      \"rssGrowthInitializeKB\": " << stats.rssGrowInit << ",\n"
+            << "      \"rssMaxGrowthProcessKB\": " << stats.rssGrowProcess << ",\n"
+            << "      \"rssAfterFinalizeKB\": " << stats.rssAfterFinal << "\n"
+            << "    }";
+    }
+    out << "\n  ]\n}\n";
+}
+
+void ProcessProfiler::writeTree(const std::string& filename) const {
+    TDirectory* cwd = gDirectory;
+    TFile* file = TFile::Open(filename.c_str(), "RECREATE");
+    if (file == nullptr || file->IsZombie()) {
+        std::cerr << "---- [ hpstr ][ Profiler ]: Cannot write " << filename << std::endl;
+        cwd->cd();
+        return;
+    }
+
+    std::string name;
+    double wall[3], cpu[3], p50, p90, p99, maxWall, eventsPerSecond;
+    long calls[3], events = nEvents_, rssAfterInit, rssGrowInit, rssGrowProcess, rssAfterFinal;
+    TTree* tree = new TTree("processorStats", "hpstr per-processor profile");
+    tree->Branch("name", &name);
+    for (int phase = kInitialize; phase <= kFinalize; ++phase) {
+        std::string prefix = PHASE_NAMES[phase];
+        tree->Branch((prefix + "Wall").c_str(), &wall[phase]);
+        tree->Branch((prefix + "Cpu").c_str(), &cpu[phase]);
+        tree->Branch((prefix + "Calls").c_str(), &calls[phase]);
+    }
+    tree->Branch("processP50", &p50);
+    tree->Branch("processP90", &p90);
+    tree->Branch("processP99", &p99);
+    tree->Branch("processMax", &maxWall);
+    tree->Branch("rssAfterInitializeKB", &rssAfterInit);
+    tree->Branch("rssGrowthInitializeKB", &rssGrowInit);
+    tree->Branch("rssMaxGrowthProcessKB", &rssGrowProcess);
+    tree->Branch("rssAfterFinalizeKB", &rssAfterFinal);
+    tree->Branch("events", &events);
+    tree->Branch("eventsPerSecond", &eventsPerSecond);
+
+    eventsPerSecond = loopWall_ > 0 ? nEvents_/loopWall_ : 0.;
+    for (auto& stats : stats_) {
+        name = stats.name;
+        for (int phase = kInitialize; phase <= kFinalize; ++phase) {
+            wall[phase] = stats.wall[phase];
+            cpu[phase] = stats.cpu[phase];
+            calls[phase] = stats.calls[phase];
+        }
+        p50 = percentile(stats, 0.5);
+        p90 = percentile(stats, 0.9);
+        p99 = percentile(stats, 0.99);
+        maxWall = stats.maxWall;
+        rssAfterInit = stats.rssAfterInit;
+        rssGrowInit = stats.rssGrowInit;
+        rssGrowProcess = stats.rssGrowProcess;
+        rssAfterFinal = stats.rssAfterFinal;
+        tree->Fill();
+    }
+    tree->Write();
+    file->Close();
+    delete file;
+    cwd->cd();
+}
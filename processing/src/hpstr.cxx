@@ -8,20 +8,82 @@
 //----------------//
 //   C++ StdLib   //
 //----------------//
+#include <algorithm>
+#include <chrono>
 #include <csignal>
 #include <cstdlib>
 #include <cstring>
+#include <fstream>
 #include <iostream>
+#include <memory>
 #include <stdexcept> 
+#include <string>
+#include <vector>
 
 //-----------//
 //   hpstr   //
 //-----------//
 #include "ConfigurePython.h"
+#include "FileScheduler.h"
+#include "HistoMerger.h"
 
 using namespace std; 
 
 void displayUsage(); 
+void reportPhase(const std::string& phase, std::chrono::steady_clock::time_point& start);
+
+/** Read a list of files, one per line, skipping empty lines and lines starting with # */
+std::vector<std::string> readFileList(const std::string& list) {
+    std::ifstream in(list);
+    if (!in)
+        throw std::runtime_error("[ hpstr ]: Cannot read the file list " + list);
+    std::vector<std::string> files;
+    std::string line;
+    while (std::getline(in, line)) {
+        line.erase(0, line.find_first_not_of(" \t"));
+        line.erase(line.find_last_not_of(" \t\r") + 1);
+        if (!line.empty() && line[0] != '#')
+            files.push_back(line);
+    }
+    return files;
+}
+
+/** Merge the outputs of several jobs, arguments are [-j threads] output input1 [input2 ...] */
+int runMerge(int argc, char **argv, int first) {
+    int nthreads = 1;
+    std::vector<std::string> files;
+    for (int iarg = first; iarg < argc; iarg++) {
+        if (!strcmp(argv[iarg], "-j") && iarg + 1 < argc)
+            nthreads = atoi(argv[++iarg]);
+        else
+            files.push_back(argv[iarg]);
+    }
+    if (files.size() < 2) {
+        displayUsage();
+        printf("  ** Merging requires an output and at least one input file. **\n");
+        return EXIT_FAILURE;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::string output = files.front();
+    files.erase(files.begin());
+    // A wildcard over the output directory can pick up the output of a previous merge
+    files.erase(std::remove(files.begin(), files.end(), output), files.end());
+    HistoMerger merger(files, output, nthreads);
+    int nproblems = merger.merge();
+    reportPhase("Merging", start);
+    if (nproblems)
+        std::cout << "---- [ hpstr ]: Merge found " << nproblems << " problems --------" << std::endl;
+    return nproblems ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+/** Print the time spent in a phase of the job and restart the clock. */
+void reportPhase(const std::string& phase, std::chrono::steady_clock::time_point& start) {
+    auto now = std::chrono::steady_clock::now();
+    std::cout << "---- [ hpstr ]: " << phase << " took "
+        << std::chrono::duration<double>(now - start).count() << " s --------" << std::endl;
+    start = now;
+}
 
 int main(int argc, char **argv) { 
 
@@ -30,14 +92,50 @@ int main(int argc, char **argv) {
         return EXIT_FAILURE;
     }
 
+    if (!strcmp(argv[1], "--merge"))
+        return runMerge(argc, argv, 2);
+
+    bool dry_run = false;
+    bool profile = false;
+    std::string profile_report;
+    std::string save_config;
+    std::string load_config;
+    std::string file_list;
+    int nworkers = 0;
+    bool keep_partials = false;
+    std::string cache_dir;
+    long cache_size = 0;
+
     int ptrpy = 1;
     for (ptrpy = 1; ptrpy < argc; ptrpy++) {
         std::cout << argv[ptrpy] << std::endl;
         if (strstr(argv[ptrpy], ".py"))
             break;
+        if (!strcmp(argv[ptrpy], "--dry-run"))
+            dry_run = true;
+        else if (!strcmp(argv[ptrpy], "--save-config") && ptrpy + 1 < argc)
+            save_config = argv[++ptrpy];
+        else if (!strcmp(argv[ptrpy], "--load-config") && ptrpy + 1 < argc)
+            load_config = argv[++ptrpy];
+        else if (!strcmp(argv[ptrpy], "--workers") && ptrpy + 1 < argc)
+            nworkers = atoi(argv[++ptrpy]);
+        else if (!strcmp(argv[ptrpy], "--file-list") && ptrpy + 1 < argc)
+            file_list = argv[++ptrpy];
+        else if (!strcmp(argv[ptrpy], "--keep-partials"))
+            keep_partials = true;
+        else if (!strcmp(argv[ptrpy], "--cache-dir") && ptrpy + 1 < argc)
+            cache_dir = argv[++ptrpy];
+        else if (!strcmp(argv[ptrpy], "--cache-size") && ptrpy + 1 < argc)
+            cache_size = atol(argv[++ptrpy])*1024*1024;
+        else if (!strcmp(argv[ptrpy], "--profile"))
+            profile = true;
+        else if (!strcmp(argv[ptrpy], "--profile-report") && ptrpy + 1 < argc) {
+            profile = true;
+            profile_report = argv[++ptrpy];
+        }
     }
 
-    if (ptrpy == argc) {
+    if (ptrpy == argc && load_config.empty()) {
         displayUsage(); 
         printf("  ** No python script provided. **\n");
         return EXIT_FAILURE;
@@ -45,16 +143,42 @@ int main(int argc, char **argv) {
 
     try {
 
+        auto start = std::chrono::steady_clock::now();
+
         std::cout << "---- [ hpstr ]: Loading configuration --------" << std::endl;
         
-        ConfigurePython cfg(argv[ptrpy], argv + ptrpy + 1, argc - ptrpy -1);
+        std::unique_ptr<ConfigurePython> cfg;
+        if (!load_config.empty())
+            cfg.reset(new ConfigurePython(load_config));
+        else
+            cfg.reset(new ConfigurePython(argv[ptrpy], argv + ptrpy + 1, argc - ptrpy -1));
 
         std::cout << "---- [ hpstr ]: Configuration load complete  --------" << std::endl;
+        reportPhase("Configuration", start);
 
-        Process* p = cfg.makeProcess();
+        if (!save_config.empty())
+            cfg->writeSnapshot(save_config);
+
+        Process* p = cfg->makeProcess(dry_run);
         int run_mode = p->getRunMode();
 
         std::cout << "---- [ hpstr ]: Process mode " << run_mode << " initialized.  --------" << std::endl;
+        reportPhase("Library loading and processor configuration", start);
+
+        if (dry_run) {
+            std::cout << "---- [ hpstr ]: Dry run, no events are processed --------" << std::endl;
+            int nproblems = p->dryRun();
+            reportPhase("Processor initialization", start);
+            nproblems += cfg->checkParameters();
+            std::cout << "---- [ hpstr ]: Dry run found " << nproblems << " problems --------" << std::endl;
+            return nproblems ? EXIT_FAILURE : EXIT_SUCCESS;
+        }
+
+        if (profile && nworkers == 0 && file_list.empty())
+            p->enableProfiling(profile_report);
+
+        if (!cache_dir.empty() && nworkers == 0 && file_list.empty())
+            p->enableCache(cache_dir, cache_size);
 
         // If Ctrl-c is used, immediately exit the application.
         struct sigaction act;
@@ -66,6 +190,41 @@ int main(int argc, char **argv) {
 
         std::cout << "---- [ hpstr ]: Start of processing --------" << std::endl;
 
+        if (nworkers > 0 || !file_list.empty()) {
+            std::vector<std::string> inputs = file_list.empty() ? p->getInputFiles() : readFileList(file_list);
+            if (p->getOutputFiles().empty())
+                throw std::runtime_error("[ hpstr ]: The configuration has no output file to merge into.");
+            std::string output = p->getOutputFiles().front();
+            nworkers = std::max(1, std::min(nworkers, (int)inputs.size()));
+
+            // Every worker gets its own processors, made from the parsed configuration
+            std::vector<std::unique_ptr<Process>> workers;
+            workers.emplace_back(p);
+            for (int iworker = 1; iworker < nworkers; ++iworker)
+                workers.emplace_back(cfg->makeProcess());
+            std::vector<Process*> processes;
+            for (int iworker = 0; iworker < nworkers; ++iworker) {
+                if (profile) {
+                    workers[iworker]->enableProfiling(profile_report.empty() ? "" 
+                            : profile_report + "_worker" + std::to_string(iworker));
+                }
+                if (!cache_dir.empty())
+                    workers[iworker]->enableCache(cache_dir, cache_size);
+                processes.push_back(workers[iworker].get());
+            }
+            reportPhase("Worker configuration", start);
+
+            std::cout << "---- [ hpstr ]: Processing " << inputs.size() << " files with " << nworkers 
+                << " workers --------" << std::endl;
+            FileScheduler scheduler(processes, inputs, output);
+            scheduler.setKeepPartials(keep_partials);
+            int nproblems = scheduler.run();
+            reportPhase("Processing", start);
+            if (nproblems)
+                std::cout << "---- [ hpstr ]: Processing found " << nproblems << " problems --------" << std::endl;
+            return nproblems ? EXIT_FAILURE : EXIT_SUCCESS;
+        }
+
         //TODO Make this better
         if (run_mode == 0) 
         {
@@ -88,6 +247,7 @@ int main(int argc, char **argv) {
         }
 
         std::cout << "---- [ hpstr ]: Event processing complete  --------" << std::endl;
+        reportPhase("Processing", start);
 
     } catch (exception& e) { 
         std::cerr << "Error! [" << e.what() << "] \n";
@@ -102,4 +262,25 @@ int main(int argc, char **argv) {
 void displayUsage() {
     printf("Usage: hpstr [application arguments] {configuration_script.py}"
             " [arguments to configuration script]\n");
+    printf("       hpstr [application arguments] --load-config {snapshot}\n");
+    printf("       hpstr --merge [-j threads] {output.root} {input.root} [input.root ...]\n");
+    printf("Application arguments:\n");
+    printf("  --dry-run              Resolve the configuration and initialize the processors"
+            " without processing events\n");
+    printf("  --save-config {file}   Write the resolved configuration to a snapshot\n");
+    printf("  --load-config {file}   Load the configuration from a snapshot instead of python\n");
+    printf("  --workers {n}          Process the input files on n worker threads and merge the"
+            " outputs into the first output file of the configuration, max_events then"
+            " applies to each file. Refused for n > 1 if a processor uses process-wide state,"
+            " e.g. VtxHistoProcessor and its projection file\n");
+    printf("  --file-list {file}     Input files, one per line, instead of the ones of the"
+            " configuration, implies --workers 1 if not given, so max_events applies to"
+            " each file\n");
+    printf("  --keep-partials        Keep the output of each file after the merge, they are"
+            " always kept if the merge reports problems\n");
+    printf("  --cache-dir {dir}      Reuse the cached output of the processors whose input file"
+            " and configuration did not change (ROOT -> Histo mode)\n");
+    printf("  --cache-size {MB}      Evict the least recently used cache entries above this size\n");
+    printf("  --profile              Print the time and memory used by each processor\n");
+    printf("  --profile-report {base} Same as --profile, also writes {base}.json and {base}.root\n");
 }
@@ -0,0 +1,174 @@
+/**
+ * @file compact_dst_read.cxx
+ * @brief Check that HpsEventFile reads back the tracks, particles and
+ *        vertices of a DST written in the standard and the compact
+ *        representation, with the vertices still pointing to their particles.
+ */
+
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "TFile.h"
+#include "TProcessID.h"
+#include "TRefArray.h"
+#include "TTree.h"
+
+#include "CalCluster.h"
+#include "Collections.h"
+#include "CompactEvent.h"
+#include "HpsEvent.h"
+#include "HpsEventFile.h"
+#include "Particle.h"
+#include "Track.h"
+#include "Vertex.h"
+
+namespace {
+
+    template <class T>
+    void deleteAll(std::vector<T*>& objects) {
+        for (auto obj : objects)
+            delete obj;
+        objects.clear();
+    }
+
+    /**
+     * @brief Write a DST with tracks, clusters, particles and vertices
+     *
+     * Vertex i of an event is made of the particles 2i and 2i+1.
+     *
+     * @return number of tracks, particles and vertices written
+     */
+    long writeDst(const std::string& filename, int nEvents, bool compact) {
+        TFile file(filename.c_str(), "RECREATE");
+        TTree* tree = new TTree("HPS_Event", "HPS event tree");
+        const std::string suffix = CompactEvent::kSuffix;
+        std::vector<Track*> tracks;
+        std::vector<CalCluster*> clusters;
+        std::vector<Particle*> particles;
+        std::vector<Vertex*> vertices;
+        std::vector<CompactTrack> compactTracks;
+        std::vector<CompactParticle> compactParticles;
+        std::vector<CompactVertex> compactVertices;
+        tree->Branch(Collections::ECAL_CLUSTERS, &clusters);
+        if (compact) {
+            tree->Branch((Collections::GBL_TRACKS + suffix).c_str(), &compactTracks)
+                ->SetTitle(CompactEvent::branchTitle("CompactTrack").c_str());
+            tree->Branch((Collections::FINAL_STATE_PARTICLES + suffix).c_str(), &compactParticles)
+                ->SetTitle(CompactEvent::branchTitle("CompactParticle", {{"tracks", Collections::GBL_TRACKS},
+                            {"clusters", Collections::ECAL_CLUSTERS}}).c_str());
+            tree->Branch((Collections::UC_V0VERTICES + suffix).c_str(), &compactVertices)
+                ->SetTitle(CompactEvent::branchTitle("CompactVertex",
+                            {{"particles", Collections::FINAL_STATE_PARTICLES}}).c_str());
+        } else {
+            tree->Branch(Collections::GBL_TRACKS, &tracks);
+            tree->Branch(Collections::FINAL_STATE_PARTICLES, &particles);
+            tree->Branch(Collections::UC_V0VERTICES, &vertices);
+        }
+
+        std::mt19937_64 rng(12345);
+        long nObjects = 0;
+        for (int ievent = 0; ievent < nEvents; ++ievent) {
+            int nTracks = rng() % 6;
+            int nClusters = rng() % 4;
+            for (int itrk = 0; itrk < nTracks; ++itrk) {
+                Track* track = new Track();
+                track->setTrackParameters(0.1*itrk, 0.01, 1e-4, 0.03, -0.1*itrk);
+                track->setCharge(itrk % 2 ? 1 : -1);
+                track->setID(itrk);
+                tracks.push_back(track);
+            }
+            for (int iclu = 0; iclu < nClusters; ++iclu) {
+                CalCluster* cluster = new CalCluster();
+                cluster->setEnergy(0.5 + iclu);
+                clusters.push_back(cluster);
+            }
+            for (int ipart = 0; ipart < nTracks; ++ipart) {
+                Particle* particle = new Particle();
+                particle->setTrack(tracks[ipart]);
+                if (ipart < nClusters)
+                    particle->setCluster(clusters[ipart]);
+                particle->setCharge(tracks[ipart]->getCharge());
+                particles.push_back(particle);
+            }
+            for (int ivtx = 0; ivtx < nTracks/2; ++ivtx) {
+                Vertex* vertex = new Vertex();
+                vertex->setID(ivtx);
+                vertex->addParticle(particles[2*ivtx]);
+                vertex->addParticle(particles[2*ivtx + 1]);
+                vertices.push_back(vertex);
+            }
+            if (compact) {
+                CompactEvent::packTracks(tracks, compactTracks);
+                CompactEvent::packParticles(particles, &tracks, &clusters, compactParticles);
+                CompactEvent::packVertices(vertices, &particles, compactVertices);
+            }
+            tree->Fill();
+            nObjects += tracks.size() + particles.size() + vertices.size();
+            deleteAll(vertices);
+            deleteAll(particles);
+            deleteAll(clusters);
+            deleteAll(tracks);
+        }
+        file.cd();
+        tree->Write();
+        file.Close();
+        return nObjects;
+    }
+
+    /** @return number of problems reading back a DST */
+    int checkDst(bool compact) {
+        const int nEvents = 2000;
+        std::string label = compact ? "compact" : "standard";
+        std::string dst = "compact_dst_read_" + label + ".root";
+        std::string out = "compact_dst_read_" + label + "_out.root";
+        long nWritten = writeDst(dst, nEvents, compact);
+
+        HpsEvent event;
+        HpsEventFile file(dst, out);
+        file.setupEvent(&event);
+        TTree* tree = event.getTree();
+        std::vector<Track*>* tracks{nullptr};
+        std::vector<Particle*>* particles{nullptr};
+        std::vector<Vertex*>* vertices{nullptr};
+        int nproblems = 0;
+        if (!tree || tree->SetBranchAddress(Collections::GBL_TRACKS, &tracks) < 0
+                || tree->SetBranchAddress(Collections::FINAL_STATE_PARTICLES, &particles) < 0
+                || tree->SetBranchAddress(Collections::UC_V0VERTICES, &vertices) < 0) {
+            std::cerr << "[ compact-dst-read ]: cannot read the collections of the " << label << " DST" << std::endl;
+            ++nproblems;
+        } else {
+            // As Process::runOnRoot, the object numbers of the references are reused every event
+            UInt_t objectCount = TProcessID::GetObjectCount();
+            long nRead = 0, nLost = 0;
+            while (file.nextEvent()) {
+                nRead += tracks->size() + particles->size() + vertices->size();
+                for (unsigned int ivtx = 0; ivtx < vertices->size(); ++ivtx) {
+                    TRefArray parts = vertices->at(ivtx)->getParticles();
+                    if (parts.GetEntriesFast() != 2 || parts.At(0) != particles->at(2*ivtx)
+                            || parts.At(1) != particles->at(2*ivtx + 1))
+                        ++nLost;
+                }
+                TProcessID::SetObjectCount(objectCount);
+            }
+            if (nRead != nWritten || nLost) {
+                std::cerr << "[ compact-dst-read ]: " << label << " DST: read " << nRead << " of " << nWritten
+                          << " objects, " << nLost << " vertices without their particles" << std::endl;
+                ++nproblems;
+            }
+        }
+        file.close();
+        std::remove(dst.c_str());
+        std::remove(out.c_str());
+        return nproblems;
+    }
+}
+
+int main(int argc, char** argv) {
+
+    int nproblems = checkDst(false) + checkDst(true);
+    std::cout << "[ compact-dst-read ]: " << (nproblems ? "FAILED" : "passed") << std::endl;
+    return nproblems ? 1 : 0;
+}
@@ -38,6 +38,8 @@ svtblana.parameters["rawSvtHitsColl"] = "SVTRawTrackerHits"
 svtblana.parameters["histCfg"] = os.environ['HPSTR_BASE']+'/analysis/plotconfigs/svt/Svt2DBl.json'
 svtblana.parameters["triggerBankColl"] = "TSBank"
 svtblana.parameters["triggerBankCfg"] = os.environ['HPSTR_BASE']+'/analysis/selections/triggerSelection.json'
+# Store only the hit channel vs ADC bins, for low occupancy runs
+svtblana.parameters["sparse"] = 0
 
 # Sequence which the processors will run.
 p.sequence = [svtblana]
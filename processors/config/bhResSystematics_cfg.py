@@ -72,6 +72,8 @@ bhressys.parameters["function_file"] = options.function_file
 bhressys.parameters["function_name"] = options.function_name
 bhressys.parameters["num_toys"] = options.num_toys
 bhressys.parameters["toy_num_iters"] = options.toy_num_iters
+bhressys.parameters["fit_cache_dir"] = ""
+bhressys.parameters["nThreads"] = 1
 
 # Sequence which the processors will run.
 p.sequence = [bhressys]
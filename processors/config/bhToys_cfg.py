@@ -77,6 +77,8 @@ bhtoys.parameters["res_scale"] = options.res_scale
 bhtoys.parameters["signal_shape_h_name"] = options.signal_shape_h_name
 bhtoys.parameters["signal_shape_h_file"] = options.signal_shape_h_file
 bhtoys.parameters["bkg_model"] = options.bkg_model
+bhtoys.parameters["fit_cache_dir"] = ""
+bhtoys.parameters["toy_poisson"] = 0
 
 # Sequence which the processors will run.
 p.sequence = [bhtoys]
@@ -36,6 +36,10 @@ if options.nevents > -1:
     cnvStd.parameters["maxEvent"] = options.skip_events+options.nevents
 else:
     cnvStd.parameters["maxEvent"] = -1
+# Decode the StdHep records in a separate thread
+cnvStd.parameters["pipeline"] = 1
+# Convert through LCIO events instead of decoding the records directly
+cnvStd.parameters["lcioReader"] = 0
 # Sequence which the processors will run.
 p.sequence = [cnvStd]
 
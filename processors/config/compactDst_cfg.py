@@ -0,0 +1,48 @@
+import HpstrConf
+import os
+import sys
+import baseConfig as base
+
+options = base.parser.parse_args()
+
+# Use the input file to set the output file name
+inFilename = options.inFilename
+outFilename = options.outFilename
+
+print('Input file:  %s' % inFilename)
+print('Output file: %s' % outFilename)
+
+p = HpstrConf.Process()
+
+p.run_mode = 1
+p.skip_events = options.skip_events
+p.max_events = options.nevents
+
+# Library containing processors
+p.add_library("libprocessors")
+
+###############################
+#          Processors         #
+###############################
+compact = HpstrConf.Processor('compact', 'CompactDstProcessor')
+
+###############################
+#   Processor Configuration   #
+###############################
+# The output is read like the input DST, the compact collections are
+# unpacked to the standard ones when the file is opened.
+compact.parameters["debug"] = 0
+compact.parameters["trkColls"] = ['KalmanFullTracks']
+compact.parameters["partColls"] = ['FinalStateParticles_KF']
+compact.parameters["partTrkColls"] = ['KalmanFullTracks']
+compact.parameters["partClusterColls"] = ['RecoEcalClusters']
+compact.parameters["vtxColls"] = ['UnconstrainedV0Vertices_KF']
+compact.parameters["vtxPartColls"] = ['FinalStateParticles_KF']
+
+# Sequence which the processors will run.
+p.sequence = [compact]
+
+p.input_files = inFilename
+p.output_files = [outFilename]
+
+p.printProcess()
@@ -44,11 +44,15 @@ rawAnaSvt.parameters["anaName"] = 'rawSvtHitAna'
 rawAnaSvt.parameters["trkrHitColl"] = 'SVTRawTrackerHits'  # 'SVTRawHitsOnTrack_KF'#'SVTRawTrackerHits'
 rawAnaSvt.parameters["histCfg"] = os.environ['HPSTR_BASE']+'/analysis/plotconfigs/svt/rawSvtAnaHits.json'
 rawAnaSvt.parameters["sample"] = 0
+rawAnaSvt.parameters["nativeFit"] = 0     # refit the raw samples with the native APV25 fitter
+rawAnaSvt.parameters["fitBenchmark"] = 0  # compare the native fitter against the TF1 fit
+rawAnaSvt.parameters["pulseModel"] = 0    # native pulse shape: 0 four-pole, 1 two-pole
 
 RegionPath = os.environ['HPSTR_BASE']+"/analysis/selections/svtHit/"
 
 rawAnaSvt.parameters["baselineFile"] = os.environ['HPSTR_BASE']+"/processors/dat/hps_14552_offline_baselines.dat"
 rawAnaSvt.parameters["timeProfiles"] = os.environ['HPSTR_BASE'] + "/processors/dat/hpssvt_014393_database_svt_pulse_shapes_final.dat"
+rawAnaSvt.parameters["calibCacheDir"] = ""  # e.g. '/tmp/hpstr_svtcalib' to share the parsed calibration between jobs
 
 rawAnaSvt.parameters["regionDefinitions"] = [RegionPath+'OneFit.json',
                                              RegionPath+'FirstFit.json',
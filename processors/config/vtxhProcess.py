@@ -36,6 +36,8 @@ vtxPostProc = HpstrConf.Processor('vtxPostProc', 'VtxHistoProcessor')
 #MCParticles
 vtxPostProc.parameters["debug"] = 1
 vtxPostProc.parameters["rebin"] = 4
+vtxPostProc.parameters["nThreads"] = 1
+vtxPostProc.parameters["fitCacheDir"] = ""
 #KF
 #vtxPostProc.parameters["selection"] = "vtxana_kf_vtxSelection"
 #GBL
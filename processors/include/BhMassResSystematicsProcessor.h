@@ -76,10 +76,23 @@ class BhMassResSystematicsProcessor : public Processor {
         virtual void finalize();
 
     private:
+        /**
+         * @brief Add the result of one resolution run to the tuple vectors.
+         * 
+         * @param prefix Prefix of the vector names, "toy_" for the toy runs.
+         * @param res_scale The resolution scale of the run.
+         * @param mass_resolution The scaled mass resolution at the mass hypothesis.
+         * @param result The search result.
+         */
+        void fillResult(const std::string& prefix, double res_scale, double mass_resolution,
+                        HpsFitResult* result);
+
         TFile* inF_{nullptr}; //!< description
         TFile* function_file_{nullptr}; //!< The file that contains the mass resolution error parameterization.
         std::string function_name_{""}; //!< The name of the function object in the error file.
         BumpHunter* bump_hunter_{nullptr}; //!< The bump hunter manager
+        std::string fit_cache_dir_{""}; //!< Directory of the fit result cache. Empty disables the cache.
+        FitCache* fit_cache_{nullptr}; //!< The fit result cache
         FlatTupleMaker* flat_tuple_{nullptr}; //!< The flat tuple manager
         std::string massSpectrum_{"testSpectrum_h"}; //!< The name of the mass spectrum to fit.
         TH1* mass_spec_h{nullptr}; //!< The mass spectrum to fit
@@ -93,6 +106,7 @@ class BhMassResSystematicsProcessor : public Processor {
         int res_runs_{1000}; //!< How many resolution variance runs to make.
         int toy_res_runs_{100}; //!< How many resolution variance runs to make.
         int nToys_{1000}; //!< How many toys to generated.
+        int nThreads_{1}; //!< Number of resolution runs fitted concurrently, <= 0 uses one per core. With more than one, all the fits use Minuit2 if TMinuit is the default.
         int debug_{0}; //!< Debug Level
 };
 
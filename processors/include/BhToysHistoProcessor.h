@@ -81,6 +81,10 @@ class BhToysHistoProcessor : public Processor {
 
         BumpHunter* bump_hunter_{nullptr}; //!< The bump hunter manager
 
+        std::string fit_cache_dir_{""}; //!< Directory of the fit result cache. Empty disables the cache.
+
+        FitCache* fit_cache_{nullptr}; //!< The fit result cache
+
         FlatTupleMaker* flat_tuple_{nullptr}; //!< The flat tuple manager
 
         std::string massSpectrum_{"testSpectrum_h"}; //!< The name of the mass spectrum to fit.
@@ -125,6 +129,12 @@ class BhToysHistoProcessor : public Processor {
          */
         int bkg_mult_{1};
 
+        /**
+         * Draw the toy bin contents from independent Poisson distributions, so
+         * that the number of events per toy fluctuates. Defaults to false.
+         */
+        int toy_poisson_{0};
+
         double res_scale_{1.00}; //!< The factor by which to scale the mass resolution function.
         bool asymptotic_limit_{true}; //!< Whether to use the asymptotic upper limit or the power constrained. Defaults to asymptotic.
         int bkg_model_{1}; //!< What background model type to use.
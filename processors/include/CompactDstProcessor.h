@@ -0,0 +1,111 @@
+#ifndef __COMPACT_DST_PROCESSOR_H__
+#define __COMPACT_DST_PROCESSOR_H__
+
+//-----------------//
+//   C++  StdLib   //
+//-----------------//
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+//----------//
+//   ROOT   //
+//----------//
+#include "TFile.h"
+#include "TTree.h"
+
+//-----------//
+//   hpstr   //
+//-----------//
+#include "Processor.h"
+#include "CompactEvent.h"
+
+/**
+ * @brief Copy a DST, storing some of its collections in the compact representation
+ *
+ * The output tree has all the branches of the input one, except the track,
+ * particle and vertex collections selected in the configuration, which are
+ * replaced by their compact version, see CompactEvent. Jobs reading the
+ * output see the standard collections, HpsEventFile unpacks them.
+ * The collections the particles and vertices point to must be compacted
+ * with them, the clusters stay in their standard branch.
+ */
+class CompactDstProcessor : public Processor {
+
+    public:
+        /**
+         * @brief Class constructor.
+         *
+         * @param name Name for this instance of the class.
+         * @param process The Process class associated with Processor, provided
+         *                by the processing framework.
+         */
+        CompactDstProcessor(const std::string& name, Process& process);
+
+        /** Destructor */
+        ~CompactDstProcessor();
+
+        /**
+         * @brief Configure the Processor
+         *
+         * @param parameters The configuration parameters
+         */
+        virtual void configure(const ParameterSet& parameters);
+
+        /**
+         * @brief Bind the input collections and make the output tree
+         *
+         * @param tree input tree
+         */
+        virtual void initialize(TTree* tree);
+
+        /**
+         * @brief Move the output tree to the output file
+         *
+         * @param outFile output file
+         */
+        virtual void setFile(TFile* outFile);
+
+        /**
+         * @brief Pack the selected collections and fill the output tree
+         *
+         * @param ievent The Event to process.
+         */
+        virtual bool process(IEvent* ievent);
+
+        /** Write the output tree */
+        virtual void finalize();
+
+    private:
+        /** @struct Collection */
+        template <class C, class T>
+        struct Collection {
+            std::vector<T*>* objects{nullptr}; //!< input collection
+            std::vector<C> compact; //!< compact collection, written to the output
+        };
+
+        /** Add the compact branch of a collection to the output tree */
+        template <class C, class T>
+        void addBranch(const std::string& name, Collection<C, T>& coll, const std::string& type,
+                const std::vector<std::pair<std::string, std::string>>& refs = {});
+
+        std::vector<std::string> trkColls_; //!< track collections to compact
+        std::vector<std::string> partColls_; //!< particle collections to compact
+        std::vector<std::string> partTrkColls_; //!< track collection of each particle collection
+        std::vector<std::string> partClusterColls_; //!< cluster collection of each particle collection
+        std::vector<std::string> vtxColls_; //!< vertex collections to compact
+        std::vector<std::string> vtxPartColls_; //!< particle collection of each vertex collection
+
+        std::map<std::string, Collection<CompactTrack, Track>> tracks_; //!< tracks by collection name
+        std::map<std::string, Collection<CompactParticle, Particle>> particles_; //!< particles by collection name
+        std::map<std::string, Collection<CompactVertex, Vertex>> vertices_; //!< vertices by collection name
+        std::map<std::string, std::vector<CalCluster*>*> clusters_; //!< clusters the particles point to
+
+        TTree* out_{nullptr}; //!< output tree
+        long nEvents_{0}; //!< number of events written
+        int debug_{0}; //!< debug level
+
+}; // CompactDstProcessor
+
+#endif // __COMPACT_DST_PROCESSOR_H__
@@ -32,6 +32,7 @@
 #include "CalCluster.h"
 #include "CalHit.h"
 #include "Collections.h"
+#include "EcalHitTable.h"
 #include "Processor.h"
 
 typedef long long long64;
@@ -90,13 +91,14 @@ class ECalDataProcessor : public Processor {
     private: 
 
         /**
-         * @brief Method to unpack field value from a calorimeter hit ID.
+         * @brief Method to unpack the crystal indices from a calorimeter hit ID.
          * 
-         * @param field The field ID to unpack
          * @param hit The CalorimeterHit whose ID will be used to unpack the 
-         *            the field value. 
+         *            the indices. 
+         * @param index_x The crystal index along x
+         * @param index_y The crystal index along y
          */
-        UTIL::BitFieldValue getIdentifierFieldValue(std::string field, EVENT::CalorimeterHit* hit);
+        void getCrystalIndices(EVENT::CalorimeterHit* hit, int& index_x, int& index_y);
 
         /** TClonesArray collection containing all ECal hits. */ 
         std::vector<CalHit*> cal_hits_; 
@@ -111,6 +113,17 @@ class ECalDataProcessor : public Processor {
         /** Encoding string describing cell ID. */
         const std::string encoder_string_{"system:6,layer:2,ix:-8,iy:-6"};
 
+        /** Decoder of the cell ID, built once from the encoding string. */
+        UTIL::BitField64 decoder_{encoder_string_};
+        size_t ix_field_{decoder_.index("ix")}; //!< index of the ix field in the decoder
+        size_t iy_field_{decoder_.index("iy")}; //!< index of the iy field in the decoder
+
+        /** Hits of the event indexed by crystal, used to link the cluster hits. */
+        EcalHitTable hit_table_;
+
+        /** Number of hits which are not on a crystal and could not be added to the table. */
+        long rejected_hits_{0};
+
         int debug_{0}; //!< Debug Level
 
 }; // ECalDataProcessor
@@ -16,6 +16,7 @@
 #include <iostream>
 #include <fstream>
 #include <algorithm>
+#include <vector>
 //----------//
 //   LCIO   //
 //----------//
@@ -36,6 +37,7 @@
 #include "VTPData.h"
 #include "TSData.h"
 #include "TriggerData.h"
+#include "TriggerDecoder.h"
 #include "Event.h"
 
 // Forward declarations
@@ -112,6 +114,9 @@ class EventProcessor : public Processor {
         /** Parsing method */
         void parseTSData(EVENT::LCGenericObject* ts_data_lcio);
 
+        std::vector<int> vtpWords_; //!< raw words of the VTP bank, reused between events
+        std::vector<int> tsWords_; //!< raw words of the TS bank, reused between events
+
         /** single events checks */
         std::string run_evt_list_{""};
         std::map<int,std::vector<int >> run_evts_map_; //!< description
@@ -36,13 +36,19 @@
 #include "CalCluster.h"
 #include "Collections.h"
 #include "MCParticle.h"
+#include "MCTruthGraph.h"
 #include "Processor.h"
 #include "Track.h"
 #include "Event.h"
 
 /**
  * @brief Processor used to translate LCIO MCParticles to DST MCParticle objects.
- * more details
+ *
+ * The particles of each event are put in an MCTruthGraph, which indexes
+ * them by LCIO id and computes for each particle whether it descends from
+ * one of ancestorPDGs. When trkRelCollLcio names an LCRelation collection
+ * between tracks and MCParticles, the LCIO id of the related track is
+ * stored in each particle.
  */
 class MCParticleProcessor : public Processor { 
 
@@ -94,6 +100,10 @@ class MCParticleProcessor : public Processor {
         std::vector<MCParticle*> mc_particles_{}; 
         std::string mcPartCollLcio_{"MCParticle"}; //!< description
         std::string mcPartCollRoot_{"MCParticle"}; //!< description
+        std::string trkRelCollLcio_{""}; //!< track to MCParticle relations, not used if empty
+        std::vector<int> ancestorPDGs_{622, 625}; //!< PDG ids looked for in the ancestry
+
+        MCTruthGraph truth_graph_; //!< graph of the particles of the current event
 
         int debug_{0}; //!< Debug level
 
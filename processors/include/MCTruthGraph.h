@@ -0,0 +1,128 @@
+/**
+ * @file MCTruthGraph.h
+ * @brief Per event graph of the LCIO MCParticles.
+ */
+
+#ifndef __MC_TRUTH_GRAPH_H__
+#define __MC_TRUTH_GRAPH_H__
+
+//----------------//
+//   C++ StdLib   //
+//----------------//
+#include <unordered_map>
+#include <vector>
+
+//----------//
+//   LCIO   //
+//----------//
+#include <EVENT/LCCollection.h>
+#include <EVENT/MCParticle.h>
+
+/**
+ * @brief Parent/daughter graph of the MCParticles of an event
+ *
+ * Particles are identified by their position in the collection. The LCIO
+ * id of each particle is indexed in a hash map and the parents and
+ * daughters are stored as adjacency arrays, so looking up a particle or
+ * walking the graph does not search the collection. For a list of PDG ids
+ * (e.g. 622 and 625 for the A' and the dark vector) the nearest ancestor
+ * with each id is computed once when the graph is built, so "does this
+ * particle come from a 622" is a single lookup. Tracks are linked to the
+ * particles through an LCRelation collection between tracks and
+ * MCParticles, in either direction.
+ */
+class MCTruthGraph {
+
+    public:
+
+        /** Range of particle indices, e.g. the parents of a particle */
+        struct Range {
+            const int* first; //!< first index
+            const int* last; //!< one past the last index
+            const int* begin() const { return first; };
+            const int* end() const { return last; };
+            int size() const { return last - first; };
+        };
+
+        /**
+         * @brief Set the PDG ids for which the nearest ancestor is precomputed
+         *
+         * @param pdgs PDG ids
+         */
+        void setAncestorPDGs(const std::vector<int>& pdgs) { ancestorPDGs_ = pdgs; };
+
+        /**
+         * @brief Build the graph of the particles of an event
+         *
+         * Parents that are not in the collection are ignored.
+         *
+         * @param particles MCParticle collection
+         */
+        void build(EVENT::LCCollection* particles);
+
+        /**
+         * @brief Link the tracks to the particles
+         *
+         * When a track or a particle has several relations, the one with the
+         * largest weight is kept.
+         *
+         * @param relations LCRelations between tracks and MCParticles
+         */
+        void linkTracks(EVENT::LCCollection* relations);
+
+        /** @return number of particles */
+        int size() const { return particles_.size(); };
+
+        /** @return particle at index i */
+        EVENT::MCParticle* particle(int i) const { return particles_[i]; };
+
+        /**
+         * @param id LCIO id of a particle
+         * @return index of the particle, -1 if it is not in the graph
+         */
+        int index(int id) const;
+
+        /** @return indices of the parents of particle i, in the LCIO order */
+        Range parents(int i) const {
+            return {parents_.data() + parentOffsets_[i], parents_.data() + parentOffsets_[i+1]};
+        };
+
+        /** @return indices of the daughters of particle i, in the LCIO order */
+        Range daughters(int i) const {
+            return {daughters_.data() + daughterOffsets_[i], daughters_.data() + daughterOffsets_[i+1]};
+        };
+
+        /**
+         * @param i particle index
+         * @param pdg one of the PDG ids given to setAncestorPDGs
+         * @return index of the nearest ancestor with this PDG id, -1 if none
+         */
+        int ancestor(int i, int pdg) const;
+
+        /** @return PDG ids of setAncestorPDGs found in the ancestry of particle i */
+        std::vector<int> ancestorPDGs(int i) const;
+
+        /** @return LCIO id of the track linked to particle i, -1 if none */
+        int trackID(int i) const { return trackIDs_.empty() ? -1 : trackIDs_[i]; };
+
+        /**
+         * @param trackID LCIO id of a track
+         * @return index of the particle linked to the track, -1 if none
+         */
+        int trackParticle(int trackID) const;
+
+    private:
+
+        std::vector<EVENT::MCParticle*> particles_; //!< particles, in the collection order
+        std::unordered_map<int, int> index_; //!< LCIO id to index
+        std::vector<int> parentOffsets_; //!< first parent of each particle in parents_
+        std::vector<int> parents_; //!< parent indices
+        std::vector<int> daughterOffsets_; //!< first daughter of each particle in daughters_
+        std::vector<int> daughters_; //!< daughter indices
+        std::vector<int> ancestorPDGs_; //!< PDG ids of the precomputed ancestors
+        std::vector<int> ancestors_; //!< nearest ancestor of each particle for each PDG id
+        std::vector<int> trackIDs_; //!< linked track of each particle
+        std::unordered_map<int, int> trackParticles_; //!< track LCIO id to particle index
+};
+
+#endif // __MC_TRUTH_GRAPH_H__
@@ -5,6 +5,7 @@
 #include "Processor.h"
 #include "ZBiHistos.h"
 #include "IterativeCutSelector.h"
+#include "CutPassCache.h"
 #include "SimpEquations.h"
 #include "SimpAnaTTree.h"
 
@@ -71,16 +72,6 @@ class SimpZBiOptimizationProcessor : public Processor {
          */
         double calculateZBi(double n_on, double n_off, double tau);
 
-        /**
-         *@brief description
-         */
-        bool failPersistentCuts(SimpAnaTTree* MTT);
-
-        /**
-         *@brief description
-         */
-        bool failTestCut(std::string cutname, SimpAnaTTree* MTT);
-
         /**
          *@brief description
          */
@@ -171,6 +162,10 @@ class SimpZBiOptimizationProcessor : public Processor {
         std::map<std::string, std::pair<double,int>>* testCutsPtr_; //<! description
         IterativeCutSelector *persistentCutsSelector_{nullptr}; //<! description
         std::map<std::string, std::pair<double,int>>* persistentCutsPtr_; //<! description
+        std::shared_ptr<CutPassCache> signalPersistentCuts_; //<! persistent cuts bound to the signal tuple
+        std::shared_ptr<CutPassCache> bkgPersistentCuts_; //<! persistent cuts bound to the background tuple
+        std::shared_ptr<CutPassCache> signalTestCuts_; //<! test cuts bound to the signal tuple
+        std::shared_ptr<CutPassCache> bkgTestCuts_; //<! test cuts bound to the background tuple
 
         //backgroun
         std::string tritrigFilename_{""}; //<! description
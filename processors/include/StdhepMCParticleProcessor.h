@@ -27,6 +27,7 @@
 #include <IMPL/MCParticleImpl.h>
 
 #include <UTIL/LCStdHepRdr.h>
+#include <UTIL/lStdHep.hh>
 
 
 //----------//
@@ -42,7 +43,16 @@
 
 /**
  * @brief Processor used to translate StdHep MCParticles to ROOT MCParticle objects.
- * more details
+ *
+ * By default the StdHep records are decoded with UTIL::lStdHep directly into
+ * MCParticle objects that are reused from event to event, following what
+ * UTIL::LCStdHepRdr does so the output is identical to the conversion through
+ * LCIO events, which is still available with lcioReader = 1. With
+ * pipeline = 1 the records are decoded in a separate thread while the
+ * previous events are filled in the tree.
+ *
+ * The first skipEvent records are skipped and the records up to maxEvent
+ * (excluded) are converted.
  */
 class StdhepMCParticleProcessor : public Processor { 
 
@@ -100,10 +110,68 @@ class StdhepMCParticleProcessor : public Processor {
 
 
     private: 
+
+        /** Converted particles of one event */
+        struct EventSlot {
+            std::vector<MCParticle*> particles; //!< particles of the event, from the pool
+            std::vector<MCParticle*> pool; //!< particles owned by the slot, reused from event to event
+            std::vector<int> firstParent; //!< index of the first parent of each particle, -1 if none
+
+            EventSlot() = default;
+            EventSlot(const EventSlot&) = delete;
+            EventSlot& operator=(const EventSlot&) = delete;
+            ~EventSlot();
+        };
+
+        /**
+         * @brief Read the next record
+         *
+         * @param reader
+         * @return false at the end of the file or on a read error
+         */
+        bool readRecord(UTIL::lStdHep& reader);
+
+        /**
+         * @brief Convert the current record of the reader
+         *
+         * @param reader
+         * @param slot filled with the particles of the record
+         */
+        void decodeEvent(UTIL::lStdHep& reader, EventSlot& slot);
+
+        /**
+         * @brief Set up the LCIO ids of the first record
+         *
+         * LCIO numbers its objects with one counter of the process. The
+         * ids an event, its collection and a particle take are measured
+         * once on a few objects, the records are then numbered without
+         * making LCIO objects.
+         */
+        void initLcioIds();
+
+        /**
+         * @brief Take the LCIO ids LCStdHepRdr would use for a record
+         *
+         * @param nParticles number of particles of the record
+         * @return id of the first particle
+         */
+        int takeLcioIds(int nParticles);
+
+        /** Fill the tree with the particles of a slot */
+        void fillEvent(EventSlot& slot);
+
+        /** Convert through LCIO events built by UTIL::LCStdHepRdr */
+        bool processLcio();
+
         std::string inFilename_; //!< stdhep input file
         std::string mcPartCollStdhep_{"MCParticle"}; //!< name temporary lcio collection
         int maxEvent_{-1}; //!< max stdhep event number to convert
         int skipEvent_{0};//!< skipped event numbers to convet
+        int pipeline_{1}; //!< decode the records in a separate thread
+        int lcioReader_{0}; //!< convert through LCIO events instead of decoding the records directly
+        int nextLcioId_{0}; //!< LCIO id of the event of the next record
+        int lcioEventIds_{0}; //!< LCIO ids taken by an event and its collection
+        int lcioParticleIds_{1}; //!< LCIO ids taken by a particle
         TFile* outF_{nullptr}; //!< root tuple outfile
         std::string mcPartCollRoot_{"MCParticle"}; //!< name root collection
         std::vector<MCParticle*> mc_particles_{}; //!< list of converted MCParticles
@@ -82,8 +82,8 @@ class SvtBl2DAnaProcessor : public Processor {
 
         TBranch* btriggerBank_{nullptr}; //!< description
         TObject* triggerBank_{}; //!< description
-        std::map<std::string, bool> prescaledtriggerMap_; //!< description
-        std::map<std::string, bool> exttriggerMap_; //!< description
+        std::vector<bool TSData::tsBits::*> selectedTriggers_; //!< bits of the selected triggers
+        bool sparse_{false}; //!< sparse channel vs ADC counts, for low occupancy runs
 
         int debug_{0}; //!< Debug level
 
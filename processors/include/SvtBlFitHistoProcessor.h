@@ -106,6 +106,10 @@ class SvtBlFitHistoProcessor : public Processor {
 
         std::string simpleGausFit_;//!< description
 
+        //Fit result cache. Disabled if no directory is given.
+        std::string fitCacheDir_{""};//!< description
+        FitCache* fitCache_{nullptr};//!< description
+
         FlatTupleMaker* flat_tuple_{nullptr};//!< description
 
 
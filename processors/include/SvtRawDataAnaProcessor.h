@@ -15,6 +15,8 @@
 #include "CalCluster.h"
 #include "Track.h"
 #include "TrackerHit.h"
+#include "Apv25PulseFitter.h"
+#include "SvtCalibrationCache.h"
 
 //#include <IMPL/TrackerHitImpl.h>"
 //ROOT
@@ -47,7 +49,7 @@ class SvtRawDataAnaProcessor : public Processor {
 
         virtual void initialize(TTree* tree);
         
-        virtual void sample(RawSvtHit* thisHit, std::string word, IEvent* ievent, long t,int i);
+        virtual void sample(RawSvtHit* thisHit, std::string word, IEvent* ievent, long t,int i, int hitIndex = -1);
 
         virtual TF1* fourPoleFitFunction(std::string word, int caser);
 
@@ -63,6 +65,15 @@ class SvtRawDataAnaProcessor : public Processor {
 
     private:
 
+        /** Build the native fitter calibration of every channel from the baseline and time arrays */
+        void buildFitChannels();
+
+        /** @return position of the hit channel in fitChannels_, -1 if unknown */
+        int channelIndex(RawSvtHit* hit);
+
+        /** Refit all the hits of the event with the native fitter, and with the TF1 path when benchmarking */
+        void fitEventHits(long eventTime);
+
         //Containers to hold histogrammer info
         RawSvtHitHistos* histos{nullptr};
         std::string  histCfgFilename_;
@@ -107,8 +118,28 @@ class SvtRawDataAnaProcessor : public Processor {
         std::vector<std::string> regions_;
         std::string baselineFile_;
         std::string timeProfiles_;
+        std::string calibCacheDir_{""}; //!< directory of the binary calibration cache, disabled if empty
         int tphase_{6};
 
+        //Native pulse fitting
+        int nativeFit_{0}; //!< refit the hits with the native fitter
+        int fitBenchmark_{0}; //!< compare the native fitter against the TF1 path
+        int pulseModel_{0}; //!< native pulse shape, 0 four-pole, 1 two-pole
+        Apv25PulseFitter fitter_; //!< native waveform fitter
+        std::vector<Apv25PulseFitter::Channel> fitChannels_; //!< calibration per channel
+        std::map<std::pair<int,int>,int> hybridOffsets_; //!< (layer, module) -> first channel index
+        std::vector<Apv25PulseFitter::Result> nativeFits_; //!< native fits of the current event hits
+        TF1* benchFunc_[2]{nullptr,nullptr}; //!< TF1 path functions for one and two pulses
+        double benchNativeTime_{0}; //!< time spent in native fits [s]
+        double benchTF1Time_{0}; //!< time spent in TF1 fits [s]
+        long benchHits_{0}; //!< hits fitted by both paths
+        long benchFailed_{0}; //!< hits where one of the fits failed
+        double benchSumDT0_{0}; //!< sum of the t0 differences
+        double benchSumDT02_{0}; //!< sum of the squared t0 differences
+        double benchSumDAmp_{0}; //!< sum of the relative amplitude differences
+        double benchSumDAmp2_{0}; //!< sum of the squared relative amplitude differences
+        double benchMaxDT0_{0}; //!< largest absolute t0 difference
+
         //Debug Level
         int debug_{0};
 
@@ -104,6 +104,8 @@ class VertexAnaProcessor : public Processor {
         std::vector<Vertex*>* vtxs_{}; //!< description
         std::vector<Track*>* trks_{}; //!< description
         std::vector<TrackerHit*>* hits_{}; //!< description
+        SiClusterIndex hitIndex_; //!< per-event index of hits_ used for track isolations
+        bool hitIndexBuilt_{false}; //!< hitIndex_ is up to date for the current event
         std::vector<MCParticle*>* mcParts_{}; //!< description
 
         std::string anaName_{"vtxAna"}; //!< description
@@ -56,6 +56,13 @@ class VtxHistoProcessor : public Processor {
          */
         virtual bool process();
 
+        /**
+         * @brief The projections are written to the process-wide file of HistogramHelpers
+         * 
+         * @return true
+         */
+        virtual bool usesSharedState() const { return true; }
+
         /**
          * @brief description
          * 
@@ -84,6 +91,9 @@ class VtxHistoProcessor : public Processor {
 
         int debug_{0}; //!< Debug Level
         int rebin_{1}; //!< Rebin factor
+        int nThreads_{1}; //!< Number of threads fitting the projections, <= 0 uses all cores
+        std::string fitCacheDir_{""}; //!< Fit result cache directory, disabled if empty
+        FitCache* fitCache_{nullptr}; //!< Fit result cache
 
         std::vector<std::string> selections_{}; //!< Selection folder
         std::vector<std::string> projections_; //!< 2D histos to project
@@ -36,6 +36,7 @@ using json = nlohmann::json;
 #include "CalHit.h"
 #include "Event.h"
 #include "TrackerHit.h"
+#include "SiClusterIndex.h"
 
 //-----------//
 //   ROOT    //
@@ -183,6 +184,18 @@ namespace utils {
      */
     double getKalmanTrackL1Isolations(Track* track, std::vector<TrackerHit*>* siClusters);
 
+    /**
+     * @brief L1 isolation of a Kalman track using a prebuilt SiCluster index
+     *
+     * Same as above, but the SiClusters of the event are looked up in an
+     * index built once per event, see SiClusterIndex.
+     *
+     * @param track
+     * @param siClusterIndex
+     * @return double
+     */
+    double getKalmanTrackL1Isolations(Track* track, const SiClusterIndex& siClusterIndex);
+
     /**
      * @brief description
      * 
@@ -1,6 +1,13 @@
 #include <math.h>
 #include "BhMassResSystematicsProcessor.h"
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+
 BhMassResSystematicsProcessor::BhMassResSystematicsProcessor(const std::string& name, Process& process)
     : Processor(name, process) { 
     }
@@ -25,6 +32,8 @@ void BhMassResSystematicsProcessor::configure(const ParameterSet& parameters) {
         function_name_       = parameters.getString("function_name");
         toy_res_runs_        = parameters.getInteger("toy_num_iters");
         nToys_               = parameters.getInteger("num_toys");
+        fit_cache_dir_       = parameters.getString("fit_cache_dir", fit_cache_dir_);
+        nThreads_            = parameters.getInteger("nThreads", nThreads_);
     } catch(std::runtime_error& error) {
         std::cout << error.what() << std::endl;
     }
@@ -58,6 +67,10 @@ void BhMassResSystematicsProcessor::initialize(std::string inFilename, std::stri
     // Initiate the bump hunter.
     bump_hunter_ = new BumpHunter(bkg_fit_model, poly_order_, poly_order_, win_factor_, 1.00, asymptotic_limit_);
     bump_hunter_->setWindowSizeUsesResScale(false);
+    if(fit_cache_dir_ != "") {
+        fit_cache_ = new FitCache(fit_cache_dir_);
+        bump_hunter_->setFitCache(fit_cache_);
+    }
     bump_hunter_->setBounds(mass_spec_h->GetXaxis()->GetBinUpEdge(mass_spec_h->FindFirstBinAbove()),
             mass_spec_h->GetXaxis()->GetBinLowEdge(mass_spec_h->FindLastBinAbove()));
 
@@ -158,6 +171,15 @@ bool BhMassResSystematicsProcessor::process() {
     flat_tuple_->setVariableValue("num_toys",       nToys_);
     flat_tuple_->setVariableValue("toy_iterations", toy_res_runs_);
 
+    // The nominal and the resolution runs use the same minimizer, so it is
+    // chosen before any fit from the number of runs fitted concurrently.
+    int nWorkers = std::max(1, std::min(nThreads_ > 0 ? nThreads_ : (int) std::thread::hardware_concurrency(),
+                                        res_runs_ + nToys_*toy_res_runs_));
+    if(nWorkers > 1) {
+        std::string minimizer = BumpHunter::enableConcurrentFits();
+        if(!minimizer.empty()) { bump_hunter_->setMinimizer(minimizer); }
+    }
+
     // Run one fit with the nominal resolution.
     HpsFitResult* nominal_result = bump_hunter_->performSearch(mass_spec_h, mass_hypo_, false, false);
     TFitResultPtr nominal_bkg_result = nominal_result->getBkgFitResult();
@@ -195,51 +217,117 @@ bool BhMassResSystematicsProcessor::process() {
     // Make a random number generator.
     TRandom3 *rng = new TRandom3();
 
-    // Iterate for a number of loops equal to the desired number of
-    // resolution scale samples.
-    for(int i = 0; i < res_runs_; i++) {
-        // Set the resolution scale to a random value according to a
-        // normal distribution around the actual resolution with a
-        // width as specified by the user.
-        double res_scale = rng->Gaus(1.00, res_width_);
-        bump_hunter_->setResolutionScale(res_scale);
+    // Draw all the resolution scales up front, in the order of the serial
+    // runs: first the runs on the data, then the runs of every toy. Each
+    // scale is a random value according to a normal distribution around
+    // the actual resolution with a width as specified by the user.
+    std::vector<double> res_scales;
+    for(int i = 0; i < res_runs_; i++) { res_scales.push_back(rng->Gaus(1.00, res_width_)); }
 
-        // Search for a resonance at the given mass hypothesis.
-        HpsFitResult* result = bump_hunter_->performSearch(mass_spec_h, mass_hypo_, false, false);
+    // Set the parameters for toy generation. Most of these should be
+    // defaults. Systematic studies should not require the more
+    // advanced options.
+    int seed_ = 0;
+    int toy_sig_samples_ = 0;
+    double bkg_mult_ = 1.00;
+    TH1* signal_shape_h_ = nullptr;
 
-        // Get the result of the background fit.
-        TFitResultPtr bkg_result = result->getBkgFitResult();
+    // Generate the toy models. The window of the bump hunter was set by the
+    // nominal search and does not depend on the resolution scale.
+    std::vector<TH1*> toys_hist;
+    if(nToys_ > 0) {
+        std::cout << "Generating " << nToys_ << " Toys" << std::endl;
+        toys_hist = bump_hunter_->generateToys(mass_spec_h, nToys_, seed_, toy_sig_samples_, bkg_mult_, signal_shape_h_);
+        for(unsigned int itoy = 0; itoy < toys_hist.size(); itoy++) {
+            for(int i = 0; i < toy_res_runs_; i++) { res_scales.push_back(rng->Gaus(1.00, res_width_)); }
+        }
+    }
 
+    // Every resolution run is an independent task, run on its own clone of
+    // the spectrum with its own copy of the bump hunter. Tasks are picked up
+    // by the workers in order and their results are consumed in order.
+    int nTasks = res_scales.size();
+    std::vector<HpsFitResult*> task_results(nTasks, nullptr);
+    std::vector<double> task_resolutions(nTasks, 0.);
+    std::vector<std::exception_ptr> task_errors(nTasks);
+    std::vector<bool> task_done(nTasks, false);
+    std::mutex task_mutex;
+    std::condition_variable task_cv;
+    std::atomic<int> next_task(0);
+
+    auto runTask = [&](int itask) {
+        TH1* source = (itask < res_runs_) ? mass_spec_h : toys_hist[(itask - res_runs_)/toy_res_runs_];
+        HpsFitResult* result = nullptr;
+        double resolution = 0.;
+        std::exception_ptr error;
+        try {
+            TH1* hist{nullptr};
+            {
+                std::lock_guard<std::mutex> lock(task_mutex);
+                hist = (TH1*) source->Clone(Form("%s_res_run_%i", source->GetName(), itask));
+                hist->SetDirectory(0);
+                hist->GetListOfFunctions()->Delete();
+            }
+            BumpHunter bump_hunter(*bump_hunter_);
+            bump_hunter.setResolutionScale(res_scales[itask]);
+            result = bump_hunter.performSearch(hist, mass_hypo_, false, false);
+            resolution = bump_hunter.getMassResolution(mass_hypo_);
+            std::lock_guard<std::mutex> lock(task_mutex);
+            delete hist;
+        } catch(...) {
+            error = std::current_exception();
+        }
+        {
+            std::lock_guard<std::mutex> lock(task_mutex);
+            task_results[itask] = result;
+            task_resolutions[itask] = resolution;
+            task_errors[itask] = error;
+            task_done[itask] = true;
+        }
+        task_cv.notify_all();
+    };
+
+    nWorkers = std::max(1, std::min(nWorkers, nTasks));
+    std::vector<std::thread> workers;
+    if(nWorkers > 1) {
+        for(int iworker = 0; iworker < nWorkers; iworker++) {
+            workers.emplace_back([&]() {
+                for(int itask = next_task++; itask < nTasks; itask = next_task++) { runTask(itask); }
+            });
+        }
+    }
+    auto stopWorkers = [&]() {
+        next_task = nTasks;
+        for(auto& worker : workers) { worker.join(); }
+        workers.clear();
+    };
+
+    // Wait for a task, or run it directly without workers, and write its
+    // result to the tuple vectors.
+    auto consumeTask = [&](int itask, const std::string& prefix) {
+        if(nWorkers == 1) { runTask(itask); }
+        std::unique_lock<std::mutex> lock(task_mutex);
+        task_cv.wait(lock, [&]() { return bool(task_done[itask]); });
+        lock.unlock();
+        if(task_errors[itask]) {
+            // Let the running tasks finish and drop every result not consumed yet
+            stopWorkers();
+            for(auto& result : task_results) {
+                delete result;
+                result = nullptr;
+            }
+            std::rethrow_exception(task_errors[itask]);
+        }
+        fillResult(prefix, res_scales[itask], task_resolutions[itask], task_results[itask]);
+        delete task_results[itask];
+        task_results[itask] = nullptr;
+    };
+
+    // Iterate for a number of loops equal to the desired number of
+    // resolution scale samples.
+    for(int i = 0; i < res_runs_; i++) {
         std::cout << "Filling Fit Results " << std::endl;
-        // Get the result of the signal+background fit.
-        TFitResultPtr sig_result = result->getCompFitResult();
-
-        // Set the fit parameters in the tuple.
-        flat_tuple_->addToVector("bkg_total",              result->getIntegral());
-        flat_tuple_->addToVector("corr_mass",              result->getCorrectedMass());
-        flat_tuple_->addToVector("mass_hypo",              result->getMass());
-        flat_tuple_->addToVector("window_size",            result->getWindowSize());
-        flat_tuple_->addToVector("resolution_scale",       res_scale);
-        flat_tuple_->addToVector("mass_resolution",        bump_hunter_->getMassResolution(mass_hypo_));
-
-        // Set the fit results in the tuple.
-        flat_tuple_->addToVector("bkg_chi2_prob",          bkg_result->Prob());
-        flat_tuple_->addToVector("bkgsig_chi2_prob",       sig_result->Prob());
-        flat_tuple_->addToVector("bkg_edm",                bkg_result->Edm());
-        flat_tuple_->addToVector("bkg_minuit_status",      bkg_result->Status());
-        flat_tuple_->addToVector("bkg_nll",                bkg_result->MinFcnValue());
-
-        flat_tuple_->addToVector("edm",                    sig_result->Edm());
-        flat_tuple_->addToVector("minuit_status",          sig_result->Status());
-        flat_tuple_->addToVector("nll",                    sig_result->MinFcnValue());
-        flat_tuple_->addToVector("p_value",                result->getPValue());
-        flat_tuple_->addToVector("q0",                     result->getQ0());
-        flat_tuple_->addToVector("bkg_rate_mass_hypo",     result->getFullBkgRate());
-        flat_tuple_->addToVector("bkg_rate_mass_hypo_err", result->getFullBkgRateError());
-        flat_tuple_->addToVector("sig_yield",              result->getSignalYield());
-        flat_tuple_->addToVector("sig_yield_err",          result->getSignalYieldErr());
-        flat_tuple_->addToVector("upper_limit",            result->getUpperLimit());
-        flat_tuple_->addToVector("ul_p_value",             result->getUpperLimitPValue());
+        consumeTask(i, "");
     }
 
     // Get the quantile vectors.
@@ -304,14 +392,6 @@ bool BhMassResSystematicsProcessor::process() {
     flat_tuple_->setVariableValue("p_value_sigma1l", vec_pValue[sigma_1_l]);
 
 
-    // Set the parameters for toy generation. Most of these should be
-    // defaults. Systematic studies should not require the more
-    // advanced options.
-    int seed_ = 0;
-    int toy_sig_samples_ = 0;
-    double bkg_mult_ = 1.00;
-    TH1* signal_shape_h_ = nullptr;
-
     // Generate the vector entries for the toy results. A
     // different set of tuples must be generated for each
     // toy distribution.
@@ -339,72 +419,22 @@ bool BhMassResSystematicsProcessor::process() {
     flat_tuple_->addVector("toy_upper_limit");
     flat_tuple_->addVector("toy_ul_p_value");
 
-    // Generate the toys and perform the toy fits.
-    if(nToys_ > 0) {
-        // Generate toy models.
-        std::cout << "Generating " << nToys_ << " Toys" << std::endl;
-        std::vector<TH1*> toys_hist = bump_hunter_->generateToys(mass_spec_h, nToys_, seed_, toy_sig_samples_, bkg_mult_, signal_shape_h_);
-
-        // Perform the fits for each toy model.
-        int toyFitN = 0;
-        for(TH1* hist : toys_hist) {
-            // Store the results of the mass resolution variance for
-            // this toy.
-            std::cout << "Fitting Toy " << toyFitN << std::endl;
-
-            // Fit the toy multiple times with different mass
-            // resolution values.
-            for(int i = 0; i < toy_res_runs_; i++) {
-                // Set the resolution scale to a random value according to a
-                // normal distribution around the actual resolution with a
-                // width as specified by the user.
-                double res_scale = rng->Gaus(1.00, res_width_);
-                bump_hunter_->setResolutionScale(res_scale);
-
-                // Perform the resonance search.
-                HpsFitResult* result = bump_hunter_->performSearch(hist, mass_hypo_, false, false);
-
-                // Get the result of the background fit.
-                TFitResultPtr bkg_result = result->getBkgFitResult();
-
-                // Get the result of the signal+background fit.
-                TFitResultPtr sig_result = result->getCompFitResult();
-
-                // Set the fit parameters in the tuple.
-                flat_tuple_->addToVector("toy_bkg_total",              result->getIntegral());
-                flat_tuple_->addToVector("toy_corr_mass",              result->getCorrectedMass());
-                flat_tuple_->addToVector("toy_mass_hypo",              result->getMass());
-                flat_tuple_->addToVector("toy_window_size",            result->getWindowSize());
-                flat_tuple_->addToVector("toy_resolution_scale",       res_scale);
-                flat_tuple_->addToVector("toy_mass_resolution",        bump_hunter_->getMassResolution(mass_hypo_));
-
-                // Set the fit results in the tuple.
-                flat_tuple_->addToVector("toy_bkg_chi2_prob",          bkg_result->Prob());
-                flat_tuple_->addToVector("toy_bkgsig_chi2_prob",       sig_result->Prob());
-                flat_tuple_->addToVector("toy_bkg_edm",                bkg_result->Edm());
-                flat_tuple_->addToVector("toy_bkg_minuit_status",      bkg_result->Status());
-                flat_tuple_->addToVector("toy_bkg_nll",                bkg_result->MinFcnValue());
-
-                flat_tuple_->addToVector("toy_edm",                    sig_result->Edm());
-                flat_tuple_->addToVector("toy_minuit_status",          sig_result->Status());
-                flat_tuple_->addToVector("toy_nll",                    sig_result->MinFcnValue());
-                flat_tuple_->addToVector("toy_p_value",                result->getPValue());
-                flat_tuple_->addToVector("toy_q0",                     result->getQ0());
-                flat_tuple_->addToVector("toy_bkg_rate_mass_hypo",     result->getFullBkgRate());
-                flat_tuple_->addToVector("toy_bkg_rate_mass_hypo_err", result->getFullBkgRateError());
-                flat_tuple_->addToVector("toy_sig_yield",              result->getSignalYield());
-                flat_tuple_->addToVector("toy_sig_yield_err",          result->getSignalYieldErr());
-                flat_tuple_->addToVector("toy_upper_limit",            result->getUpperLimit());
-                flat_tuple_->addToVector("toy_ul_p_value",             result->getUpperLimitPValue());
-            }
+    // Perform the fits for each toy model.
+    for(unsigned int toyFitN = 0; toyFitN < toys_hist.size(); toyFitN++) {
+        // Store the results of the mass resolution variance for
+        // this toy.
+        std::cout << "Fitting Toy " << toyFitN << std::endl;
 
-            // Fill the tuple.
-            flat_tuple_->fill();
-
-            // Step to the next toy.
-            toyFitN++;
+        // The toy is fitted multiple times with different mass
+        // resolution values.
+        for(int i = 0; i < toy_res_runs_; i++) {
+            consumeTask(res_runs_ + toyFitN*toy_res_runs_ + i, "toy_");
         }
+
+        // Fill the tuple.
+        flat_tuple_->fill();
     }
+    stopWorkers();
 
     // Fill and write the tuple
     flat_tuple_->close();
@@ -412,10 +442,50 @@ bool BhMassResSystematicsProcessor::process() {
     return true;
 }
 
+void BhMassResSystematicsProcessor::fillResult(const std::string& prefix, double res_scale,
+        double mass_resolution, HpsFitResult* result) {
+    // Get the result of the background fit.
+    TFitResultPtr bkg_result = result->getBkgFitResult();
+
+    // Get the result of the signal+background fit.
+    TFitResultPtr sig_result = result->getCompFitResult();
+
+    // Set the fit parameters in the tuple.
+    flat_tuple_->addToVector(prefix + "bkg_total",              result->getIntegral());
+    flat_tuple_->addToVector(prefix + "corr_mass",              result->getCorrectedMass());
+    flat_tuple_->addToVector(prefix + "mass_hypo",              result->getMass());
+    flat_tuple_->addToVector(prefix + "window_size",            result->getWindowSize());
+    flat_tuple_->addToVector(prefix + "resolution_scale",       res_scale);
+    flat_tuple_->addToVector(prefix + "mass_resolution",        mass_resolution);
+
+    // Set the fit results in the tuple.
+    flat_tuple_->addToVector(prefix + "bkg_chi2_prob",          bkg_result->Prob());
+    flat_tuple_->addToVector(prefix + "bkgsig_chi2_prob",       sig_result->Prob());
+    flat_tuple_->addToVector(prefix + "bkg_edm",                bkg_result->Edm());
+    flat_tuple_->addToVector(prefix + "bkg_minuit_status",      bkg_result->Status());
+    flat_tuple_->addToVector(prefix + "bkg_nll",                bkg_result->MinFcnValue());
+
+    flat_tuple_->addToVector(prefix + "edm",                    sig_result->Edm());
+    flat_tuple_->addToVector(prefix + "minuit_status",          sig_result->Status());
+    flat_tuple_->addToVector(prefix + "nll",                    sig_result->MinFcnValue());
+    flat_tuple_->addToVector(prefix + "p_value",                result->getPValue());
+    flat_tuple_->addToVector(prefix + "q0",                     result->getQ0());
+    flat_tuple_->addToVector(prefix + "bkg_rate_mass_hypo",     result->getFullBkgRate());
+    flat_tuple_->addToVector(prefix + "bkg_rate_mass_hypo_err", result->getFullBkgRateError());
+    flat_tuple_->addToVector(prefix + "sig_yield",              result->getSignalYield());
+    flat_tuple_->addToVector(prefix + "sig_yield_err",          result->getSignalYieldErr());
+    flat_tuple_->addToVector(prefix + "upper_limit",            result->getUpperLimit());
+    flat_tuple_->addToVector(prefix + "ul_p_value",             result->getUpperLimitPValue());
+}
+
 void BhMassResSystematicsProcessor::finalize() {
     inF_->Close();
     delete inF_;
     delete bump_hunter_;
+    if(fit_cache_) {
+        fit_cache_->printStats();
+        delete fit_cache_;
+    }
 }
 
 DECLARE_PROCESSOR(BhMassResSystematicsProcessor);
@@ -29,6 +29,8 @@ void BhToysHistoProcessor::configure(const ParameterSet& parameters) {
         signal_shape_h_name_ = parameters.getString("signal_shape_h_name", "");
         signal_shape_h_file_ = parameters.getString("signal_shape_h_file", "");
         bkg_model_           = parameters.getInteger("bkg_model");
+        fit_cache_dir_       = parameters.getString("fit_cache_dir", fit_cache_dir_);
+        toy_poisson_         = parameters.getInteger("toy_poisson", toy_poisson_);
         //asymptotic_limit_ = parameters.getBoolean("asymptoticLimit");
     } catch(std::runtime_error& error) {
         std::cout << error.what() << std::endl;
@@ -77,6 +79,11 @@ void BhToysHistoProcessor::initialize(std::string inFilename, std::string outFil
     bump_hunter_->setBounds(mass_spec_h->GetXaxis()->GetBinUpEdge(mass_spec_h->FindFirstBinAbove()),
             mass_spec_h->GetXaxis()->GetBinLowEdge(mass_spec_h->FindLastBinAbove()));
     if(debug_ > 0) bump_hunter_->enableDebug();
+    bump_hunter_->setToyPoisson(toy_poisson_ != 0);
+    if(fit_cache_dir_ != "") {
+        fit_cache_ = new FitCache(fit_cache_dir_);
+        bump_hunter_->setFitCache(fit_cache_);
+    }
 
     // Init FlatTupleMaker
     flat_tuple_ = new FlatTupleMaker(outFilename.c_str(), "fit_toys");
@@ -251,6 +258,10 @@ void BhToysHistoProcessor::finalize() {
     delete inF_;
     //delete flat_tuple_;
     delete bump_hunter_;
+    if(fit_cache_) {
+        fit_cache_->printStats();
+        delete fit_cache_;
+    }
 }
 
 DECLARE_PROCESSOR(BhToysHistoProcessor); 
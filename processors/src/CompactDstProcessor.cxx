@@ -0,0 +1,147 @@
+#include "CompactDstProcessor.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "TBranch.h"
+
+CompactDstProcessor::CompactDstProcessor(const std::string& name, Process& process)
+    : Processor(name, process) {
+    }
+
+CompactDstProcessor::~CompactDstProcessor() {
+}
+
+void CompactDstProcessor::configure(const ParameterSet& parameters) {
+
+    std::cout << "Configuring CompactDstProcessor" << std::endl;
+    try
+    {
+        debug_            = parameters.getInteger("debug", debug_);
+        trkColls_         = parameters.getVString("trkColls", trkColls_);
+        partColls_        = parameters.getVString("partColls", partColls_);
+        partTrkColls_     = parameters.getVString("partTrkColls", partTrkColls_);
+        partClusterColls_ = parameters.getVString("partClusterColls", partClusterColls_);
+        vtxColls_         = parameters.getVString("vtxColls", vtxColls_);
+        vtxPartColls_     = parameters.getVString("vtxPartColls", vtxPartColls_);
+    }
+    catch (std::runtime_error& error)
+    {
+        std::cout << error.what() << std::endl;
+    }
+
+    // The references of a collection are optional
+    partTrkColls_.resize(partColls_.size());
+    partClusterColls_.resize(partColls_.size());
+    vtxPartColls_.resize(vtxColls_.size());
+}
+
+template <class C, class T>
+void CompactDstProcessor::addBranch(const std::string& name, Collection<C, T>& coll, const std::string& type,
+        const std::vector<std::pair<std::string, std::string>>& refs) {
+    TBranch* branch = out_->Branch((name + CompactEvent::kSuffix).c_str(), &coll.compact);
+    branch->SetTitle(CompactEvent::branchTitle(type, refs).c_str());
+    if (debug_ > 0)
+        std::cout << "[ CompactDstProcessor ]: " << branch->GetName() << ": " << branch->GetTitle() << std::endl;
+}
+
+void CompactDstProcessor::initialize(TTree* tree) {
+
+    // Particles and vertices point into the compact collections
+    for (auto& coll : partTrkColls_) {
+        if (!coll.empty() && std::find(trkColls_.begin(), trkColls_.end(), coll) == trkColls_.end())
+            throw std::runtime_error("[ CompactDstProcessor ]: Track collection " + coll
+                    + " of the particles must be in trkColls");
+    }
+    for (auto& coll : vtxPartColls_) {
+        if (!coll.empty() && std::find(partColls_.begin(), partColls_.end(), coll) == partColls_.end())
+            throw std::runtime_error("[ CompactDstProcessor ]: Particle collection " + coll
+                    + " of the vertices must be in partColls");
+    }
+
+    // Bind the inputs first, the output tree shares their addresses
+    std::vector<std::string> compacted;
+    for (auto& coll : trkColls_) {
+        tree->SetBranchAddress(coll.c_str(), &tracks_[coll].objects);
+        compacted.push_back(coll);
+    }
+    for (auto& coll : partColls_) {
+        tree->SetBranchAddress(coll.c_str(), &particles_[coll].objects);
+        compacted.push_back(coll);
+    }
+    for (auto& coll : vtxColls_) {
+        tree->SetBranchAddress(coll.c_str(), &vertices_[coll].objects);
+        compacted.push_back(coll);
+    }
+    for (auto& coll : partClusterColls_) {
+        if (!coll.empty() && !clusters_.count(coll)) {
+            clusters_[coll] = nullptr;
+            tree->SetBranchAddress(coll.c_str(), &clusters_[coll]);
+        }
+    }
+
+    // Only the active branches are cloned
+    std::vector<std::string> disabled;
+    for (auto& coll : compacted) {
+        if (tree->GetBranchStatus(coll.c_str())) {
+            tree->SetBranchStatus(coll.c_str(), 0);
+            disabled.push_back(coll);
+        }
+    }
+    out_ = tree->CloneTree(0);
+    for (auto& coll : disabled)
+        tree->SetBranchStatus(coll.c_str(), 1);
+
+    for (auto& coll : trkColls_)
+        addBranch(coll, tracks_[coll], "CompactTrack");
+    for (unsigned int i = 0; i < partColls_.size(); ++i)
+        addBranch(partColls_[i], particles_[partColls_[i]], "CompactParticle",
+                {{"tracks", partTrkColls_[i]}, {"clusters", partClusterColls_[i]}});
+    for (unsigned int i = 0; i < vtxColls_.size(); ++i)
+        addBranch(vtxColls_[i], vertices_[vtxColls_[i]], "CompactVertex", {{"particles", vtxPartColls_[i]}});
+}
+
+void CompactDstProcessor::setFile(TFile* outFile) {
+    Processor::setFile(outFile);
+    if (out_)
+        out_->SetDirectory(outFile);
+}
+
+bool CompactDstProcessor::process(IEvent* ievent) {
+
+    for (auto& coll : tracks_) {
+        if (coll.second.objects)
+            CompactEvent::packTracks(*coll.second.objects, coll.second.compact);
+    }
+    for (unsigned int i = 0; i < partColls_.size(); ++i) {
+        Collection<CompactParticle, Particle>& coll = particles_[partColls_[i]];
+        if (!coll.objects)
+            continue;
+        const std::vector<Track*>* tracks = partTrkColls_[i].empty() ? nullptr : tracks_[partTrkColls_[i]].objects;
+        const std::vector<CalCluster*>* clusters = partClusterColls_[i].empty() ? nullptr : clusters_[partClusterColls_[i]];
+        CompactEvent::packParticles(*coll.objects, tracks, clusters, coll.compact);
+    }
+    for (unsigned int i = 0; i < vtxColls_.size(); ++i) {
+        Collection<CompactVertex, Vertex>& coll = vertices_[vtxColls_[i]];
+        if (!coll.objects)
+            continue;
+        const std::vector<Particle*>* particles = vtxPartColls_[i].empty() ? nullptr : particles_[vtxPartColls_[i]].objects;
+        CompactEvent::packVertices(*coll.objects, particles, coll.compact);
+    }
+
+    out_->Fill();
+    ++nEvents_;
+    return true;
+}
+
+void CompactDstProcessor::finalize() {
+
+    if (!out_)
+        return;
+    outF_->cd();
+    out_->Write();
+    std::cout << "[ CompactDstProcessor ]: Wrote " << nEvents_ << " events, "
+        << out_->GetZipBytes()/1.e6 << " MB" << std::endl;
+}
+
+DECLARE_PROCESSOR(CompactDstProcessor);
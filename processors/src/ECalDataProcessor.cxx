@@ -58,11 +58,8 @@ bool ECalDataProcessor::process(IEvent* ievent) {
         std::cout << e.what() << std::endl;
     }
 
-    // A calorimeter hit
-    IMPL::CalorimeterHitImpl* lc_hit{nullptr}; 
-
-    // Get the collection of Ecal hits from the event.
-    std::map< std::pair<int,int>, CalHit*> hit_map;
+    // Index the hits by crystal, the table is reused from event to event
+    hit_table_.clear();
 
     // Loop through all of the hits and add them to event.
     for (int ihit=0; ihit < hits->getNumberOfElements(); ++ihit) {
@@ -71,18 +68,8 @@ bool ECalDataProcessor::process(IEvent* ievent) {
         IMPL::CalorimeterHitImpl* lc_hit 
             = static_cast<IMPL::CalorimeterHitImpl*>(hits->getElementAt(ihit));
 
-        // Get the unique cell id of this hit. Combine it with the integer time,
-        // since a crystal can be hit more than once.
-        int id0 = lc_hit->getCellID0();
-
-        // 0.1 ns resolution is sufficient to distinguish any 2 hits on the same crystal.
-        int id1 = static_cast<int>(10.0*lc_hit->getTime()); 
-
         CalHit* cal_hit = new CalHit();
 
-        // Store the hit in the map for easy access later.
-        hit_map[ std::make_pair(id0,id1) ] = cal_hit;
-
         // Set the energy of the Ecal hit
         cal_hit->setEnergy(lc_hit->getEnergy());
 
@@ -90,12 +77,19 @@ bool ECalDataProcessor::process(IEvent* ievent) {
         cal_hit->setTime(lc_hit->getTime());
 
         // Set the indices of the crystal
-        int index_x = this->getIdentifierFieldValue("ix", lc_hit);
-        int index_y = this->getIdentifierFieldValue("iy", lc_hit);
+        int index_x, index_y;
+        this->getCrystalIndices(lc_hit, index_x, index_y);
 
         cal_hit->setCrystalIndices(index_x, index_y);
         cal_hits_.push_back(cal_hit);
 
+        // Store the hit in the table for easy access later. A crystal can be
+        // hit more than once, the hits are told apart by their time.
+        if (!hit_table_.add(cal_hit, index_x, index_y)) {
+            ++rejected_hits_;
+            std::cout << "[ EcalDataProcessor ]: WARNING: Hit at (" << index_x << ", " << index_y
+                      << ") is not on a crystal, it cannot be added to a cluster." << std::endl;
+        }
     }
 
     // Get the collection of Ecal clusters from the event
@@ -125,7 +119,7 @@ bool ECalDataProcessor::process(IEvent* ievent) {
         cluster->setEnergy(lc_cluster->getEnergy());
 
         // Get the ecal hits used to create the cluster
-        EVENT::CalorimeterHitVec lc_hits = lc_cluster->getCalorimeterHits();
+        const EVENT::CalorimeterHitVec& lc_hits = lc_cluster->getCalorimeterHits();
 
         // Loop over all of the Ecal hits and add them to the Ecal cluster.  The
         // seed hit is set to be the hit with the highest energy.  The cluster time
@@ -136,16 +130,18 @@ bool ECalDataProcessor::process(IEvent* ievent) {
         for(int ihit = 0; ihit < (int) lc_hits.size(); ++ihit) {
 
             // Get an Ecal hit
-            lc_hit  = static_cast<IMPL::CalorimeterHitImpl*>(lc_hits[ihit]); 
+            EVENT::CalorimeterHit* lc_hit = lc_hits[ihit]; 
 
-            int id0=lc_hit->getCellID0();
-            int id1=(int)(10.0*lc_hit->getTime());
+            int index_x, index_y;
+            this->getCrystalIndices(lc_hit, index_x, index_y);
+            CalHit* cal_hit = hit_table_.find(index_x, index_y, EcalHitTable::timeKey(lc_hit->getTime()));
 
-            if (hit_map.find(std::make_pair(id0,id1)) == hit_map.end()) {
+            if (!cal_hit) {
+                // The hits off the crystals were reported when they were added
+                if (!EcalHitTable::isCrystal(index_x, index_y)) continue;
                 throw std::runtime_error("[ EcalDataProcessor ]: Hit not found in map, but is in the cluster."); 
             } else {
-                // Get the hit and add it to the cluster
-                CalHit* cal_hit = hit_map[std::make_pair(id0,id1)];
+                // Add the hit to the cluster
                 cluster->addHit(cal_hit);
 
                 if (senergy < lc_hit->getEnergy()) { 
@@ -169,15 +165,19 @@ bool ECalDataProcessor::process(IEvent* ievent) {
 }
 
 void ECalDataProcessor::finalize() { 
+    if (rejected_hits_ > 0) {
+        std::cout << "[ EcalDataProcessor ]: WARNING: " << rejected_hits_
+                  << " hits were not on a crystal and were left out of the clusters." << std::endl;
+    }
 }
 
-UTIL::BitFieldValue ECalDataProcessor::getIdentifierFieldValue(std::string field, EVENT::CalorimeterHit* hit){
+void ECalDataProcessor::getCrystalIndices(EVENT::CalorimeterHit* hit, int& index_x, int& index_y){
 
-    UTIL::BitField64 decoder(encoder_string_);
     long64 value = long64( hit->getCellID0() & 0xffffffff ) | ( long64( hit->getCellID1() ) << 32 ) ;
-    decoder.setValue(value); 
+    decoder_.setValue(value); 
 
-    return decoder[field]; 
+    index_x = decoder_[ix_field_];
+    index_y = decoder_[iy_field_];
 }
 
 DECLARE_PROCESSOR(ECalDataProcessor); 
@@ -22,6 +22,8 @@ void MCParticleProcessor::configure(const ParameterSet& parameters) {
         debug_          = parameters.getInteger("debug", debug_ );
         mcPartCollLcio_    = parameters.getString("mcPartCollLcio", mcPartCollLcio_);
         mcPartCollRoot_    = parameters.getString("mcPartCollRoot", mcPartCollRoot_);
+        trkRelCollLcio_    = parameters.getString("trkRelCollLcio", trkRelCollLcio_);
+        ancestorPDGs_      = parameters.getVInteger("ancestorPDGs", ancestorPDGs_);
     }
     catch (std::runtime_error& error)
     {
@@ -35,6 +37,7 @@ void MCParticleProcessor::initialize(TTree* tree) {
     // Add branch to tree
     tree->Branch(mcPartCollRoot_.c_str(),&mc_particles_);
 
+    truth_graph_.setAncestorPDGs(ancestorPDGs_);
 }
 
 bool MCParticleProcessor::process(IEvent* ievent) {
@@ -64,12 +67,25 @@ bool MCParticleProcessor::process(IEvent* ievent) {
     }
 
 
+    // Index the particles by LCIO id and precompute their ancestry
+    truth_graph_.build(lc_particles);
+    if (!trkRelCollLcio_.empty()) {
+        try
+        {
+            truth_graph_.linkTracks(event->getLCCollection(trkRelCollLcio_.c_str()));
+        }
+        catch (EVENT::DataNotAvailableException e)
+        {
+            if (debug_ > 0) std::cout << e.what() << std::endl;
+        }
+    }
+
     // Loop through all of the particles in the event
-    for (int iparticle = 0; iparticle < lc_particles->getNumberOfElements(); ++iparticle) {
+    mc_particles_.reserve(truth_graph_.size());
+    for (int iparticle = 0; iparticle < truth_graph_.size(); ++iparticle) {
 
         // Get a particle from the LCEvent
-        IMPL::MCParticleImpl* lc_particle
-            = static_cast<IMPL::MCParticleImpl*>(lc_particles->getElementAt(iparticle)); 
+        EVENT::MCParticle* lc_particle = truth_graph_.particle(iparticle);
 
         // Make an MCParticle to build and add to vector
         MCParticle* particle = new MCParticle();
@@ -98,9 +114,16 @@ bool MCParticleProcessor::process(IEvent* ievent) {
         // Set the LCIO id of the particle
         particle->setID(lc_particle->id());    
 
-        // Set the PDG of the particle
-        std::vector<EVENT::MCParticle*> parentVec = lc_particle->getParents();
-        if(parentVec.size() > 0) particle->setMomPDG(parentVec.at(parentVec.size()-1)->getPDG());    
+        // Set the PDG and the LCIO id of the mother, the last parent
+        const EVENT::MCParticleVec& parentVec = lc_particle->getParents();
+        if(parentVec.size() > 0) {
+            particle->setMomPDG(parentVec.back()->getPDG());
+            particle->setMomID(parentVec.back()->id());
+        }
+
+        // Set the ancestors looked for and the related track
+        particle->setAncestorPDGs(truth_graph_.ancestorPDGs(iparticle));
+        particle->setTrackID(truth_graph_.trackID(iparticle));
 
         // Set the generator status of the particle
         particle->setGenStatus(lc_particle->getGeneratorStatus());    
@@ -108,46 +131,6 @@ bool MCParticleProcessor::process(IEvent* ievent) {
         // Set the generator status of the particle
         particle->setSimStatus(lc_particle->getSimulatorStatus());    
 
-        // Loop through all of the tracks associated with the particle
-        // and add references to the MCParticle object.
-        /*for (auto const &lc_track : lc_particle->getTracks()) { 
-
-          TClonesArray* tracks = event->getCollection(Collections::GBL_TRACKS); 
-
-        // Loop through all of the tracks in the HpsEvent and find the one
-        // that matches the track associated with the particle
-        for (int itrack = 0; itrack < tracks->GetEntriesFast(); ++itrack) { 
-        Track* track = static_cast<Track*>(tracks->At(itrack)); 
-
-        // Use the track chi^2 to find the match
-        // TODO: Verify that the chi^2 is unique enough to find the match
-        if (lc_track->getChi2() == track->getChi2()) {
-
-        // Add a reference to the track 
-        particle->addTrack(track);
-
-        // If the particle is a final state particle, add a
-        // reference from the corresponding track to the particle
-        if ((collections.first.compare(Collections::FINAL_STATE_PARTICLES) == 0)
-        || (collections.first.compare(Collections::OTHER_ELECTRONS) == 0) ) {                    
-        track->setMCParticle(particle);
-        track->setMomentum(particle->getMomentum()); 
-        track->setCharge(particle->getCharge());  
-        } 
-        break; 
-        }
-        }
-
-        }*/   
-
-        // Only add vertex information if the particle is not a final state particle
-        //if ((collections.first.compare(Collections::FINAL_STATE_PARTICLES) == 0) || 
-        //        (collections.first.compare(Collections::OTHER_ELECTRONS) == 0)) {                    
-        //    // Set the PDG ID of the particle
-        //    particle->setPDG(lc_particle->getParticleIDUsed()->getPDG());    
-        //    continue;
-        //}
-
         // Set the vertex position of the particle
         particle->setVertexPosition(lc_particle->getVertex()); 
 
@@ -155,41 +138,6 @@ bool MCParticleProcessor::process(IEvent* ievent) {
         particle->setEndPoint(lc_particle->getEndpoint()); 
 
         mc_particles_.push_back(particle);
-        // If the particle has daughter particles, add the daughters to the
-        // MCParticle.
-        //
-
-        // Loop through all of the daughter particles associated with the particle
-        /*for (auto const &daughter : lc_particle->getParticles()) { 
-
-        // Loop through all of the final state particles in the event 
-        // and find the one that matches the daughters associated with 
-        // the particles.
-        for (int iparticle = 0; 
-        iparticle < fs_particles->GetEntriesFast(); ++iparticle) {
-
-        MCParticle* dparticle = static_cast<MCParticle*>(fs_particles->At(iparticle));   
-
-        // Try to find the match between a final state particle
-        // and ReconstructedParticle daughter.  For now, use the
-        // momentum as the matching criterion. 
-        // TODO: Verify that the track momentum is always unique in an event.
-        if ((dparticle->getMomentum()[0] == lc_particle->getMomentum()[0])
-        && (dparticle->getMomentum()[1] == lc_particle->getMomentum()[1])
-        && (dparticle->getMomentum()[2] == lc_particle->getMomentum()[2])) {
-
-        particle->addDaughter(dparticle);
-
-        if (dparticle->getTracks()->GetEntriesFast() != 0) 
-        particle->addTrack(dparticle->getTracks()->At(0)); 
-
-        if (dparticle->getClusters()->GetEntriesFast() != 0) 
-        particle->addCluster(dparticle->getClusters()->At(0)); 
-
-        break; 
-        }
-        }
-        }*/
     }   
 
     return true;
@@ -0,0 +1,149 @@
+/**
+ * @file MCTruthGraph.cxx
+ * @brief Per event graph of the LCIO MCParticles.
+ */
+
+#include "MCTruthGraph.h"
+
+//----------//
+//   LCIO   //
+//----------//
+#include <EVENT/LCRelation.h>
+
+void MCTruthGraph::build(EVENT::LCCollection* particles) {
+
+    int n = particles->getNumberOfElements();
+    particles_.resize(n);
+    index_.clear();
+    index_.reserve(n);
+    for (int i = 0; i < n; ++i) {
+        particles_[i] = static_cast<EVENT::MCParticle*>(particles->getElementAt(i));
+        index_[particles_[i]->id()] = i;
+    }
+
+    // Adjacency arrays, the LCIO vectors are only read through references
+    parentOffsets_.resize(n + 1);
+    daughterOffsets_.resize(n + 1);
+    parents_.clear();
+    daughters_.clear();
+    for (int i = 0; i < n; ++i) {
+        parentOffsets_[i] = parents_.size();
+        for (auto parent : particles_[i]->getParents()) {
+            int j = index(parent->id());
+            if (j >= 0) parents_.push_back(j);
+        }
+        daughterOffsets_[i] = daughters_.size();
+        for (auto daughter : particles_[i]->getDaughters()) {
+            int j = index(daughter->id());
+            if (j >= 0) daughters_.push_back(j);
+        }
+    }
+    parentOffsets_[n] = parents_.size();
+    daughterOffsets_[n] = daughters_.size();
+
+    // Nearest ancestors, the parents of a particle are completed before the particle.
+    // Iterative depth first search, a parent already on the current path (a cycle) is ignored.
+    int npdgs = ancestorPDGs_.size();
+    ancestors_.assign(n*npdgs, -1);
+    if (npdgs) {
+        enum { kNew, kOnPath, kDone };
+        std::vector<char> state(n, kNew);
+        std::vector<std::pair<int, bool>> stack;
+        for (int root = 0; root < n; ++root) {
+            if (state[root] != kNew) continue;
+            stack.push_back({root, false});
+            while (!stack.empty()) {
+                int i = stack.back().first;
+                bool expanded = stack.back().second;
+                stack.pop_back();
+                if (!expanded) {
+                    if (state[i] != kNew) continue;
+                    state[i] = kOnPath;
+                    stack.push_back({i, true});
+                    for (int j : parents(i))
+                        if (state[j] == kNew) stack.push_back({j, false});
+                    continue;
+                }
+                for (int k = 0; k < npdgs; ++k) {
+                    for (int j : parents(i)) {
+                        if (particles_[j]->getPDG() == ancestorPDGs_[k]) {
+                            ancestors_[i*npdgs + k] = j;
+                            break;
+                        }
+                        if (ancestors_[j*npdgs + k] >= 0) {
+                            ancestors_[i*npdgs + k] = ancestors_[j*npdgs + k];
+                            break;
+                        }
+                    }
+                }
+                state[i] = kDone;
+            }
+        }
+    }
+
+    trackIDs_.clear();
+    trackParticles_.clear();
+}
+
+void MCTruthGraph::linkTracks(EVENT::LCCollection* relations) {
+
+    int n = particles_.size();
+    trackIDs_.assign(n, -1);
+    trackParticles_.clear();
+    std::vector<float> particleWeights(n, 0.f);
+    std::unordered_map<int, float> trackWeights;
+
+    for (int irel = 0; irel < relations->getNumberOfElements(); ++irel) {
+        auto relation = static_cast<EVENT::LCRelation*>(relations->getElementAt(irel));
+        EVENT::LCObject* track = relation->getTo();
+        auto particle = dynamic_cast<EVENT::MCParticle*>(relation->getFrom());
+        if (!particle) {
+            track = relation->getFrom();
+            particle = dynamic_cast<EVENT::MCParticle*>(relation->getTo());
+        }
+        if (!particle || !track) continue;
+        int i = index(particle->id());
+        if (i < 0) continue;
+
+        float weight = relation->getWeight();
+        int trackID = track->id();
+        if (trackIDs_[i] < 0 || weight > particleWeights[i]) {
+            trackIDs_[i] = trackID;
+            particleWeights[i] = weight;
+        }
+        auto found = trackWeights.find(trackID);
+        if (found == trackWeights.end() || weight > found->second) {
+            trackWeights[trackID] = weight;
+            trackParticles_[trackID] = i;
+        }
+    }
+}
+
+int MCTruthGraph::index(int id) const {
+    auto found = index_.find(id);
+    return found == index_.end() ? -1 : found->second;
+}
+
+int MCTruthGraph::ancestor(int i, int pdg) const {
+    int npdgs = ancestorPDGs_.size();
+    for (int k = 0; k < npdgs; ++k) {
+        if (ancestorPDGs_[k] == pdg)
+            return ancestors_[i*npdgs + k];
+    }
+    return -1;
+}
+
+std::vector<int> MCTruthGraph::ancestorPDGs(int i) const {
+    std::vector<int> pdgs;
+    int npdgs = ancestorPDGs_.size();
+    for (int k = 0; k < npdgs; ++k) {
+        if (ancestors_[i*npdgs + k] >= 0)
+            pdgs.push_back(ancestorPDGs_[k]);
+    }
+    return pdgs;
+}
+
+int MCTruthGraph::trackParticle(int trackID) const {
+    auto found = trackParticles_.find(trackID);
+    return found == trackParticles_.end() ? -1 : found->second;
+}
@@ -331,6 +331,14 @@ void SimpZBiOptimizationProcessor::initialize(std::string inFilename, std::strin
     std::cout << "Test Cuts: " << std::endl;
     testCutsSelector_->printCuts();
 
+    //Compile the cuts once and bind them to the variables of each tuple
+    persistentCutsSelector_->compileCuts();
+    testCutsSelector_->compileCuts();
+    signalPersistentCuts_ = std::make_shared<CutPassCache>(persistentCutsSelector_, signalMTT_);
+    bkgPersistentCuts_ = std::make_shared<CutPassCache>(persistentCutsSelector_, bkgMTT_);
+    signalTestCuts_ = std::make_shared<CutPassCache>(testCutsSelector_, signalMTT_);
+    bkgTestCuts_ = std::make_shared<CutPassCache>(testCutsSelector_, bkgMTT_);
+
     //Initialize signal histograms
     std::cout << "[SimpZBiOptimization]::Initializing Signal Variable Histograms" << std::endl;
     signalHistos_= std::make_shared<ZBiHistos>("signal");
@@ -436,10 +444,8 @@ bool SimpZBiOptimizationProcessor::process(){
 
         //Fill signal variable distributions
         for(int e=0;  e < signalMTT_->GetEntries(); e++){
-            signalMTT_->GetEntry(e);
-
             //Apply current set of persistent cuts to all events
-            if(failPersistentCuts(signalMTT_))
+            if(!signalPersistentCuts_->select(e))
                 continue;
 
             //Fill Signal variable distributions
@@ -481,29 +487,33 @@ bool SimpZBiOptimizationProcessor::process(){
             }
         }
 
+        //Histogram names of the Test Cuts, in the order of the compiled cuts
+        const std::vector<IterativeCutSelector::CompiledCut>& testCuts = testCutsSelector_->getCompiledCuts();
+        std::vector<std::string> bkgZVtxNames;
+        std::vector<std::string> signalZVtxNames;
+        for(unsigned int cut = 0; cut < testCuts.size(); cut++){
+            bkgZVtxNames.push_back("background_zVtx_"+testCuts[cut].name+"_h");
+            signalZVtxNames.push_back("unc_vtx_z_vs_true_vtx_z_"+testCuts[cut].name+"_hh");
+        }
+
         //Fill Background Histograms corresponding to each Test Cut
         if(debug_) std::cout << "Filling Background Variables for each Test Cut" << std::endl;
         for(int e=0;  e < bkgMTT_->GetEntries(); e++){
-            bkgMTT_->GetEntry(e);
-
             //Apply persistent cuts
-            if(failPersistentCuts(bkgMTT_))
+            if(!bkgPersistentCuts_->select(e))
                 continue;
 
             fillEventHistograms(bkgHistos_, bkgMTT_);
 
             //Loop over each Test Cut
-            for(cut_iter_ it=testCutsPtr_->begin(); it!=testCutsPtr_->end(); it++){
-               std::string cutname = it->first;
-               std::string cutvar = testCutsSelector_->getCutVar(cutname);
-
+            for(unsigned int cut = 0; cut < testCuts.size(); cut++){
                //apply Test Cut
-               if(failTestCut(cutname, bkgMTT_))
+               if(!bkgTestCuts_->passCut(cut))
                    continue;
 
                 //If event passes Test Cut, fill vertex z distribution. 
                 //This distribution is used to build the Background Model corresponding to each Test Cut
-                testCutHistos_->Fill1DHisto("background_zVtx_"+cutname+"_h",
+                testCutHistos_->Fill1DHisto(bkgZVtxNames[cut],
                         bkgMTT_->getValue("unc_vtx_z"),background_sf_);
             }
         }
@@ -512,21 +522,16 @@ bool SimpZBiOptimizationProcessor::process(){
         //This is used to get the truth Signal Selection Efficiency F(z), given a Zcut in reconstructed z_vtx
         if(debug_) std::cout << "Build Signal truth z vs recon z" << std::endl;
         for(int e=0;  e < signalMTT_->GetEntries(); e++){
-            signalMTT_->GetEntry(e);
-
-            //Apply persistent cuts
-            if(failPersistentCuts(signalMTT_))
+            //Apply persistent cuts, unchanged since the signal distributions were filled
+            if(!signalPersistentCuts_->select(e))
                 continue;
 
             //Loop over each Test Cut and plot unc_vtx_z vs true_vtx_z
-            for(cut_iter_ it=testCutsPtr_->begin(); it!=testCutsPtr_->end(); it++){
-                std::string cutname = it->first;
-                std::string cutvar = testCutsSelector_->getCutVar(cutname);
-                double cutvalue = testCutsSelector_->getCut(cutname);
+            for(unsigned int cut = 0; cut < testCuts.size(); cut++){
                 //Apply Test Cut
-                if(!testCutsSelector_->passCutGTorLT(cutname, signalMTT_->getValue(cutvar)))
+                if(!signalTestCuts_->passCut(cut))
                     continue;
-                testCutHistos_->Fill2DHisto("unc_vtx_z_vs_true_vtx_z_"+cutname+"_hh",
+                testCutHistos_->Fill2DHisto(signalZVtxNames[cut],
                         signalMTT_->getValue("unc_vtx_z"),signalMTT_->getValue("vd_true_vtx_z"),1.0);
             }
         }
@@ -860,36 +865,6 @@ double SimpZBiOptimizationProcessor::calculateZBi(double n_on, double n_off, dou
     return Z_Bi;
 }
 
-bool SimpZBiOptimizationProcessor::failPersistentCuts(SimpAnaTTree* MTT){
-    bool failCuts = false;
-    for(cut_iter_ it=persistentCutsPtr_->begin(); it!=persistentCutsPtr_->end(); it++){
-        std::string cutname = it->first;
-        std::string cutvar = persistentCutsSelector_->getCutVar(cutname);
-        //If no value inside the tuple exists for this cut, do not apply the cut.
-        if(!MTT->variableExists(cutvar))
-            continue;
-        if(!persistentCutsSelector_->passCutGTorLT(cutname, MTT->getValue(cutvar))){ 
-            failCuts = true;
-            break;
-        }
-    }
-
-    return failCuts;
-}
-
-bool SimpZBiOptimizationProcessor::failTestCut(std::string cutname, SimpAnaTTree* MTT){
-
-    std::string cutvar = testCutsSelector_->getCutVar(cutname);
-    double cutvalue = testCutsSelector_->getCut(cutname);
-    //If cut variable is not found in the list of tuples, do not apply cut
-    if(!MTT->variableExists(cutvar))
-        return false;
-    if(!testCutsSelector_->passCutGTorLT(cutname, MTT->getValue(cutvar)))
-        return true;
-    else
-        return false;
-}
-
 void SimpZBiOptimizationProcessor::getSignalMCAnaVtxZ_h(std::string signalMCAnaFilename, 
         std::string signal_pdgid){
     //Read pre-trigger Signal MCAna vertex z distribution
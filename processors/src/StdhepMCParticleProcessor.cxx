@@ -7,6 +7,112 @@
 #include "StdhepMCParticleProcessor.h" 
 #include "utilities.h"
 
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+#include <IMPL/LCCollectionVec.h>
+
+#include "TROOT.h"
+
+namespace {
+
+    /** Speed of light [mm/ns], used by LCStdHepRdr to convert the StdHep time */
+    const double c_light = 299.792;
+
+    /** Number of events buffered between the decoding thread and the tree filling */
+    const int nPipelineSlots = 16;
+
+    /** @return digit of a PDG code, 1 being the last digit */
+    int pdgDigit(int apdg, int loc) {
+        static const int powers[10] = {1, 10, 100, 1000, 10000, 100000, 1000000,
+            10000000, 100000000, 1000000000};
+        return (apdg / powers[loc - 1]) % 10;
+    }
+
+    /**
+     * @brief Charge of a particle in units of e/3
+     *
+     * Same computation as LCStdHepRdr, which sets the MCParticle charges
+     * with the HepPDT ParticleID::threeCharge algorithm.
+     *
+     * @param pdg PDG code
+     * @return three times the charge
+     */
+    int threeCharge(int pdg) {
+        // Charges of the fundamental particles 1 to 100
+        static const int ch100[100] = { -1, 2,-1, 2,-1, 2,-1, 2, 0, 0,
+                                        -3, 0,-3, 0,-3, 0,-3, 0, 0, 0,
+                                         0, 0, 0, 3, 0, 0, 0, 0, 0, 0,
+                                         0, 0, 0, 3, 0, 0, 3, 0, 0, 0,
+                                         0,-1, 0, 0, 0, 0, 0, 0, 0, 0,
+                                         0, 6, 3, 6, 0, 0, 0, 0, 0, 0,
+                                         0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+                                         0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+                                         0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+                                         0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+        int apdg = std::abs(pdg);
+        // Ions and invalid codes
+        if (apdg == 0 || apdg / 10000000 > 0)
+            return 0;
+
+        int q1 = pdgDigit(apdg, 4);
+        int q2 = pdgDigit(apdg, 3);
+        int q3 = pdgDigit(apdg, 2);
+        int fundamental = 0;
+        if (q2 == 0 && q1 == 0)
+            fundamental = apdg % 10000;
+        else if (apdg <= 100)
+            fundamental = apdg;
+
+        int charge = 0;
+        if (fundamental > 0 && fundamental <= 100) {
+            charge = ch100[fundamental - 1];
+            if (apdg == 1000017 || apdg == 1000018) charge = 0;
+            if (apdg == 1000034 || apdg == 1000052) charge = 0;
+            if (apdg == 1000053 || apdg == 1000054) charge = 0;
+            if (apdg == 5100061 || apdg == 5100062) charge = 6;
+        }
+        else if (pdgDigit(apdg, 1) == 0 || q2 == 0) {
+            // KL, KS or undefined
+            return 0;
+        }
+        else if (q1 == 0) {
+            // Mesons
+            if (q3 == 0)
+                return 0;
+            if (q2 == 3 || q2 == 5)
+                charge = ch100[q3 - 1] - ch100[q2 - 1];
+            else
+                charge = ch100[q2 - 1] - ch100[q3 - 1];
+        }
+        else if (q3 == 0) {
+            // Diquarks
+            charge = ch100[q2 - 1] + ch100[q1 - 1];
+        }
+        else {
+            // Baryons
+            charge = ch100[q3 - 1] + ch100[q2 - 1] + ch100[q1 - 1];
+        }
+        return pdg < 0 ? -charge : charge;
+    }
+
+    /** Mark particle as child of parent unless it already has a first parent */
+    void setFirstParent(std::vector<int>& firstParent, int particle, int parent) {
+        if (particle < (int) firstParent.size() && firstParent[particle] < 0)
+            firstParent[particle] = parent;
+    }
+}
+
+StdhepMCParticleProcessor::EventSlot::~EventSlot() {
+    for (auto particle : pool)
+        delete particle;
+}
+
 StdhepMCParticleProcessor::StdhepMCParticleProcessor(const std::string& name, Process& process)
     : Processor(name, process) { 
     }
@@ -22,6 +128,8 @@ void StdhepMCParticleProcessor::configure(const ParameterSet& parameters) {
         mcPartCollRoot_ = parameters.getString("mcPartCollRoot", mcPartCollRoot_);
         maxEvent_ = parameters.getInteger("maxEvent",maxEvent_);
         skipEvent_ = parameters.getInteger("skipEvent",skipEvent_);   
+        pipeline_ = parameters.getInteger("pipeline", pipeline_);
+        lcioReader_ = parameters.getInteger("lcioReader", lcioReader_);
     }
     catch (std::runtime_error& error)
     {
@@ -44,7 +152,253 @@ void StdhepMCParticleProcessor::initialize(std::string inFilename, std::string o
 
 bool StdhepMCParticleProcessor::process() {
     std::cout << "[StdhepMCParticleProcessor] Starting process()" << std::endl;
-       
+
+    if (lcioReader_)
+        return processLcio();
+
+    std::cout << "opening file : " << inFilename_ << std::endl;
+    UTIL::lStdHep reader(inFilename_.c_str());
+    if (reader.getError()) {
+        std::cout << "[StdhepMCParticleProcessor] ERROR: cannot open stdhep file " << inFilename_ << std::endl;
+        return false;
+    }
+    reader.printFileHeader();
+
+    // Skipped records are read but not converted, they still take their LCIO ids
+    initLcioIds();
+    int count = 0;
+    while (count < skipEvent_ && readRecord(reader)) {
+        takeLcioIds(reader.nTracks());
+        ++count;
+    }
+    int nSkipped = count;
+
+    if (pipeline_) {
+        // The particles are created in the decoding thread
+        ROOT::EnableThreadSafety();
+
+        // Slots go from the free queue to the decoding thread, then to the
+        // ready queue filled in the tree. -1 in the ready queue ends the loop.
+        std::vector<EventSlot> slots(nPipelineSlots);
+        std::deque<int> free_slots;
+        std::deque<int> ready_slots;
+        for (int islot = 0; islot < nPipelineSlots; ++islot)
+            free_slots.push_back(islot);
+        std::mutex slot_mutex;
+        std::condition_variable free_cv;
+        std::condition_variable ready_cv;
+        bool stop = false;
+        std::exception_ptr error;
+
+        {
+            // Stops and joins the decoding thread however the filling loop ends
+            struct DecoderGuard {
+                std::thread thread;
+                std::mutex& mutex;
+                bool& stop;
+                std::condition_variable& free_cv;
+                std::condition_variable& ready_cv;
+
+                ~DecoderGuard() {
+                    {
+                        std::lock_guard<std::mutex> lock(mutex);
+                        stop = true;
+                    }
+                    free_cv.notify_all();
+                    ready_cv.notify_all();
+                    if (thread.joinable())
+                        thread.join();
+                }
+            } decoder{std::thread(), slot_mutex, stop, free_cv, ready_cv};
+
+            decoder.thread = std::thread([&]() {
+                int nRead = count;
+                bool more = true;
+                while (more && (maxEvent_ < 0 || nRead < maxEvent_)) {
+                    int islot;
+                    {
+                        std::unique_lock<std::mutex> lock(slot_mutex);
+                        free_cv.wait(lock, [&]() { return stop || !free_slots.empty(); });
+                        if (stop)
+                            return;
+                        islot = free_slots.front();
+                        free_slots.pop_front();
+                    }
+                    try {
+                        more = readRecord(reader);
+                        if (more)
+                            decodeEvent(reader, slots[islot]);
+                    }
+                    catch (...) {
+                        error = std::current_exception();
+                        more = false;
+                    }
+                    if (!more)
+                        break;
+                    ++nRead;
+                    {
+                        std::lock_guard<std::mutex> lock(slot_mutex);
+                        ready_slots.push_back(islot);
+                    }
+                    ready_cv.notify_all();
+                }
+                {
+                    std::lock_guard<std::mutex> lock(slot_mutex);
+                    ready_slots.push_back(-1);
+                }
+                ready_cv.notify_all();
+            });
+
+            while (true) {
+                int islot;
+                {
+                    std::unique_lock<std::mutex> lock(slot_mutex);
+                    ready_cv.wait(lock, [&]() { return !ready_slots.empty(); });
+                    islot = ready_slots.front();
+                    ready_slots.pop_front();
+                }
+                if (islot < 0)
+                    break;
+                fillEvent(slots[islot]);
+                ++count;
+                {
+                    std::lock_guard<std::mutex> lock(slot_mutex);
+                    free_slots.push_back(islot);
+                }
+                free_cv.notify_all();
+            }
+        }
+        if (error)
+            std::rethrow_exception(error);
+    }
+    else {
+        EventSlot slot;
+        while ((maxEvent_ < 0 || count < maxEvent_) && readRecord(reader)) {
+            decodeEvent(reader, slot);
+            fillEvent(slot);
+            ++count;
+        }
+    }
+
+    std::cout << "  converted " << count - nSkipped << std::endl;
+
+    std::cout << "==================================================== "
+         << std::endl << std::endl;
+
+    return true;
+}
+
+bool StdhepMCParticleProcessor::readRecord(UTIL::lStdHep& reader) {
+    long status = reader.readEvent();
+    if (status == LSH_SUCCESS)
+        return true;
+    if (status != LSH_ENDOFFILE)
+        std::cout << "[StdhepMCParticleProcessor] ERROR: cannot read record from " << inFilename_
+            << ", status " << status << std::endl;
+    return false;
+}
+
+void StdhepMCParticleProcessor::decodeEvent(UTIL::lStdHep& reader, EventSlot& slot) {
+    int nParticles = reader.nTracks();
+    while ((int) slot.pool.size() < nParticles)
+        slot.pool.push_back(new MCParticle());
+    slot.particles.assign(slot.pool.begin(), slot.pool.begin() + nParticles);
+
+    int firstId = takeLcioIds(nParticles);
+
+    // The parents are set by LCStdHepRdr from the mother indices first and
+    // then from the daughter indices, only the first one is kept here.
+    slot.firstParent.assign(nParticles, -1);
+    for (int ip = 0; ip < nParticles; ++ip) {
+        int firstMother = reader.mother1(ip) % 10000 - 1;
+        int lastMother = reader.mother2(ip) % 10000 - 1;
+        if (firstMother > -1)
+            setFirstParent(slot.firstParent, ip, firstMother < nParticles ? firstMother : -1);
+        else if (lastMother > -1)
+            setFirstParent(slot.firstParent, ip, lastMother < nParticles ? lastMother : -1);
+    }
+    for (int ip = 0; ip < nParticles; ++ip) {
+        int firstDaughter = reader.daughter1(ip) % 10000 - 1;
+        int lastDaughter = reader.daughter2(ip) % 10000 - 1;
+        if (firstDaughter > -1 && lastDaughter > -1) {
+            if (lastDaughter >= firstDaughter) {
+                for (int id = firstDaughter; id <= lastDaughter && id < nParticles; ++id)
+                    setFirstParent(slot.firstParent, id, ip);
+            }
+            else {
+                setFirstParent(slot.firstParent, firstDaughter, ip);
+                setFirstParent(slot.firstParent, lastDaughter, ip);
+            }
+        }
+        else if (firstDaughter > -1)
+            setFirstParent(slot.firstParent, firstDaughter, ip);
+        else if (lastDaughter > -1)
+            setFirstParent(slot.firstParent, lastDaughter, ip);
+    }
+
+    const double zero[3] = {0., 0., 0.};
+    for (int ip = 0; ip < nParticles; ++ip) {
+        MCParticle* particle = slot.particles[ip];
+
+        int pdg = reader.pid(ip);
+
+        // LCStdHepRdr stores the charge, the momentum, the mass and the time as floats
+        float charge = threeCharge(pdg) / 3.;
+        particle->setCharge(charge);
+
+        float time = reader.T(ip) / c_light;
+        particle->setTime(time);
+
+        double momentum[3] = {(float) reader.Px(ip), (float) reader.Py(ip), (float) reader.Pz(ip)};
+        double mass = (float) reader.M(ip);
+        particle->setEnergy(std::sqrt(momentum[0]*momentum[0] + momentum[1]*momentum[1]
+                    + momentum[2]*momentum[2] + mass*mass));
+        particle->setMomentum(momentum);
+        particle->setEndpointMomentum(zero);
+        particle->setMass(mass);
+        particle->setPDG(pdg);
+        particle->setID(firstId + ip * lcioParticleIds_);
+
+        // The particles are reused, so the default of MCParticle is restored without parent
+        int parent = slot.firstParent[ip];
+        particle->setMomPDG(parent > -1 ? reader.pid(parent) : -9999);
+
+        particle->setGenStatus(reader.status(ip));
+        particle->setSimStatus(0);
+
+        double vertex[3] = {reader.X(ip), reader.Y(ip), reader.Z(ip)};
+        particle->setVertexPosition(vertex);
+        particle->setEndPoint(zero);
+    }
+}
+
+void StdhepMCParticleProcessor::initLcioIds() {
+    // Objects like the ones LCStdHepRdr makes for a record, only used to
+    // measure the ids each one takes. Nothing made LCIO objects before, so
+    // the event gets the id of the event of the first record.
+    IMPL::LCEventImpl lcEvent;
+    IMPL::LCCollectionVec lcParticles(EVENT::LCIO::MCPARTICLE);
+    IMPL::MCParticleImpl lcParticle;
+    IMPL::MCParticleImpl lcNextParticle;
+
+    nextLcioId_ = lcEvent.simpleUID();
+    lcioEventIds_ = lcParticle.simpleUID() - lcEvent.simpleUID();
+    lcioParticleIds_ = lcNextParticle.simpleUID() - lcParticle.simpleUID();
+}
+
+int StdhepMCParticleProcessor::takeLcioIds(int nParticles) {
+    int firstId = nextLcioId_ + lcioEventIds_;
+    nextLcioId_ = firstId + nParticles * lcioParticleIds_;
+    return firstId;
+}
+
+void StdhepMCParticleProcessor::fillEvent(EventSlot& slot) {
+    mc_particles_.swap(slot.particles);
+    tree_->Fill();
+    mc_particles_.swap(slot.particles);
+}
+
+bool StdhepMCParticleProcessor::processLcio() {
     std::cout << "opening file : " << inFilename_ << std::endl;
     UTIL::LCStdHepRdr rdr(inFilename_.c_str());
     rdr.printHeader();
@@ -52,9 +406,16 @@ bool StdhepMCParticleProcessor::process() {
 
     description << " file generated with LCIO stdhepjob from "  << inFilename_;
 
-    int count = skipEvent_;
+    int count = 0;
 
     try {
+
+        // Skipped events are read but not converted
+        while (count < skipEvent_) {
+            IMPL::LCEventImpl evt;
+            rdr.updateNextEvent(&evt, mcPartCollStdhep_.c_str());
+            ++count;
+        }
      
         while( maxEvent_ < 0  || count < maxEvent_ ){
 
@@ -143,7 +504,7 @@ bool StdhepMCParticleProcessor::process() {
     catch( IO::EndOfDataException& e ) {  
     }
 
-    std::cout << "  converted " << count <<  std::endl ;
+    std::cout << "  converted " << std::max(count - skipEvent_, 0) <<  std::endl ;
 
     std::cout << "==================================================== " 
          << std::endl << std::endl ;
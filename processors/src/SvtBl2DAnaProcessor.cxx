@@ -3,6 +3,32 @@
 #include <fstream>
 #include <map>
 
+namespace {
+    /** Trigger bits of TSData.h by their name in the trigger selection file */
+    const std::pair<const char*, bool TSData::tsBits::*> triggerBits[] = {
+        {"Single_0_Top", &TSData::tsBits::Single_0_Top},
+        {"Single_1_Top", &TSData::tsBits::Single_1_Top},
+        {"Single_2_Top", &TSData::tsBits::Single_2_Top},
+        {"Single_3_Top", &TSData::tsBits::Single_3_Top},
+        {"Single_0_Bot", &TSData::tsBits::Single_0_Bot},
+        {"Single_1_Bot", &TSData::tsBits::Single_1_Bot},
+        {"Single_2_Bot", &TSData::tsBits::Single_2_Bot},
+        {"Single_3_Bot", &TSData::tsBits::Single_3_Bot},
+        {"Pair_0      ", &TSData::tsBits::Pair_0},
+        {"Pair_1      ", &TSData::tsBits::Pair_1},
+        {"Pair_2      ", &TSData::tsBits::Pair_2},
+        {"Pair_3      ", &TSData::tsBits::Pair_3},
+        {"LED         ", &TSData::tsBits::LED},
+        {"Cosmic      ", &TSData::tsBits::Cosmic},
+        {"Hodoscope   ", &TSData::tsBits::Hodoscope},
+        {"Pulser      ", &TSData::tsBits::Pulser},
+        {"Mult_0      ", &TSData::tsBits::Mult_0},
+        {"Mult_1      ", &TSData::tsBits::Mult_1},
+        {"FEE_Top     ", &TSData::tsBits::FEE_Top},
+        {"FEE_Bot     ", &TSData::tsBits::FEE_Bot}
+    };
+}
+
 SvtBl2DAnaProcessor::SvtBl2DAnaProcessor(const std::string& name, Process& process) : Processor(name,process){
     mmapper_ = new ModuleMapper();
 }
@@ -15,6 +41,7 @@ void SvtBl2DAnaProcessor::configure(const ParameterSet& parameters) {
     std::cout << "Configuring SvtBl2DAnaProcessor" << std::endl;
     try
     {
+        sparse_          = (bool) parameters.getInteger("sparse", sparse_);
         debug_           = parameters.getInteger("debug");
         rawSvtHitsColl_  = parameters.getString("rawSvtHitsColl");
         histCfgFilename_ = parameters.getString("histCfg");
@@ -34,6 +61,7 @@ void SvtBl2DAnaProcessor::initialize(TTree* tree) {
 
     std::cout << "[SvtBl2DAnaProcessor] Load JSON" << std::endl;
     svtCondHistos->loadHistoConfig(histCfgFilename_);
+    svtCondHistos->setSparse(sparse_);
 
     if (debug_ > 0) std::cout << "[SvtBl2DAnaProcessor] Define 2DHistos" << std::endl;
     svtCondHistos->Svt2DBlHistos::DefineHistos();
@@ -50,63 +78,25 @@ void SvtBl2DAnaProcessor::initialize(TTree* tree) {
         i_file >> triggers_;
         i_file.close();
     }
+    //Names which are not trigger bits never select an event
+    for (auto trigger : triggers_.items()){
+        for (auto& bit : triggerBits){
+            if (trigger.key() == bit.first)
+                selectedTriggers_.push_back(bit.second);
+        }
+    }
 }
 
 bool SvtBl2DAnaProcessor::process(IEvent* ievent) {
 
     TSData* tsdata = (TSData*) triggerBank_;
     
-    //Build binary map of triggers based on TSData.h
-    //make this just trigger map
-    //add random -> tsdata->ext.Pulsar
-    prescaledtriggerMap_["Single_0_Top"] = tsdata->prescaled.Single_0_Top;  
-    prescaledtriggerMap_["Single_1_Top"] = tsdata->prescaled.Single_1_Top; 
-    prescaledtriggerMap_["Single_2_Top"] = tsdata->prescaled.Single_2_Top; 
-    prescaledtriggerMap_["Single_3_Top"] = tsdata->prescaled.Single_3_Top; 
-    prescaledtriggerMap_["Single_0_Bot"] = tsdata->prescaled.Single_0_Bot; 
-    prescaledtriggerMap_["Single_1_Bot"] = tsdata->prescaled.Single_1_Bot; 
-    prescaledtriggerMap_["Single_2_Bot"] = tsdata->prescaled.Single_2_Bot; 
-    prescaledtriggerMap_["Single_3_Bot"] = tsdata->prescaled.Single_3_Bot; 
-    prescaledtriggerMap_["Pair_0      "] = tsdata->prescaled.Pair_0      ; 
-    prescaledtriggerMap_["Pair_1      "] = tsdata->prescaled.Pair_1      ; 
-    prescaledtriggerMap_["Pair_2      "] = tsdata->prescaled.Pair_2      ; 
-    prescaledtriggerMap_["Pair_3      "] = tsdata->prescaled.Pair_3      ; 
-    prescaledtriggerMap_["LED         "] = tsdata->prescaled.LED         ; 
-    prescaledtriggerMap_["Cosmic      "] = tsdata->prescaled.Cosmic      ; 
-    prescaledtriggerMap_["Hodoscope   "] = tsdata->prescaled.Hodoscope   ; 
-    prescaledtriggerMap_["Pulser      "] = tsdata->prescaled.Pulser      ; 
-    prescaledtriggerMap_["Mult_0      "] = tsdata->prescaled.Mult_0      ; 
-    prescaledtriggerMap_["Mult_1      "] = tsdata->prescaled.Mult_1      ;
-    prescaledtriggerMap_["FEE_Top     "] = tsdata->prescaled.FEE_Top     ;
-    prescaledtriggerMap_["FEE_Bot     "] = tsdata->prescaled.FEE_Bot     ;   
-
-    //dont need ext trigger map to require specific triggers
-    //unless we want to require randoms
-    exttriggerMap_["Single_0_Top"] = tsdata->ext.Single_0_Top; 
-    exttriggerMap_["Single_1_Top"] = tsdata->ext.Single_1_Top; 
-    exttriggerMap_["Single_2_Top"] = tsdata->ext.Single_2_Top; 
-    exttriggerMap_["Single_3_Top"] = tsdata->ext.Single_3_Top; 
-    exttriggerMap_["Single_0_Bot"] = tsdata->ext.Single_0_Bot; 
-    exttriggerMap_["Single_1_Bot"] = tsdata->ext.Single_1_Bot; 
-    exttriggerMap_["Single_2_Bot"] = tsdata->ext.Single_2_Bot; 
-    exttriggerMap_["Single_3_Bot"] = tsdata->ext.Single_3_Bot; 
-    exttriggerMap_["Pair_0      "] = tsdata->ext.Pair_0      ; 
-    exttriggerMap_["Pair_1      "] = tsdata->ext.Pair_1      ; 
-    exttriggerMap_["Pair_2      "] = tsdata->ext.Pair_2      ; 
-    exttriggerMap_["Pair_3      "] = tsdata->ext.Pair_3      ; 
-    exttriggerMap_["LED         "] = tsdata->ext.LED         ; 
-    exttriggerMap_["Cosmic      "] = tsdata->ext.Cosmic      ; 
-    exttriggerMap_["Hodoscope   "] = tsdata->ext.Hodoscope   ; 
-    exttriggerMap_["Pulser      "] = tsdata->ext.Pulser      ; 
-    exttriggerMap_["Mult_0      "] = tsdata->ext.Mult_0      ; 
-    exttriggerMap_["Mult_1      "] = tsdata->ext.Mult_1      ;
-    exttriggerMap_["FEE_Top     "] = tsdata->ext.FEE_Top     ;
-    exttriggerMap_["FEE_Bot     "] = tsdata->ext.FEE_Bot     ;   
-    
+    //Prescaled or external bit of any selected trigger
     bool triggerFound = false;
-    for (auto trigger : triggers_.items()){
-        if ( (prescaledtriggerMap_[trigger.key()] > 0) || (exttriggerMap_[trigger.key()]) > 0 ){
+    for (auto bit : selectedTriggers_){
+        if ( (tsdata->prescaled.*bit) || (tsdata->ext.*bit) ){
             triggerFound = true;
+            break;
         }
     }
 
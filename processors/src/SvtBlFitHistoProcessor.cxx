@@ -24,6 +24,7 @@ void SvtBlFitHistoProcessor::configure(const ParameterSet& parameters) {
         deadRMS_ = parameters.getInteger("deadRMS");
         debug_ = parameters.getInteger("debug");
         year_ = parameters.getInteger("year");
+        fitCacheDir_ = parameters.getString("fitCacheDir", fitCacheDir_);
     }
     catch (std::runtime_error& error)
     {
@@ -44,6 +45,10 @@ void SvtBlFitHistoProcessor::initialize(std::string inFilename, std::string outF
     //Initialize fit histos
     fitHistos_ = new BlFitHistos(year_);
     fitHistos_->setDebug(debug_);
+    if (fitCacheDir_ != "") {
+        fitCache_ = new FitCache(fitCacheDir_);
+        fitHistos_->setFitCache(fitCache_);
+    }
     std::cout << "[BlFitHistos] Loading 2D Histos" << std::endl;
     fitHistos_->loadHistoConfig(rawhitsHistCfgFilename_);
     fitHistos_->getHistosFromFile(inF_,layer_);
@@ -107,6 +112,10 @@ void SvtBlFitHistoProcessor::finalize() {
     std::cout << "finalizing SvtBlFitHistoProcessor" << std::endl;
     flat_tuple_->close();
     outF_->Close();
+    if (fitCache_) {
+        fitCache_->printStats();
+        delete fitCache_;
+    }
 }
 
 DECLARE_PROCESSOR(SvtBlFitHistoProcessor);
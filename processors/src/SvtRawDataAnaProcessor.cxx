@@ -5,7 +5,11 @@
  */     
 #include "SvtRawDataAnaProcessor.h"
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
 #include <iostream>
+#include <memory>
 
 SvtRawDataAnaProcessor::SvtRawDataAnaProcessor(const std::string& name, Process& process) : Processor(name,process){
     mmapper_ = new ModuleMapper();
@@ -19,6 +23,10 @@ void SvtRawDataAnaProcessor::configure(const ParameterSet& parameters) {
     try
     {
         debug_           = parameters.getInteger("debug");
+        calibCacheDir_   = parameters.getString("calibCacheDir", calibCacheDir_);
+        nativeFit_       = parameters.getInteger("nativeFit", nativeFit_);
+        fitBenchmark_    = parameters.getInteger("fitBenchmark", fitBenchmark_);
+        pulseModel_      = parameters.getInteger("pulseModel", pulseModel_);
         anaName_         = parameters.getString("anaName");
         svtHitColl_     = parameters.getString("trkrHitColl");           
         histCfgFilename_ = parameters.getString("histCfg");
@@ -134,6 +142,142 @@ TF1* SvtRawDataAnaProcessor::fourPoleFitFunction(std::string word, int caser){
     return func2;
 }
 
+/*
+ *
+ *NATIVE PULSE FITTING. THE BASELINES, NOISE AND SHAPING TIMES OF EVERY CHANNEL ARE CONVERTED ONCE INTO AN
+ APV25PULSEFITTER CALIBRATION, WHICH IS THEN REUSED FOR ALL THE HITS OF THE RUN. WHEN BENCHMARKING THE SAME HITS
+ ARE ALSO FITTED WITH THE FOURPOLEFITFUNCTION TF1 AND THE TWO PATHS ARE COMPARED IN FINALIZE.
+ *
+ */
+
+void SvtRawDataAnaProcessor::buildFitChannels(){
+    Apv25PulseShape::Model model = (pulseModel_==1) ? Apv25PulseShape::TwoPole : Apv25PulseShape::FourPole;
+    fitChannels_.assign(24576, Apv25PulseFitter::Channel());
+    int nValid = 0;
+    for(int i=0; i<24576; i++){
+        float* times;
+        float* baseErr;
+        if(i<4096){
+            int feb=i/2048;
+            int hyb=(i-feb*2048)/512;
+            int ch=i-feb*2048-hyb*512;
+            times=times1_[feb][hyb][ch];
+            baseErr=baseErr1_[feb][hyb][ch];
+        }else{
+            int feb=((i-4096)/2560);
+            int hyb=(i-4096-feb*2560)/640;
+            int ch=i-4096-feb*2560-hyb*640;
+            times=times2_[feb][hyb][ch];
+            baseErr=baseErr2_[feb][hyb][ch];
+        }
+        if(!((times[1]>0)and(times[2]>0)and(times[1]!=times[2]))){continue;}
+        Apv25PulseFitter::Channel& channel = fitChannels_[i];
+        channel.shape.set(times[1],times[2],model);
+        for(int I=0;I<Apv25PulseFitter::nSamples;I++){
+            channel.baseline[I]=baseErr[I];
+            channel.sigma[I]=baseErr[I+6];
+        }
+        channel.valid=true;
+        nValid++;
+    }
+    std::cout<<"[ SvtRawDataAnaProcessor ]: Native pulse fit calibration built for "<<nValid<<" channels"<<std::endl;
+
+    if(fitBenchmark_){
+        if(pulseModel_!=0){
+            std::cout<<"[ SvtRawDataAnaProcessor ]: WARNING: the TF1 path only has the four-pole model, "
+                <<"the benchmark compares different pulse shapes"<<std::endl;
+        }
+        benchFunc_[0] = fourPoleFitFunction("BenchPulse",0);
+        benchFunc_[1] = fourPoleFitFunction("BenchPulses",1);
+    }
+}
+
+int SvtRawDataAnaProcessor::channelIndex(RawSvtHit* hit){
+    std::pair<int,int> key(hit->getLayer(),hit->getModule());
+    auto it = hybridOffsets_.find(key);
+    if(it==hybridOffsets_.end()){
+        //The module mapper lookup is done once per hybrid
+        std::string hw = mmapper_->getHwFromSw("ly"+std::to_string(key.first)+"_m"+std::to_string(key.second));
+        int offset = -1;
+        if(hw.length()>=4){
+            int feb = (int)hw[1]-48;
+            int hyb = (int)hw[3]-48;
+            offset = (feb<=1) ? feb*2048+hyb*512 : 4096+(feb-2)*2560+hyb*640;
+        }
+        it = hybridOffsets_.emplace(key,offset).first;
+    }
+    if(it->second<0){return -1;}
+    int index = it->second+(int)hit->getStrip();
+    if((index<0)or(index>=(int)fitChannels_.size())){return -1;}
+    return index;
+}
+
+void SvtRawDataAnaProcessor::fitEventHits(long eventTime){
+    nativeFits_.assign(svtHits_->size(), Apv25PulseFitter::Result());
+    for(unsigned int i = 0; i < svtHits_->size(); i++){
+        RawSvtHit* hit = svtHits_->at(i);
+        int nPulses = std::min(hit->getFitN(),Apv25PulseFitter::maxPulses);
+        if(nPulses<1){continue;}
+        int index = channelIndex(hit);
+        if((index<0)or(!fitChannels_[index].valid)){continue;}
+        const Apv25PulseFitter::Channel& channel = fitChannels_[index];
+
+        //Start from the reconstructed fit, shifted to the sample frame
+        double t0[2];
+        double amp[2];
+        for(int P=0;P<nPulses;P++){
+            t0[P] = -1*rETime(-(hit->getT0(P)),eventTime);
+            amp[P] = hit->getAmp(P);
+        }
+        int* adcs = hit->getADCs();
+
+        auto start = std::chrono::steady_clock::now();
+        nativeFits_[i] = fitter_.fit(adcs,channel,nPulses,t0,amp);
+        auto stop = std::chrono::steady_clock::now();
+        if(!fitBenchmark_){continue;}
+        benchNativeTime_ += std::chrono::duration<double>(stop-start).count();
+
+        //Same fit through the TF1 path
+        TF1* func = benchFunc_[nPulses-1];
+        double times[6]; double points[6]; double errors[6]; double zeroes[6];
+        start = std::chrono::steady_clock::now();
+        for(int I=0;I<6;I++){
+            times[I]=float(I)*24.0;
+            points[I]=adcs[I]-channel.baseline[I];
+            errors[I]=channel.sigma[I];
+            zeroes[I]=0.0;
+        }
+        TGraphErrors gr(6,times,points,zeroes,errors);
+        func->SetParameter(0,t0[0]);
+        func->SetParameter(3,amp[0]);
+        func->FixParameter(1,channel.shape.getTau1());
+        func->FixParameter(2,channel.shape.getTau2());
+        func->FixParameter(4,0.0);
+        if(nPulses==2){
+            func->SetParameter(5,t0[1]);
+            func->SetParameter(8,amp[1]);
+            func->FixParameter(6,channel.shape.getTau1());
+            func->FixParameter(7,channel.shape.getTau2());
+        }
+        int status = gr.Fit(func,"QN");
+        stop = std::chrono::steady_clock::now();
+        benchTF1Time_ += std::chrono::duration<double>(stop-start).count();
+
+        if((status!=0)or(!nativeFits_[i].converged)){
+            benchFailed_++;
+            continue;
+        }
+        double dT0 = nativeFits_[i].t0[0]-func->GetParameter(0);
+        double dAmp = (nativeFits_[i].amp[0]-func->GetParameter(3))/func->GetParameter(3);
+        benchHits_++;
+        benchSumDT0_ += dT0;
+        benchSumDT02_ += dT0*dT0;
+        benchSumDAmp_ += dAmp;
+        benchSumDAmp2_ += dAmp*dAmp;
+        benchMaxDT0_ = std::max(benchMaxDT0_,std::abs(dT0));
+    }
+}
+
 /*
  *
  *PROCESS INITIALIZER. READS IN THE OFFLINE BASELINES INTO LOCAL BASELINE FILES, READs in the PULSE SHAPES, and FINALLLY
@@ -144,68 +288,93 @@ TF1* SvtRawDataAnaProcessor::fourPoleFitFunction(std::string word, int caser){
  */
 
 void SvtRawDataAnaProcessor::initialize(TTree* tree) {
-    if(doSample_){
-        //Fill in the Background Arrays
-        std::ifstream myfile(baselineFile_.data());
-        std::ifstream myfile2(timeProfiles_.data());
-        std::string s;
-        std::string s2;
-        std::vector<float [12]> baselines;
-        for(int i=0; i<24576; i++){ 
-            std::getline(myfile,s);
-            std::getline(myfile2,s2);
-            int feb=0;
-            int hyb=0;
-            int ch=0;
-            if(i>=4096){
-                feb=((i-4096)/2560);
-                hyb=(i-4096-feb*2560)/640;
-                ch=i-4096-feb*2560-hyb*640;
-            }else{
-                feb=i/2048;
-                hyb=(i-feb*2048)/512;
-                ch=i-feb*2048-hyb*512;
+    if(doSample_ || nativeFit_ || fitBenchmark_){
+        //Try the binary calibration cache before parsing the text files
+        std::unique_ptr<SvtCalibrationCache> calibCache;
+        bool cached = false;
+        if(!calibCacheDir_.empty()){
+            calibCache.reset(new SvtCalibrationCache(calibCacheDir_,{baselineFile_,timeProfiles_}));
+            calibCache->addTable("times1",&times1_[0][0][0][0],sizeof(times1_)/sizeof(float));
+            calibCache->addTable("times2",&times2_[0][0][0][0],sizeof(times2_)/sizeof(float));
+            calibCache->addTable("baseErr1",&baseErr1_[0][0][0][0],sizeof(baseErr1_)/sizeof(float));
+            calibCache->addTable("baseErr2",&baseErr2_[0][0][0][0],sizeof(baseErr2_)/sizeof(float));
+            cached = calibCache->load();
+            if(cached){
+                std::cout<<"[ SvtRawDataAnaProcessor ]: Loaded SVT calibration from "<<calibCache->getPath()<<std::endl;
             }
-            for(int I=0;I<5;I++){
-                std::string token=s2.substr(0,s2.find(","));
-                s2=s2.substr(s2.find(",")+1);
-                if(I>=2){
-                    if(i<=4096){
-                        times1_[feb][hyb][ch][I-2]=str_to_float(token);
-                    }else{
-                        times2_[feb][hyb][ch][I-2]=str_to_float(token);
-                    }   
+        }
+        if(!cached){
+            //Fill in the Background Arrays
+            std::ifstream myfile(baselineFile_.data());
+            std::ifstream myfile2(timeProfiles_.data());
+            bool opened = myfile.is_open() and myfile2.is_open();
+            std::string s;
+            std::string s2;
+            std::vector<float [12]> baselines;
+            for(int i=0; i<24576; i++){ 
+                std::getline(myfile,s);
+                std::getline(myfile2,s2);
+                int feb=0;
+                int hyb=0;
+                int ch=0;
+                if(i>=4096){
+                    feb=((i-4096)/2560);
+                    hyb=(i-4096-feb*2560)/640;
+                    ch=i-4096-feb*2560-hyb*640;
+                }else{
+                    feb=i/2048;
+                    hyb=(i-feb*2048)/512;
+                    ch=i-feb*2048-hyb*512;
                 }
-            }
-            //if(i<2048){
-            //std::cout<<i<<" "<<feb<<" "<<hyb<<" "<<ch<<std::endl;
-            //std::cout<<s<<std::endl;}
-            for(int I=0;I<13;I++){
-                if(I>0){
-                    if(i<=4096){
-                        std::string token=s.substr(0,s.find(" "));
-                        if(debug_){
-                            std::cout<<i<<" "<<feb<<" "<<hyb<<" "<<ch<<std::endl;
+                for(int I=0;I<5;I++){
+                    std::string token=s2.substr(0,s2.find(","));
+                    s2=s2.substr(s2.find(",")+1);
+                    if(I>=2){
+                        if(i<4096){
+                            times1_[feb][hyb][ch][I-2]=str_to_float(token);
+                        }else{
+                            times2_[feb][hyb][ch][I-2]=str_to_float(token);
+                        }   
+                    }
+                }
+                //if(i<2048){
+                //std::cout<<i<<" "<<feb<<" "<<hyb<<" "<<ch<<std::endl;
+                //std::cout<<s<<std::endl;}
+                for(int I=0;I<13;I++){
+                    if(I>0){
+                        if(i<4096){
+                            std::string token=s.substr(0,s.find(" "));
+                            if(debug_){
+                                std::cout<<i<<" "<<feb<<" "<<hyb<<" "<<ch<<std::endl;
+                            }
+                            baseErr1_[feb][hyb][ch][I-1]=str_to_float(token);
+                            //std::cout<<str_to_float(token)<<std::endl;
+                            s=s.substr(s.find(" ")+1);
+                        }else{
+                            std::string token=s.substr(0,s.find(" ")); 
+                            baseErr2_[feb][hyb][ch][I-1]=str_to_float(token);
+                            //std::cout<<str_to_float(token)<<std::endl;
+                            s=s.substr(s.find(" ")+1);
+                            //std::cout<<s<<std::endl;
                         }
-                        baseErr1_[feb][hyb][ch][I-1]=str_to_float(token);
-                        //std::cout<<str_to_float(token)<<std::endl;
-                        s=s.substr(s.find(" ")+1);
                     }else{
-                        std::string token=s.substr(0,s.find(" ")); 
-                        baseErr2_[feb][hyb][ch][I-1]=str_to_float(token);
-                        //std::cout<<str_to_float(token)<<std::endl;
                         s=s.substr(s.find(" ")+1);
-                        //std::cout<<s<<std::endl;
                     }
-                }else{
-                    s=s.substr(s.find(" ")+1);
                 }
-            }
 
+            }
+            myfile.close();
+            myfile2.close();
+            //sleep(2000);
+            if(calibCache and opened){
+                if(calibCache->store()){
+                    std::cout<<"[ SvtRawDataAnaProcessor ]: Stored SVT calibration in "<<calibCache->getPath()<<std::endl;
+                }
+            }
+        }
+        if(nativeFit_ || fitBenchmark_){
+            buildFitChannels();
         }
-        myfile.close();
-        myfile2.close();
-        //sleep(2000);
     }
 
 
@@ -271,6 +440,9 @@ bool SvtRawDataAnaProcessor::process(IEvent* ievent) {
     //std::cout<<"Trigger Time: "<<vtpBank_->singletrigs.at(0).T<<std::endl;
     int trigPhase =  (int)((eventTime%24)/4);
     if((trigPhase!=tphase_)&&(tphase_!=6)){return true;}
+    if(nativeFit_ || fitBenchmark_){
+        fitEventHits(eventTime);
+    }
     for(unsigned int i = 0; i < svtHits_->size(); i++){ 
         RawSvtHit * thisHit = svtHits_->at(i); 
         int getNum = thisHit->getFitN();//std::cout<<"I got here 10"<<std::endl;
@@ -376,7 +548,7 @@ bool SvtRawDataAnaProcessor::process(IEvent* ievent) {
                     //std::cout<<T<<std::endl;
                     //if((regions_[i_reg]=="OneFit")and(feb>=2)){continue;}
                     if((regions_[i_reg]=="CTFit")and((thisHit->getT0(J)<26.0)or(thisHit->getT0(J)>30.0))){continue;}
-                    sample(thisHit,regions_[i_reg],ievent,eventTime,N); 
+                    sample(thisHit,regions_[i_reg],ievent,eventTime,N,i); 
                 
                 }
 
@@ -398,7 +570,7 @@ bool SvtRawDataAnaProcessor::process(IEvent* ievent) {
      *
      */
 
-    void SvtRawDataAnaProcessor::sample(RawSvtHit* thisHit,std::string word, IEvent* ievent,long T,int N){
+    void SvtRawDataAnaProcessor::sample(RawSvtHit* thisHit,std::string word, IEvent* ievent,long T,int N,int hitIndex){
         auto mod = std::to_string(thisHit->getModule());
         auto lay = std::to_string(thisHit->getLayer());
         //swTag= mmapper_->getStringFromSw("ly"+lay+"_m"+mod);
@@ -551,6 +723,17 @@ bool SvtRawDataAnaProcessor::process(IEvent* ievent) {
                     //add->Draw("same");
                     //auto ADD = new TF1();
                 }
+                bool drawNative = nativeFit_ && hitIndex >= 0 && hitIndex < (int)nativeFits_.size()
+                    && nativeFits_[hitIndex].converged;
+                if(drawNative){
+                    Apv25PulseFitter::Result nativeFit = nativeFits_[hitIndex];
+                    Apv25PulseShape shape = fitChannels_[channelIndex(thisHit)].shape;
+                    TF1* nativefunc = new TF1("Native",[nativeFit,shape](double* x, double*){
+                            return Apv25PulseFitter::evaluate(nativeFit, shape, x[0]);},0.0,150.0,0);
+                    nativefunc->SetLineColor(kBlue);
+                    nativefunc->SetLineStyle(2);
+                    nativefunc->Draw("same");
+                }
                 //gr->Draw("same");
                 auto legend = new TLegend(0.1,0.7,.48,.9);
                 legend->AddEntry("gr","ADC counts");
@@ -560,6 +743,9 @@ bool SvtRawDataAnaProcessor::process(IEvent* ievent) {
                     legend->AddEntry("Pulse 1","Second Pulse");
                     legend->AddEntry("Addition","Summed Fit");
                 }
+                if(drawNative){
+                    legend->AddEntry("Native","Native Refit");
+                }
                 legend->Draw("same");
                 std::string helper2=word+std::to_string(readout[K]-1)+".png";
                 const char *thing2 = helper2.data(); 
@@ -591,6 +777,28 @@ bool SvtRawDataAnaProcessor::process(IEvent* ievent) {
 
     void SvtRawDataAnaProcessor::finalize() {
 
+        if(fitBenchmark_){
+            //Both paths are timed on every attempted hit, including the failed fits
+            long attempted = benchHits_ + benchFailed_;
+            std::cout << "[ SvtRawDataAnaProcessor ]: Pulse fit benchmark on " << attempted << " hits ("
+                << benchFailed_ << " with a failed fit)" << std::endl;
+            if(attempted > 0){
+                std::cout << "    native: " << attempted/benchNativeTime_ << " hits/s, TF1: "
+                    << attempted/benchTF1Time_ << " hits/s, speedup " << benchTF1Time_/benchNativeTime_ << std::endl;
+            }
+            if(benchHits_ > 0){
+                double meanDT0 = benchSumDT0_/benchHits_;
+                double meanDAmp = benchSumDAmp_/benchHits_;
+                std::cout << "    t0 native-TF1 over the " << benchHits_ << " converged hits: mean " << meanDT0 << " ns, rms "
+                    << std::sqrt(std::max(0.0, benchSumDT02_/benchHits_ - meanDT0*meanDT0))
+                    << " ns, max |dt0| " << benchMaxDT0_ << " ns" << std::endl;
+                std::cout << "    amplitude (native-TF1)/TF1: mean " << meanDAmp << ", rms "
+                    << std::sqrt(std::max(0.0, benchSumDAmp2_/benchHits_ - meanDAmp*meanDAmp)) << std::endl;
+            }
+            delete benchFunc_[0];
+            delete benchFunc_[1];
+        }
+
         outF_->cd();
         for(reg_it it = reg_histos_.begin(); it!=reg_histos_.end(); ++it){
             std::string dirName = it->first;
@@ -248,6 +248,7 @@ bool VertexAnaProcessor::process(IEvent* ievent) {
     }
     HpsEvent* hps_evt = (HpsEvent*) ievent;
     double weight = 1.;
+    hitIndexBuilt_ = false;
     int run_number = evth_->getRunNumber();
     int closest_run;
     if(!bpc_configs_.empty()){
@@ -1116,8 +1117,13 @@ bool VertexAnaProcessor::process(IEvent* ievent) {
             double pos_trk_iso_L1 = 99999.9;
             if(hasL1ele && hasL2ele && hasL1pos && hasL2pos){
                 if (ele_trk_gbl->isKalmanTrack()){
-                    ele_trk_iso_L1 = utils::getKalmanTrackL1Isolations(ele_trk_gbl, hits_);
-                    pos_trk_iso_L1 = utils::getKalmanTrackL1Isolations(pos_trk_gbl, hits_);
+                    //Index the SiClusters once per event, shared by all vertices and regions
+                    if (!hitIndexBuilt_) {
+                        hitIndex_.build(hits_);
+                        hitIndexBuilt_ = true;
+                    }
+                    ele_trk_iso_L1 = utils::getKalmanTrackL1Isolations(ele_trk_gbl, hitIndex_);
+                    pos_trk_iso_L1 = utils::getKalmanTrackL1Isolations(pos_trk_gbl, hitIndex_);
                 }
             }
 
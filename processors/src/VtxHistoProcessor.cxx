@@ -20,6 +20,8 @@ void VtxHistoProcessor::configure(const ParameterSet& parameters) {
     {
         debug_          = parameters.getInteger("debug");
         rebin_          = parameters.getInteger("rebin");
+        nThreads_       = parameters.getInteger("nThreads", nThreads_);
+        fitCacheDir_    = parameters.getString("fitCacheDir", fitCacheDir_);
         selections_     = parameters.getVString("selections");
         projections_    = parameters.getVString("projections");
     }
@@ -36,6 +38,9 @@ void VtxHistoProcessor::initialize(std::string inFilename, std::string outFilena
 
     //To save the projections
     HistogramHelpers::OpenProjectionFile();    
+
+    if (fitCacheDir_ != "")
+        fitCache_ = new FitCache(fitCacheDir_);
     
     //Get the vtx vs InvM and p 
     
@@ -79,7 +84,10 @@ bool VtxHistoProcessor::process() {
         _histos1d[it->first+"_sigma"]->Sumw2();
         
         std::cout<<"Fitting::"<<it->first<<std::endl;
-        HistogramHelpers::profileYwithIterativeGaussFit(it->second,_histos1d[it->first+"_mu"],_histos1d[it->first+"_sigma"],1,0);
+        if (nThreads_ == 1)
+            HistogramHelpers::profileYwithIterativeGaussFit(it->second,_histos1d[it->first+"_mu"],_histos1d[it->first+"_sigma"],1,0,fitCache_);
+        else
+            HistogramHelpers::profileYwithIterativeGaussFitMT(it->second,_histos1d[it->first+"_mu"],_histos1d[it->first+"_sigma"],1,nThreads_,0,fitCache_);
     }       
     return true;
 }
@@ -102,6 +110,11 @@ void VtxHistoProcessor::finalize() {
     //Close the projection file
     HistogramHelpers::CloseProjectionFile();
 
+    if (fitCache_) {
+        fitCache_->printStats();
+        delete fitCache_;
+    }
+
     delete inF_;
 }
 
@@ -564,6 +564,12 @@ bool utils::getParticlesFromVertex(Vertex* vtx, Particle* ele, Particle* pos) {
 }
 
 double utils::getKalmanTrackL1Isolations(Track* track, std::vector<TrackerHit*>* siClusters){
+    SiClusterIndex siClusterIndex;
+    siClusterIndex.build(siClusters);
+    return getKalmanTrackL1Isolations(track, siClusterIndex);
+}
+
+double utils::getKalmanTrackL1Isolations(Track* track, const SiClusterIndex& siClusterIndex){
     double L1_axial_iso = 999999.9;
     double L1_stereo_iso = 999999.9;
     //Loop over hits on track
@@ -574,15 +580,13 @@ double utils::getKalmanTrackL1Isolations(Track* track, std::vector<TrackerHit*>*
         int trackhit_layer = track_hit->getLayer();
         int trackhit_volume = track_hit->getVolume();
         double trackhit_y = track_hit->getGlobalY();
-        double trackhit_charge = track_hit->getRawCharge();
-        double trackhit_time = track_hit->getTime();
 
         //Only look at L1
         if(trackhit_layer > 1)
             continue;
 
         //Get rawhit strip information
-        std::vector<int> trackhit_rawhits = track_hit->getRawHitStripNumbers();
+        const std::vector<int>& trackhit_rawhits = track_hit->getRawHitStripNumbers();
         if(trackhit_rawhits.size() < 1)
             continue;
         int trackhit_maxstrip = *max_element(trackhit_rawhits.begin(), trackhit_rawhits.end());
@@ -601,62 +605,13 @@ double utils::getKalmanTrackL1Isolations(Track* track, std::vector<TrackerHit*>*
                 isAxial = true;
         }
 
-        //Loop over all SiClusters in event
-        //Find closest/best alternative SiCluster to track hit 
-        TrackerHit* closest_althit = nullptr;
+        //Find closest alternative SiCluster further from beam-axis in Global Y,
+        //within +-30ns (based on SiClustersOnTrack t distr) and not adjacent to the track hit
         double isohit_dy = 999999.9;
-        double closest_dcharge = 99999.9;
-        double closest_dt = 999999.9;
-        double isohit_y = 999999.9;
-
-        if ( siClusters == nullptr )
-            return isohit_dy;
-        for(int j = 0; j < siClusters->size(); j++){
-            TrackerHit* althit = siClusters->at(j);
-            int althit_id = althit->getID();
-            int althit_volume = althit->getVolume();
-            int althit_layer = althit->getLayer();
-            double althit_y = althit->getGlobalY();
-            double althit_charge = althit->getRawCharge();
-            double althit_time = althit->getTime();
-
-            //Skip if SiCluster not on same layer as track hit
-            if (althit_layer != trackhit_layer)
-                continue;
-
-            //Skip if volume doesn't match
-            if(althit_volume != trackhit_volume)
-                continue;
-
-            //Skip same hit
-            if (althit_id == trackhit_id)
-                continue;
-
-            //Only look at hits that are further from beam-axis in Global Y
-            if ( (trackhit_volume == 0 && althit_y < trackhit_y) ||
-                    (trackhit_volume == 1 && althit_y > trackhit_y))
-                continue;
-
-            //Require alternative hits to be within +-30ns (based on SiClustersOnTrack t distr)
-            if(std::abs(althit_time) > 30.0)
-                continue;
-
-            //Skip adjacent rawhits
-            std::vector<int> althit_rawhits = althit->getRawHitStripNumbers();
-            int althit_maxstrip = *max_element(althit_rawhits.begin(), althit_rawhits.end());
-            int althit_minstrip = *min_element(althit_rawhits.begin(), althit_rawhits.end());
-            if(trackhit_minstrip - althit_maxstrip <= 1 && althit_minstrip - trackhit_maxstrip <= 1)
-                continue;
-
-            //Pick closest alternative hit
-            if (std::abs(trackhit_y - althit_y) < isohit_dy){
-                isohit_dy = std::abs(trackhit_y-althit_y);
-                closest_althit = althit;
-                closest_dcharge = trackhit_charge - althit_charge;
-                closest_dt = trackhit_time - althit_time;
-                isohit_y = althit_y;
-            }
-        }
+        const SiClusterIndex::Entry* closest_althit = siClusterIndex.findClosestOutward(trackhit_volume,
+                trackhit_layer, trackhit_id, trackhit_y, trackhit_minstrip, trackhit_maxstrip, 30.0);
+        if (closest_althit)
+            isohit_dy = std::abs(trackhit_y - closest_althit->y);
 
         if(isAxial)
             L1_axial_iso = isohit_dy;
@@ -14,10 +14,10 @@ python run_jobPool.py -t hpstr -c /home/pbutti/run/anaKalVtxTuple_cfg.py  -i ${i
 python run_jobPool.py -t hpstr -c /home/pbutti/run/anaKalVtxTuple_cfg.py  -i ${inputPath}/hpstr_ntuples/ -z 1 -o ${inputPath}/hpstr_histos_KF/ -r root -p 10 -e "-wKF"
 
 
-#Hadd the histograms
-echo "hadding the outputs..."
-hadd ${inputPath}/hpstr_histos_GBL/${out_histoFilename}.root ${inputPath}/hpstr_histos_GBL/*.root
-hadd ${inputPath}/hpstr_histos_KF/${out_histoFilename}.root ${inputPath}/hpstr_histos_KF/*.root
+#Merge the histograms
+echo "merging the outputs..."
+hpstr --merge -j 10 ${inputPath}/hpstr_histos_GBL/${out_histoFilename}.root ${inputPath}/hpstr_histos_GBL/*.root
+hpstr --merge -j 10 ${inputPath}/hpstr_histos_KF/${out_histoFilename}.root ${inputPath}/hpstr_histos_KF/*.root
 
 #Make the projections
 echo "Making the projections...."